@@ -24,10 +24,11 @@
 #define MY_SIGN(x) (((x)>=0.0)?1:-1)
   double OneDimSolver::newton(FuncOneDim* func,double l,double r,double acc,
 			      double facc,int brRight,double boundR,double fl,
-			      double df,double rat,const char* debName)
+			      double df,double rat,const char* debName,
+			      bool fHalve)
   {
     int j,lsgn;
-    double f,df2,rat2,dx,temp,rts,olds,alpha;
+    double f,df2,rat2,dx,temp,rts,olds,oldf,alpha;
     bool nextBisect,didNewton,numerErr;
 
     if (!func->hasDerivative())
@@ -122,7 +123,10 @@
       // Newton step falls out of the bracket.
       // If we take the Newton step and find out that by doing so, the
       // bracket shrunk by a fraction less than 0.15, we set 'nextBisect'
-      // to true, which leads to bisection in the next turn.
+      // to true, which leads to bisection in the next turn. If 'fHalve',
+      // this is not done if |f| shrunk by a factor 2 at least. This lets
+      // Newton steps continue which converge from one side of the bracket
+      // (typical after a warm start, see 'newtonWarm').
 #ifdef HAVE_DEBUG
       if (debName!=0)
 	cout << debName << ": [l=" << l << ",r=" << r << "]" << endl;
@@ -145,6 +149,7 @@
 	  cout << debName << ":   Newton: rts=" << rts << endl;
 #endif
       }
+      oldf=fabs(f);
       func->evalStable(rts,&f,&df,&rat);
       if (fabs(f)<facc) return rts;
       else if (MY_SIGN(f)==lsgn) l=rts;
@@ -154,11 +159,79 @@
       if (debName!=0)
 	cout << debName << ":   f(rts)=" << f << ",df=" << df << endl;
 #endif
-      nextBisect=didNewton && (temp>0.85*olds); // Bisection step next?
+      nextBisect=didNewton && (temp>0.85*olds) &&
+	!(fHalve && fabs(f)<0.5*oldf); // Bisection step next?
       olds=temp;
     }
     throw NumericalException("OneDimSolver::newton failed: Maximum number of iterations exceeded");
   }
+
+  /*
+   * Represents g(y) = f(-y), for searching to the left in 'newtonWarm'.
+   */
+  class OneDimSolver_Reflect : public FuncOneDim
+  {
+  protected:
+    FuncOneDim* func;
+
+  public:
+    OneDimSolver_Reflect(FuncOneDim* pfunc) : func(pfunc) {}
+
+    bool hasDerivative() const {
+      return true;
+    }
+
+    void eval(double x,double* f,double* df) {
+      func->eval(-x,f,df);
+      *df=-(*df);
+    }
+
+    void evalStable(double x,double* f,double* df,double* rat) {
+      func->evalStable(-x,f,df,rat);
+      *df=-(*df); *rat=-(*rat);
+    }
+  };
+
+  double OneDimSolver::newtonWarm(FuncOneDim* func,double x0,double l,
+				  double r,double acc,double facc,int lsgn,
+				  int brRight,double boundR,const char* debName)
+  {
+    double f,df,rat,dx,lim;
+    bool hasLim=(brRight!=brackRightInfinite);
+
+    if (!func->hasDerivative())
+      throw InvalidParameterException("'func' must return derivatives!");
+    if (lsgn!=1 && lsgn!=-1)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    // f can be evaluated in [l,lim]
+    lim=(brRight==brackRightRegular)?r:(boundR-acc);
+    if (!(x0>=l+acc) || (hasLim && !(x0<=lim-acc)))
+      return newton(func,l,r,acc,facc,brRight,boundR,debName); // Cold start
+    func->evalStable(x0,&f,&df,&rat);
+#ifdef HAVE_DEBUG
+    if (debName!=0)
+      cout << debName << ": Warm start: x0=" << x0 << ",f=" << f << ",df="
+	   << df << endl;
+#endif
+    if (fabs(f)<facc) return x0;
+    if (MY_SIGN(f)==lsgn) {
+      // Root in (x0,r]. 'dx' is the first step ('newton' uses 'acc' if
+      // 'dx'<=0)
+      if (!((dx=-1.1*rat)>0.0)) dx=0.0;
+      if (hasLim && x0+dx>lim-acc)
+	dx=0.9*(lim-acc-x0);
+      return newton(func,x0,x0+dx,acc,facc,hasLim?brackRightBound:
+		    brackRightInfinite,lim+acc,f,df,rat,debName,true);
+    } else {
+      // Root in [l,x0): Search on g(y) = f(-y) from -x0, bound -l
+      OneDimSolver_Reflect refl(func);
+      if (!((dx=1.1*rat)>0.0)) dx=0.0;
+      if (x0-dx<l+acc)
+	dx=0.9*(x0-l-acc);
+      return -newton(&refl,-x0,dx-x0,acc,facc,brackRightBound,acc-l,f,-df,
+		     -rat,debName,true);
+    }
+  }
 #undef MY_SIGN
 #undef MAXIT
 //ENDNS
@@ -61,7 +61,9 @@
      * The algorithm is started from l. At each iteration, a Newton step is
      * attempted from the last recent point (l or r). If this falls out of
      * [l,r], a bisection step is done. If a Newton step is taken, but the
-     * bracket shrinks by less than 15%, the next step is a bisection.
+     * bracket shrinks by less than 15%, the next step is a bisection. If
+     * 'fHalve' is true, this bisection is skipped if |f| shrank by a factor
+     * 2 at least (used by 'newtonWarm').
      * <p>
      * Not passing the right bracket end r:
      * If 'brRight'!='brackRightRegular', no right bracket end has to be
@@ -114,11 +116,13 @@
      * @param rat       Value f(l)/f'(l). Optional
      * @param debName   Name for debug messages. Def.: 0 (no debug messages)
      *                  (only if HAVE_DEBUG defined)
+     * @param fHalve    See above. Def.: false
      * @return          Solution
      */
     static double newton(FuncOneDim* func,double l,double r,double acc,
 			 double facc,int brRight,double boundR,double fl,
-			 double df,double rat,const char* debName=0);
+			 double df,double rat,const char* debName=0,
+			 bool fHalve=false);
 
     static double newton(FuncOneDim* func,double l,double r,double acc,
 			 double facc,int brRight=brackRightRegular,
@@ -132,6 +136,41 @@
 
       return newton(func,l,r,acc,facc,brRight,boundR,fl,df,rat,debName);
     }
+
+    /**
+     * Warm-started variant of 'newton', for a starting point 'x0' which is
+     * close to the solution (say, the solution of a similar problem).
+     * 'l', 'r', 'brRight', 'boundR' are as for 'newton', the root must lie
+     * in the bracket, and f(l) must have sign 'lsgn' (f is not evaluated
+     * at l).
+     * We evaluate f at 'x0'. If f(x0) has sign 'lsgn', the root lies to the
+     * right of 'x0', and 'newton' is run with left bracket end 'x0', the
+     * first step being the Newton step at 'x0' (enlarged by 10%). The right
+     * end is not exceeded ('brackRightBound' is used with a regular
+     * bracket). Otherwise, the root lies in [l,x0], and the same is done
+     * for f(-x) (see 'newton'), with bound -l.
+     * If 'x0' is close to the root, the first step typically brackets it,
+     * and one or two more evaluations are needed.
+     * If 'x0' is not inside the bracket (by 'acc'), 'newton' is called.
+     * NOTE: A search to the left does not make use of f(l), so it is slow
+     * if the root is very close to l.
+     *
+     * @param func    Function f
+     * @param x0      Starting point
+     * @param l       See 'newton'
+     * @param r       "
+     * @param acc     "
+     * @param facc    "
+     * @param lsgn    Sign of f(l): +1 or -1
+     * @param brRight See 'newton'. Def: 'brackRightRegular'
+     * @param boundR  "
+     * @param debName "
+     * @return        Solution
+     */
+    static double newtonWarm(FuncOneDim* func,double x0,double l,double r,
+			     double acc,double facc,int lsgn,
+			     int brRight=brackRightRegular,double boundR=0.0,
+			     const char* debName=0);
   };
 //ENDNS
 
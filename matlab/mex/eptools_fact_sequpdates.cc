@@ -84,6 +84,7 @@
  * - SD_TOPVAL:   " [double array; I/O]
  * - SD_SUBIND    " [int32 array]
  * - SD_SUBEXCL   ". Def.: false
+ * - SD_HEAP      ". Use heap per variable? Def.: false
  *
  * Return:
  * - RSTAT:       Return stati for each update. Optional
@@ -107,7 +108,7 @@ char errMsg[512];
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
   int n,m,argidx;
-  double piminthres,dampfact=0.0,sd_subexcl=0;
+  double piminthres,dampfact=0.0,sd_subexcl=0,sd_heap=0;
   int* updjind,*pm_potids,*pm_numpot,*pm_parshrd,*rp_rowind,*rp_colind;
   double* pm_parvec,*rp_bvals,*rp_pi,*rp_beta,*margpi,*margbeta;
   int nupdjind,npm_potids,npm_numpot,npm_parshrd,nrp_rowind,nrp_colind,
@@ -156,8 +157,11 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
       M_GETDARRAY(sd_topval,"SD_TOPVAL");
       if (nrhs>19) {
 	M_GETIARRAY(sd_subind,"SD_SUBIND");
-	if (nrhs>20)
+	if (nrhs>20) {
 	  M_GETISCAL(sd_subexcl,"SD_SUBEXCL");
+	  if (nrhs>21)
+	    M_GETISCAL(sd_heap,"SD_HEAP");
+	}
       }
     }
   }
@@ -176,14 +180,14 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   /*sprintf(errstr,"nupdjind=%d. Call wrapper",nupdjind);
     printMsgStdout(errstr);*/
   annobj=getZeroVoidArray(npm_potids); /* Dummy void* array */
-  eptwrap_fact_sequpdates(std::min(nrhs+1,22),nlhs,n,m,M_ARR(updjind),
+  eptwrap_fact_sequpdates(std::min(nrhs+1,23),nlhs,n,m,M_ARR(updjind),
 			  M_ARR(pm_potids),M_ARR(pm_numpot),M_ARR(pm_parvec),
 			  M_ARR(pm_parshrd),annobj,npm_potids,M_ARR(rp_rowind),
 			  M_ARR(rp_colind),M_ARR(rp_bvals),M_ARR(rp_pi),
 			  M_ARR(rp_beta),M_ARR(margpi),M_ARR(margbeta),
 			  piminthres,dampfact,M_ARR(sd_numvalid),
 			  M_ARR(sd_topind),M_ARR(sd_topval),M_ARR(sd_subind),
-			  sd_subexcl,M_ARR(rstat),M_ARR(delta),
+			  sd_subexcl,sd_heap,M_ARR(rstat),M_ARR(delta),
 			  M_ARR(sd_dampfact),&sd_nupd,&sd_nrec,&errcode,errstr);
   mxFree((void*) annobj);
   /*printMsgStdout("Exit from wrapper");*/
@@ -10,6 +10,8 @@ basic subclasses of the B coupling factor hierarchy.
 import numpy as np
 import scipy.sparse as ssp
 import numbers
+import struct
+import sys
 
 import apbsint.helpers as helpers
 
@@ -583,14 +585,37 @@ class MatFactorizedInf(MatSparse):
     - Internal representation of B: 'rowind', 'colind', 'bvals'. See
       comments in C++ class 'FactorizedEPRepresentation' for details
     - Sparse matrix B**2 in 'b2fact' (required for variance computations)
+    'rowind', 'colind' have dtype np.int32, unless 'colind' (2*nnz+n+1
+    entries) does not fit into 32-bit indexes, in which case np.int64 is
+    used. Only 'FactSession', 'fact_compmarginals', 'fact_compmaxpi'
+    support np.int64 indexes.
+    If 'single'==True, 'bvals' has dtype np.float32, and the EP parameters
+    of a representation for this factor are stored in single precision as
+    well (marginals and EP updates are still computed in double
+    precision). This halves the memory for per-nonzero arrays. It is
+    supported by the same functions as np.int64 indexes (not in combination
+    with them), and not for potentials with bounded variance.
+    If 'mx' is a file name, 'rowind', 'colind', 'bvals' are memory-mapped
+    from a file written by 'save' (see there for the format).
+    The arrays are then shared with other processes mapping the same file,
+    and nothing has to be built. They are mapped copy-on-write, but never
+    written to. 'mx' refers to the same arrays, 'b2fact' is None then (it
+    is needed for test factors only).
     """
-    def __init__(self,mx):
+    # File format of 'save', '_load_mapped'
+    _file_tag = '@FactEPReprFile'
+    _file_ffver = 1
+    _file_align = 64
+
+    def __init__(self,mx,single=False):
         if isinstance(mx,MatFactorizedInf):
             MatSparse.__init__(self,mx)
             self.rowind = mx.rowind
             self.colind = mx.colind
             self.bvals = mx.bvals
             self.b2fact = mx.b2fact
+        elif isinstance(mx,basestring):
+            self._load_mapped(mx)
         else:
             if not isinstance(mx,ssp.csr_matrix):
                 raise TypeError('MX must be scipy.sparse.csr_matrix')
@@ -599,8 +624,17 @@ class MatFactorizedInf(MatSparse):
             m, n = mx.shape
             # The ssp.csr_matrix format is pretty much what we need for
             # 'rowind' and 'bvals'
-            self.bvals = mx.data.copy()
-            self.rowind = np.empty(mx.nnz+m+1,dtype=np.int32)
+            if single:
+                self.bvals = mx.data.astype(np.float32)
+            else:
+                self.bvals = mx.data.copy()
+            if 2*mx.nnz+n+1 > np.iinfo(np.int32).max:
+                if single:
+                    raise ValueError('SINGLE not supported for this size')
+                itype = np.int64
+            else:
+                itype = np.int32
+            self.rowind = np.empty(mx.nnz+m+1,dtype=itype)
             self.rowind[:m+1] = mx.indptr
             self.rowind[m+1:] = mx.indices
             # 'colind': V_i are obtained by doing the same on the transpose.
@@ -609,10 +643,10 @@ class MatFactorizedInf(MatSparse):
             # fact, we fill in 1:nnz and subtract 1 later, as otherwise the 0
             # does not count as data entry
             tmpm = ssp.csr_matrix((np.arange(1,mx.nnz+1),mx.indices,
-                                   mx.indptr),shape=(m,n),dtype=np.int32)
+                                   mx.indptr),shape=(m,n),dtype=itype)
             tmpm = tmpm.T.tocsr()  # Transpose
             tmpm.sort_indices()
-            self.colind = np.empty(2*mx.nnz+n+1,dtype=np.int32)
+            self.colind = np.empty(2*mx.nnz+n+1,dtype=itype)
             self.colind[:n+1] = 2*tmpm.indptr+(n+1)
             off = 0; off2 = n+1
             for i in xrange(1,n+1):
@@ -631,6 +665,74 @@ class MatFactorizedInf(MatSparse):
     def get_mat(self):
         return self.mx
 
+    def save(self,fname):
+        """
+        Writes 'rowind', 'colind', 'bvals' to file 'fname', which can be
+        memory-mapped by passing 'fname' to the constructor. Arrays are
+        written in the byte order of this machine.
+        File format:
+        - Tag '@FactEPReprFile'
+        - FF version, byte order of arrays (0: big, 1: little endian),
+          byte size of index entries (4 or 8), byte size of values (4 or
+          8), n, m [4 byte int, big endian]
+        - nnz, byte offsets of 'rowind', 'colind', 'bvals' from start of
+          file [8 byte int, big endian]
+        - Arrays 'rowind' (size nnz+m+1), 'colind' (2*nnz+n+1), 'bvals'
+          (nnz), each starting at a multiple of 64 bytes
+        """
+        m, n = self.shape()
+        nnz = self.bvals.shape[0]
+        align = MatFactorizedInf._file_align
+        hsz = len(MatFactorizedInf._file_tag)+4+5*4+4*8
+        offs = []
+        pos = hsz
+        for arr in (self.rowind, self.colind, self.bvals):
+            pos = ((pos+align-1)//align)*align
+            offs.append(pos)
+            pos += arr.nbytes
+        border = 0 if sys.byteorder == 'big' else 1
+        fid = open(fname,'wb')
+        fid.write(MatFactorizedInf._file_tag)
+        fid.write(struct.pack('>6i',MatFactorizedInf._file_ffver,border,
+                              self.rowind.itemsize,self.bvals.itemsize,n,m))
+        fid.write(struct.pack('>4q',nnz,offs[0],offs[1],offs[2]))
+        pos = hsz
+        for (off, arr) in zip(offs,(self.rowind, self.colind, self.bvals)):
+            fid.write('\0'*(off-pos))
+            np.ascontiguousarray(arr).tofile(fid)
+            pos = off+arr.nbytes
+        fid.close()
+
+    # Internal methods
+
+    def _load_mapped(self,fname):
+        fid = open(fname,'rb')
+        tag = MatFactorizedInf._file_tag
+        if fid.read(len(tag)) != tag:
+            raise ValueError("File '%s' has wrong format" % fname)
+        (ffver, border, isz, vsz, n, m) = struct.unpack('>6i',fid.read(24))
+        (nnz, off_row, off_col, off_b) = struct.unpack('>4q',fid.read(32))
+        fid.close()
+        if ffver != MatFactorizedInf._file_ffver:
+            raise ValueError("File '%s': Unsupported FF version" % fname)
+        if border != (0 if sys.byteorder == 'big' else 1):
+            raise ValueError("File '%s': Written with different byte order" %
+                             fname)
+        if not (isz in (4, 8) and vsz in (4, 8) and (isz, vsz) != (8, 4)):
+            raise ValueError("File '%s': Header entries invalid" % fname)
+        itype = np.int32 if isz == 4 else np.int64
+        vtype = np.float32 if vsz == 4 else np.float64
+        self.rowind = np.memmap(fname,dtype=itype,mode='c',offset=off_row,
+                                shape=(nnz+m+1,))
+        self.colind = np.memmap(fname,dtype=itype,mode='c',offset=off_col,
+                                shape=(2*nnz+n+1,))
+        self.bvals = np.memmap(fname,dtype=vtype,mode='c',offset=off_b,
+                               shape=(nnz,))
+        mx = ssp.csr_matrix((self.bvals,self.rowind[m+1:],self.rowind[:m+1]),
+                            shape=(m,n),copy=False)
+        MatSparse.__init__(self,mx)
+        self.b2fact = None
+
 # Testcode (really basic)
 
 if __name__ == "__main__":
@@ -761,6 +761,10 @@ class EPFactorizedInfDriver(InfDriver):
         we iterate sequentially over all potentials in random ordering.
         Selective damping is used (and the SD representation updated) iff
         activated (see apbsint.RepresentationFactorized).
+        Sweeps are run by epx.FactSession.sweeps in C++ (random orderings
+        are drawn from a generator seeded by np.random). With test
+        statistics ('bc_testmodel') or debugging, sweeps are run one by
+        one from here.
         'opts' attributes:
         - maxit: Maximum number of sweeps
         - deltaeps: Threshold for convergence (statistic based on relative
@@ -772,10 +776,62 @@ class EPFactorizedInfDriver(InfDriver):
           Def.: 1e-8
         - refresh: If True, marginals are refreshed from messages after each
           sweep. Def.: True
+        - refresh_dirty: If True (and 'refresh'), only marginals of
+          variables touched by updates of the sweep are refreshed. Results
+          are the same, unless rounding drift exceeds 'drifttol', in which
+          case a full refresh is done. Ignored by 'parallel', 'hogwild'.
+          Def.: False
+        - drifttol: See 'refresh_dirty'. Def.: 1e-6
         - skip_gauss: If True, EP updates are not done on potentials of type
           'Gaussian'. Def.: False
         - upd_1stsweep: See apbsint.EPCoupSequentialInfDriver.inference.
           Optional
+        - nthreads: If >1, each sweep is partitioned into batches of
+          potentials which do not share variables, and updates within a
+          batch are done by 'nthreads' threads (see epx.fact_colupdates).
+          Results are the same as for sequential updates. Requires the
+          extension to be built with OpenMP. Not supported for potentials
+          with annotation objects. Def.: 1
+        - hogwild: If True (and 'nthreads'>1), updates are done
+          asynchronously by 'nthreads' threads, without any coordination
+          (see epx.fact_asyncupdates). Marginals are refreshed at the end
+          of each sweep. Results are not deterministic. Selective damping
+          is not supported. Def.: False
+        - parallel: If True, parallel (synchronous) updates are done in
+          each sweep: all updates are w.r.t. the marginals before the
+          sweep, which are recomputed at the end (see epx.fact_parupdates).
+          Computations are distributed over 'nthreads' threads. Results
+          differ from sequential updates. Use damping. Def.: False
+        - residual: If True, sweeps use residual scheduling: after the
+          first sweep, potentials are updated in the order of their
+          last change (relative), and those whose neighbours have not
+          changed are not updated again. A sweep stops once all expected
+          changes are below 'deltaeps' (see epx.FactSession.sweeps,
+          mode 4). Sequential, cannot be combined with 'nthreads'>1,
+          'parallel', 'hogwild'. Def.: False
+        - maxfanout: For 'residual': variables with more potentials than
+          this do not pass on changes (0: no limit). Def.: 0
+        - freeze_sweeps: If positive, potentials whose change stays below
+          'freeze_eps' for this many consecutive sweeps are frozen (not
+          updated), until the marginals of their variables move by more
+          than 'react_tol' (relative). Cannot be combined with 'residual'.
+          Def.: 0 (no freezing)
+        - freeze_eps: S.a. Def.: 'deltaeps'
+        - react_tol: S.a. Def.: 'freeze_eps'
+        - moment_tol: If positive, local EP updates of potentials sharing
+          the same parameters are answered by interpolation in tables
+          built during the run, up to an error of about this value (see
+          epx.FactSession.momtables). Worthwhile for potentials whose
+          updates need numerical quadrature. Def.: 0 (no tables)
+        - warm_start: Local EP updates which solve a proximal map (potentials
+          with numerical quadrature) start from the solution of the
+          previous update on the same potential. Not used with test
+          statistics or debugging. Def.: False
+        - sd_heap: If True (and selective damping is active), max_k pi_ki is
+          tracked by a heap for each variable, kept across all sweeps (see
+          epx.FactSession). No recomputations are needed, which pays off if
+          some variables are touched by very many potentials. Costs 20
+          bytes per nonzero of B. Def.: False
         - res_det: Return detailed results in 'res_det' (below)? Def.: False
         - verbose: Verbosity level (0: no messages, 1: some messages). Def.: 0
         - bc_testmodel: See apbsint.EPCoupParallelInfDriver.inference.
@@ -788,12 +844,13 @@ class EPFactorizedInfDriver(InfDriver):
         - 2: Skipped due to local EP update error
         - 3: Skipped due to invalid new marginal ('piminthres')
         - 4: Skipped due to selective damping
+        - 5: Skipped since potential retired
         'res' attributes:
         - rstat: Return status (0: Converged to 'deltaeps'; 1: Done
           'maxit' sweeps)
         - nit: Number of sweeps done
         - delta: Value convergence statistic after last sweep
-        - nskip: Skip status histogram (vector of size 5), summed over all
+        - nskip: Skip status histogram (vector of size 6), summed over all
           updates and sweeps
         - nsdamp: Only if selective damping active. Number of non-skipped
           updates which were selectively damped
@@ -801,6 +858,9 @@ class EPFactorizedInfDriver(InfDriver):
         - delta: Value after each sweep
         - nskip: Matrix, each row skip status histogram for a sweep
         - nsdamp: S.a. Value for each sweep
+        - nrefresh: Number of marginals refreshed after each sweep
+        - nfrozen: Number of frozen potentials in each sweep (not counted
+          in 'nskip')
         """
         opts.imode = 'Factorized'
         self._infer_check_commonargs(opts)
@@ -821,6 +881,85 @@ class EPFactorizedInfDriver(InfDriver):
                 raise TypeError('OPTS.SKIP_GAUSS wrong')
         except AttributeError:
             opts.skip_gauss = False
+        try:
+            if not (isinstance(opts.nthreads,numbers.Integral) and
+                    opts.nthreads>0):
+                raise TypeError('OPTS.NTHREADS wrong')
+        except AttributeError:
+            opts.nthreads = 1
+        try:
+            if not isinstance(opts.hogwild,bool):
+                raise TypeError('OPTS.HOGWILD wrong')
+        except AttributeError:
+            opts.hogwild = False
+        try:
+            if not isinstance(opts.parallel,bool):
+                raise TypeError('OPTS.PARALLEL wrong')
+        except AttributeError:
+            opts.parallel = False
+        if opts.parallel and opts.hogwild:
+            raise ValueError('OPTS.PARALLEL, OPTS.HOGWILD cannot both be True')
+        try:
+            if not isinstance(opts.residual,bool):
+                raise TypeError('OPTS.RESIDUAL wrong')
+        except AttributeError:
+            opts.residual = False
+        if opts.residual and (opts.parallel or opts.hogwild or
+                              opts.nthreads>1):
+            raise ValueError('OPTS.RESIDUAL: Only for sequential updates')
+        try:
+            if not (isinstance(opts.maxfanout,numbers.Integral) and
+                    opts.maxfanout>=0):
+                raise TypeError('OPTS.MAXFANOUT wrong')
+        except AttributeError:
+            opts.maxfanout = 0
+        try:
+            if not (isinstance(opts.freeze_sweeps,numbers.Integral) and
+                    opts.freeze_sweeps>=0):
+                raise TypeError('OPTS.FREEZE_SWEEPS wrong')
+        except AttributeError:
+            opts.freeze_sweeps = 0
+        if opts.freeze_sweeps>0 and opts.residual:
+            raise ValueError('OPTS.FREEZE_SWEEPS: Not with OPTS.RESIDUAL')
+        try:
+            if not (isinstance(opts.freeze_eps,numbers.Real) and
+                    opts.freeze_eps>0.):
+                raise TypeError('OPTS.FREEZE_EPS wrong')
+        except AttributeError:
+            opts.freeze_eps = opts.deltaeps
+        try:
+            if not (isinstance(opts.react_tol,numbers.Real) and
+                    opts.react_tol>0.):
+                raise TypeError('OPTS.REACT_TOL wrong')
+        except AttributeError:
+            opts.react_tol = opts.freeze_eps
+        try:
+            if not (isinstance(opts.moment_tol,numbers.Real) and
+                    opts.moment_tol>=0.):
+                raise TypeError('OPTS.MOMENT_TOL wrong')
+        except AttributeError:
+            opts.moment_tol = 0.
+        try:
+            if not isinstance(opts.warm_start,bool):
+                raise TypeError('OPTS.WARM_START wrong')
+        except AttributeError:
+            opts.warm_start = False
+        try:
+            if not isinstance(opts.sd_heap,bool):
+                raise TypeError('OPTS.SD_HEAP wrong')
+        except AttributeError:
+            opts.sd_heap = False
+        try:
+            if not isinstance(opts.refresh_dirty,bool):
+                raise TypeError('OPTS.REFRESH_DIRTY wrong')
+        except AttributeError:
+            opts.refresh_dirty = False
+        try:
+            if not (isinstance(opts.drifttol,numbers.Real) and
+                    opts.drifttol>0.):
+                raise TypeError('OPTS.DRIFTTOL wrong')
+        except AttributeError:
+            opts.drifttol = 1e-6
         # Initialization
         bfact = self.model.bfact
         potman = self.model.potman
@@ -831,9 +970,21 @@ class EPFactorizedInfDriver(InfDriver):
             do_seldamp = (rep.sd_numk>0)
         except AttributeError:
             do_seldamp = False
+        # Update mode. Asynchronous updates do not support selective damping
+        # ('FactorizedEPDriver::asyncSweep'), this is checked here
+        if opts.parallel:
+            umode = 2 # Parallel updates (epx.fact_parupdates)
+        elif opts.hogwild and opts.nthreads>1:
+            if do_seldamp:
+                raise ValueError('OPTS.HOGWILD: Selective damping not supported')
+            umode = 3 # Asynchronous updates (epx.fact_asyncupdates)
+        elif opts.nthreads>1:
+            umode = 1 # Colored parallel updates (epx.fact_colupdates)
+        else:
+            umode = 0 # Sequential updates (epx.fact_sequpdates)
         res = helpers.Struct()
         res.rstat = 1
-        res.nskip = np.zeros(5,dtype=np.int32)
+        res.nskip = np.zeros(6,dtype=np.int32)
         if do_seldamp:
             res.nsdamp = 0
         if opts.res_det:
@@ -843,6 +994,27 @@ class EPFactorizedInfDriver(InfDriver):
             res_det.nsdamp = []
         if do_1stsweep:
             ind_swp1 = set(potman.filterpots(opts.upd_1stsweep))
+        # Session object: Potential manager, representation, SD structure are
+        # created and checked once (see epx.FactSession). It refers to the
+        # arrays in 'rep', which are modified in place
+        if not do_seldamp:
+            sess = epx.FactSession(n,m,potman.potids,potman.numpot,
+                                   potman.parvec,potman.parshrd,potman.annobj,
+                                   bfact.rowind,bfact.colind,bfact.bvals,
+                                   rep.ep_pi,rep.ep_beta,rep.marg_pi,
+                                   rep.marg_beta,opts.piminthres,opts.nthreads)
+        else:
+            sess = epx.FactSession(n,m,potman.potids,potman.numpot,
+                                   potman.parvec,potman.parshrd,potman.annobj,
+                                   bfact.rowind,bfact.colind,bfact.bvals,
+                                   rep.ep_pi,rep.ep_beta,rep.marg_pi,
+                                   rep.marg_beta,opts.piminthres,opts.nthreads,
+                                   rep.sd_numvalid,rep.sd_topind,rep.sd_topval,
+                                   rep.sd_subind,rep.sd_subexcl,opts.sd_heap)
+        if opts.moment_tol>0.:
+            ntab = sess.momtables(opts.moment_tol)
+            if opts.verbose>0:
+                print 'Moment tables: %d' % ntab
         try:
             targets = self._binclass_assemble_targets(opts)
             do_teststats = True
@@ -859,7 +1031,65 @@ class EPFactorizedInfDriver(InfDriver):
             do_deb_matcomp = True
         except AttributeError:
             do_deb_matcomp = False
-        # Loop over sweeps
+        if opts.residual and (do_deb_matcomp or do_teststats):
+            raise ValueError('OPTS.RESIDUAL: Not with test statistics or debugging')
+        if opts.freeze_sweeps>0 and (do_deb_matcomp or do_teststats):
+            raise ValueError('OPTS.FREEZE_SWEEPS: Not with test statistics or debugging')
+        if not (do_deb_matcomp or do_teststats):
+            # Complete run is done by the session object (see
+            # epx.FactSession.sweeps): random orderings, filtering by
+            # potential type, statistics, refresh, convergence test
+            if opts.skip_gauss:
+                skipids = np.array([epx.getpotid('Gaussian')],dtype=np.int32)
+            else:
+                skipids = None
+            if do_1stsweep:
+                firstids = np.array([epx.getpotid(x) for x in
+                                     opts.upd_1stsweep],dtype=np.int32)
+            else:
+                firstids = None
+            if opts.refresh and opts.refresh_dirty:
+                srefresh = 'dirty'
+            else:
+                srefresh = opts.refresh
+            (res.nit, rstat, sdelta, snskip, snsdamp, snrefresh,
+             snfrozen) = \
+                sess.sweeps(opts.maxit,opts.deltaeps,opts.damp,
+                            4 if opts.residual else umode,srefresh,
+                            np.random.randint(2**31-1),skipids,firstids,
+                            drifttol=opts.drifttol,maxfanout=opts.maxfanout,
+                            freezek=opts.freeze_sweeps,
+                            freezeeps=opts.freeze_eps,
+                            reacttol=opts.react_tol,
+                            warmstart=opts.warm_start)
+            res.rstat = rstat
+            res.delta = sdelta[-1]
+            res.nskip += np.int32(np.sum(snskip,0))
+            if do_seldamp:
+                res.nsdamp = int(np.sum(snsdamp))
+            if opts.res_det:
+                res_det.delta = list(sdelta)
+                res_det.nskip = [list(x) for x in snskip]
+                if do_seldamp:
+                    res_det.nsdamp = list(snsdamp)
+                res_det.nrefresh = list(snrefresh)
+                res_det.nfrozen = list(snfrozen)
+            if opts.verbose>0:
+                for it in xrange(res.nit):
+                    nskip = list(snskip[it])
+                    print 'It. %d: delta=%f, nnskip=%d' % (it+1,sdelta[it],
+                                                           sum(nskip[1:]))
+                    if do_seldamp:
+                        print '   nskip=', nskip, ', nsdamp=%d' % snsdamp[it]
+                    else:
+                        print '   nskip=', nskip
+                    if opts.freeze_sweeps>0:
+                        print '   nfrozen=%d' % snfrozen[it]
+            if opts.res_det:
+                return (res, res_det)
+            else:
+                return res
+        # Loop over sweeps (only for test statistics or debugging)
         for res.nit in range(1,opts.maxit+1):
             if not do_deb_matcomp:
                 if not opts.skip_gauss:
@@ -875,29 +1105,15 @@ class EPFactorizedInfDriver(InfDriver):
             else:
                 deb_mc = scipy.io.loadmat(opts.deb_matcomp_fname % res.nit)
                 updind = deb_mc['updind'].ravel()
-            # Everything is done by epx.fact_sequpdates
+            # Everything is done by the session object
             sz = updind.shape[0]
             rstat = np.empty(sz,dtype=np.int32)
             delta = np.empty(sz)
             if not do_seldamp:
-                epx.fact_sequpdates(n,m,updind,potman.potids,potman.numpot,
-                                    potman.parvec,potman.parshrd,potman.annobj,
-                                    bfact.rowind,bfact.colind,bfact.bvals,
-                                    rep.ep_pi,rep.ep_beta,rep.marg_pi,
-                                    rep.marg_beta,opts.piminthres,opts.damp,
-                                    rstat,delta)
+                sess.updates(updind,opts.damp,umode,rstat,delta)
             else:
                 sd_dampfact = np.empty(sz)
-                sd_nupd, sd_nrec = \
-                    epx.fact_sequpdates(n,m,updind,potman.potids,potman.numpot,
-                                        potman.parvec,potman.parshrd,
-                                        potman.annobj,bfact.rowind,
-                                        bfact.colind,bfact.bvals,rep.ep_pi,
-                                        rep.ep_beta,rep.marg_pi,rep.marg_beta,
-                                        opts.piminthres,opts.damp,rstat,delta,
-                                        rep.sd_numvalid,rep.sd_topind,
-                                        rep.sd_topval,rep.sd_subind,
-                                        rep.sd_subexcl,sd_dampfact)
+                sess.updates(updind,opts.damp,umode,rstat,delta,sd_dampfact)
                 # Among non-skipped updates, count those for which SD_DAMPFACT
                 # larger than OPTS.DAMP
                 nsdamp = np.sum(sd_dampfact[np.nonzero(rstat==0)] > opts.damp)
@@ -905,8 +1121,8 @@ class EPFactorizedInfDriver(InfDriver):
                 if opts.res_det:
                     res_det.nsdamp.append(nsdamp)
             res.delta = max(delta)
-            nskip = [0]*5
-            for k in xrange(5):
+            nskip = [0]*6
+            for k in xrange(6):
                 nskip[k] = np.sum(rstat==k)
             res.nskip += np.array(nskip,dtype=np.int32)
             if opts.res_det:
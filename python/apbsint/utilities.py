@@ -13,6 +13,8 @@ import numpy as np
 import scipy.sparse as ssp
 import scipy.linalg as sla
 import numbers
+import struct
+import sys
 import time  # For profiling
 
 import apbsint.helpers as helpers
@@ -261,20 +263,20 @@ class Representation:
 
     """
     def __init__(self,bfact,ep_pi=None,ep_beta=None):
+        self.bfact = bfact
         self.ep_pi = None
         if ep_pi is not None:
             self.setpi(ep_pi)
         self.ep_beta = None
         if ep_beta is not None:
             self.setbeta(ep_beta)
-        self.bfact = bfact
 
     def setpi(self,ep_pi):
         sz = self.size_pars()
         if not helpers.check_vecsize(ep_pi,sz):
             raise TypeError('EP_PI must be vector of size {0}'.format(sz))
         if self.ep_pi is None:
-            self.ep_pi = np.empty(sz)
+            self.ep_pi = np.empty(sz,dtype=self.pars_dtype())
         self.ep_pi[:] = ep_pi
 
     def setbeta(self,ep_beta):
@@ -282,7 +284,7 @@ class Representation:
         if not helpers.check_vecsize(ep_beta,sz):
             raise TypeError('EP_BETA must be vector of size {0}'.format(sz))
         if self.ep_beta is None:
-            self.ep_beta = np.empty(sz)
+            self.ep_beta = np.empty(sz,dtype=self.pars_dtype())
         self.ep_beta[:] = ep_beta
 
     # Internal methods
@@ -293,6 +295,12 @@ class Representation:
         """
         raise NotImplementedError('SIZE_PARS must be implemented')
 
+    def pars_dtype(self):
+        """
+        Returns dtype of EP parameter vectors ep_pi, ep_beta
+        """
+        return np.float64
+
 class RepresentationCoupled(Representation):
     """
     RepresentationCoupled
@@ -568,37 +576,132 @@ class RepresentationFactorized(Representation):
     EP posterior representation in factorized mode. B (in 'bfact') is a
     sparse matrix (see apbsint.MatFactorizedInf).
     'ep_pi', 'ep_beta' are the message parameters (flat, size 'bfact.nnz()').
+    They have the same dtype as 'bfact.bvals' (np.float32 if 'bfact' was
+    created with 'single'==True).
     'marg_pi', 'marg_beta' are the marginals (natural parameters).
 
     Selective damping is supported if 'sd_numk' is given. The SD
     representation tracks max_k pi_{k,i} for each variable, it is
     initialized/recomputed by 'seldamp_reset'.
+
+    If the model has bivariate precision potentials (they come last), their
+    message parameters 'ep_a', 'ep_c' (size m_prec) and index 'tauind' are
+    set by 'setprec' ('tauind' as for C++ class
+    'FactorizedEPRepresentation'). 'refresh' then computes the marginals
+    'marg_a', 'marg_c' as well. Otherwise, these are None.
+
+    The EP state (message parameters, marginals, SD representation and
+    optionally the potential parameters) can be checkpointed by
+    'save_state' and restored by 'load_state'. Restored arrays are
+    memory-mapped copy-on-write, and neither 'refresh' nor 'seldamp_reset'
+    have to be called.
     """
+    # File format of 'save_state', 'load_state'
+    _file_tag = '@FactEPStateFile'
+    _file_ffver = 1
+    _file_align = 64
+    _file_numarr = 14
+
     def __init__(self,bfact,ep_pi=None,ep_beta=None):
         if not isinstance(bfact,cf.MatFactorizedInf):
             raise TypeError('BFACT must be apbsint.MatFactorizedInf')
         Representation.__init__(self,bfact,ep_pi,ep_beta)
+        self.tauind = None
+        self.ep_a = None
+        self.ep_c = None
+        self.marg_a = None
+        self.marg_c = None
 
     def size_pars(self):
         return self.bfact.nnz()
 
-    def refresh(self):
+    def setprec(self,tauind,ep_a,ep_c):
+        """
+        Sets message parameters 'ep_a', 'ep_c' of bivariate precision
+        potentials, and the index 'tauind' (dtype np.int32) which assigns
+        them to precision variables k=0,...,K-1. Only for 32-bit index and
+        double precision.
+        """
+        bf = self.bfact
+        if not (bf.rowind.dtype == np.int32 and
+                bf.bvals.dtype == np.float64):
+            raise ValueError('Only for 32-bit index and double precision')
+        if not (helpers.check_vecsize(tauind) and
+                tauind.dtype == np.int32):
+            raise TypeError('TAUIND must be numpy.ndarray with dtype numpy.int32')
+        mprec = ep_a.shape[0]
+        if not (mprec>0 and helpers.check_vecsize(ep_c,mprec) and
+                mprec<=bf.shape(0)):
+            raise TypeError('EP_A, EP_C wrong')
+        if not (tauind.shape[0]>mprec and
+                tauind.shape[0] == 2*mprec+tauind[mprec]+2):
+            raise TypeError('TAUIND has wrong size')
+        self.tauind = tauind
+        self.ep_a = ep_a
+        self.ep_c = ep_c
+
+    def pars_dtype(self):
+        return self.bfact.bvals.dtype
+
+    def refresh(self,nthreads=1,seldamp=False):
         """
         Recomputes marginals 'marg_pi', 'marg_beta' from message parameters
-        'ep_pi', 'ep_beta'.
+        'ep_pi', 'ep_beta' (and 'marg_a', 'marg_c' from 'ep_a', 'ep_c' if
+        'setprec' has been called). If 'seldamp'==True, the selective damping
+        representation (see 'seldamp_reset', which must have been called)
+        is recomputed as well, in the same pass over B. The pass is
+        distributed over 'nthreads' threads (32-bit index and double
+        precision only, otherwise a single thread is used).
         """
         bf = self.bfact
         m, n = bf.shape()
         if self.ep_pi is None or self.ep_beta is None:
             raise ValueError('EP parameters must be initialized')
         try:
-            self.marg_pi.resize(n,refcheck=False)
-            self.marg_beta.resize(n,refcheck=False)
+            if self.marg_pi.shape[0] != n or self.marg_beta.shape[0] != n:
+                self.marg_pi.resize(n,refcheck=False)
+                self.marg_beta.resize(n,refcheck=False)
         except AttributeError:
             self.marg_pi = np.empty(n)
             self.marg_beta = np.empty(n)
-        epx.fact_compmarginals(n,m,bf.rowind,bf.colind,bf.bvals,self.ep_pi,
-                               self.ep_beta,self.marg_pi,self.marg_beta)
+        if seldamp:
+            try:
+                numk = self.sd_numk
+            except AttributeError:
+                raise ValueError('SD representation must be initialized (call seldamp_reset)')
+        if self.tauind is not None:
+            numtau = self.tauind[self.ep_a.shape[0]]
+            if self.marg_a is None or self.marg_a.shape[0] != numtau:
+                self.marg_a = np.empty(numtau)
+                self.marg_c = np.empty(numtau)
+            epx.fact_compmarginals_bvprec(n,m,bf.rowind,bf.colind,bf.bvals,
+                                          self.ep_pi,self.ep_beta,
+                                          self.tauind,self.ep_a,self.ep_c,
+                                          self.marg_pi,self.marg_beta,
+                                          self.marg_a,self.marg_c)
+        if bf.rowind.dtype == np.int32 and bf.bvals.dtype == np.float64:
+            if seldamp:
+                epx.fact_compmarginals_maxpi(n,m,bf.rowind,bf.colind,bf.bvals,
+                                             self.ep_pi,self.ep_beta,
+                                             self.marg_pi,self.marg_beta,
+                                             nthreads,numk,self.sd_numvalid,
+                                             self.sd_topind,self.sd_topval,
+                                             self.sd_subind,
+                                             int(self.sd_subexcl))
+            else:
+                epx.fact_compmarginals_maxpi(n,m,bf.rowind,bf.colind,bf.bvals,
+                                             self.ep_pi,self.ep_beta,
+                                             self.marg_pi,self.marg_beta,
+                                             nthreads)
+        else:
+            epx.fact_compmarginals(n,m,bf.rowind,bf.colind,bf.bvals,
+                                   self.ep_pi,self.ep_beta,self.marg_pi,
+                                   self.marg_beta)
+            if seldamp:
+                (self.sd_numvalid[:], self.sd_topind[:], self.sd_topval[:]) \
+                    = epx.fact_compmaxpi(n,m,bf.rowind,bf.colind,bf.bvals,
+                                         self.ep_pi,self.ep_beta,numk,
+                                         self.sd_subind,self.sd_subexcl)
 
     def predict(self,pbfact,pmeans,pvars=None):
         if not isinstance(pbfact,cf.MatFactorizedInf):
@@ -643,6 +746,167 @@ class RepresentationFactorized(Representation):
         self.sd_subexcl = subexcl
         self.sd_numk = numk
 
+    def save_state(self,fname,potman=None):
+        """
+        Writes EP state to file 'fname': message parameters 'ep_pi',
+        'ep_beta', marginals 'marg_pi', 'marg_beta', the bivariate
+        precision part if 'setprec' has been called, and the SD
+        representation if 'seldamp_reset' has been called. If 'potman'
+        (apbsint.PotManager) is given, its parameter vector is written as
+        well. B is not written (see apbsint.MatFactorizedInf.save).
+        File format:
+        - Tag '@FactEPStateFile'
+        - FF version, byte order of arrays (0: big, 1: little endian),
+          byte size of EP parameters (4 or 8), n, m, m_prec, K, SD numk,
+          SD subexcl, size of SD subind [4 byte int, big endian]
+        - nnz, size of parameter vector, byte offsets of the 14 arrays
+          below from start of file (0 if not present) [8 byte int, big
+          endian]
+        - Arrays 'ep_pi', 'ep_beta' (nnz), 'marg_pi', 'marg_beta' (n),
+          'ep_a', 'ep_c' (m_prec), 'tauind' (2*m_prec+K+2), 'marg_a',
+          'marg_c' (K), 'sd_numvalid' (n), 'sd_topind', 'sd_topval'
+          (n*(numk+1)), 'sd_subind', parameter vector, each starting at a
+          multiple of 64 bytes, in the byte order of this machine
+        """
+        m, n = self.bfact.shape()
+        nnz = self.size_pars()
+        try:
+            margs = (self.marg_pi, self.marg_beta)
+        except AttributeError:
+            raise ValueError('Marginals must be initialized (call refresh)')
+        if self.ep_pi is None or self.ep_beta is None:
+            raise ValueError('EP parameters must be initialized')
+        # Arrays in file order (None: not present)
+        arrs = [self.ep_pi, self.ep_beta, margs[0], margs[1]] + [None]*10
+        mprec = 0
+        numtau = 0
+        if self.tauind is not None:
+            if self.marg_a is None:
+                raise ValueError('Marginals must be initialized (call refresh)')
+            mprec = self.ep_a.shape[0]
+            numtau = self.marg_a.shape[0]
+            arrs[4:9] = [self.ep_a, self.ep_c, self.tauind, self.marg_a,
+                         self.marg_c]
+        numk = 0
+        subexcl = 0
+        numsub = 0
+        if getattr(self,'sd_numk',0) > 0:
+            numk = self.sd_numk
+            arrs[9:12] = [self.sd_numvalid, self.sd_topind, self.sd_topval]
+            if self.sd_subind is not None:
+                arrs[12] = self.sd_subind
+                numsub = self.sd_subind.shape[0]
+            subexcl = 1 if self.sd_subexcl else 0
+        numpar = 0
+        if potman is not None:
+            potman.check_internal()
+            arrs[13] = potman.parvec
+            numpar = potman.parvec.shape[0]
+        cls = RepresentationFactorized
+        align = cls._file_align
+        hsz = len(cls._file_tag)+10*4+(cls._file_numarr+2)*8
+        offs = []
+        pos = hsz
+        for arr in arrs:
+            if arr is None:
+                offs.append(0)
+            else:
+                pos = ((pos+align-1)//align)*align
+                offs.append(pos)
+                pos += arr.nbytes
+        border = 0 if sys.byteorder == 'big' else 1
+        fid = open(fname,'wb')
+        fid.write(cls._file_tag)
+        fid.write(struct.pack('>10i',cls._file_ffver,border,
+                              self.ep_pi.itemsize,n,m,mprec,numtau,numk,
+                              subexcl,numsub))
+        fid.write(struct.pack('>16q',nnz,numpar,*offs))
+        pos = hsz
+        for (off, arr) in zip(offs,arrs):
+            if arr is not None:
+                fid.write('\0'*(off-pos))
+                np.ascontiguousarray(arr).tofile(fid)
+                pos = off+arr.nbytes
+        fid.close()
+
+    def load_state(self,fname,potman=None):
+        """
+        Restores EP state from file 'fname' written by 'save_state'.
+        'ep_pi', 'ep_beta', 'marg_pi', 'marg_beta', the bivariate precision
+        part and the SD representation (if present) are memory-mapped
+        copy-on-write: pages are copied only once they are written to, the
+        file is not modified. If 'potman' is given, its parameters are set
+        from the file (they must have been saved).
+        """
+        m, n = self.bfact.shape()
+        cls = RepresentationFactorized
+        fid = open(fname,'rb')
+        tag = cls._file_tag
+        if fid.read(len(tag)) != tag:
+            raise ValueError("File '%s' has wrong format" % fname)
+        (ffver, border, vsz, fn, fm, mprec, numtau, numk, subexcl,
+         numsub) = struct.unpack('>10i',fid.read(40))
+        hdrl = struct.unpack('>16q',fid.read(16*8))
+        fid.close()
+        (nnz, numpar) = hdrl[:2]
+        offs = hdrl[2:]
+        if ffver != cls._file_ffver:
+            raise ValueError("File '%s': Unsupported FF version" % fname)
+        if border != (0 if sys.byteorder == 'big' else 1):
+            raise ValueError("File '%s': Written with different byte order" %
+                             fname)
+        if (fn, fm, nnz) != (n, m, self.size_pars()):
+            raise ValueError("File '%s': Sizes do not match BFACT" % fname)
+        vtype = np.float32 if vsz == 4 else np.float64
+        if vtype != self.pars_dtype():
+            raise ValueError("File '%s': EP parameters have wrong dtype" %
+                             fname)
+        if mprec<0 or mprec>m or (mprec>0 and numtau<1):
+            raise ValueError("File '%s': Header entries invalid" % fname)
+        mapped = lambda k, dt, sz: np.memmap(fname,dtype=dt,mode='c',
+                                             offset=offs[k],shape=(sz,))
+        self.ep_pi = mapped(0,vtype,nnz)
+        self.ep_beta = mapped(1,vtype,nnz)
+        self.marg_pi = mapped(2,np.float64,n)
+        self.marg_beta = mapped(3,np.float64,n)
+        if mprec > 0:
+            self.ep_a = mapped(4,np.float64,mprec)
+            self.ep_c = mapped(5,np.float64,mprec)
+            self.tauind = np.array(mapped(6,np.int32,2*mprec+numtau+2))
+            self.marg_a = mapped(7,np.float64,numtau)
+            self.marg_c = mapped(8,np.float64,numtau)
+        else:
+            self.tauind = self.ep_a = self.ep_c = None
+            self.marg_a = self.marg_c = None
+        if numk > 0:
+            self.sd_numk = numk
+            self.sd_numvalid = mapped(9,np.int32,n)
+            self.sd_topind = mapped(10,np.int32,n*(numk+1))
+            self.sd_topval = mapped(11,np.float64,n*(numk+1))
+            self.sd_subind = None
+            if numsub > 0:
+                self.sd_subind = np.array(mapped(12,np.int32,numsub))
+            self.sd_subexcl = (subexcl != 0)
+        if potman is not None:
+            if numpar == 0:
+                raise ValueError("File '%s': No potential parameters" % fname)
+            potman.check_internal()
+            if potman.parvec.shape[0] != numpar:
+                raise ValueError("File '%s': POTMAN has wrong number of parameters" % fname)
+            parvec = np.array(mapped(13,np.float64,numpar))
+            off = 0
+            for el in potman.elem:
+                pars = []
+                for par in el.pars:
+                    if isinstance(par,float):
+                        pars.append(float(parvec[off]))
+                        off += 1
+                    else:
+                        sz = par.shape[0]
+                        pars.append(parvec[off:off+sz].copy())
+                        off += sz
+                el.setpars(tuple(pars))
+
 # Testcode (really basic)
 
 if __name__ == "__main__":
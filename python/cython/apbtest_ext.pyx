@@ -14,8 +14,32 @@ cimport numpy as np
 # Declarations: Static methods as functions
 
 cdef extern from "src/eptools/potentials/SpecfunServices.h" namespace "SpecfunServices":
+    double logPdfNormal(double z)
+    double cdfNormal(double z)
     double logCdfNormal(double z)
     double derivLogCdfNormal(double z)
+    void logPdfNormal(double* z,double* res,int n)
+    void cdfNormal(double* z,double* res,int n)
+    void logCdfNormal(double* z,double* res,int n)
+    void derivLogCdfNormal(double* z,double* res,int n)
+    int getSimdLevel()
+    void setSimdLevel(int lev) except +
+
+cdef extern from "src/eptools/potentials/quad/QuadPotProximal.h":
+    cdef cppclass QuadPotProximal:
+        void setPars(double* pv) except +
+        bint proximal(double h,double rho,double& sstar)
+        void proximalBatch(int num,double* h,double* rho,double** pars,
+                           int* parStr,double* sstar,int* rstat) except +
+
+cdef extern from "src/eptools/potentials/quad/EPPotPoissonLogisticRate.h":
+    cdef cppclass EPPotPoissonLogisticRate(QuadPotProximal):
+        EPPotPoissonLogisticRate(double py,double pacc,double pfacc) except +
+
+cdef extern from "src/eptools/potentials/quad/EPPotNegBinomialExpRate.h":
+    cdef cppclass EPPotNegBinomialExpRate(QuadPotProximal):
+        EPPotNegBinomialExpRate(double py,double pr,double pacc,
+                                double pfacc) except +
 
 # Cython functions
 
@@ -46,3 +70,113 @@ def specfun_derivlogcdfnormal(np.ndarray[np.double_t,ndim=1] z not None,
     # Loop: Compute function values
     for i in range(sz):
         res[i] = derivLogCdfNormal(z[i])
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def specfun_logpdfnormal(np.ndarray[np.double_t,ndim=1] z not None,
+                         np.ndarray[np.double_t,ndim=1] res not None):
+    cdef int i, sz
+    # Check input/output
+    sz = z.shape[0]
+    if not res.shape[0]==sz:
+        raise TypeError('RES must be same size as Z')
+    # Loop: Compute function values
+    for i in range(sz):
+        res[i] = logPdfNormal(z[i])
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def specfun_cdfnormal(np.ndarray[np.double_t,ndim=1] z not None,
+                      np.ndarray[np.double_t,ndim=1] res not None):
+    cdef int i, sz
+    # Check input/output
+    sz = z.shape[0]
+    if not res.shape[0]==sz:
+        raise TypeError('RES must be same size as Z')
+    # Loop: Compute function values
+    for i in range(sz):
+        res[i] = cdfNormal(z[i])
+
+# Array methods of SpecfunServices (SIMD kernels). Z, RES must be
+# contiguous. SPECFUN_SETSIMDLEVEL limits the instruction set used (0:
+# scalar loop, 1: generic, 2: AVX2, 3: AVX-512), SPECFUN_GETSIMDLEVEL
+# returns the one in use
+
+def specfun_getsimdlevel():
+    return getSimdLevel()
+
+def specfun_setsimdlevel(int lev):
+    setSimdLevel(lev)
+
+def specfun_logpdfnormal_arr(np.ndarray[np.double_t,ndim=1,mode='c'] z not None,
+                             np.ndarray[np.double_t,ndim=1,mode='c'] res not None):
+    if not res.shape[0]==z.shape[0]:
+        raise TypeError('RES must be same size as Z')
+    logPdfNormal(<double*> z.data,<double*> res.data,z.shape[0])
+
+def specfun_cdfnormal_arr(np.ndarray[np.double_t,ndim=1,mode='c'] z not None,
+                          np.ndarray[np.double_t,ndim=1,mode='c'] res not None):
+    if not res.shape[0]==z.shape[0]:
+        raise TypeError('RES must be same size as Z')
+    cdfNormal(<double*> z.data,<double*> res.data,z.shape[0])
+
+def specfun_logcdfnormal_arr(np.ndarray[np.double_t,ndim=1,mode='c'] z not None,
+                             np.ndarray[np.double_t,ndim=1,mode='c'] res not None):
+    if not res.shape[0]==z.shape[0]:
+        raise TypeError('RES must be same size as Z')
+    logCdfNormal(<double*> z.data,<double*> res.data,z.shape[0])
+
+def specfun_derivlogcdfnormal_arr(np.ndarray[np.double_t,ndim=1,mode='c'] z not None,
+                                  np.ndarray[np.double_t,ndim=1,mode='c'] res not None):
+    if not res.shape[0]==z.shape[0]:
+        raise TypeError('RES must be same size as Z')
+    derivLogCdfNormal(<double*> z.data,<double*> res.data,z.shape[0])
+
+# Proximal map of 'QuadPotProximalNewton' potentials at (H[j], RHO[j]),
+# parameters in row PARS[j,:]. PTYPE: 0 for EPPotPoissonLogisticRate (y),
+# 1 for EPPotNegBinomialExpRate (y, r). If BATCH is true, 'proximalBatch'
+# is used, otherwise 'proximal' for each j. Results in SSTAR, RSTAT
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def quadprox_newton(int ptype,
+                    np.ndarray[np.double_t,ndim=1,mode='c'] h not None,
+                    np.ndarray[np.double_t,ndim=1,mode='c'] rho not None,
+                    np.ndarray[np.double_t,ndim=2,mode='c'] pars not None,
+                    np.ndarray[np.double_t,ndim=1,mode='c'] sstar not None,
+                    np.ndarray[np.int32_t,ndim=1,mode='c'] rstat not None,
+                    bint batch):
+    cdef QuadPotProximal* pot
+    cdef double* ppar[2]
+    cdef int pstr[2]
+    cdef int j, k, num, npar
+    cdef double s = 0.
+    num = h.shape[0]
+    if ptype==0:
+        npar = 1
+    elif ptype==1:
+        npar = 2
+    else:
+        raise TypeError('PTYPE must be 0 or 1')
+    if not (rho.shape[0]==num and pars.shape[0]==num and
+            pars.shape[1]==npar and sstar.shape[0]==num and
+            rstat.shape[0]==num):
+        raise TypeError('H, RHO, PARS, SSTAR, RSTAT: Wrong sizes')
+    if ptype==0:
+        pot = new EPPotPoissonLogisticRate(0.,1e-10,1e-12)
+    else:
+        pot = new EPPotNegBinomialExpRate(0.,1.,1e-10,1e-12)
+    try:
+        if batch:
+            for k in range(npar):
+                ppar[k] = (<double*> pars.data)+k
+                pstr[k] = npar
+            pot.proximalBatch(num,<double*> h.data,<double*> rho.data,ppar,
+                              pstr,<double*> sstar.data,<int*> rstat.data)
+        else:
+            for j in range(num):
+                pot.setPars((<double*> pars.data)+j*npar)
+                rstat[j] = pot.proximal(h[j],rho[j],s)
+                sstar[j] = s
+    finally:
+        del pot
@@ -8,6 +8,8 @@
 # Declarations: Pointer_to_function types for BLAS functions. Required by
 # eptwrap_choluprk1, eptwrap_choldnrk1
 
+from libc.stdint cimport int64_t
+
 cdef extern from "src/eptools/wrap/matrix_types.h":
     ctypedef int blasint_t
 
@@ -69,6 +71,22 @@ cdef extern from "src/eptools/wrap/eptwrap_fact_compmarginals.h":
                                     double* margbeta,int nmargbeta,
                                     int* errcode,char* errstr)
 
+cdef extern from "src/eptools/wrap/eptwrap_fact_compmarginals_bvprec.h":
+    void eptwrap_fact_compmarginals_bvprec(int ain,int aout,int n,int m,
+                                           int* rp_rowind,int nrp_rowind,
+                                           int* rp_colind,int nrp_colind,
+                                           double* rp_bvals,int nrp_bvals,
+                                           double* rp_pi,int nrp_pi,
+                                           double* rp_beta,int nrp_beta,
+                                           int* rp_tauind,int nrp_tauind,
+                                           double* rp_a,int nrp_a,
+                                           double* rp_c,int nrp_c,
+                                           double* margpi,int nmargpi,
+                                           double* margbeta,int nmargbeta,
+                                           double* marga,int nmarga,
+                                           double* margc,int nmargc,
+                                           int* errcode,char* errstr)
+
 cdef extern from "src/eptools/wrap/eptwrap_fact_compmaxpi.h":
     void eptwrap_fact_compmaxpi(int ain,int aout,int n,int m,int* rp_rowind,
                                 int nrp_rowind,int* rp_colind,int nrp_colind,
@@ -80,6 +98,78 @@ cdef extern from "src/eptools/wrap/eptwrap_fact_compmaxpi.h":
                                 double* sd_topval,int nsd_topval,int* errcode,
                                 char* errstr)
 
+cdef extern from "src/eptools/wrap/eptwrap_fact_compmarginals_i64.h":
+    void eptwrap_fact_compmarginals_i64(int ain,int aout,int n,int m,
+                                        int64_t* rp_rowind,
+                                        int64_t nrp_rowind,
+                                        int64_t* rp_colind,
+                                        int64_t nrp_colind,double* rp_bvals,
+                                        int64_t nrp_bvals,double* rp_pi,
+                                        int64_t nrp_pi,double* rp_beta,
+                                        int64_t nrp_beta,double* margpi,
+                                        int nmargpi,double* margbeta,
+                                        int nmargbeta,int* errcode,
+                                        char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_compmaxpi_i64.h":
+    void eptwrap_fact_compmaxpi_i64(int ain,int aout,int n,int m,
+                                    int64_t* rp_rowind,int64_t nrp_rowind,
+                                    int64_t* rp_colind,int64_t nrp_colind,
+                                    double* rp_bvals,int64_t nrp_bvals,
+                                    double* rp_pi,int64_t nrp_pi,
+                                    double* rp_beta,int64_t nrp_beta,
+                                    int sd_k,int* sd_subind,int nsd_subind,
+                                    int sd_subexcl,int* sd_numvalid,
+                                    int nsd_numvalid,int* sd_topind,
+                                    int nsd_topind,double* sd_topval,
+                                    int nsd_topval,int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_compmarginals_f32.h":
+    void eptwrap_fact_compmarginals_f32(int ain,int aout,int n,int m,
+                                        int* rp_rowind,int nrp_rowind,
+                                        int* rp_colind,int nrp_colind,
+                                        float* rp_bvals,int nrp_bvals,
+                                        float* rp_pi,int nrp_pi,
+                                        float* rp_beta,int nrp_beta,
+                                        double* margpi,int nmargpi,
+                                        double* margbeta,int nmargbeta,
+                                        int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_compmaxpi_f32.h":
+    void eptwrap_fact_compmaxpi_f32(int ain,int aout,int n,int m,
+                                    int* rp_rowind,int nrp_rowind,
+                                    int* rp_colind,int nrp_colind,
+                                    float* rp_bvals,int nrp_bvals,
+                                    float* rp_pi,int nrp_pi,float* rp_beta,
+                                    int nrp_beta,int sd_k,int* sd_subind,
+                                    int nsd_subind,int sd_subexcl,
+                                    int* sd_numvalid,int nsd_numvalid,
+                                    int* sd_topind,int nsd_topind,
+                                    double* sd_topval,int nsd_topval,
+                                    int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_compmarginals_maxpi.h":
+    void eptwrap_fact_compmarginals_maxpi(int ain,int aout,int n,int m,
+                                          int* rp_rowind,int nrp_rowind,
+                                          int* rp_colind,int nrp_colind,
+                                          double* rp_bvals,int nrp_bvals,
+                                          double* rp_pi,int nrp_pi,
+                                          double* rp_beta,int nrp_beta,
+                                          int* rp_tauind,int nrp_tauind,
+                                          double* rp_a,int nrp_a,
+                                          double* rp_c,int nrp_c,
+                                          double* margpi,int nmargpi,
+                                          double* margbeta,int nmargbeta,
+                                          double* marga,int nmarga,
+                                          double* margc,int nmargc,
+                                          int nthreads,int sd_k,
+                                          int* sd_numvalid,int nsd_numvalid,
+                                          int* sd_topind,int nsd_topind,
+                                          double* sd_topval,int nsd_topval,
+                                          int* sd_subind,int nsd_subind,
+                                          int sd_subexcl,int* errcode,
+                                          char* errstr)
+
 cdef extern from "src/eptools/wrap/eptwrap_fact_sequpdates.h":
     void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,int* updjind,
                                  int nupdjind,int* pm_potids,int npm_potids,
@@ -97,11 +187,197 @@ cdef extern from "src/eptools/wrap/eptwrap_fact_sequpdates.h":
                                  int* sd_topind,int nsd_topind,
                                  double* sd_topval,int nsd_topval,
                                  int* sd_subind,int nsd_subind,int sd_subexcl,
-                                 int* rstat,int nrstat,double* delta,
-                                 int ndelta,double* sd_dampfact,
+                                 int sd_heap,int* rstat,int nrstat,
+                                 double* delta,int ndelta,double* sd_dampfact,
                                  int nsd_dampfact,int* sd_nupd,int* sd_nrec,
                                  int* errcode,char* errstr)
 
+cdef extern from "src/eptools/wrap/eptwrap_fact_colupdates.h":
+    void eptwrap_fact_colupdates(int ain,int aout,int n,int m,int* updjind,
+                                 int nupdjind,int* pm_potids,int npm_potids,
+                                 int* pm_numpot,int npm_numpot,
+                                 double* pm_parvec,int npm_parvec,
+                                 int* pm_parshrd,int npm_parshrd,
+                                 void** pm_annobj,int npm_annobj,
+                                 int* rp_rowind,int nrp_rowind,int* rp_colind,
+                                 int nrp_colind,double* rp_bvals,int nrp_bvals,
+                                 double* rp_pi,int nrp_pi,double* rp_beta,
+                                 int nrp_beta,double* margpi,int nmargpi,
+                                 double* margbeta,int nmargbeta,
+                                 double piminthres,double dampfact,
+                                 int nthreads,int* sd_numvalid,
+                                 int nsd_numvalid,int* sd_topind,
+                                 int nsd_topind,double* sd_topval,
+                                 int nsd_topval,int* sd_subind,int nsd_subind,
+                                 int sd_subexcl,int* schedjind,
+                                 int nschedjind,int* nbatch,int* rstat,
+                                 int nrstat,double* delta,int ndelta,
+                                 double* sd_dampfact,int nsd_dampfact,
+                                 int* sd_nupd,int* sd_nrec,int* errcode,
+                                 char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_parupdates.h":
+    void eptwrap_fact_parupdates(int ain,int aout,int n,int m,int* updjind,
+                                 int nupdjind,int* pm_potids,int npm_potids,
+                                 int* pm_numpot,int npm_numpot,
+                                 double* pm_parvec,int npm_parvec,
+                                 int* pm_parshrd,int npm_parshrd,
+                                 void** pm_annobj,int npm_annobj,
+                                 int* rp_rowind,int nrp_rowind,int* rp_colind,
+                                 int nrp_colind,double* rp_bvals,int nrp_bvals,
+                                 double* rp_pi,int nrp_pi,double* rp_beta,
+                                 int nrp_beta,double* margpi,int nmargpi,
+                                 double* margbeta,int nmargbeta,
+                                 double piminthres,double dampfact,
+                                 int nthreads,int* sd_numvalid,
+                                 int nsd_numvalid,int* sd_topind,
+                                 int nsd_topind,double* sd_topval,
+                                 int nsd_topval,int* sd_subind,int nsd_subind,
+                                 int sd_subexcl,int* rstat,int nrstat,
+                                 double* delta,int ndelta,
+                                 double* sd_dampfact,int nsd_dampfact,
+                                 int* sd_nupd,int* sd_nrec,int* errcode,
+                                 char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_asyncupdates.h":
+    void eptwrap_fact_asyncupdates(int ain,int aout,int n,int m,int* updjind,
+                                   int nupdjind,int* pm_potids,int npm_potids,
+                                   int* pm_numpot,int npm_numpot,
+                                   double* pm_parvec,int npm_parvec,
+                                   int* pm_parshrd,int npm_parshrd,
+                                   void** pm_annobj,int npm_annobj,
+                                   int* rp_rowind,int nrp_rowind,
+                                   int* rp_colind,int nrp_colind,
+                                   double* rp_bvals,int nrp_bvals,
+                                   double* rp_pi,int nrp_pi,double* rp_beta,
+                                   int nrp_beta,double* margpi,int nmargpi,
+                                   double* margbeta,int nmargbeta,
+                                   double piminthres,double dampfact,
+                                   int nthreads,int* rstat,int nrstat,
+                                   double* delta,int ndelta,int* errcode,
+                                   char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_create.h":
+    void eptwrap_fact_session_create(int ain,int aout,int n,int m,
+                                     int* pm_potids,int npm_potids,
+                                     int* pm_numpot,int npm_numpot,
+                                     double* pm_parvec,int npm_parvec,
+                                     int* pm_parshrd,int npm_parshrd,
+                                     void** pm_annobj,int npm_annobj,
+                                     int* rp_rowind,int nrp_rowind,
+                                     int* rp_colind,int nrp_colind,
+                                     double* rp_bvals,int nrp_bvals,
+                                     double* rp_pi,int nrp_pi,double* rp_beta,
+                                     int nrp_beta,double* margpi,int nmargpi,
+                                     double* margbeta,int nmargbeta,
+                                     double piminthres,int nthreads,
+                                     int* sd_numvalid,int nsd_numvalid,
+                                     int* sd_topind,int nsd_topind,
+                                     double* sd_topval,int nsd_topval,
+                                     int* sd_subind,int nsd_subind,
+                                     int sd_subexcl,int sd_heap,void** sess,
+                                     int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_create_i64.h":
+    void eptwrap_fact_session_create_i64(int ain,int aout,int n,int m,
+                                         int* pm_potids,int npm_potids,
+                                         int* pm_numpot,int npm_numpot,
+                                         double* pm_parvec,int npm_parvec,
+                                         int* pm_parshrd,int npm_parshrd,
+                                         void** pm_annobj,int npm_annobj,
+                                         int64_t* rp_rowind,
+                                         int64_t nrp_rowind,
+                                         int64_t* rp_colind,
+                                         int64_t nrp_colind,double* rp_bvals,
+                                         int64_t nrp_bvals,double* rp_pi,
+                                         int64_t nrp_pi,double* rp_beta,
+                                         int64_t nrp_beta,double* margpi,
+                                         int nmargpi,double* margbeta,
+                                         int nmargbeta,double piminthres,
+                                         int nthreads,int* sd_numvalid,
+                                         int nsd_numvalid,int* sd_topind,
+                                         int nsd_topind,double* sd_topval,
+                                         int nsd_topval,int* sd_subind,
+                                         int nsd_subind,int sd_subexcl,
+                                         int sd_heap,void** sess,int* errcode,
+                                         char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_create_f32.h":
+    void eptwrap_fact_session_create_f32(int ain,int aout,int n,int m,
+                                         int* pm_potids,int npm_potids,
+                                         int* pm_numpot,int npm_numpot,
+                                         double* pm_parvec,int npm_parvec,
+                                         int* pm_parshrd,int npm_parshrd,
+                                         void** pm_annobj,int npm_annobj,
+                                         int* rp_rowind,int nrp_rowind,
+                                         int* rp_colind,int nrp_colind,
+                                         float* rp_bvals,int nrp_bvals,
+                                         float* rp_pi,int nrp_pi,
+                                         float* rp_beta,int nrp_beta,
+                                         double* margpi,int nmargpi,
+                                         double* margbeta,int nmargbeta,
+                                         double piminthres,int nthreads,
+                                         int* sd_numvalid,int nsd_numvalid,
+                                         int* sd_topind,int nsd_topind,
+                                         double* sd_topval,int nsd_topval,
+                                         int* sd_subind,int nsd_subind,
+                                         int sd_subexcl,int sd_heap,
+                                         void** sess,int* errcode,
+                                         char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_updates.h":
+    void eptwrap_fact_session_updates(int ain,int aout,void* sess,
+                                      int* updjind,int nupdjind,
+                                      double dampfact,int mode,int* rstat,
+                                      int nrstat,double* delta,int ndelta,
+                                      double* sd_dampfact,int nsd_dampfact,
+                                      int* sd_nupd,int* sd_nrec,int* errcode,
+                                      char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_sweeps.h":
+    void eptwrap_fact_session_sweeps(int ain,int aout,void* sess,int maxit,
+                                     double deltaeps,double dampfact,int mode,
+                                     int refresh,int seed,int* skipids,
+                                     int nskipids,int* firstids,int nfirstids,
+                                     int packed,double drifttol,
+                                     int maxfanout,int freezek,
+                                     double freezeeps,double reacttol,
+                                     int warmstart,int* nit,int* rstat,
+                                     double* delta,
+                                     int ndelta,int* nskip,int nnskip,
+                                     int* nsdamp,int nnsdamp,int* nrefresh,
+                                     int nnrefresh,int* nfrozen,int nnfrozen,
+                                     int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_append.h":
+    void eptwrap_fact_session_append(int ain,int aout,void* sess,
+                                     int* pm_potids,int npm_potids,
+                                     int* pm_numpot,int npm_numpot,
+                                     double* pm_parvec,int npm_parvec,
+                                     int* pm_parshrd,int npm_parshrd,
+                                     void** pm_annobj,int npm_annobj,
+                                     int* ap_rowoff,int nap_rowoff,
+                                     int* ap_ind,int nap_ind,
+                                     double* ap_bvals,int nap_bvals,
+                                     double* ap_pi,int nap_pi,
+                                     double* ap_beta,int nap_beta,int* j0,
+                                     int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_retire.h":
+    void eptwrap_fact_session_retire(void* sess,int* retjind,int nretjind,
+                                     int* errcode,char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_momtables.h":
+    void eptwrap_fact_session_momtables(int ain,int aout,void* sess,
+                                        double tol,double* murange,
+                                        int nmurange,double* rhorange,
+                                        int nrhorange,int maxdepth,
+                                        int minshare,int* ntab,int* errcode,
+                                        char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_fact_session_delete.h":
+    void eptwrap_fact_session_delete(void* sess,int* errcode,char* errstr)
+
 cdef extern from "src/eptools/wrap/eptwrap_potmanager_isvalid.h":
     void eptwrap_potmanager_isvalid(int ain,int aout,int* potids,int npotids,
                                     int* numpot,int nnumpot,double* parvec,
@@ -133,6 +409,24 @@ cdef extern from "src/eptools/wrap/eptwrap_epupdate_single.h":
                                   double* alpha,double* nu,double* logz,
                                   int* errcode,char* errstr)
 
+cdef extern from "src/eptools/wrap/eptwrap_epupdate_single_bvprec.h":
+    void eptwrap_epupdate_single_bvprec1(int ain,int aout,int pid,
+                                         double* pars,int npars,void* annobj,
+                                         double cmu,double crho,double ca,
+                                         double cc,int* rstat,double* alpha,
+                                         double* nu,double* hata,double* hatc,
+                                         double* logz,int* errcode,
+                                         char* errstr)
+
+cdef extern from "src/eptools/wrap/eptwrap_epupdate_single_bvprec.h":
+    void eptwrap_epupdate_single_bvprec2(int ain,int aout,char* pname,
+                                         double* pars,int npars,void* annobj,
+                                         double cmu,double crho,double ca,
+                                         double cc,int* rstat,double* alpha,
+                                         double* nu,double* hata,double* hatc,
+                                         double* logz,int* errcode,
+                                         char* errstr)
+
 cdef extern from "src/eptools/wrap/eptwrap_choluprk1.h":
     void eptwrap_choluprk1(int ain,int aout,fst_matrix* lmat,double* vvec,
                            int nvvec,double* cvec,int ncvec,double* svec,
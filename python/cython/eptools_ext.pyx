@@ -144,52 +144,146 @@ def getpotname(int pid):
 
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def fact_compmarginals(int n,int m,np.ndarray[int,ndim=1] rp_rowind not None,
-                       np.ndarray[int,ndim=1] rp_colind not None,
-                       np.ndarray[np.double_t,ndim=1] rp_bvals not None,
-                       np.ndarray[np.double_t,ndim=1] rp_pi not None,
-                       np.ndarray[np.double_t,ndim=1] rp_beta not None,
+def fact_compmarginals(int n,int m,np.ndarray rp_rowind not None,
+                       np.ndarray rp_colind not None,
+                       np.ndarray rp_bvals not None,
+                       np.ndarray rp_pi not None,
+                       np.ndarray rp_beta not None,
                        np.ndarray[np.double_t,ndim=1] margpi not None,
                        np.ndarray[np.double_t,ndim=1] margbeta not None):
     cdef int errcode
     cdef char errstr[512]
+    cdef np.ndarray[int,ndim=1] rowind32
+    cdef np.ndarray[int,ndim=1] colind32
+    cdef np.ndarray[np.int64_t,ndim=1] rowind64
+    cdef np.ndarray[np.int64_t,ndim=1] colind64
+    cdef np.ndarray[np.double_t,ndim=1] bvals64
+    cdef np.ndarray[np.double_t,ndim=1] pi64
+    cdef np.ndarray[np.double_t,ndim=1] beta64
+    cdef np.ndarray[np.float32_t,ndim=1] bvals32
+    cdef np.ndarray[np.float32_t,ndim=1] pi32
+    cdef np.ndarray[np.float32_t,ndim=1] beta32
     # Ensure that input/output arguments are contiguous
     check_contiguous_array(margpi,'MARGPI')
     check_contiguous_array(margbeta,'MARGBETA')
+    # Call C function (int64 index if rp_rowind is int64, single precision
+    # if rp_bvals is float32)
+    if rp_bvals.dtype == np.float32:
+        if rp_rowind.dtype == np.int64:
+            raise ValueError('RP_BVALS: float32 not supported with int64 index')
+        rowind32 = np.ascontiguousarray(rp_rowind)
+        colind32 = np.ascontiguousarray(rp_colind)
+        bvals32 = np.ascontiguousarray(rp_bvals)
+        pi32 = np.ascontiguousarray(rp_pi,dtype=np.float32)
+        beta32 = np.ascontiguousarray(rp_beta,dtype=np.float32)
+        eptwrap_fact_compmarginals_f32(9,0,n,m,&rowind32[0],
+                                       rowind32.shape[0],&colind32[0],
+                                       colind32.shape[0],&bvals32[0],
+                                       bvals32.shape[0],&pi32[0],
+                                       pi32.shape[0],&beta32[0],
+                                       beta32.shape[0],&margpi[0],
+                                       margpi.shape[0],&margbeta[0],
+                                       margbeta.shape[0],&errcode,errstr)
+    else:
+        bvals64 = np.ascontiguousarray(rp_bvals)
+        pi64 = np.ascontiguousarray(rp_pi)
+        beta64 = np.ascontiguousarray(rp_beta)
+        if rp_rowind.dtype == np.int64:
+            rowind64 = np.ascontiguousarray(rp_rowind)
+            colind64 = np.ascontiguousarray(rp_colind,dtype=np.int64)
+            eptwrap_fact_compmarginals_i64(9,0,n,m,&rowind64[0],
+                                           rowind64.shape[0],&colind64[0],
+                                           colind64.shape[0],&bvals64[0],
+                                           bvals64.shape[0],&pi64[0],
+                                           pi64.shape[0],&beta64[0],
+                                           beta64.shape[0],&margpi[0],
+                                           margpi.shape[0],&margbeta[0],
+                                           margbeta.shape[0],&errcode,errstr)
+        else:
+            rowind32 = np.ascontiguousarray(rp_rowind)
+            colind32 = np.ascontiguousarray(rp_colind)
+            eptwrap_fact_compmarginals(9,0,n,m,&rowind32[0],
+                                       rowind32.shape[0],&colind32[0],
+                                       colind32.shape[0],&bvals64[0],
+                                       bvals64.shape[0],&pi64[0],
+                                       pi64.shape[0],&beta64[0],
+                                       beta64.shape[0],&margpi[0],
+                                       margpi.shape[0],&margbeta[0],
+                                       margbeta.shape[0],&errcode,errstr)
+    # Check for error, raise exception
+    if errcode != 0:
+        raise exc.ApBsWrapError(<bytes>errstr)
+
+# Marginals for a model with bivariate precision potentials (see
+# eptwrap_fact_compmarginals_bvprec). Only for 32-bit index and double
+# precision.
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def fact_compmarginals_bvprec(int n,int m,
+                              np.ndarray[int,ndim=1] rp_rowind not None,
+                              np.ndarray[int,ndim=1] rp_colind not None,
+                              np.ndarray[np.double_t,ndim=1] rp_bvals not None,
+                              np.ndarray[np.double_t,ndim=1] rp_pi not None,
+                              np.ndarray[np.double_t,ndim=1] rp_beta not None,
+                              np.ndarray[int,ndim=1] rp_tauind not None,
+                              np.ndarray[np.double_t,ndim=1] rp_a not None,
+                              np.ndarray[np.double_t,ndim=1] rp_c not None,
+                              np.ndarray[np.double_t,ndim=1] margpi not None,
+                              np.ndarray[np.double_t,ndim=1] margbeta not None,
+                              np.ndarray[np.double_t,ndim=1] marga not None,
+                              np.ndarray[np.double_t,ndim=1] margc not None):
+    cdef int errcode
+    cdef char errstr[512]
+    # Ensure that input/output arguments are contiguous
     rp_rowind = np.ascontiguousarray(rp_rowind)
     rp_colind = np.ascontiguousarray(rp_colind)
     rp_bvals = np.ascontiguousarray(rp_bvals)
     rp_pi = np.ascontiguousarray(rp_pi)
     rp_beta = np.ascontiguousarray(rp_beta)
+    rp_tauind = np.ascontiguousarray(rp_tauind)
+    rp_a = np.ascontiguousarray(rp_a)
+    rp_c = np.ascontiguousarray(rp_c)
+    check_contiguous_array(margpi,'MARGPI')
+    check_contiguous_array(margbeta,'MARGBETA')
+    check_contiguous_array(marga,'MARGA')
+    check_contiguous_array(margc,'MARGC')
     # Call C function
-    eptwrap_fact_compmarginals(9,0,n,m,&rp_rowind[0],rp_rowind.shape[0],
-                               &rp_colind[0],rp_colind.shape[0],&rp_bvals[0],
-                               rp_bvals.shape[0],&rp_pi[0],rp_pi.shape[0],
-                               &rp_beta[0],rp_beta.shape[0],&margpi[0],
-                               margpi.shape[0],&margbeta[0],margbeta.shape[0],
-                               &errcode,errstr)
+    eptwrap_fact_compmarginals_bvprec(15,0,n,m,&rp_rowind[0],
+                                      rp_rowind.shape[0],&rp_colind[0],
+                                      rp_colind.shape[0],&rp_bvals[0],
+                                      rp_bvals.shape[0],&rp_pi[0],
+                                      rp_pi.shape[0],&rp_beta[0],
+                                      rp_beta.shape[0],&rp_tauind[0],
+                                      rp_tauind.shape[0],&rp_a[0],
+                                      rp_a.shape[0],&rp_c[0],rp_c.shape[0],
+                                      &margpi[0],margpi.shape[0],
+                                      &margbeta[0],margbeta.shape[0],
+                                      &marga[0],marga.shape[0],&margc[0],
+                                      margc.shape[0],&errcode,errstr)
     # Check for error, raise exception
     if errcode != 0:
         raise exc.ApBsWrapError(<bytes>errstr)
 
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def fact_compmaxpi(int n,int m,np.ndarray[int,ndim=1] rp_rowind not None,
-                   np.ndarray[int,ndim=1] rp_colind not None,
-                   np.ndarray[np.double_t,ndim=1] rp_bvals not None,
-                   np.ndarray[np.double_t,ndim=1] rp_pi not None,
-                   np.ndarray[np.double_t,ndim=1] rp_beta not None,
-                   int sd_k,np.ndarray[int,ndim=1] sd_subind = None,
+def fact_compmaxpi(int n,int m,np.ndarray rp_rowind not None,
+                   np.ndarray rp_colind not None,
+                   np.ndarray rp_bvals not None,np.ndarray rp_pi not None,
+                   np.ndarray rp_beta not None,int sd_k,np.ndarray[int,ndim=1] sd_subind = None,
                    int sd_subexcl = 0):
     cdef int errcode, rsz, subind_n, ain
     cdef char errstr[512]
     cdef int* subind_p
-    # Ensure that input arguments are contiguous
-    rp_rowind = np.ascontiguousarray(rp_rowind)
-    rp_colind = np.ascontiguousarray(rp_colind)
-    rp_bvals = np.ascontiguousarray(rp_bvals)
-    rp_pi = np.ascontiguousarray(rp_pi)
-    rp_beta = np.ascontiguousarray(rp_beta)
+    cdef np.ndarray[int,ndim=1] rowind32
+    cdef np.ndarray[int,ndim=1] colind32
+    cdef np.ndarray[np.int64_t,ndim=1] rowind64
+    cdef np.ndarray[np.int64_t,ndim=1] colind64
+    cdef np.ndarray[np.double_t,ndim=1] bvals64
+    cdef np.ndarray[np.double_t,ndim=1] pi64
+    cdef np.ndarray[np.double_t,ndim=1] beta64
+    cdef np.ndarray[np.float32_t,ndim=1] bvals32
+    cdef np.ndarray[np.float32_t,ndim=1] pi32
+    cdef np.ndarray[np.float32_t,ndim=1] beta32
     # Create return arguments
     if sd_k<2:
         raise ValueError('SD_K: Must be >1')
@@ -210,20 +304,131 @@ def fact_compmaxpi(int n,int m,np.ndarray[int,ndim=1] rp_rowind not None,
         subind_n = sd_subind.shape[0]
         subind_p = &sd_subind[0]
         ain = 10
-    eptwrap_fact_compmaxpi(ain,3,n,m,&rp_rowind[0],rp_rowind.shape[0],
-                           &rp_colind[0],rp_colind.shape[0],&rp_bvals[0],
-                           rp_bvals.shape[0],&rp_pi[0],rp_pi.shape[0],
-                           &rp_beta[0],rp_beta.shape[0],sd_k,subind_p,subind_n,
-                           sd_subexcl,&sd_numvalid[0],sd_numvalid.shape[0],
-                           &sd_topind[0],sd_topind.shape[0],&sd_topval[0],
-                           sd_topval.shape[0],&errcode,errstr)
+    if rp_bvals.dtype == np.float32:
+        if rp_rowind.dtype == np.int64:
+            raise ValueError('RP_BVALS: float32 not supported with int64 index')
+        rowind32 = np.ascontiguousarray(rp_rowind)
+        colind32 = np.ascontiguousarray(rp_colind)
+        bvals32 = np.ascontiguousarray(rp_bvals)
+        pi32 = np.ascontiguousarray(rp_pi,dtype=np.float32)
+        beta32 = np.ascontiguousarray(rp_beta,dtype=np.float32)
+        eptwrap_fact_compmaxpi_f32(ain,3,n,m,&rowind32[0],rowind32.shape[0],
+                                   &colind32[0],colind32.shape[0],
+                                   &bvals32[0],bvals32.shape[0],&pi32[0],
+                                   pi32.shape[0],&beta32[0],beta32.shape[0],
+                                   sd_k,subind_p,subind_n,sd_subexcl,
+                                   &sd_numvalid[0],sd_numvalid.shape[0],
+                                   &sd_topind[0],sd_topind.shape[0],
+                                   &sd_topval[0],sd_topval.shape[0],
+                                   &errcode,errstr)
+    else:
+        bvals64 = np.ascontiguousarray(rp_bvals)
+        pi64 = np.ascontiguousarray(rp_pi)
+        beta64 = np.ascontiguousarray(rp_beta)
+        if rp_rowind.dtype == np.int64:
+            rowind64 = np.ascontiguousarray(rp_rowind)
+            colind64 = np.ascontiguousarray(rp_colind,dtype=np.int64)
+            eptwrap_fact_compmaxpi_i64(ain,3,n,m,&rowind64[0],
+                                       rowind64.shape[0],&colind64[0],
+                                       colind64.shape[0],&bvals64[0],
+                                       bvals64.shape[0],&pi64[0],
+                                       pi64.shape[0],&beta64[0],
+                                       beta64.shape[0],sd_k,subind_p,
+                                       subind_n,sd_subexcl,&sd_numvalid[0],
+                                       sd_numvalid.shape[0],&sd_topind[0],
+                                       sd_topind.shape[0],&sd_topval[0],
+                                       sd_topval.shape[0],&errcode,errstr)
+        else:
+            rowind32 = np.ascontiguousarray(rp_rowind)
+            colind32 = np.ascontiguousarray(rp_colind)
+            eptwrap_fact_compmaxpi(ain,3,n,m,&rowind32[0],rowind32.shape[0],
+                                   &colind32[0],colind32.shape[0],
+                                   &bvals64[0],bvals64.shape[0],&pi64[0],
+                                   pi64.shape[0],&beta64[0],beta64.shape[0],
+                                   sd_k,subind_p,subind_n,sd_subexcl,
+                                   &sd_numvalid[0],sd_numvalid.shape[0],
+                                   &sd_topind[0],sd_topind.shape[0],
+                                   &sd_topval[0],sd_topval.shape[0],
+                                   &errcode,errstr)
     # Check for error, raise exception
     if errcode != 0:
         raise exc.ApBsWrapError(<bytes>errstr)
     return (sd_numvalid,sd_topind,sd_topval)
 
+# Fused refresh: marginals and (if sd_k>0) top-K lists for selective damping
+# in one pass over the columns of B, using nthreads threads. sd_numvalid,
+# sd_topind, sd_topval are overwritten (sizes as returned by fact_compmaxpi).
+# Only for 32-bit index and double precision.
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def fact_compmarginals_maxpi(int n,int m,
+                             np.ndarray[int,ndim=1] rp_rowind not None,
+                             np.ndarray[int,ndim=1] rp_colind not None,
+                             np.ndarray[np.double_t,ndim=1] rp_bvals not None,
+                             np.ndarray[np.double_t,ndim=1] rp_pi not None,
+                             np.ndarray[np.double_t,ndim=1] rp_beta not None,
+                             np.ndarray[np.double_t,ndim=1] margpi not None,
+                             np.ndarray[np.double_t,ndim=1] margbeta not None,
+                             int nthreads = 1,int sd_k = 0,
+                             np.ndarray[int,ndim=1] sd_numvalid = None,
+                             np.ndarray[int,ndim=1] sd_topind = None,
+                             np.ndarray[np.double_t,ndim=1] sd_topval = None,
+                             np.ndarray[int,ndim=1] sd_subind = None,
+                             int sd_subexcl = 0):
+    cdef int errcode, ain, subind_n
+    cdef char errstr[512]
+    cdef int* subind_p
+    cdef int* numvalid_p = NULL
+    cdef int* topind_p = NULL
+    cdef double* topval_p = NULL
+    # Ensure that input/output arguments are contiguous
+    check_contiguous_array(rp_rowind,'RP_ROWIND')
+    check_contiguous_array(rp_colind,'RP_COLIND')
+    check_contiguous_array(rp_bvals,'RP_BVALS')
+    check_contiguous_array(rp_pi,'RP_PI')
+    check_contiguous_array(rp_beta,'RP_BETA')
+    check_contiguous_array(margpi,'MARGPI')
+    check_contiguous_array(margbeta,'MARGBETA')
+    ain = 15
+    if sd_k>0:
+        if sd_numvalid is None or sd_topind is None or sd_topval is None:
+            raise ValueError('SD_NUMVALID, SD_TOPIND, SD_TOPVAL must be given')
+        check_contiguous_array_size(sd_numvalid,'SD_NUMVALID',n)
+        check_contiguous_array_size(sd_topind,'SD_TOPIND',n*(sd_k+1))
+        check_contiguous_array_size(sd_topval,'SD_TOPVAL',n*(sd_k+1))
+        numvalid_p = &sd_numvalid[0]
+        topind_p = &sd_topind[0]
+        topval_p = &sd_topval[0]
+        ain = 21
+    if sd_subind is None:
+        subind_n = 0
+        subind_p = NULL
+    else:
+        sd_subind = np.ascontiguousarray(sd_subind)
+        subind_n = sd_subind.shape[0]
+        subind_p = &sd_subind[0]
+    # Call C function
+    eptwrap_fact_compmarginals_maxpi(ain,0,n,m,&rp_rowind[0],
+                                     rp_rowind.shape[0],&rp_colind[0],
+                                     rp_colind.shape[0],&rp_bvals[0],
+                                     rp_bvals.shape[0],&rp_pi[0],
+                                     rp_pi.shape[0],&rp_beta[0],
+                                     rp_beta.shape[0],NULL,0,NULL,0,NULL,0,
+                                     &margpi[0],margpi.shape[0],&margbeta[0],
+                                     margbeta.shape[0],NULL,0,NULL,0,
+                                     nthreads,sd_k,numvalid_p,
+                                     n if sd_k>0 else 0,topind_p,
+                                     n*(sd_k+1) if sd_k>0 else 0,topval_p,
+                                     n*(sd_k+1) if sd_k>0 else 0,subind_p,
+                                     subind_n,sd_subexcl,&errcode,errstr)
+    # Check for error, raise exception
+    if errcode != 0:
+        raise exc.ApBsWrapError(<bytes>errstr)
+
 # NOTE: sd_nupd, sd_nrec are returned only if rstat, delta, sd_dampfact and
 # sd_numvalid are all given
+# If sd_heap is True, selective damping uses a heap per variable instead of
+# top-K lists (see EPTWRAP_FACT_SEQUPDATES).
 @cython.boundscheck(False)
 @cython.wraparound(False)
 def fact_sequpdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
@@ -247,7 +452,8 @@ def fact_sequpdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
                     np.ndarray[np.double_t,ndim=1] sd_topval = None,
                     np.ndarray[int,ndim=1] sd_subind = None,
                     int sd_subexcl = 0,
-                    np.ndarray[np.double_t,ndim=1] sd_dampfact = None):
+                    np.ndarray[np.double_t,ndim=1] sd_dampfact = None,
+                    sd_heap = False):
     cdef int errcode, rsz, sd_nupd, sd_nrec, aout, ain
     cdef char errstr[512]
     cdef void** annobj_p
@@ -324,6 +530,8 @@ def fact_sequpdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
             subind_n = sd_subind.shape[0]
             subind_p = &sd_subind[0]
             ain += 2
+        if sd_heap:
+            ain = 23
         if sd_dampfact is not None:
             dampfact_n = sd_dampfact.shape[0]
             dampfact_p = &sd_dampfact[0]
@@ -341,16 +549,796 @@ def fact_sequpdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
                             rp_beta.shape[0],&margpi[0],margpi.shape[0],
                             &margbeta[0],margbeta.shape[0],piminthres,dampfact,
                             numvalid_p,numvalid_n,topind_p,topind_n,topval_p,
-                            topval_n,subind_p,subind_n,sd_subexcl,rstat_p,
+                            topval_n,subind_p,subind_n,sd_subexcl,
+                            1 if sd_heap else 0,rstat_p,rstat_n,delta_p,
+                            delta_n,dampfact_p,dampfact_n,&sd_nupd,&sd_nrec,
+                            &errcode,errstr)
+    PyMem_Free(annobj_p)  # Free temp. void* array
+    # Check for error, raise exception
+    if errcode != 0:
+        raise exc.ApBsWrapError(<bytes>errstr)
+    if aout>2:
+        return (sd_nupd,sd_nrec)
+
+# Same as fact_sequpdates, but potentials in updjind are partitioned into
+# batches without shared variables, and updates within a batch are done by
+# nthreads threads. Returns (schedjind, nbatch), where schedjind is the batch
+# ordering of updjind. rstat, delta, sd_dampfact are w.r.t. schedjind.
+# (sd_nupd, sd_nrec) are appended to the return tuple if rstat, delta,
+# sd_dampfact and sd_numvalid are all given.
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def fact_colupdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
+                    np.ndarray[int,ndim=1] pm_potids not None,
+                    np.ndarray[int,ndim=1] pm_numpot not None,
+                    np.ndarray[np.double_t,ndim=1] pm_parvec not None,
+                    np.ndarray[int,ndim=1] pm_parshrd not None,
+                    np.ndarray[np.uint64_t,ndim=1] pm_annobj not None,
+                    np.ndarray[int,ndim=1] rp_rowind not None,
+                    np.ndarray[int,ndim=1] rp_colind not None,
+                    np.ndarray[np.double_t,ndim=1] rp_bvals not None,
+                    np.ndarray[np.double_t,ndim=1] rp_pi not None,
+                    np.ndarray[np.double_t,ndim=1] rp_beta not None,
+                    np.ndarray[np.double_t,ndim=1] margpi not None,
+                    np.ndarray[np.double_t,ndim=1] margbeta not None,
+                    double piminthres,double dampfact = 0.,
+                    int nthreads = 1,
+                    np.ndarray[int,ndim=1] rstat = None,
+                    np.ndarray[np.double_t,ndim=1] delta = None,
+                    np.ndarray[int,ndim=1] sd_numvalid = None,
+                    np.ndarray[int,ndim=1] sd_topind = None,
+                    np.ndarray[np.double_t,ndim=1] sd_topval = None,
+                    np.ndarray[int,ndim=1] sd_subind = None,
+                    int sd_subexcl = 0,
+                    np.ndarray[np.double_t,ndim=1] sd_dampfact = None):
+    cdef int errcode, rsz, sd_nupd, sd_nrec, nbatch, aout, ain
+    cdef char errstr[512]
+    cdef void** annobj_p
+    cdef int rstat_n, delta_n, numvalid_n, topind_n, topval_n, subind_n
+    cdef int dampfact_n
+    cdef int* rstat_p
+    cdef double* delta_p
+    cdef int* numvalid_p
+    cdef int* topind_p
+    cdef double* topval_p
+    cdef int* subind_p
+    cdef double* dampfact_p
+    # Ensure that input/output arguments are contiguous
+    updjind = np.ascontiguousarray(updjind)
+    pm_potids = np.ascontiguousarray(pm_potids)
+    pm_numpot = np.ascontiguousarray(pm_numpot)
+    pm_parvec = np.ascontiguousarray(pm_parvec)
+    pm_parshrd = np.ascontiguousarray(pm_parshrd)
+    rp_rowind = np.ascontiguousarray(rp_rowind)
+    rp_colind = np.ascontiguousarray(rp_colind)
+    rp_bvals = np.ascontiguousarray(rp_bvals)
+    check_contiguous_array(rp_pi,'RP_PI')
+    check_contiguous_array(rp_beta,'RP_BETA')
+    check_contiguous_array(margpi,'MARGPI')
+    check_contiguous_array(margbeta,'MARGBETA')
+    if sd_numvalid is not None:
+        check_contiguous_array(sd_numvalid,'SD_NUMVALID')
+        if sd_topind is None or sd_topval is None:
+            raise ValueError('SD_TOPIND, SD_TOPVAL must be given')
+        check_contiguous_array(sd_topind,'SD_TOPIND')
+        check_contiguous_array(sd_topval,'SD_TOPVAL')
+        if sd_dampfact is not None:
+            check_contiguous_array(sd_dampfact,'SD_DAMPFACT')
+    # Create return arguments
+    rsz = updjind.shape[0]
+    if rsz<1:
+        raise ValueError('UPDJIND must not be empty')
+    cdef np.ndarray[int,ndim=1] schedjind = np.zeros(rsz,dtype=np.int32)
+    # Call C function
+    aout = 2
+    ain = 18
+    rstat_n = 0
+    rstat_p = NULL
+    delta_n = 0
+    delta_p = NULL
+    numvalid_n = 0
+    numvalid_p = NULL
+    topind_n = 0
+    topind_p = NULL
+    topval_n = 0
+    topval_p = NULL
+    subind_n = 0
+    subind_p = NULL
+    dampfact_n = 0
+    dampfact_p = NULL
+    if rstat is not None:
+        check_contiguous_array(rstat,'RSTAT')
+        rstat_n = rstat.shape[0]
+        rstat_p = &rstat[0]
+        aout += 1
+        if delta is not None:
+            check_contiguous_array(delta,'DELTA')
+            delta_n = delta.shape[0]
+            delta_p = &delta[0]
+            aout += 1
+    if sd_numvalid is not None:
+        numvalid_n = sd_numvalid.shape[0]
+        numvalid_p = &sd_numvalid[0]
+        topind_n = sd_topind.shape[0]
+        topind_p = &sd_topind[0]
+        topval_n = sd_topval.shape[0]
+        topval_p = &sd_topval[0]
+        ain += 3
+        if sd_subind is not None:
+            sd_subind = np.ascontiguousarray(sd_subind)
+            subind_n = sd_subind.shape[0]
+            subind_p = &sd_subind[0]
+            ain += 2
+        if sd_dampfact is not None:
+            dampfact_n = sd_dampfact.shape[0]
+            dampfact_p = &sd_dampfact[0]
+            if aout==4:
+                aout = 7
+    annobj_p = make_voidptr_array(pm_annobj)  # Convert to void* array
+    eptwrap_fact_colupdates(ain,aout,n,m,&updjind[0],updjind.shape[0],
+                            &pm_potids[0],pm_potids.shape[0],&pm_numpot[0],
+                            pm_numpot.shape[0],&pm_parvec[0],
+                            pm_parvec.shape[0],&pm_parshrd[0],
+                            pm_parshrd.shape[0],annobj_p,pm_annobj.shape[0],
+                            &rp_rowind[0],rp_rowind.shape[0],&rp_colind[0],
+                            rp_colind.shape[0],&rp_bvals[0],rp_bvals.shape[0],
+                            &rp_pi[0],rp_pi.shape[0],&rp_beta[0],
+                            rp_beta.shape[0],&margpi[0],margpi.shape[0],
+                            &margbeta[0],margbeta.shape[0],piminthres,dampfact,
+                            nthreads,numvalid_p,numvalid_n,topind_p,topind_n,
+                            topval_p,topval_n,subind_p,subind_n,sd_subexcl,
+                            &schedjind[0],schedjind.shape[0],&nbatch,rstat_p,
                             rstat_n,delta_p,delta_n,dampfact_p,dampfact_n,
                             &sd_nupd,&sd_nrec,&errcode,errstr)
     PyMem_Free(annobj_p)  # Free temp. void* array
     # Check for error, raise exception
+    if errcode != 0:
+        raise exc.ApBsWrapError(<bytes>errstr)
+    if aout>4:
+        return (schedjind,nbatch,sd_nupd,sd_nrec)
+    else:
+        return (schedjind,nbatch)
+
+# Parallel (synchronous) variant of fact_sequpdates: Updates on potentials in
+# updjind (distinct entries) are all done w.r.t. the same marginals, which are
+# recomputed at the end. Computations are distributed over nthreads threads.
+# Returns (sd_nupd, sd_nrec) if rstat, delta, sd_dampfact and sd_numvalid are
+# all given.
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def fact_parupdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
+                    np.ndarray[int,ndim=1] pm_potids not None,
+                    np.ndarray[int,ndim=1] pm_numpot not None,
+                    np.ndarray[np.double_t,ndim=1] pm_parvec not None,
+                    np.ndarray[int,ndim=1] pm_parshrd not None,
+                    np.ndarray[np.uint64_t,ndim=1] pm_annobj not None,
+                    np.ndarray[int,ndim=1] rp_rowind not None,
+                    np.ndarray[int,ndim=1] rp_colind not None,
+                    np.ndarray[np.double_t,ndim=1] rp_bvals not None,
+                    np.ndarray[np.double_t,ndim=1] rp_pi not None,
+                    np.ndarray[np.double_t,ndim=1] rp_beta not None,
+                    np.ndarray[np.double_t,ndim=1] margpi not None,
+                    np.ndarray[np.double_t,ndim=1] margbeta not None,
+                    double piminthres,double dampfact = 0.,
+                    int nthreads = 1,
+                    np.ndarray[int,ndim=1] rstat = None,
+                    np.ndarray[np.double_t,ndim=1] delta = None,
+                    np.ndarray[int,ndim=1] sd_numvalid = None,
+                    np.ndarray[int,ndim=1] sd_topind = None,
+                    np.ndarray[np.double_t,ndim=1] sd_topval = None,
+                    np.ndarray[int,ndim=1] sd_subind = None,
+                    int sd_subexcl = 0,
+                    np.ndarray[np.double_t,ndim=1] sd_dampfact = None):
+    cdef int errcode, sd_nupd, sd_nrec, aout, ain
+    cdef char errstr[512]
+    cdef void** annobj_p
+    cdef int rstat_n, delta_n, numvalid_n, topind_n, topval_n, subind_n
+    cdef int dampfact_n
+    cdef int* rstat_p
+    cdef double* delta_p
+    cdef int* numvalid_p
+    cdef int* topind_p
+    cdef double* topval_p
+    cdef int* subind_p
+    cdef double* dampfact_p
+    # Ensure that input/output arguments are contiguous
+    updjind = np.ascontiguousarray(updjind)
+    pm_potids = np.ascontiguousarray(pm_potids)
+    pm_numpot = np.ascontiguousarray(pm_numpot)
+    pm_parvec = np.ascontiguousarray(pm_parvec)
+    pm_parshrd = np.ascontiguousarray(pm_parshrd)
+    rp_rowind = np.ascontiguousarray(rp_rowind)
+    rp_colind = np.ascontiguousarray(rp_colind)
+    rp_bvals = np.ascontiguousarray(rp_bvals)
+    check_contiguous_array(rp_pi,'RP_PI')
+    check_contiguous_array(rp_beta,'RP_BETA')
+    check_contiguous_array(margpi,'MARGPI')
+    check_contiguous_array(margbeta,'MARGBETA')
+    if sd_numvalid is not None:
+        check_contiguous_array(sd_numvalid,'SD_NUMVALID')
+        if sd_topind is None or sd_topval is None:
+            raise ValueError('SD_TOPIND, SD_TOPVAL must be given')
+        check_contiguous_array(sd_topind,'SD_TOPIND')
+        check_contiguous_array(sd_topval,'SD_TOPVAL')
+        if sd_dampfact is not None:
+            check_contiguous_array(sd_dampfact,'SD_DAMPFACT')
+    if updjind.shape[0]<1:
+        raise ValueError('UPDJIND must not be empty')
+    # Call C function
+    aout = 0
+    ain = 18
+    rstat_n = 0
+    rstat_p = NULL
+    delta_n = 0
+    delta_p = NULL
+    numvalid_n = 0
+    numvalid_p = NULL
+    topind_n = 0
+    topind_p = NULL
+    topval_n = 0
+    topval_p = NULL
+    subind_n = 0
+    subind_p = NULL
+    dampfact_n = 0
+    dampfact_p = NULL
+    if rstat is not None:
+        check_contiguous_array(rstat,'RSTAT')
+        rstat_n = rstat.shape[0]
+        rstat_p = &rstat[0]
+        aout += 1
+        if delta is not None:
+            check_contiguous_array(delta,'DELTA')
+            delta_n = delta.shape[0]
+            delta_p = &delta[0]
+            aout += 1
+    if sd_numvalid is not None:
+        numvalid_n = sd_numvalid.shape[0]
+        numvalid_p = &sd_numvalid[0]
+        topind_n = sd_topind.shape[0]
+        topind_p = &sd_topind[0]
+        topval_n = sd_topval.shape[0]
+        topval_p = &sd_topval[0]
+        ain += 3
+        if sd_subind is not None:
+            sd_subind = np.ascontiguousarray(sd_subind)
+            subind_n = sd_subind.shape[0]
+            subind_p = &sd_subind[0]
+            ain += 2
+        if sd_dampfact is not None:
+            dampfact_n = sd_dampfact.shape[0]
+            dampfact_p = &sd_dampfact[0]
+            if aout==2:
+                aout = 5
+    annobj_p = make_voidptr_array(pm_annobj)  # Convert to void* array
+    eptwrap_fact_parupdates(ain,aout,n,m,&updjind[0],updjind.shape[0],
+                            &pm_potids[0],pm_potids.shape[0],&pm_numpot[0],
+                            pm_numpot.shape[0],&pm_parvec[0],
+                            pm_parvec.shape[0],&pm_parshrd[0],
+                            pm_parshrd.shape[0],annobj_p,pm_annobj.shape[0],
+                            &rp_rowind[0],rp_rowind.shape[0],&rp_colind[0],
+                            rp_colind.shape[0],&rp_bvals[0],rp_bvals.shape[0],
+                            &rp_pi[0],rp_pi.shape[0],&rp_beta[0],
+                            rp_beta.shape[0],&margpi[0],margpi.shape[0],
+                            &margbeta[0],margbeta.shape[0],piminthres,dampfact,
+                            nthreads,numvalid_p,numvalid_n,topind_p,topind_n,
+                            topval_p,topval_n,subind_p,subind_n,sd_subexcl,
+                            rstat_p,rstat_n,delta_p,delta_n,dampfact_p,
+                            dampfact_n,
+                            &sd_nupd,&sd_nrec,&errcode,errstr)
+    PyMem_Free(annobj_p)  # Free temp. void* array
+    # Check for error, raise exception
     if errcode != 0:
         raise exc.ApBsWrapError(<bytes>errstr)
     if aout>2:
         return (sd_nupd,sd_nrec)
 
+# Asynchronous ("Hogwild") variant of fact_sequpdates: Updates on potentials
+# in updjind (distinct entries) are done by nthreads threads without
+# coordination, marginals are recomputed at the end. Selective damping is
+# not supported.
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def fact_asyncupdates(int n,int m,np.ndarray[int,ndim=1] updjind not None,
+                      np.ndarray[int,ndim=1] pm_potids not None,
+                      np.ndarray[int,ndim=1] pm_numpot not None,
+                      np.ndarray[np.double_t,ndim=1] pm_parvec not None,
+                      np.ndarray[int,ndim=1] pm_parshrd not None,
+                      np.ndarray[np.uint64_t,ndim=1] pm_annobj not None,
+                      np.ndarray[int,ndim=1] rp_rowind not None,
+                      np.ndarray[int,ndim=1] rp_colind not None,
+                      np.ndarray[np.double_t,ndim=1] rp_bvals not None,
+                      np.ndarray[np.double_t,ndim=1] rp_pi not None,
+                      np.ndarray[np.double_t,ndim=1] rp_beta not None,
+                      np.ndarray[np.double_t,ndim=1] margpi not None,
+                      np.ndarray[np.double_t,ndim=1] margbeta not None,
+                      double piminthres,double dampfact = 0.,
+                      int nthreads = 1,
+                      np.ndarray[int,ndim=1] rstat = None,
+                      np.ndarray[np.double_t,ndim=1] delta = None):
+    cdef int errcode, aout, rstat_n, delta_n
+    cdef char errstr[512]
+    cdef void** annobj_p
+    cdef int* rstat_p
+    cdef double* delta_p
+    # Ensure that input/output arguments are contiguous
+    updjind = np.ascontiguousarray(updjind)
+    pm_potids = np.ascontiguousarray(pm_potids)
+    pm_numpot = np.ascontiguousarray(pm_numpot)
+    pm_parvec = np.ascontiguousarray(pm_parvec)
+    pm_parshrd = np.ascontiguousarray(pm_parshrd)
+    rp_rowind = np.ascontiguousarray(rp_rowind)
+    rp_colind = np.ascontiguousarray(rp_colind)
+    rp_bvals = np.ascontiguousarray(rp_bvals)
+    check_contiguous_array(rp_pi,'RP_PI')
+    check_contiguous_array(rp_beta,'RP_BETA')
+    check_contiguous_array(margpi,'MARGPI')
+    check_contiguous_array(margbeta,'MARGBETA')
+    if updjind.shape[0]<1:
+        raise ValueError('UPDJIND must not be empty')
+    # Call C function
+    aout = 0
+    rstat_n = 0
+    rstat_p = NULL
+    delta_n = 0
+    delta_p = NULL
+    if rstat is not None:
+        check_contiguous_array(rstat,'RSTAT')
+        rstat_n = rstat.shape[0]
+        rstat_p = &rstat[0]
+        aout += 1
+        if delta is not None:
+            check_contiguous_array(delta,'DELTA')
+            delta_n = delta.shape[0]
+            delta_p = &delta[0]
+            aout += 1
+    annobj_p = make_voidptr_array(pm_annobj)  # Convert to void* array
+    eptwrap_fact_asyncupdates(18,aout,n,m,&updjind[0],updjind.shape[0],
+                              &pm_potids[0],pm_potids.shape[0],&pm_numpot[0],
+                              pm_numpot.shape[0],&pm_parvec[0],
+                              pm_parvec.shape[0],&pm_parshrd[0],
+                              pm_parshrd.shape[0],annobj_p,
+                              pm_annobj.shape[0],&rp_rowind[0],
+                              rp_rowind.shape[0],&rp_colind[0],
+                              rp_colind.shape[0],&rp_bvals[0],
+                              rp_bvals.shape[0],&rp_pi[0],rp_pi.shape[0],
+                              &rp_beta[0],rp_beta.shape[0],&margpi[0],
+                              margpi.shape[0],&margbeta[0],margbeta.shape[0],
+                              piminthres,dampfact,nthreads,rstat_p,rstat_n,
+                              delta_p,delta_n,&errcode,errstr)
+    PyMem_Free(annobj_p)  # Free temp. void* array
+    # Check for error, raise exception
+    if errcode != 0:
+        raise exc.ApBsWrapError(<bytes>errstr)
+
+# Session for EP with factorized backbone: Potential manager, representation,
+# selective damping structure and EP driver are created (and checked) once,
+# and kept until the object is deallocated. Updates are run by 'updates',
+# with the same semantics as fact_sequpdates (mode=0), fact_colupdates
+# (mode=1), fact_parupdates (mode=2) or fact_asyncupdates (mode=3), except
+# that return arguments are always w.r.t. updjind.
+# The C++ objects refer to the arrays passed to the constructor (references
+# are kept here). rp_pi, rp_beta, margpi, margbeta, sd_numvalid, sd_topind,
+# sd_topval are overwritten by 'updates'. They must not be reallocated while
+# the session is in use. If the SD representation is recomputed (new arrays),
+# a new session has to be created.
+# If rp_rowind is int64, rp_colind is converted to int64 and the 64-bit index
+# variant of the representation is used (see fact_compmarginals).
+# If rp_bvals is float32, the single precision variant is used. In this case,
+# rp_pi, rp_beta must be float32 as well (not with an int64 index).
+# If sd_heap is True, selective damping uses a heap per variable, built once
+# here and kept between calls (see eptwrap_fact_session_create). sd_numvalid,
+# sd_topind, sd_topval are written back at the end of 'updates', 'sweeps',
+# 'retire'. 'append' is not supported then.
+cdef class FactSession:
+    cdef void* sess
+    cdef object arrays
+    cdef readonly int selective_damping
+
+    def __cinit__(self,int n,int m,np.ndarray[int,ndim=1] pm_potids not None,
+                  np.ndarray[int,ndim=1] pm_numpot not None,
+                  np.ndarray[np.double_t,ndim=1] pm_parvec not None,
+                  np.ndarray[int,ndim=1] pm_parshrd not None,
+                  np.ndarray[np.uint64_t,ndim=1] pm_annobj not None,
+                  np.ndarray rp_rowind not None,
+                  np.ndarray rp_colind not None,
+                  np.ndarray rp_bvals not None,np.ndarray rp_pi not None,
+                  np.ndarray rp_beta not None,
+                  np.ndarray[np.double_t,ndim=1] margpi not None,
+                  np.ndarray[np.double_t,ndim=1] margbeta not None,
+                  double piminthres,int nthreads = 1,
+                  np.ndarray[int,ndim=1] sd_numvalid = None,
+                  np.ndarray[int,ndim=1] sd_topind = None,
+                  np.ndarray[np.double_t,ndim=1] sd_topval = None,
+                  np.ndarray[int,ndim=1] sd_subind = None,
+                  int sd_subexcl = 0,sd_heap = False):
+        cdef int errcode, ain
+        cdef char errstr[512]
+        cdef void** annobj_p
+        cdef int numvalid_n, topind_n, topval_n, subind_n
+        cdef int* numvalid_p
+        cdef int* topind_p
+        cdef double* topval_p
+        cdef int* subind_p
+        cdef np.ndarray[int,ndim=1] rowind32
+        cdef np.ndarray[int,ndim=1] colind32
+        cdef np.ndarray[np.int64_t,ndim=1] rowind64
+        cdef np.ndarray[np.int64_t,ndim=1] colind64
+        cdef np.ndarray[np.double_t,ndim=1] bvals64
+        cdef np.ndarray[np.double_t,ndim=1] pi64
+        cdef np.ndarray[np.double_t,ndim=1] beta64
+        cdef np.ndarray[np.float32_t,ndim=1] bvals32
+        cdef np.ndarray[np.float32_t,ndim=1] pi32
+        cdef np.ndarray[np.float32_t,ndim=1] beta32
+        self.sess = NULL
+        # Ensure that input/output arguments are contiguous
+        pm_potids = np.ascontiguousarray(pm_potids)
+        pm_numpot = np.ascontiguousarray(pm_numpot)
+        pm_parvec = np.ascontiguousarray(pm_parvec)
+        pm_parshrd = np.ascontiguousarray(pm_parshrd)
+        is_i64 = (rp_rowind.dtype == np.int64)
+        is_f32 = (rp_bvals.dtype == np.float32)
+        if is_i64 and is_f32:
+            raise ValueError('RP_BVALS: float32 not supported with int64 index')
+        if is_i64:
+            rp_rowind = rowind64 = np.ascontiguousarray(rp_rowind)
+            rp_colind = colind64 = np.ascontiguousarray(rp_colind,
+                                                        dtype=np.int64)
+        else:
+            rp_rowind = rowind32 = np.ascontiguousarray(rp_rowind)
+            rp_colind = colind32 = np.ascontiguousarray(rp_colind)
+        check_contiguous_array(rp_pi,'RP_PI')
+        check_contiguous_array(rp_beta,'RP_BETA')
+        if is_f32:
+            rp_bvals = bvals32 = np.ascontiguousarray(rp_bvals)
+            pi32 = rp_pi
+            beta32 = rp_beta
+        else:
+            rp_bvals = bvals64 = np.ascontiguousarray(rp_bvals)
+            pi64 = rp_pi
+            beta64 = rp_beta
+        check_contiguous_array(margpi,'MARGPI')
+        check_contiguous_array(margbeta,'MARGBETA')
+        ain = 16
+        numvalid_n = 0
+        numvalid_p = NULL
+        topind_n = 0
+        topind_p = NULL
+        topval_n = 0
+        topval_p = NULL
+        subind_n = 0
+        subind_p = NULL
+        if sd_numvalid is not None:
+            check_contiguous_array(sd_numvalid,'SD_NUMVALID')
+            if sd_topind is None or sd_topval is None:
+                raise ValueError('SD_TOPIND, SD_TOPVAL must be given')
+            check_contiguous_array(sd_topind,'SD_TOPIND')
+            check_contiguous_array(sd_topval,'SD_TOPVAL')
+            numvalid_n = sd_numvalid.shape[0]
+            numvalid_p = &sd_numvalid[0]
+            topind_n = sd_topind.shape[0]
+            topind_p = &sd_topind[0]
+            topval_n = sd_topval.shape[0]
+            topval_p = &sd_topval[0]
+            ain += 3
+            if sd_subind is not None:
+                sd_subind = np.ascontiguousarray(sd_subind)
+                subind_n = sd_subind.shape[0]
+                subind_p = &sd_subind[0]
+                ain += 2
+            if sd_heap:
+                ain = 22
+        self.selective_damping = (sd_numvalid is not None)
+        # Keep references to all arrays the C++ objects refer to
+        self.arrays = (pm_potids,pm_numpot,pm_parvec,pm_parshrd,pm_annobj,
+                       rp_rowind,rp_colind,rp_bvals,rp_pi,rp_beta,margpi,
+                       margbeta,sd_numvalid,sd_topind,sd_topval,sd_subind)
+        # Call C function. The void* array is only needed during creation,
+        # but annotation objects must be kept alive by the caller
+        annobj_p = make_voidptr_array(pm_annobj)  # Convert to void* array
+        if is_f32:
+            eptwrap_fact_session_create_f32(ain,1,n,m,&pm_potids[0],
+                                            pm_potids.shape[0],&pm_numpot[0],
+                                            pm_numpot.shape[0],&pm_parvec[0],
+                                            pm_parvec.shape[0],
+                                            &pm_parshrd[0],
+                                            pm_parshrd.shape[0],annobj_p,
+                                            pm_annobj.shape[0],&rowind32[0],
+                                            rowind32.shape[0],&colind32[0],
+                                            colind32.shape[0],&bvals32[0],
+                                            bvals32.shape[0],&pi32[0],
+                                            pi32.shape[0],&beta32[0],
+                                            beta32.shape[0],&margpi[0],
+                                            margpi.shape[0],&margbeta[0],
+                                            margbeta.shape[0],piminthres,
+                                            nthreads,numvalid_p,numvalid_n,
+                                            topind_p,topind_n,topval_p,
+                                            topval_n,subind_p,subind_n,
+                                            sd_subexcl,
+                                            1 if sd_heap else 0,&self.sess,
+                                            &errcode,errstr)
+        elif is_i64:
+            eptwrap_fact_session_create_i64(ain,1,n,m,&pm_potids[0],
+                                            pm_potids.shape[0],&pm_numpot[0],
+                                            pm_numpot.shape[0],&pm_parvec[0],
+                                            pm_parvec.shape[0],
+                                            &pm_parshrd[0],
+                                            pm_parshrd.shape[0],annobj_p,
+                                            pm_annobj.shape[0],&rowind64[0],
+                                            rowind64.shape[0],&colind64[0],
+                                            colind64.shape[0],&bvals64[0],
+                                            bvals64.shape[0],&pi64[0],
+                                            pi64.shape[0],&beta64[0],
+                                            beta64.shape[0],&margpi[0],
+                                            margpi.shape[0],&margbeta[0],
+                                            margbeta.shape[0],piminthres,
+                                            nthreads,numvalid_p,numvalid_n,
+                                            topind_p,topind_n,topval_p,
+                                            topval_n,subind_p,subind_n,
+                                            sd_subexcl,
+                                            1 if sd_heap else 0,&self.sess,
+                                            &errcode,errstr)
+        else:
+            eptwrap_fact_session_create(ain,1,n,m,&pm_potids[0],
+                                        pm_potids.shape[0],&pm_numpot[0],
+                                        pm_numpot.shape[0],&pm_parvec[0],
+                                        pm_parvec.shape[0],&pm_parshrd[0],
+                                        pm_parshrd.shape[0],annobj_p,
+                                        pm_annobj.shape[0],&rowind32[0],
+                                        rowind32.shape[0],&colind32[0],
+                                        colind32.shape[0],&bvals64[0],
+                                        bvals64.shape[0],&pi64[0],
+                                        pi64.shape[0],&beta64[0],
+                                        beta64.shape[0],&margpi[0],
+                                        margpi.shape[0],&margbeta[0],
+                                        margbeta.shape[0],piminthres,
+                                        nthreads,numvalid_p,numvalid_n,
+                                        topind_p,topind_n,topval_p,topval_n,
+                                        subind_p,subind_n,sd_subexcl,
+                                        1 if sd_heap else 0,&self.sess,
+                                        &errcode,errstr)
+        PyMem_Free(annobj_p)  # Free temp. void* array
+        # Check for error, raise exception
+        if errcode != 0:
+            self.sess = NULL
+            raise exc.ApBsWrapError(<bytes>errstr)
+
+    def __dealloc__(self):
+        cdef int errcode
+        cdef char errstr[512]
+        if self.sess != NULL:
+            eptwrap_fact_session_delete(self.sess,&errcode,errstr)
+            self.sess = NULL
+
+    # rstat, delta, sd_dampfact (optional) are return arguments. Returns
+    # (sd_nupd, sd_nrec) if all of them are given (selective damping).
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def updates(self,np.ndarray[int,ndim=1] updjind not None,
+                double dampfact = 0.,int mode = 0,
+                np.ndarray[int,ndim=1] rstat = None,
+                np.ndarray[np.double_t,ndim=1] delta = None,
+                np.ndarray[np.double_t,ndim=1] sd_dampfact = None):
+        cdef int errcode, sd_nupd, sd_nrec, aout
+        cdef char errstr[512]
+        cdef int rstat_n, delta_n, dampfact_n
+        cdef int* rstat_p
+        cdef double* delta_p
+        cdef double* dampfact_p
+        if self.sess == NULL:
+            raise ValueError('Session not initialized')
+        updjind = np.ascontiguousarray(updjind)
+        if updjind.shape[0]<1:
+            raise ValueError('UPDJIND must not be empty')
+        aout = 0
+        rstat_n = 0
+        rstat_p = NULL
+        delta_n = 0
+        delta_p = NULL
+        dampfact_n = 0
+        dampfact_p = NULL
+        if rstat is not None:
+            check_contiguous_array(rstat,'RSTAT')
+            rstat_n = rstat.shape[0]
+            rstat_p = &rstat[0]
+            aout += 1
+            if delta is not None:
+                check_contiguous_array(delta,'DELTA')
+                delta_n = delta.shape[0]
+                delta_p = &delta[0]
+                aout += 1
+                if sd_dampfact is not None:
+                    check_contiguous_array(sd_dampfact,'SD_DAMPFACT')
+                    dampfact_n = sd_dampfact.shape[0]
+                    dampfact_p = &sd_dampfact[0]
+                    aout = 5
+        eptwrap_fact_session_updates(4,aout,self.sess,&updjind[0],
+                                     updjind.shape[0],dampfact,mode,rstat_p,
+                                     rstat_n,delta_p,delta_n,dampfact_p,
+                                     dampfact_n,&sd_nupd,&sd_nrec,&errcode,
+                                     errstr)
+        # Check for error, raise exception
+        if errcode != 0:
+            raise exc.ApBsWrapError(<bytes>errstr)
+        if aout>2:
+            return (sd_nupd,sd_nrec)
+
+    # Appends potentials to the model (see eptwrap_fact_session_append):
+    # potential manager pm_XXX for the new potentials, rows of B in CSR
+    # format (ap_rowoff, ap_ind, ap_bvals). ap_pi, ap_beta are optional
+    # initial EP parameters. Returns the index of the first new potential.
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def append(self,np.ndarray[int,ndim=1] pm_potids not None,
+               np.ndarray[int,ndim=1] pm_numpot not None,
+               np.ndarray[np.double_t,ndim=1] pm_parvec not None,
+               np.ndarray[int,ndim=1] pm_parshrd not None,
+               np.ndarray[np.uint64_t,ndim=1] pm_annobj not None,
+               np.ndarray[int,ndim=1] ap_rowoff not None,
+               np.ndarray[int,ndim=1] ap_ind not None,
+               np.ndarray[np.double_t,ndim=1] ap_bvals not None,
+               np.ndarray[np.double_t,ndim=1] ap_pi = None,
+               np.ndarray[np.double_t,ndim=1] ap_beta = None):
+        cdef int errcode, ain, j0, pi_n, beta_n
+        cdef char errstr[512]
+        cdef void** annobj_p
+        cdef double* pi_p
+        cdef double* beta_p
+        if self.sess == NULL:
+            raise ValueError('Session not initialized')
+        pm_potids = np.ascontiguousarray(pm_potids)
+        pm_numpot = np.ascontiguousarray(pm_numpot)
+        pm_parvec = np.ascontiguousarray(pm_parvec)
+        pm_parshrd = np.ascontiguousarray(pm_parshrd)
+        ap_rowoff = np.ascontiguousarray(ap_rowoff)
+        ap_ind = np.ascontiguousarray(ap_ind)
+        ap_bvals = np.ascontiguousarray(ap_bvals)
+        if ap_ind.shape[0]<1:
+            raise ValueError('AP_IND must not be empty')
+        ain = 9
+        pi_n = 0
+        pi_p = NULL
+        beta_n = 0
+        beta_p = NULL
+        if ap_pi is not None:
+            ap_pi = np.ascontiguousarray(ap_pi)
+            pi_n = ap_pi.shape[0]
+            pi_p = &ap_pi[0]
+            ain += 1
+            if ap_beta is not None:
+                ap_beta = np.ascontiguousarray(ap_beta)
+                beta_n = ap_beta.shape[0]
+                beta_p = &ap_beta[0]
+                ain += 1
+        # The potential manager refers to the pm_XXX arrays
+        self.arrays += (pm_potids,pm_numpot,pm_parvec,pm_parshrd,pm_annobj)
+        annobj_p = make_voidptr_array(pm_annobj)  # Convert to void* array
+        eptwrap_fact_session_append(ain,1,self.sess,&pm_potids[0],
+                                    pm_potids.shape[0],&pm_numpot[0],
+                                    pm_numpot.shape[0],&pm_parvec[0],
+                                    pm_parvec.shape[0],&pm_parshrd[0],
+                                    pm_parshrd.shape[0],annobj_p,
+                                    pm_annobj.shape[0],&ap_rowoff[0],
+                                    ap_rowoff.shape[0],&ap_ind[0],
+                                    ap_ind.shape[0],&ap_bvals[0],
+                                    ap_bvals.shape[0],pi_p,pi_n,beta_p,
+                                    beta_n,&j0,&errcode,errstr)
+        PyMem_Free(annobj_p)  # Free temp. void* array
+        # Check for error, raise exception
+        if errcode != 0:
+            raise exc.ApBsWrapError(<bytes>errstr)
+        return j0
+
+    # Retires potentials retjind (see eptwrap_fact_session_retire)
+    def retire(self,np.ndarray[int,ndim=1] retjind not None):
+        cdef int errcode
+        cdef char errstr[512]
+        if self.sess == NULL:
+            raise ValueError('Session not initialized')
+        retjind = np.ascontiguousarray(retjind)
+        if retjind.shape[0]<1:
+            raise ValueError('RETJIND must not be empty')
+        eptwrap_fact_session_retire(self.sess,&retjind[0],retjind.shape[0],
+                                    &errcode,errstr)
+        # Check for error, raise exception
+        if errcode != 0:
+            raise exc.ApBsWrapError(<bytes>errstr)
+
+    # Enables moment tables for local EP updates (see
+    # eptwrap_fact_session_momtables), or disables them if tol is 0.
+    # Returns the number of tables created.
+    def momtables(self,double tol,murange = (-10.,10.),
+                  rhorange = (1e-4,100.),int maxdepth = 6,
+                  int minshare = 2):
+        cdef int errcode, ntab
+        cdef char errstr[512]
+        cdef np.ndarray[np.double_t,ndim=1] murange_a
+        cdef np.ndarray[np.double_t,ndim=1] rhorange_a
+        if self.sess == NULL:
+            raise ValueError('Session not initialized')
+        murange_a = np.array(murange,dtype=np.float64)
+        rhorange_a = np.array(rhorange,dtype=np.float64)
+        if murange_a.shape[0] != 2 or rhorange_a.shape[0] != 2:
+            raise ValueError('MURANGE, RHORANGE must have size 2')
+        eptwrap_fact_session_momtables(6,1,self.sess,tol,&murange_a[0],2,
+                                       &rhorange_a[0],2,maxdepth,minshare,
+                                       &ntab,&errcode,errstr)
+        # Check for error, raise exception
+        if errcode != 0:
+            raise exc.ApBsWrapError(<bytes>errstr)
+        return ntab
+
+    # Runs sweeps until convergence (see eptwrap_fact_session_sweeps).
+    # skipids, firstids are potential type IDs (or None). refresh is True
+    # (full), False (none), or 'dirty' (only variables touched by updates
+    # of the sweep, full refresh if rounding drift exceeds drifttol).
+    # mode 4 is residual scheduling (maxfanout: variables with more
+    # potentials do not raise priorities, 0 for no limit).
+    # If freezek>0, potentials are frozen once their delta is below
+    # freezeeps for freezek sweeps, until marginals of their variables move
+    # by more than reacttol (0: defaults, see eptwrap_fact_session_sweeps).
+    # If warmstart, local EP updates are warm-started from the previous
+    # ones (stays on for later calls).
+    # Returns (nit, rstat, delta, nskip, nsdamp, nrefresh, nfrozen), where
+    # delta, nsdamp, nrefresh, nfrozen have size nit, nskip has shape
+    # (nit,6).
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def sweeps(self,int maxit,double deltaeps,double dampfact = 0.,
+               int mode = 0,refresh = True,int seed = 0,
+               np.ndarray[int,ndim=1] skipids = None,
+               np.ndarray[int,ndim=1] firstids = None,packed = False,
+               double drifttol = 1e-6,int maxfanout = 0,int freezek = 0,
+               double freezeeps = 0.,double reacttol = 0.,
+               warmstart = False):
+        cdef int errcode, nit, rstat, skipids_n, firstids_n, refr
+        cdef char errstr[512]
+        cdef int* skipids_p
+        cdef int* firstids_p
+        cdef np.ndarray[np.double_t,ndim=1] delta
+        cdef np.ndarray[int,ndim=1] nskip
+        cdef np.ndarray[int,ndim=1] nsdamp
+        cdef np.ndarray[int,ndim=1] nrefresh
+        cdef np.ndarray[int,ndim=1] nfrozen
+        if self.sess == NULL:
+            raise ValueError('Session not initialized')
+        if maxit<1:
+            raise ValueError('MAXIT must be positive')
+        if refresh == 'dirty':
+            refr = 2
+        else:
+            refr = 1 if refresh else 0
+        skipids_n = 0
+        skipids_p = NULL
+        firstids_n = 0
+        firstids_p = NULL
+        if skipids is not None and skipids.shape[0]>0:
+            skipids = np.ascontiguousarray(skipids)
+            skipids_n = skipids.shape[0]
+            skipids_p = &skipids[0]
+        if firstids is not None and firstids.shape[0]>0:
+            firstids = np.ascontiguousarray(firstids)
+            firstids_n = firstids.shape[0]
+            firstids_p = &firstids[0]
+        delta = np.empty(maxit,dtype=np.float64)
+        nskip = np.empty(6*maxit,dtype=np.int32)
+        nsdamp = np.empty(maxit,dtype=np.int32)
+        nrefresh = np.empty(maxit,dtype=np.int32)
+        nfrozen = np.empty(maxit,dtype=np.int32)
+        eptwrap_fact_session_sweeps(16,7,self.sess,maxit,deltaeps,dampfact,
+                                    mode,refr,seed,skipids_p,skipids_n,
+                                    firstids_p,firstids_n,
+                                    1 if packed else 0,drifttol,maxfanout,
+                                    freezek,freezeeps,reacttol,
+                                    1 if warmstart else 0,&nit,&rstat,
+                                    &delta[0],maxit,&nskip[0],6*maxit,
+                                    &nsdamp[0],maxit,&nrefresh[0],maxit,
+                                    &nfrozen[0],maxit,&errcode,errstr)
+        # Check for error, raise exception
+        if errcode != 0:
+            raise exc.ApBsWrapError(<bytes>errstr)
+        return (nit,rstat,delta[:nit],nskip[:6*nit].reshape((nit,6)),
+                nsdamp[:nit],nrefresh[:nit],nfrozen[:nit])
+
 # tauind must be passed iff the potential manager contains bivariate precision
 # potentials.
 @cython.boundscheck(False)
@@ -445,6 +1433,30 @@ def epupdate_single_pman(np.ndarray[int,ndim=1] potids not None,
         raise exc.ApBsWrapError(<bytes>errstr)
     return (rstat,alpha,nu,logz)
 
+def epupdate_single_bvprec(pid,np.ndarray[np.double_t,ndim=1] pars not None,
+                           np.uint64_t annobj,double cmu,double crho,
+                           double ca,double cc):
+    cdef int errcode, rstat
+    cdef char errstr[512]
+    cdef double alpha, nu, hata, hatc, logz
+    # Ensure that input arguments are contiguous
+    pars = np.ascontiguousarray(pars)
+    # Call C function
+    if isinstance(pid,str):
+        eptwrap_epupdate_single_bvprec2(7,6,<char*>pid,&pars[0],
+                                        pars.shape[0],<void*>annobj,cmu,crho,
+                                        ca,cc,&rstat,&alpha,&nu,&hata,&hatc,
+                                        &logz,&errcode,errstr)
+    else:
+        eptwrap_epupdate_single_bvprec1(7,6,<int>pid,&pars[0],pars.shape[0],
+                                        <void*>annobj,cmu,crho,ca,cc,&rstat,
+                                        &alpha,&nu,&hata,&hatc,&logz,
+                                        &errcode,errstr)
+    # Check for error, raise exception
+    if errcode != 0:
+        raise exc.ApBsWrapError(<bytes>errstr)
+    return (rstat,alpha,nu,hata,hatc,logz)
+
 @cython.boundscheck(False)
 @cython.wraparound(False)
 def choluprk1(np.ndarray[np.double_t,ndim=2] l not None,bytes luplo not None,
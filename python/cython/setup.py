@@ -18,6 +18,12 @@ work_around = False
 if '--workaround' in sys.argv:
     work_around = True
     sys.argv.remove('--workaround')
+# Use '--openmp' in order to build eptools_ext with OpenMP support
+# (multi-threaded EP updates, see eptwrap_fact_colupdates)
+use_openmp = False
+if '--openmp' in sys.argv:
+    use_openmp = True
+    sys.argv.remove('--openmp')
 
 # Basic information passed to compiler/linker
 # NOTE: Do not change the present file. Enter system-specific information
@@ -46,6 +52,11 @@ if work_around:
     df_define_macros.extend([('HAVE_LIBGSL', None),
                              ('HAVE_WORKAROUND', None)])
     df_libraries.append('gsl')
+df_compile_args = []
+df_link_args = []
+if use_openmp:
+    df_compile_args.append('-fopenmp')
+    df_link_args.append('-fopenmp')
 
 # eptools_ext: Main API to C++ functions
 eptools_ext_sources = [
@@ -58,24 +69,48 @@ eptools_ext_sources = [
     'base/lhotse/Range.cc',
     'base/lhotse/optimize/OneDimSolver.cc',
     'base/src/eptools/FactorizedEPDriver.cc',
+    'base/src/eptools/FactorizedEPSession.cc',
+    'base/src/eptools/FactEPDriverFactory.cc',
     'base/src/eptools/potentials/EPScalarPotential.cc',
     'base/src/eptools/potentials/DefaultPotManager.cc',
     'base/src/eptools/potentials/EPPotentialFactory.cc',
     'base/src/eptools/potentials/EPPotentialNamedFactory.cc',
     'base/src/eptools/potentials/PotManagerFactory.cc',
+    'base/src/eptools/potentials/PotMomentTable.cc',
     'base/src/eptools/potentials/SpecfunServices.cc',
     'base/src/eptools/potentials/quad/QuadPotProximalNewton.cc',
     'base/src/eptools/potentials/quad/EPPotQuadLaplaceApprox.cc',
     'base/src/eptools/potentials/quad/EPPotPoissonExpRate.cc',
+    'base/src/eptools/potentials/quad/EPPotGaussianPrecision.cc',
+    'base/src/eptools/potentials/quad/GaussHermiteQuadServices.cc',
     'base/src/eptools/wrap/eptools_helper_basic.cc',
     'base/src/eptools/wrap/eptools_helper.cc',
     'base/src/eptools/wrap/eptwrap_choldnrk1.cc',
     'base/src/eptools/wrap/eptwrap_choluprk1.cc',
     'base/src/eptools/wrap/eptwrap_epupdate_parallel.cc',
     'base/src/eptools/wrap/eptwrap_epupdate_single.cc',
+    'base/src/eptools/wrap/eptwrap_epupdate_single_bvprec.cc',
     'base/src/eptools/wrap/eptwrap_fact_compmarginals.cc',
     'base/src/eptools/wrap/eptwrap_fact_compmaxpi.cc',
+    'base/src/eptools/wrap/eptwrap_fact_compmarginals_i64.cc',
+    'base/src/eptools/wrap/eptwrap_fact_compmaxpi_i64.cc',
+    'base/src/eptools/wrap/eptwrap_fact_compmarginals_f32.cc',
+    'base/src/eptools/wrap/eptwrap_fact_compmaxpi_f32.cc',
+    'base/src/eptools/wrap/eptwrap_fact_compmarginals_maxpi.cc',
+    'base/src/eptools/wrap/eptwrap_fact_compmarginals_bvprec.cc',
     'base/src/eptools/wrap/eptwrap_fact_sequpdates.cc',
+    'base/src/eptools/wrap/eptwrap_fact_colupdates.cc',
+    'base/src/eptools/wrap/eptwrap_fact_asyncupdates.cc',
+    'base/src/eptools/wrap/eptwrap_fact_parupdates.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_create.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_create_i64.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_create_f32.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_updates.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_sweeps.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_append.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_retire.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_momtables.cc',
+    'base/src/eptools/wrap/eptwrap_fact_session_delete.cc',
     'base/src/eptools/wrap/eptwrap_getpotid.cc',
     'base/src/eptools/wrap/eptwrap_getpotname.cc',
     'base/src/eptools/wrap/eptwrap_potmanager_isvalid.cc',
@@ -98,7 +133,8 @@ apbtest_ext_sources = [
     'base/lhotse/Interval.cc',
     'base/lhotse/Range.cc',
     'base/lhotse/optimize/OneDimSolver.cc',
-    'base/src/eptools/potentials/SpecfunServices.cc'
+    'base/src/eptools/potentials/SpecfunServices.cc',
+    'base/src/eptools/potentials/quad/QuadPotProximalNewton.cc'
 ]
 
 # apbtest_workaround_ext: API for test code (workaround part)
@@ -137,6 +173,8 @@ df_ext_modules = [
         define_macros = df_define_macros,
         libraries = df_libraries,
         library_dirs = df_library_dirs,
+        extra_compile_args = df_compile_args,
+        extra_link_args = df_link_args,
         language = 'c++'
     ),
     # NOTE: apbtest_ext has to be build in default mode, even if the workaround
@@ -0,0 +1,113 @@
+#! /usr/bin/env python
+
+# Memory-mapped coupling factor for factorized EP ('MatFactorizedInf.save',
+# 'MatFactorizedInf' constructor with file name): B is written to file for
+# 32-bit and 64-bit indexes and for single precision values, and mapped
+# back. Arrays must be the same, and sweeps with the mapped factor must
+# give identical results to sweeps with the in-memory one. Files with the
+# wrong byte order or format version must be refused.
+
+import os
+import sys
+import struct
+import tempfile
+import numpy as np
+import scipy.sparse as ssp
+
+import apbsint as abt
+import apbsint.eptools_ext as epx
+
+# Helper functions
+
+def maxdiff(a,b):
+    return np.abs(np.asarray(a,dtype=np.float64)-
+                  np.asarray(b,dtype=np.float64)).max()
+
+def init_repres(bfact,n):
+    rep = abt.RepresentationFactorized(bfact)
+    tvec = np.zeros(rep.size_pars(),dtype=rep.pars_dtype())
+    rep.setbeta(tvec)
+    tvec[:n] = 1. # Laplace prior potentials
+    rep.setpi(tvec)
+    rep.refresh()
+    return rep
+
+def run_sweeps(bfact):
+    m, n = bfact.shape()
+    rep = init_repres(bfact,n)
+    pman.check_internal()
+    sess = epx.FactSession(n,m,pman.potids,pman.numpot,pman.parvec,
+                           pman.parshrd,pman.annobj,bfact.rowind,
+                           bfact.colind,bfact.bvals,rep.ep_pi,rep.ep_beta,
+                           rep.marg_pi,rep.marg_beta,1e-8,1)
+    sess.sweeps(nsweeps,1e-8,damp,0,True,seed)
+    return rep
+
+# Overwrites 4 byte header entry 'pos' (0: FF version, 1: byte order)
+def patch_header(fname,pos,val):
+    fid = open(fname,'r+b')
+    fid.seek(len(abt.MatFactorizedInf._file_tag)+4*pos)
+    fid.write(struct.pack('>i',val))
+    fid.close()
+
+def expect_refused(name,fname):
+    try:
+        abt.MatFactorizedInf(fname)
+    except ValueError as ex:
+        print '%s: Refused (%s)' % (name,str(ex))
+        return
+    raise ValueError('%s: Not refused' % name)
+
+# Model: Laplace prior on n variables, m-n probit potentials on 4
+# variables each
+
+np.random.seed(1)
+n = 100
+m = n+300
+nsweeps = 10
+damp = 0.1
+seed = 3
+rows = np.repeat(np.arange(m-n),4)
+cols = np.array([np.random.permutation(n)[:4] for j in xrange(m-n)]).ravel()
+bmat = ssp.vstack([ssp.eye(n,format='csr'),
+                   ssp.csr_matrix((np.random.randn(4*(m-n)),(rows,cols)),
+                                  shape=(m-n,n))],format='csr')
+pman = abt.PotManager((abt.ElemPotManager('Laplace',n,(0., 1.5)),
+                       abt.ElemPotManager('Probit',m-n,
+                                          (np.sign(np.random.randn(m-n)),
+                                           0.))))
+bfact = abt.MatFactorizedInf(bmat)
+bfact_i64 = abt.MatFactorizedInf(bfact)
+bfact_i64.rowind = np.int64(bfact.rowind)
+bfact_i64.colind = np.int64(bfact.colind)
+fname = os.path.join(tempfile.mkdtemp(),'fact_repr.bin')
+
+for (name,bf) in [('32-bit index',bfact),('64-bit index',bfact_i64),
+                  ('Single precision',abt.MatFactorizedInf(bmat,single=True))]:
+    bf.save(fname)
+    bf2 = abt.MatFactorizedInf(fname)
+    if not (bf2.rowind.dtype == bf.rowind.dtype and
+            bf2.bvals.dtype == bf.bvals.dtype and
+            bf2.shape() == bf.shape()):
+        raise ValueError('%s: Mapped factor has wrong types or shape' % name)
+    df = max(maxdiff(bf.rowind,bf2.rowind),maxdiff(bf.colind,bf2.colind),
+             maxdiff(bf.bvals,bf2.bvals))
+    rep0 = run_sweeps(bf)
+    rep1 = run_sweeps(bf2)
+    df2 = max(maxdiff(rep0.ep_pi,rep1.ep_pi),
+              maxdiff(rep0.ep_beta,rep1.ep_beta),
+              maxdiff(rep0.marg_pi,rep1.marg_pi),
+              maxdiff(rep0.marg_beta,rep1.marg_beta))
+    print '%s: df(arrays)=%.4e, df(EP)=%.4e' % (name,df,df2)
+    if df > 0. or df2 > 0.:
+        raise ValueError('%s: Mapped factor differs from in-memory one' % name)
+    del bf2, rep1
+
+# Wrong byte order, wrong FF version
+bfact.save(fname)
+patch_header(fname,1,1 if sys.byteorder == 'big' else 0)
+expect_refused('Wrong byte order',fname)
+bfact.save(fname)
+patch_header(fname,0,abt.MatFactorizedInf._file_ffver+1)
+expect_refused('Wrong FF version',fname)
+os.remove(fname)
@@ -0,0 +1,87 @@
+#! /usr/bin/env python
+
+# Packed row layout of the factorized EP representation ('FactSession.sweeps'
+# with packed=True): Sweeps run on the packed layout must give the same
+# EP parameters and marginals as sweeps on the flat layout, with the same
+# seed. Checked for sequential sweeps with selective damping and for
+# colored sweeps with several threads.
+
+import numpy as np
+import scipy.sparse as ssp
+
+import apbsint as abt
+import apbsint.eptools_ext as epx
+
+# Helper functions
+
+def maxdiff(a,b):
+    return np.abs(np.asarray(a,dtype=np.float64)-
+                  np.asarray(b,dtype=np.float64)).max()
+
+def init_repres(bfact,n):
+    rep = abt.RepresentationFactorized(bfact)
+    tvec = np.zeros(rep.size_pars())
+    rep.setbeta(tvec)
+    tvec[:n] = 1. # Laplace prior potentials
+    rep.setpi(tvec)
+    rep.refresh()
+    rep.seldamp_reset(seldamp_numk)
+    return rep
+
+def create_session(bfact,pman,rep,nthreads,seldamp):
+    m, n = bfact.shape()
+    pman.check_internal()
+    if seldamp:
+        return epx.FactSession(n,m,pman.potids,pman.numpot,pman.parvec,
+                               pman.parshrd,pman.annobj,bfact.rowind,
+                               bfact.colind,bfact.bvals,rep.ep_pi,
+                               rep.ep_beta,rep.marg_pi,rep.marg_beta,1e-8,
+                               nthreads,rep.sd_numvalid,rep.sd_topind,
+                               rep.sd_topval,rep.sd_subind,rep.sd_subexcl)
+    else:
+        return epx.FactSession(n,m,pman.potids,pman.numpot,pman.parvec,
+                               pman.parshrd,pman.annobj,bfact.rowind,
+                               bfact.colind,bfact.bvals,rep.ep_pi,
+                               rep.ep_beta,rep.marg_pi,rep.marg_beta,1e-8,
+                               nthreads)
+
+def run_sweeps(nthreads,seldamp,mode,packed):
+    rep = init_repres(bfact,n)
+    sess = create_session(bfact,pman,rep,nthreads,seldamp)
+    res = sess.sweeps(maxit,deltaeps,damp,mode,True,seed,packed=packed)
+    return (rep,res)
+
+# Model: Laplace prior on n variables, m-n probit potentials on 4
+# variables each
+
+np.random.seed(1)
+n = 100
+m = n+300
+maxit = 20
+deltaeps = 1e-8
+damp = 0.1
+seed = 3
+seldamp_numk = 5
+rows = np.repeat(np.arange(m-n),4)
+cols = np.array([np.random.permutation(n)[:4] for j in xrange(m-n)]).ravel()
+bmat = ssp.vstack([ssp.eye(n,format='csr'),
+                   ssp.csr_matrix((np.random.randn(4*(m-n)),(rows,cols)),
+                                  shape=(m-n,n))],format='csr')
+bfact = abt.MatFactorizedInf(bmat)
+pman = abt.PotManager((abt.ElemPotManager('Laplace',n,(0., 1.5)),
+                       abt.ElemPotManager('Probit',m-n,
+                                          (np.sign(np.random.randn(m-n)),
+                                           0.))))
+
+for (name,nthreads,seldamp,mode) in [('Sequential, sel. damping',1,True,0),
+                                     ('Colored, 4 threads',4,False,1)]:
+    (rep0,res0) = run_sweeps(nthreads,seldamp,mode,False)
+    (rep1,res1) = run_sweeps(nthreads,seldamp,mode,True)
+    df = max(maxdiff(rep0.ep_pi,rep1.ep_pi),
+             maxdiff(rep0.ep_beta,rep1.ep_beta),
+             maxdiff(rep0.marg_pi,rep1.marg_pi),
+             maxdiff(rep0.marg_beta,rep1.marg_beta))
+    print '%s: nit=%d/%d, df(packed,flat)=%.4e' % \
+        (name,res1[0],res0[0],df)
+    if df > 0. or res1[0] != res0[0] or maxdiff(res0[2],res1[2]) > 0.:
+        raise ValueError('%s: Packed layout differs from flat layout' % name)
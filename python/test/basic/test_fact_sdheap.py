@@ -0,0 +1,117 @@
+#! /usr/bin/env python
+
+# Selective damping with a heap per variable ('FactSession' with
+# sd_heap=True) against top-K lists (sd_heap=False): Sequential updates
+# must give identical EP parameters and marginals. The top-K lists written
+# back for the heap variant (sd_numvalid, sd_topind, sd_topval, see
+# 'FactEPMaximumPiHeap::syncTopLists') must be the same as recomputed from
+# scratch ('fact_compmaxpi'), and the valid parts of the lists maintained
+# by the list variant must agree with them.
+
+import numpy as np
+import scipy.sparse as ssp
+
+import apbsint as abt
+import apbsint.eptools_ext as epx
+
+# Helper functions
+
+def maxdiff(a,b):
+    return np.abs(np.asarray(a,dtype=np.float64)-
+                  np.asarray(b,dtype=np.float64)).max()
+
+def init_repres(bfact,n):
+    rep = abt.RepresentationFactorized(bfact)
+    tvec = np.zeros(rep.size_pars())
+    rep.setbeta(tvec)
+    tvec[:n] = 1. # Laplace prior potentials
+    rep.setpi(tvec)
+    rep.refresh()
+    rep.seldamp_reset(seldamp_numk)
+    return rep
+
+def create_session(bfact,pman,rep,sd_heap):
+    m, n = bfact.shape()
+    pman.check_internal()
+    return epx.FactSession(n,m,pman.potids,pman.numpot,pman.parvec,
+                           pman.parshrd,pman.annobj,bfact.rowind,
+                           bfact.colind,bfact.bvals,rep.ep_pi,rep.ep_beta,
+                           rep.marg_pi,rep.marg_beta,1e-8,1,
+                           rep.sd_numvalid,rep.sd_topind,rep.sd_topval,
+                           rep.sd_subind,rep.sd_subexcl,sd_heap)
+
+def run_updates(rep,sd_heap):
+    sess = create_session(bfact,pman,rep,sd_heap)
+    rstat = np.empty(m,dtype=np.int32)
+    delta = np.empty(m)
+    sd_dampfact = np.empty(m)
+    nrec = 0
+    for updind in orders:
+        (sd_nupd,sd_nrec) = sess.updates(updind,damp,0,rstat,delta,
+                                         sd_dampfact)
+        nrec += sd_nrec
+    return nrec
+
+# Maximum difference between valid parts of top-K lists. 'rep0' must have
+# at least as many valid entries as 'rep1'
+def toplist_diff(rep0,rep1):
+    numk = seldamp_numk+1
+    ti0 = rep0.sd_topind.reshape((n,numk))
+    tv0 = rep0.sd_topval.reshape((n,numk))
+    ti1 = rep1.sd_topind.reshape((n,numk))
+    tv1 = rep1.sd_topval.reshape((n,numk))
+    df = 0.
+    for i in xrange(n):
+        k = rep1.sd_numvalid[i]
+        if k > rep0.sd_numvalid[i]:
+            return np.inf
+        if k > 0:
+            df = max(df,maxdiff(ti0[i,:k],ti1[i,:k]),
+                     maxdiff(tv0[i,:k],tv1[i,:k]))
+    return df
+
+# Model: Laplace prior on n variables, m-n probit potentials on 3
+# variables each. Variable 0 is an intercept (in all probit potentials),
+# so that its top-K list runs empty often
+
+np.random.seed(1)
+n = 100
+m = n+400
+nsweeps = 8
+damp = 0.1
+seldamp_numk = 3
+rows = np.repeat(np.arange(m-n),3)
+cols = np.array([np.concatenate(([0],np.random.permutation(n-1)[:2]+1))
+                 for j in xrange(m-n)]).ravel()
+bmat = ssp.vstack([ssp.eye(n,format='csr'),
+                   ssp.csr_matrix((np.random.randn(3*(m-n)),(rows,cols)),
+                                  shape=(m-n,n))],format='csr')
+bfact = abt.MatFactorizedInf(bmat)
+pman = abt.PotManager((abt.ElemPotManager('Laplace',n,(0., 1.5)),
+                       abt.ElemPotManager('Probit',m-n,
+                                          (np.sign(np.random.randn(m-n)),
+                                           0.))))
+orders = [np.int32(np.random.permutation(m)) for k in xrange(nsweeps)]
+
+rep0 = init_repres(bfact,n)
+nrec0 = run_updates(rep0,False)
+rep1 = init_repres(bfact,n)
+nrec1 = run_updates(rep1,True)
+df = max(maxdiff(rep0.ep_pi,rep1.ep_pi),maxdiff(rep0.ep_beta,rep1.ep_beta),
+         maxdiff(rep0.marg_pi,rep1.marg_pi),
+         maxdiff(rep0.marg_beta,rep1.marg_beta))
+print 'Heap vs. lists: df=%.4e, recomputations: %d/%d' % (df,nrec1,nrec0)
+if df > 0.:
+    raise ValueError('Selective damping with heap differs from lists')
+# Recompute top-K lists from scratch
+rep2 = abt.RepresentationFactorized(bfact,rep1.ep_pi,rep1.ep_beta)
+rep2.seldamp_reset(seldamp_numk)
+df = max(maxdiff(rep1.sd_numvalid,rep2.sd_numvalid),toplist_diff(rep2,rep1))
+print 'Heap top-K lists vs. recomputed: df=%.4e' % df
+if df > 0.:
+    raise ValueError('Top-K lists of heap differ from recomputed ones')
+df = toplist_diff(rep2,rep0)
+print 'List top-K lists vs. recomputed: df=%.4e (numvalid: %d/%d)' % \
+    (df,rep0.sd_numvalid.sum(),rep2.sd_numvalid.sum())
+if df > 0.:
+    raise ValueError('Top-K lists differ from recomputed ones')
@@ -0,0 +1,124 @@
+#! /usr/bin/env python
+
+# Checkpoint/restore of the factorized EP state (RepresentationFactorized,
+# 'save_state', 'load_state'): Sequential sweeps with selective damping
+# are interrupted half-way, the state is written to file, restored into a
+# new representation, and sweeps are resumed from there. The final state
+# must be identical to the one of an uninterrupted run with the same
+# update orderings. The round trip is also checked for the parameters of
+# bivariate precision potentials (see 'setprec') and for the potential
+# manager parameters.
+
+import os
+import tempfile
+import numpy as np
+import scipy.sparse as ssp
+
+import apbsint as abt
+import apbsint.eptools_ext as epx
+
+# Helper functions
+
+def maxdiff(a,b):
+    return np.abs(np.asarray(a,dtype=np.float64)-
+                  np.asarray(b,dtype=np.float64)).max()
+
+def init_repres(bfact,n):
+    rep = abt.RepresentationFactorized(bfact)
+    tvec = np.zeros(rep.size_pars())
+    rep.setbeta(tvec)
+    tvec[:n] = 1. # Laplace prior potentials
+    rep.setpi(tvec)
+    rep.refresh()
+    rep.seldamp_reset(seldamp_numk)
+    return rep
+
+def create_session(bfact,pman,rep):
+    m, n = bfact.shape()
+    pman.check_internal()
+    return epx.FactSession(n,m,pman.potids,pman.numpot,pman.parvec,
+                           pman.parshrd,pman.annobj,bfact.rowind,
+                           bfact.colind,bfact.bvals,rep.ep_pi,rep.ep_beta,
+                           rep.marg_pi,rep.marg_beta,1e-8,1,
+                           rep.sd_numvalid,rep.sd_topind,rep.sd_topval,
+                           rep.sd_subind,rep.sd_subexcl)
+
+def run_sweeps(sess,orders):
+    for updind in orders:
+        sess.updates(updind,damp)
+
+def state_diff(rep0,rep1):
+    return max(maxdiff(rep0.ep_pi,rep1.ep_pi),
+               maxdiff(rep0.ep_beta,rep1.ep_beta),
+               maxdiff(rep0.marg_pi,rep1.marg_pi),
+               maxdiff(rep0.marg_beta,rep1.marg_beta),
+               maxdiff(rep0.sd_numvalid,rep1.sd_numvalid),
+               maxdiff(rep0.sd_topind,rep1.sd_topind),
+               maxdiff(rep0.sd_topval,rep1.sd_topval))
+
+# Model: Laplace prior on n variables, m-n Gaussian potentials on 3
+# variables each
+
+np.random.seed(1)
+n = 200
+m = n+600
+nsweeps = 10
+damp = 0.1
+seldamp_numk = 5
+rows = np.repeat(np.arange(m-n),3)
+cols = np.array([np.random.permutation(n)[:3] for j in xrange(m-n)]).ravel()
+bmat = ssp.vstack([ssp.eye(n,format='csr'),
+                   ssp.csr_matrix((np.random.randn(3*(m-n)),(rows,cols)),
+                                  shape=(m-n,n))],format='csr')
+bfact = abt.MatFactorizedInf(bmat)
+pman = abt.PotManager((abt.ElemPotManager('Laplace',n,(0., 1.5)),
+                       abt.ElemPotManager('Gaussian',m-n,
+                                          (np.random.randn(m-n), 0.5))))
+orders = [np.int32(np.random.permutation(m)) for k in xrange(nsweeps)]
+fname = os.path.join(tempfile.mkdtemp(),'fact_state.bin')
+
+# Uninterrupted run
+rep0 = init_repres(bfact,n)
+run_sweeps(create_session(bfact,pman,rep0),orders)
+
+# Interrupted run, restored from file
+rep1 = init_repres(bfact,n)
+run_sweeps(create_session(bfact,pman,rep1),orders[:nsweeps/2])
+rep1.save_state(fname,pman)
+rep2 = abt.RepresentationFactorized(bfact)
+pman2 = abt.PotManager((abt.ElemPotManager('Laplace',n,(0., 1.)),
+                        abt.ElemPotManager('Gaussian',m-n,
+                                           (np.zeros(m-n), 1.))))
+rep2.load_state(fname,pman2)
+pman2.check_internal()
+print 'Restored state: df=%.4e, df(parvec)=%.4e' % \
+    (state_diff(rep1,rep2), maxdiff(pman.parvec,pman2.parvec))
+run_sweeps(create_session(bfact,pman2,rep2),orders[nsweeps/2:])
+df = state_diff(rep0,rep2)
+print 'Resumed vs. uninterrupted: df=%.4e' % df
+if df > 0.:
+    raise ValueError('Resumed run differs from uninterrupted run')
+
+# Bivariate precision potentials: The last 'mprec' potentials, assigned to
+# 'numtau' precision variables
+mprec = 30
+numtau = 4
+kind = np.int32(np.random.randint(numtau,size=mprec))
+kind[:numtau] = np.arange(numtau)
+jsets = [np.int32(np.nonzero(kind==k)[0]) for k in xrange(numtau)]
+offs = mprec+numtau+2+np.cumsum([0]+[x.shape[0] for x in jsets])
+tauind = np.int32(np.concatenate((kind, [numtau], offs)+tuple(jsets)))
+rep3 = init_repres(bfact,n)
+rep3.setprec(tauind,np.random.uniform(0.5,2.,mprec),
+             np.random.uniform(0.5,2.,mprec))
+rep3.refresh()
+rep3.save_state(fname)
+rep4 = abt.RepresentationFactorized(bfact)
+rep4.load_state(fname)
+df = max(state_diff(rep3,rep4),maxdiff(rep3.ep_a,rep4.ep_a),
+         maxdiff(rep3.ep_c,rep4.ep_c),maxdiff(rep3.tauind,rep4.tauind),
+         maxdiff(rep3.marg_a,rep4.marg_a),maxdiff(rep3.marg_c,rep4.marg_c))
+print 'Bivariate precision state: df=%.4e' % df
+if df > 0.:
+    raise ValueError('Restored bivariate precision state differs')
+os.remove(fname)
@@ -0,0 +1,121 @@
+#! /usr/bin/env python
+
+# Sweep modes of 'FactSession.sweeps' on a small probit model: Colored
+# sweeps (mode 1) with a single thread must give the same results as
+# sequential sweeps (mode 0) with the same seed (same orderings). Colored
+# sweeps with several threads, parallel (mode 2), asynchronous (mode 3)
+# and residual (mode 4) sweeps, as well as sequential sweeps with freezing
+# of converged potentials, must reach the fixed point of sequential sweeps
+# within a tolerance. The histograms of update return stati (NSKIP) must
+# sum to the number of updates done in each sweep.
+
+import numpy as np
+import scipy.sparse as ssp
+
+import apbsint as abt
+import apbsint.eptools_ext as epx
+
+# Helper functions
+
+def maxdiff(a,b):
+    return np.abs(np.asarray(a,dtype=np.float64)-
+                  np.asarray(b,dtype=np.float64)).max()
+
+def init_repres(bfact,n):
+    rep = abt.RepresentationFactorized(bfact)
+    tvec = np.zeros(rep.size_pars())
+    rep.setbeta(tvec)
+    tvec[:n] = 1. # Gaussian prior potentials
+    rep.setpi(tvec)
+    rep.refresh()
+    return rep
+
+def create_session(bfact,pman,rep,nthreads):
+    m, n = bfact.shape()
+    pman.check_internal()
+    return epx.FactSession(n,m,pman.potids,pman.numpot,pman.parvec,
+                           pman.parshrd,pman.annobj,bfact.rowind,
+                           bfact.colind,bfact.bvals,rep.ep_pi,rep.ep_beta,
+                           rep.marg_pi,rep.marg_beta,1e-8,nthreads)
+
+def run_sweeps(name,nthreads,dampfact=0.,mode=0,refresh=True,freezek=0):
+    rep = init_repres(bfact,n)
+    sess = create_session(bfact,pman,rep,nthreads)
+    (nit,rstat,delta,nskip,nsdamp,nrefresh,nfrozen) = \
+        sess.sweeps(maxit,deltaeps,dampfact,mode,refresh,seed,
+                    freezek=freezek)
+    # Residual sweeps stop early: only the first one updates on all
+    # potentials
+    nupd = nskip.sum(axis=1)+nfrozen
+    nbad = np.nonzero(nupd[:1] != m)[0].shape[0]
+    if mode != 4:
+        nbad += np.nonzero(nupd != m)[0].shape[0]
+    elif np.any(nupd > m):
+        nbad += 1
+    print '%s: nit=%d, rstat=%d, delta=%.4e, nfrozen=%d, nfail=%d' % \
+        (name,nit,rstat,delta[-1],nfrozen.sum(),
+         nskip[:,1:].sum())
+    if nbad > 0:
+        raise ValueError('%s: NSKIP does not sum to number of updates' % name)
+    if rstat != 0:
+        raise ValueError('%s: Did not converge' % name)
+    return (rep,nit,delta)
+
+def state_diff(rep0,rep1):
+    return max(maxdiff(rep0.ep_pi,rep1.ep_pi),
+               maxdiff(rep0.ep_beta,rep1.ep_beta),
+               maxdiff(rep0.marg_pi,rep1.marg_pi),
+               maxdiff(rep0.marg_beta,rep1.marg_beta))
+
+# Difference in marginal means and variances
+def marg_diff(rep0,rep1):
+    return max(maxdiff(rep0.marg_beta/rep0.marg_pi,
+                       rep1.marg_beta/rep1.marg_pi),
+               maxdiff(1./rep0.marg_pi,1./rep1.marg_pi))
+
+# Model: Gaussian prior on n variables, m-n probit potentials on 4
+# variables each
+
+np.random.seed(1)
+n = 100
+m = n+300
+nthreads = 4
+maxit = 200
+deltaeps = 1e-8
+seed = 7
+tol = 1e-5
+rows = np.repeat(np.arange(m-n),4)
+cols = np.array([np.random.permutation(n)[:4] for j in xrange(m-n)]).ravel()
+bmat = ssp.vstack([ssp.eye(n,format='csr'),
+                   ssp.csr_matrix((np.random.randn(4*(m-n)),(rows,cols)),
+                                  shape=(m-n,n))],format='csr')
+bfact = abt.MatFactorizedInf(bmat)
+pman = abt.PotManager((abt.ElemPotManager('Gaussian',n,(np.zeros(n), 1.)),
+                       abt.ElemPotManager('Probit',m-n,
+                                          (np.sign(np.random.randn(m-n)),
+                                           0.))))
+
+# Sequential sweeps (reference), colored sweeps with one thread
+(rep0,nit0,delta0) = run_sweeps('Sequential',1)
+(rep1,nit1,delta1) = run_sweeps('Colored (1 thread)',1,mode=1)
+df = max(state_diff(rep0,rep1),maxdiff(delta0,delta1[:nit0]))
+print 'Colored (1 thread) vs. sequential: df=%.4e, nit=%d/%d' % \
+    (df,nit1,nit0)
+if df > 0. or nit1 != nit0:
+    raise ValueError('Colored sweeps (1 thread) differ from sequential')
+
+# Other modes must reach the same fixed point
+runs = [('Colored',dict(mode=1)),
+        ('Colored, dirty refresh',dict(mode=1,refresh='dirty')),
+        ('Parallel',dict(mode=2,dampfact=0.5)),
+        ('Asynchronous',dict(mode=3)),
+        ('Residual',dict(mode=4)),
+        ('Residual, dirty refresh',dict(mode=4,refresh='dirty')),
+        ('Freezing',dict(mode=0,freezek=2)),
+        ('Freezing, colored',dict(mode=1,freezek=2))]
+for (name,kwargs) in runs:
+    (rep1,nit1,delta1) = run_sweeps(name,nthreads,**kwargs)
+    df = marg_diff(rep0,rep1)
+    print '%s vs. sequential: df(marg)=%.4e' % (name,df)
+    if df > tol:
+        raise ValueError('%s: Does not reach sequential fixed point' % name)
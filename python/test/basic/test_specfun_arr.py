@@ -0,0 +1,52 @@
+#! /usr/bin/env python
+
+# Compares array methods of SpecfunServices (SIMD kernels) against the
+# scalar methods: maximum relative difference and running time, for each
+# instruction set supported by the CPU.
+
+import time
+import numpy as np
+import apbsint.apbtest_ext as apt
+
+# Helper functions
+
+def maxreldiff(a,b):
+    return (np.abs(a-b)/np.maximum(np.maximum(np.abs(a),np.abs(b)),
+                                   1e-300)).max()
+
+# Arguments: Mostly the range relevant for EP updates, some large ones
+# (passed to scalar methods), boundaries of the Cody approximations
+num = 1000000
+nrep = 10
+np.random.seed(1)
+z = np.concatenate((np.random.uniform(-8.,8.,num-num/10),
+                    np.random.uniform(-40.,40.,num/10)))
+z[:6] = [0., 0.6629, -0.6629, 5.6569, -5.6569, 37.]
+res0 = np.empty(num)
+res1 = np.empty(num)
+
+funcs = [('logPdfNormal', apt.specfun_logpdfnormal,
+          apt.specfun_logpdfnormal_arr),
+         ('cdfNormal', apt.specfun_cdfnormal, apt.specfun_cdfnormal_arr),
+         ('logCdfNormal', apt.specfun_logcdfnormal,
+          apt.specfun_logcdfnormal_arr),
+         ('derivLogCdfNormal', apt.specfun_derivlogcdfnormal,
+          apt.specfun_derivlogcdfnormal_arr)]
+levnames = ['scalar', 'generic', 'AVX2', 'AVX-512']
+maxlev = apt.specfun_getsimdlevel()
+print 'Instruction set detected: %s' % levnames[maxlev]
+for (name, fscal, farr) in funcs:
+    t0 = time.time()
+    for i in range(nrep):
+        fscal(z,res0)
+    tscal = time.time()-t0
+    for lev in range(maxlev+1):
+        apt.specfun_setsimdlevel(lev)
+        t0 = time.time()
+        for i in range(nrep):
+            farr(z,res1)
+        tarr = time.time()-t0
+        print '%-18s %-8s: rdf = %.2e, scalar = %.3fs, array = %.3fs (%.2fx)' % \
+            (name, levnames[lev], maxreldiff(res0,res1), tscal, tarr,
+             tscal/tarr)
+apt.specfun_setsimdlevel(3)
@@ -0,0 +1,115 @@
+#! /usr/bin/env python
+
+# EPTOOLS Python Interface
+# Accuracy report: Factorized EP with single precision storage for B and
+# the EP parameters (apbsint.MatFactorizedInf, 'single'==True) against the
+# double precision path.
+# Same problem as eptest_binclass.py (factorized mode, Laplace prior,
+# selective damping). Both runs start from the same initialization and do
+# the same number of sweeps. We report the maximum relative difference of
+# the marginals, test set accuracy, log likelihood and running time.
+
+import numpy as np
+import scipy.sparse as ssp
+import time  # Profiling
+
+import apbsint as abt
+
+# Helper functions
+
+def run_ep(mx_train,bfct_test,pman_train,pman_test,targ_test,single,
+           maxit,nthreads):
+    n = mx_train.shape[1]
+    num_test = targ_test.size
+    bfct_train = abt.MatFactorizedInf(mx_train,single=single)
+    model_train = abt.ModelFactorized(bfct_train,pman_train)
+    model_test = abt.ModelFactorized(bfct_test,pman_test)
+    repres = abt.RepresentationFactorized(bfct_train)
+    inf_driv = abt.EPFactorizedInfDriver(model_train,repres)
+    # Prior potentials: pi's set to 1, beta's to 0, skipped in 1st sweep
+    tvec = np.zeros(repres.size_pars())
+    repres.setbeta(tvec)
+    tvec[:n] = 1.
+    repres.setpi(tvec)
+    repres.refresh()
+    repres.seldamp_reset(seldamp_numk)
+    opts = abt.helpers.Struct()
+    opts.imode = 'Factorized'
+    opts.maxit = maxit
+    opts.deltaeps = 1e-12 # Run 'maxit' sweeps
+    opts.damp = 0.
+    opts.piminthres = 1e-7
+    opts.refresh = True
+    opts.verbose = 0
+    opts.res_det = False
+    opts.nthreads = nthreads
+    opts.upd_1stsweep = set(['Probit'])
+    t_start = time.time()
+    res = inf_driv.inference(opts)
+    t_inf = time.time()-t_start
+    opts = abt.helpers.Struct()
+    opts.imode = 'Factorized'
+    opts.ptype = 3
+    (h_q, rho_q, logz, h_p, rho_p) = inf_driv.predict(model_test,opts)
+    acc = 100.*float((np.sign(h_q)==targ_test).sum())/num_test
+    loglh = logz.sum()/num_test
+    mem = bfct_train.bvals.nbytes+repres.ep_pi.nbytes+repres.ep_beta.nbytes
+    return (repres.marg_pi.copy(), repres.marg_beta.copy(), res.delta, acc,
+            loglh, t_inf, mem)
+
+# Main code
+
+# Load dataset (see eptest_binclass.py)
+num_feat = n = 120  # After removing 3
+tmat = []
+fid = open('adult_a9a_inputs_comp.csv','r')
+for line in fid:
+    ind = [int(x) for x in line.split(',')]
+    v = np.zeros(n+3,dtype=np.float64)
+    v[ind] = 1.
+    tmat.append(list(np.hstack((v[:45], v[46:116], v[117:122]))))
+fid.close()
+num_cases = len(tmat)
+print 'Dataset: Read %d cases.' % num_cases
+inp_all = ssp.csr_matrix(tmat)
+del tmat
+num_test = 30000
+num_train = num_cases-num_test
+fid = open('adult_a9a_targets.csv','r')
+targ_all = np.array([float(x) for x in fid.readline().split(',')],
+                    dtype=np.float64)
+fid.close()
+if targ_all.size != num_cases:
+    raise IndexError('Internal error: Wrong file size')
+
+# Setup
+tau_lapl = 2./5.
+seldamp_numk = 5
+maxit = 100
+nthreads = 1
+bfct_test = abt.MatFactorizedInf(inp_all[:num_test,:].copy())
+mx_train = ssp.vstack([ssp.eye(n,format='csr'), inp_all[num_test:,:]],
+                      format='csr')
+pman_train = abt.PotManager((abt.ElemPotManager('Laplace',n,(0., tau_lapl)),
+                             abt.ElemPotManager('Probit',num_train,
+                                                (targ_all[num_test:].copy(),
+                                                 0.))))
+pman_test = abt.PotManager(abt.ElemPotManager('Probit',num_test,
+                                              (targ_all[:num_test].copy(), 0.)))
+
+# Run both variants
+results = []
+for single in (False, True):
+    results.append(run_ep(mx_train,bfct_test,pman_train,pman_test,
+                          targ_all[:num_test],single,maxit,nthreads))
+(mpi0, mbeta0) = results[0][:2]
+(mpi1, mbeta1) = results[1][:2]
+print '\n%-8s %-10s %-8s %-10s %-9s %-9s' % ('Storage', 'Delta', 'Acc.',
+                                            'Log-lh', 'Time', 'Memory')
+for (name, res) in zip(('double', 'single'), results):
+    print '%-8s %-10.6f %-7.2f%% %-10.6f %-8.3fs %-6.2fMB' % \
+        (name, res[2], res[3], res[4], res[5], res[6]/1048576.)
+print '\nMarginals (single vs. double): df(m_pi)=%.4e, df(m_beta)=%.4e' % \
+    (abt.helpers.maxreldiff(mpi1,mpi0), abt.helpers.maxreldiff(mbeta1,mbeta0))
+print 'Means: df(m_beta/m_pi)=%.4e' % abt.helpers.maxreldiff(mbeta1/mpi1,
+                                                             mbeta0/mpi0)
@@ -0,0 +1,71 @@
+#! /usr/bin/env python
+
+# EPTOOLS Python Interface
+# Test of EP updates for the bivariate Gaussian precision potential
+#   t(s,tau) = N(s | y, tau^-1),
+# as registered in the default potential factory ('GaussHermiteQuadServices').
+# We compare against brute force quadrature over tau (s is integrated out
+# analytically), for cavity shapes ca>1/2 (Laplace transformation used).
+# This checks the normalization of the tau moments by Z_til (a_hat, c_hat)
+# and the Jacobian term log(sigma) in log Z.
+
+import numpy as np
+from scipy.special import gammaln
+import apbsint as abt
+
+# Helper functions
+
+def reldiff(a,b):
+    return np.abs(a-b)/np.maximum(np.maximum(np.abs(a),np.abs(b)),1.)
+
+# Tilted distribution over tau (after integrating out s):
+#   N(y | cmu, crho+1/tau) Gamma(tau | ca, cc),
+# by trapezoidal rule in u = log(tau). Returns alpha, nu, a_hat, c_hat, logz
+def brute_force(y,cmu,crho,ca,cc,num=200001):
+    u = np.linspace(-40.,np.log(ca/cc)+15.,num)
+    tau = np.exp(u)
+    v = crho+1./tau
+    d = y-cmu
+    lw = -0.5*(np.log(2.*np.pi*v)+d*d/v)+ca*np.log(cc)-gammaln(ca)+ca*u- \
+        cc*tau
+    lmax = lw.max()
+    w = np.exp(lw-lmax)
+    w[0] *= 0.5; w[-1] *= 0.5
+    w *= u[1]-u[0]
+    z = w.sum()
+    w /= z
+    alpha = np.dot(w,d/v)
+    nu = np.dot(w,1./v)-np.dot(w,d*d/(v*v))+alpha*alpha
+    et1 = np.dot(w,tau)
+    chat = et1/(np.dot(w,tau*tau)-et1*et1)
+    return (alpha, nu, et1*chat, chat, np.log(z)+lmax)
+
+# Main code
+
+names = ('alpha', 'nu', 'a_hat', 'c_hat', 'logz')
+maxrdf = 0.
+print 'Gaussian precision potential: Default factory vs. brute force'
+for y in (0., 1.5):
+    pars = np.array([y])
+    for cmu in (-2., 0., 0.5, 3.):
+        for crho in (0.2, 1., 5.):
+            for ca in (1., 2., 10.):
+                for cc in (0.5, 2., 10.):
+                    res = abt.eptools_ext.epupdate_single_bvprec(
+                        'GaussianPrecision',pars,0,cmu,crho,ca,cc)
+                    if res[0] == 0:
+                        raise ValueError(('Update failed: y=%f,cmu=%f,' +
+                                          'crho=%f,ca=%f,cc=%f') %
+                                         (y,cmu,crho,ca,cc))
+                    res2 = brute_force(y,cmu,crho,ca,cc)
+                    for k in range(5):
+                        rdf = reldiff(res[k+1],res2[k])
+                        if rdf > maxrdf:
+                            maxrdf = rdf
+                            print ('%s: rdf=%.4e (v1=%f,v2=%f): y=%f,cmu=%f,' +
+                                   'crho=%f,ca=%f,cc=%f') % \
+                                (names[k],rdf,res[k+1],res2[k],y,cmu,crho,ca,
+                                 cc)
+print 'Max. rel. difference: %.4e' % maxrdf
+if maxrdf > 5e-3:
+    raise ValueError('Default GaussianPrecision differs from brute force')
@@ -0,0 +1,73 @@
+#! /usr/bin/env python
+
+# EPTOOLS Python Interface
+# Test of quadrature implementation of EP updates, as registered in the
+# default potential factory: Laplace transformation and Gauss-Hermite
+# quadrature ('GaussHermiteQuadServices'), no annotation.
+#
+# Potential: Poisson with exponential rate function. We compare against
+# brute force quadrature (trapezoidal rule on a fine grid).
+
+import numpy as np
+import apbsint as abt
+
+# Helper functions
+
+def reldiff(a,b):
+    return np.abs(a-b)/np.maximum(np.maximum(np.abs(a),np.abs(b)),1.)
+
+# Moments of t(s) N(s|cmu,crho), t(s) = exp(y s - e^s)/y!, by trapezoidal
+# rule. Returns alpha, nu, logz
+def brute_force(y,cmu,crho,num=200001):
+    sd = np.sqrt(crho)
+    s = np.linspace(max(cmu-12.*sd,-60.),min(cmu+12.*sd,np.log(y+1.)+60.),
+                    num)
+    lyfact = np.sum(np.log(np.arange(2.,y+1.))) # log(y!)
+    lf = y*s-np.exp(s)-lyfact-0.5*(s-cmu)**2/crho-0.5*np.log(2.*np.pi*crho)
+    lmax = lf.max()
+    w = np.exp(lf-lmax)
+    w[0] *= 0.5; w[-1] *= 0.5
+    w *= s[1]-s[0]
+    z = w.sum()
+    mean = np.dot(w,s)/z
+    var = np.dot(w,(s-mean)**2)/z
+    return ((mean-cmu)/crho, (1.-var/crho)/crho, np.log(z)+lmax)
+
+# Main code
+
+y_lst = [0., 1., 3., 10.]
+cmu = np.repeat(np.arange(-5.,5.,0.5),3)
+crho = np.tile(np.array([0.1, 1., 4.]),cmu.shape[0]/3)
+m = cmu.shape[0]
+rstat = np.empty(m,dtype=np.int32)
+alpha = np.empty(m)
+nu = np.empty(m)
+logz = np.empty(m)
+alpha2 = np.empty(m)
+nu2 = np.empty(m)
+logz2 = np.empty(m)
+print 'Poisson potential, exponential link: Default factory vs. brute force'
+maxrdf = 0.
+for y in y_lst:
+    pm = abt.PotManager(abt.ElemPotManager('PoissonExpRate',m,y))
+    pm.check_internal()
+    abt.eptools_ext.epupdate_parallel(pm.potids,pm.numpot,pm.parvec,
+                                      pm.parshrd,pm.annobj,cmu,crho,rstat,
+                                      alpha,nu,logz)
+    mm = np.nonzero(rstat)[0].shape[0]
+    if mm<m:
+        raise ValueError('y=%d: %d updates failed' % (np.int32(y),m-mm))
+    for j in xrange(m):
+        (alpha2[j],nu2[j],logz2[j]) = brute_force(y,cmu[j],crho[j])
+    mat1 = np.vstack((logz, alpha, nu))
+    mat2 = np.vstack((logz2, alpha2, nu2))
+    names = ('logz', 'alpha', 'nu')
+    print '\ny=%d' % np.int32(y)
+    for k in range(3):
+        rdf = reldiff(mat1[k],mat2[k])
+        j = np.argmax(rdf)
+        maxrdf = max(maxrdf,rdf[j])
+        print ('%s: rdf=%.4e (v1=%f,v2=%f): j=%d,cmu=%f,crho=%f' %
+               (names[k],rdf[j],mat1[k,j],mat2[k,j],j,cmu[j],crho[j]))
+if maxrdf > 1e-3:
+    raise ValueError('Default PoissonExpRate differs from brute force')
@@ -0,0 +1,37 @@
+#! /usr/bin/env python
+
+# EPTOOLS Python Interface
+# Test of 'QuadPotProximalNewton::proximalBatch' (lock-step Newton for
+# chunks of potentials) against 'proximal' (one potential at a time). Both
+# run the same steps, so solutions and return status must be identical.
+# Potentials: Poisson with logistic rate function, negative binomial with
+# exponential rate function.
+
+import numpy as np
+import apbsint.apbtest_ext as apt
+
+# Main code
+
+np.random.seed(1)
+num = 2000
+h = np.random.uniform(-10.,10.,num)
+rho = np.exp(np.random.uniform(-5.,3.,num))
+yv = np.floor(30.*np.random.uniform(size=num)*np.random.uniform(size=num))
+rv = np.random.uniform(0.1,10.,num)
+tests = [('PoissonLogisticRate', 0, yv.reshape((num,1))),
+         ('NegBinomialExpRate', 1, np.vstack((yv, rv)).T.copy())]
+sstar = np.empty(num)
+rstat = np.empty(num,dtype=np.int32)
+sstar2 = np.empty(num)
+rstat2 = np.empty(num,dtype=np.int32)
+print 'proximalBatch vs. proximal'
+for (name,ptype,pars) in tests:
+    apt.quadprox_newton(ptype,h,rho,pars,sstar,rstat,True)
+    apt.quadprox_newton(ptype,h,rho,pars,sstar2,rstat2,False)
+    nbad = np.nonzero(rstat != rstat2)[0].shape[0]
+    ind = np.nonzero(rstat2)[0]
+    df = np.abs(sstar[ind]-sstar2[ind]).max()
+    print '%s: %d of %d OK. Status differs: %d, max. diff.: %.4e' % \
+        (name,ind.shape[0],num,nbad,df)
+    if nbad > 0 or df > 0.:
+        raise ValueError('%s: proximalBatch differs from proximal' % name)
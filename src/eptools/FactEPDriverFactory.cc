@@ -0,0 +1,84 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Definition of class FactEPDriverFactory
+ * ------------------------------------------------------------------- */
+
+#include "src/eptools/FactEPDriverFactory.h"
+#include "src/eptools/FactorizedEPDriverSpec.h"
+#include "src/eptools/potentials/EPPotGaussian.h"
+#include "src/eptools/potentials/EPPotLaplace.h"
+#include "src/eptools/potentials/EPPotProbit.h"
+#include "src/eptools/potentials/EPPotQuantileRegress.h"
+
+//BEGINNS(eptools)
+  /*
+   * Number of potentials in 'DefaultPotManager' blocks of 'pm' whose
+   * potential object is of type 'P'.
+   */
+  template<class P> static int countPotType(const PotentialManager& pm)
+  {
+    int ic,nb,ret=0;
+    const ContainerPotManager* cpm=DYNCAST(const ContainerPotManager,&pm);
+
+    nb=(cpm!=0)?cpm->numChildren():1;
+    for (ic=0; ic<nb; ic++) {
+      const PotentialManager& child=(cpm!=0)?cpm->getChild(ic):pm;
+      const DefaultPotManager* dpm=DYNCAST(const DefaultPotManager,&child);
+      if (dpm!=0 && dpm->isPotType<P>())
+	ret+=dpm->size();
+    }
+
+    return ret;
+  }
+
+  /*
+   * NOTE: With MATLAB_MEX, 'DYNCAST' is a static cast and cannot be used
+   * to detect block types. We always return the generic driver then.
+   */
+  FactorizedEPDriver*
+  FactEPDriverFactory::create(const Handle<PotentialManager>& pepPots,
+			      const Handle<FactorizedEPRepresentation>& pepRepr,
+			      const ArrayHandle<double>& pmargBeta,
+			      const ArrayHandle<double>& pmargPi,
+			      double ppiMinThres,
+			      const Handle<FactEPMaximumPiValues>& pepMaxPi)
+  {
+#ifndef MATLAB_MEX
+    int k,kmax=-1,cnt[4];
+
+    cnt[0]=countPotType<EPPotGaussian>(*pepPots);
+    cnt[1]=countPotType<EPPotLaplace>(*pepPots);
+    cnt[2]=countPotType<EPPotProbit>(*pepPots);
+    cnt[3]=countPotType<EPPotQuantileRegress>(*pepPots);
+    for (k=0; k<4; k++)
+      if (cnt[k]>0 && (kmax<0 || cnt[k]>cnt[kmax]))
+	kmax=k;
+    switch (kmax) {
+    case 0:
+      return new FactorizedEPDriverSpec<EPPotGaussian>(pepPots,pepRepr,
+						       pmargBeta,pmargPi,
+						       ppiMinThres,pepMaxPi);
+    case 1:
+      return new FactorizedEPDriverSpec<EPPotLaplace>(pepPots,pepRepr,
+						      pmargBeta,pmargPi,
+						      ppiMinThres,pepMaxPi);
+    case 2:
+      return new FactorizedEPDriverSpec<EPPotProbit>(pepPots,pepRepr,
+						     pmargBeta,pmargPi,
+						     ppiMinThres,pepMaxPi);
+    case 3:
+      return new FactorizedEPDriverSpec<EPPotQuantileRegress>(pepPots,pepRepr,
+							      pmargBeta,
+							      pmargPi,
+							      ppiMinThres,
+							      pepMaxPi);
+    }
+#endif
+
+    return new FactorizedEPDriver(pepPots,pepRepr,pmargBeta,pmargPi,
+				  ppiMinThres,pepMaxPi);
+  }
+//ENDNS
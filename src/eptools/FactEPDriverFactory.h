@@ -0,0 +1,59 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactEPDriverFactory
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTEPDRIVERFACTORY_H
+#define EPTOOLS_FACTEPDRIVERFACTORY_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/FactorizedEPDriver.h"
+
+//BEGINNS(eptools)
+  /**
+   * Factory method to create 'FactorizedEPDriver' object for univariate
+   * potentials.
+   * <p>
+   * If the potential manager consists of 'DefaultPotManager' blocks (see
+   * 'PotManagerFactory'), we count the potentials of each type supported
+   * by 'FactorizedEPDriverSpec' (Gaussian, Laplace, probit, quantile
+   * regression), and return the specialization for the most frequent
+   * one. If there is none, a 'FactorizedEPDriver' is returned.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class FactEPDriverFactory
+  {
+  public:
+    // Public static methods
+
+    /**
+     * Same arguments as the univariate constructor of
+     * 'FactorizedEPDriver'.
+     *
+     * @param pepPots
+     * @param pepRepr
+     * @param pmargBeta
+     * @param pmargPi
+     * @param ppiMinThres
+     * @param pepMaxPi    Optional
+     * @return            New driver object
+     */
+    static FactorizedEPDriver* create(const Handle<PotentialManager>& pepPots,
+				      const Handle<FactorizedEPRepresentation>& pepRepr,
+				      const ArrayHandle<double>& pmargBeta,
+				      const ArrayHandle<double>& pmargPi,
+				      double ppiMinThres,
+				      const Handle<FactEPMaximumPiValues>& pepMaxPi=
+				      HandleZero<FactEPMaximumPiValues>::get());
+  };
+//ENDNS
+
+#endif
@@ -0,0 +1,294 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactEPMaximumPiHeap
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTEPMAXIMUMPIHEAP_H
+#define EPTOOLS_FACTEPMAXIMUMPIHEAP_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/FactEPMaximumPiValues.h"
+
+//BEGINNS(eptools)
+  /**
+   * Variant of 'FactEPMaximumPiValues' which tracks max_j pi_ji exactly
+   * by an indexed max-heap over all (not excluded) j in V_i for each
+   * variable i. 'update' costs O(log |V_i|) and never falls back to
+   * 'recompute', which is O(|V_i|) for the top-K lists. This matters for
+   * variables touched by very many potentials (bias or intercept
+   * columns), where lists run empty often.
+   * <p>
+   * The heap for i stores copies of the values x_ji, in the ordering of
+   * V_i ('facInd', 'facVal'), along with the heap ('heapLoc', positions
+   * into 'facInd') and its inverse ('heapPos'). This needs 20 bytes per
+   * nonzero of B (not excluded by 'subInd'). All heaps are built in the
+   * constructor (O(nnz)). Since values are copied, the representation
+   * is not read by 'update' (also in packed layout).
+   * <p>
+   * The top-K lists of 'MaximumValuesService' are not maintained by
+   * 'update'. 'syncTopLists' writes them for all variables changed
+   * since the last call (O(K^2) per variable), so that 'numValid',
+   * 'topInd', 'topVal' can be passed on to a list-based object later
+   * (see EPTWRAP_FACT_SEQUPDATES).
+   * <p>
+   * NOTE: Not for potentials appended to the representation after
+   * construction ('update' throws an exception for them). 'update' on
+   * j excluded by 'subInd' is ignored.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class FactEPMaximumPiHeap : public FactEPMaximumPiValues
+  {
+  protected:
+    // Additional members
+
+    ArrayHandle<int> facOff;    // Entries for i: 'facOff[i]:facOff[i+1]-1'
+    ArrayHandle<int> facInd;    // Factors j (ascending)
+    ArrayHandle<double> facVal; // Values x_ji
+    ArrayHandle<int> heapLoc;   // Heap: Positions into 'facInd' (relative)
+    ArrayHandle<int> heapPos;   // Inverse of 'heapLoc'
+    ArrayHandle<char> isDirty;  // Top-K list for i out of date?
+
+  public:
+    // Public methods
+
+    /**
+     * Constructor. Same as for 'FactEPMaximumPiValues'. The heaps are
+     * built from the values in 'pepRepr'. The entries of 'ptopInd',
+     * 'ptopVal' are not used, and 'pnumValid' only has to be valid.
+     */
+    FactEPMaximumPiHeap(const Handle<FactorizedEPRepresentation>& pepRepr,
+			int pmaxSize,const ArrayHandle<int>& pnumValid,
+			const ArrayHandle<int>& ptopInd,
+			const ArrayHandle<double>& ptopVal,
+			const ArrayHandle<int>& psubInd=
+			ArrayHandleZero<int>::get(),bool psubExcl=false) :
+      FactEPMaximumPiValues(pepRepr,pmaxSize,pnumValid,ptopInd,ptopVal,
+			    psubInd,psubExcl) {
+      buildHeaps();
+    }
+
+    /**
+     * Reloads values x_ji for variable i from the representation and
+     * rebuilds the heap.
+     *
+     * @param i Variable index
+     */
+    void recompute(int i) {
+      if (isIndex64())
+	fillT<int64_t,double>(i,false);
+      else if (isSingle())
+	fillT<int,float>(i,false);
+      else
+	fillT<int,double>(i,false);
+      heapify(i);
+    }
+
+    void recompute() {
+      for (int i=0; i<numVariables(); i++)
+	recompute(i);
+    }
+
+    double getMaxValue(int i) const {
+      int off=facOff[i];
+
+      return facVal[off+heapLoc[off]];
+    }
+
+    void update(int i,int j,double val);
+
+    /**
+     * Writes top-K lists ('numValid', 'topInd', 'topVal') for all
+     * variables whose heaps have changed since the last call.
+     */
+    void syncTopLists();
+
+  protected:
+    // Internal methods
+
+    /**
+     * Builds 'facOff', then all heaps.
+     */
+    void buildHeaps();
+
+    /**
+     * If 'count'==true, returns the number of entries for i (not
+     * excluded by 'subInd'). Otherwise, copies these entries to
+     * 'facInd', 'facVal' (at 'facOff[i]').
+     */
+    template<class I,class V> int fillT(int i,bool count);
+
+    void heapify(int i);
+
+    /**
+     * Moves heap entry at 'h' up or down, until the heap property is
+     * restored. Heap starts at 'off', has size 'sz'.
+     */
+    void siftUp(int off,int h);
+
+    void siftDown(int off,int sz,int h);
+  };
+
+  // Inline methods
+
+  template<class I,class V> inline int
+  FactEPMaximumPiHeap::fillT(int i,bool count)
+  {
+    int k,j,num,viSz;
+    const V* xP;
+    const I* viInd,*jiInd;
+
+    viSz=factorValues(i,viInd,jiInd,xP);
+    if (count) {
+      for (k=num=0; k<viSz; k++)
+	num+=!isExcluded((int) viInd[k]);
+      return num;
+    }
+    int* fiP=facInd.p()+facOff[i];
+    double* fvP=facVal.p()+facOff[i];
+    for (k=num=0; k<viSz; k++)
+      if (!isExcluded(j=(int) viInd[k])) {
+	fiP[num]=j; fvP[num++]=(double) xP[jiInd[k]];
+      }
+    isDirty[i]=1;
+
+    return num;
+  }
+
+  inline void FactEPMaximumPiHeap::siftUp(int off,int h)
+  {
+    int* hlP=heapLoc.p()+off,*hpP=heapPos.p()+off;
+    const double* fvP=facVal.p()+off;
+    int par,l=hlP[h];
+    double val=fvP[l];
+
+    for (; h>0 && fvP[hlP[par=(h-1)>>1]]<val; h=par) {
+      hlP[h]=hlP[par]; hpP[hlP[h]]=h;
+    }
+    hlP[h]=l; hpP[l]=h;
+  }
+
+  inline void FactEPMaximumPiHeap::siftDown(int off,int sz,int h)
+  {
+    int* hlP=heapLoc.p()+off,*hpP=heapPos.p()+off;
+    const double* fvP=facVal.p()+off;
+    int c,l=hlP[h];
+    double val=fvP[l];
+
+    while ((c=2*h+1)<sz) {
+      if (c+1<sz && fvP[hlP[c+1]]>fvP[hlP[c]]) c++;
+      if (fvP[hlP[c]]<=val) break;
+      hlP[h]=hlP[c]; hpP[hlP[h]]=h;
+      h=c;
+    }
+    hlP[h]=l; hpP[l]=h;
+  }
+
+  inline void FactEPMaximumPiHeap::heapify(int i)
+  {
+    int h,off=facOff[i],sz=facOff[i+1]-off;
+    int* hlP=heapLoc.p()+off,*hpP=heapPos.p()+off;
+
+    for (h=0; h<sz; h++)
+      hlP[h]=hpP[h]=h;
+    for (h=sz/2-1; h>=0; h--)
+      siftDown(off,sz,h);
+  }
+
+  inline void FactEPMaximumPiHeap::buildHeaps()
+  {
+    int i,n=numVariables(),num;
+    int64_t tot;
+
+    facOff.changeRep(n+1); isDirty.changeRep(n);
+    for (i=0,tot=0; i<n; i++) {
+      facOff[i]=(int) tot;
+      if (isIndex64())
+	num=fillT<int64_t,double>(i,true);
+      else if (isSingle())
+	num=fillT<int,float>(i,true);
+      else
+	num=fillT<int,double>(i,true);
+      if (num==0)
+	throw WrongStatusException(EXCEPT_MSG("Variable without factors (not excluded by subInd)"));
+      if ((tot+=num)>INT_MAX)
+	throw NotImplemException(EXCEPT_MSG("Too many nonzeros for heaps"));
+    }
+    facOff[n]=(int) tot;
+    facInd.changeRep(tot); facVal.changeRep(tot);
+    heapLoc.changeRep(tot); heapPos.changeRep(tot);
+    for (i=0; i<n; i++)
+      recompute(i);
+  }
+
+  inline void FactEPMaximumPiHeap::update(int i,int j,double val)
+  {
+    int off,sz,l;
+    const int* fiP,*pos;
+
+    if (i<0 || j<0 || i>=numVariables() || j>=numFactors())
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    off=facOff[i]; sz=facOff[i+1]-off;
+    fiP=facInd.p()+off;
+    pos=std::lower_bound(fiP,fiP+sz,j);
+    if (pos==fiP+sz || *pos!=j) {
+      if (isExcluded(j))
+	return;
+      throw WrongStatusException(EXCEPT_MSG("j not in heap for i (appended potential?)"));
+    }
+    l=(int) (pos-fiP);
+    double* fvP=facVal.p()+off;
+    if (val>fvP[l]) {
+      fvP[l]=val; siftUp(off,heapPos[off+l]);
+    } else {
+      fvP[l]=val; siftDown(off,sz,heapPos[off+l]);
+    }
+    isDirty[i]=1;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    statNUpd++;
+  }
+
+  /*
+   * Top-K entries are extracted from the heap without modifying it: the
+   * candidates are the children of entries extracted so far (at most
+   * K+1 of them), the largest candidate is extracted next.
+   */
+  inline void FactEPMaximumPiHeap::syncTopLists()
+  {
+    int i,k,c,h,best,ncand,off,sz,num;
+    ArrayHandle<int> cand(maxSize+1);
+    int* cP=cand.p();
+
+    for (i=0; i<numVariables(); i++)
+      if (isDirty[i]) {
+	off=facOff[i]; sz=facOff[i+1]-off;
+	const int* hlP=heapLoc.p()+off;
+	const int* fiP=facInd.p()+off;
+	const double* fvP=facVal.p()+off;
+	int* tiP=topInd.p()+i*(maxSize+1);
+	double* tvP=topVal.p()+i*(maxSize+1);
+	cP[0]=0; ncand=1;
+	for (num=0; num<maxSize && ncand>0; num++) {
+	  for (c=1,best=0; c<ncand; c++)
+	    if (fvP[hlP[cP[c]]]>fvP[hlP[cP[best]]]) best=c;
+	  h=cP[best]; cP[best]=cP[--ncand];
+	  tiP[num]=fiP[hlP[h]]; tvP[num]=fvP[hlP[h]];
+	  for (k=2*h+1; k<=2*h+2 && k<sz; k++)
+	    cP[ncand++]=k;
+	}
+	numValid[i]=num;
+	isDirty[i]=0;
+      }
+  }
+//ENDNS
+
+#endif
@@ -20,7 +20,14 @@
   /**
    * Specialization of 'MaximumValuesService' to max_k pi_ki, where the
    * factor group (coupling factor B) and the pi values are maintained
-   * by a 'FactorizedEPRepresentation' object.
+   * by a 'FactorizedEPRepresentation' object. Entries of appended
+   * potentials are covered by 'recomputeExtra'. Retired potentials have
+   * pi_ji==0 and are not treated specially.
+   * <p>
+   * 'recomputeMarginals' is a fused, multi-threaded refresh: one pass
+   * over the columns of B computes the Gaussian marginals (same as
+   * 'FactorizedEPRepresentation::compMarginals') and the top-K lists
+   * (same as 'recompute').
    *
    * @author  Matthias Seeger
    * @version %I% %G%
@@ -71,7 +78,124 @@
 
       return epRepr->accessCol(i,vind,jind,bP,betaP,xarr);
     }
+
+    int getFactorValues64(int i,const int64_t*& vind,const int64_t*& jind,
+			  const double*& xarr) const {
+      const double* bP,*betaP;
+
+      return epRepr->accessCol(i,vind,jind,bP,betaP,xarr);
+    }
+
+    int getFactorValuesF(int i,const int*& vind,const int*& jind,
+			 const float*& xarr) const {
+      const float* bP,*betaP;
+
+      return epRepr->accessCol(i,vind,jind,bP,betaP,xarr);
+    }
+
+    void recomputeExtra(int i) {
+      int p,j;
+      double bval,beta,pi;
+
+      for (p=epRepr->firstColExt(i); p>=0; p=epRepr->nextColExt(p)) {
+	j=epRepr->colExtEntry(p,bval,beta,pi);
+	insertValue(i,j,pi);
+      }
+    }
+
+    bool isIndex64() const {
+      return epRepr->isIndex64();
+    }
+
+    bool isSingle() const {
+      return epRepr->isSingle();
+    }
+
+    /**
+     * Recomputes all top-K lists (as 'recompute') and the Gaussian
+     * marginals (as 'FactorizedEPRepresentation::compMarginals') in a
+     * single pass over the columns of B. Columns are distributed over
+     * 'numThr' threads. Results do not depend on 'numThr'.
+     * NOTE: Writes the top-K lists of this class, even if 'recompute' is
+     * overwritten by a subclass.
+     *
+     * @param margBeta Marginal pars. beta ret. here
+     * @param margPi   Marginal pars. pi ret. here
+     * @param numThr   Number of threads. Def.: 1
+     */
+    void recomputeMarginals(double* margBeta,double* margPi,int numThr=1) {
+      if (isIndex64())
+	recomputeMarginalsT<int64_t,double>(margBeta,margPi,numThr);
+      else if (isSingle())
+	recomputeMarginalsT<int,float>(margBeta,margPi,numThr);
+      else
+	recomputeMarginalsT<int,double>(margBeta,margPi,numThr);
+    }
+
+  protected:
+    // Internal methods
+
+    template<class I,class V> void recomputeMarginalsT(double* margBeta,
+						       double* margPi,
+						       int numThr);
   };
+
+  // Inline methods
+
+  /*
+   * Summation order for the marginals is the same as in
+   * 'FactorizedEPRepresentation::compMarginal', and the top-K entries are
+   * inserted in the same order as by 'recompute'.
+   * Exceptions must not leave the parallel region. The first one is
+   * stored and rethrown afterwards.
+   */
+  template<class I,class V> inline void
+  FactEPMaximumPiValues::recomputeMarginalsT(double* margBeta,double* margPi,
+					     int numThr)
+  {
+    int i,n=numVariables();
+    bool isError=false;
+    StandardException firstEx;
+
+    if (margBeta==0 || margPi==0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,64) num_threads(std::max(numThr,1)) if(numThr>1)
+#endif
+    for (i=0; i<n; i++) {
+      int k,p,j,viSz;
+      double mBeta,mPi,pi,beta,bval;
+      const I* viInd,*jiInd;
+      const V* bP,*betaP,*piP;
+
+      viSz=epRepr->accessCol(i,viInd,jiInd,bP,betaP,piP);
+      numValid[i]=0;
+      for (k=0,mBeta=mPi=0.0; k<viSz; k++) {
+	pi=piP[jiInd[k]];
+	mPi+=pi; mBeta+=betaP[jiInd[k]];
+	insertValue(i,(int) viInd[k],pi);
+      }
+      for (p=epRepr->firstColExt(i); p>=0; p=epRepr->nextColExt(p)) {
+	j=epRepr->colExtEntry(p,bval,beta,pi);
+	mPi+=pi; mBeta+=beta;
+	insertValue(i,j,pi);
+      }
+      margBeta[i]=mBeta; margPi[i]=mPi;
+      if (numValid[i]==0) {
+#ifdef _OPENMP
+#pragma omp critical(factepmaxpi_except)
+#endif
+	{
+	  if (!isError) {
+	    firstEx=WrongStatusException(EXCEPT_MSG("Cannot have numValid[i]==0. Representation invalid now!"));
+	    isError=true;
+	  }
+	}
+      }
+    }
+    if (isError)
+      throw firstEx;
+  }
 //ENDNS
 
 #endif
@@ -0,0 +1,179 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactEPResidualQueue
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTEPRESIDUALQUEUE_H
+#define EPTOOLS_FACTEPRESIDUALQUEUE_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/main.h"
+
+//BEGINNS(eptools)
+  /**
+   * Indexed max-priority queue over potentials j=0,...,m-1, used for
+   * residual scheduling by 'FactorizedEPDriver::runSweeps'
+   * ('modeResidual'). The key of j is an estimate of the change an EP
+   * update on j would cause (its residual).
+   * <p>
+   * Potentials are inserted by 'insert', afterwards their keys can be
+   * changed by 'setKey' (any direction) and 'raiseKey' (to the maximum of
+   * old and new key), both O(log m). 'top' is the potential with the
+   * largest key, O(1). Potentials are never removed: a potential which
+   * has been updated gets its new key by 'setKey'.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class FactEPResidualQueue
+  {
+  protected:
+    // Members
+
+    int numHeap;              // Number of potentials in queue
+    ArrayHandle<int> heapInd; // Heap: Potentials
+    ArrayHandle<double> keys; // Keys (indexed by potential)
+    ArrayHandle<int> heapPos; // Position in 'heapInd', -1 if not in queue
+
+  public:
+    // Public methods
+
+    FactEPResidualQueue() : numHeap(0) {}
+
+    /**
+     * Empties the queue, which can hold potentials 0,...,'m'-1
+     * afterwards.
+     *
+     * @param m Number of potentials
+     */
+    void reset(int m) {
+      if (m<0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      if (heapPos.size()!=m) {
+	heapInd.changeRep(m); keys.changeRep(m); heapPos.changeRep(m);
+      }
+      std::fill(heapPos.p(),heapPos.p()+m,-1);
+      numHeap=0;
+    }
+
+    int size() const {
+      return numHeap;
+    }
+
+    bool contains(int j) const {
+      return (j>=0 && j<heapPos.size() && heapPos[j]>=0);
+    }
+
+    /**
+     * @return Potential with largest key. Queue must not be empty
+     */
+    int top() const {
+      if (numHeap==0)
+	throw WrongStatusException(EXCEPT_MSG("Queue is empty"));
+      return heapInd[0];
+    }
+
+    /**
+     * @return Largest key, -1 if queue is empty
+     */
+    double topKey() const {
+      return (numHeap>0)?keys[heapInd[0]]:-1.0;
+    }
+
+    double getKey(int j) const {
+      if (!contains(j))
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      return keys[j];
+    }
+
+    /**
+     * Inserts potential j with key 'val'. j must not be in the queue.
+     *
+     * @param j   Potential index
+     * @param val Key
+     */
+    void insert(int j,double val) {
+      if (j<0 || j>=heapPos.size() || heapPos[j]>=0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      keys[j]=val; heapInd[numHeap]=j; heapPos[j]=numHeap;
+      siftUp(numHeap++);
+    }
+
+    /**
+     * Sets key of j (in queue) to 'val'.
+     *
+     * @param j   Potential index
+     * @param val New key
+     */
+    void setKey(int j,double val) {
+      if (!contains(j))
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      if (val>keys[j]) {
+	keys[j]=val; siftUp(heapPos[j]);
+      } else {
+	keys[j]=val; siftDown(heapPos[j]);
+      }
+    }
+
+    /**
+     * Sets key of j to the maximum of its key and 'val'. Nothing is done
+     * if j is not in the queue.
+     *
+     * @param j   Potential index
+     * @param val Key
+     */
+    void raiseKey(int j,double val) {
+      int h;
+
+      if (j>=0 && j<heapPos.size() && (h=heapPos[j])>=0 && val>keys[j]) {
+	keys[j]=val; siftUp(h);
+      }
+    }
+
+  protected:
+    // Internal methods
+
+    void siftUp(int h);
+
+    void siftDown(int h);
+  };
+
+  // Inline methods
+
+  inline void FactEPResidualQueue::siftUp(int h)
+  {
+    int par,j=heapInd[h];
+    double val=keys[j];
+    int* hiP=heapInd.p(),*hpP=heapPos.p();
+    const double* kP=keys.p();
+
+    for (; h>0 && kP[hiP[par=(h-1)>>1]]<val; h=par) {
+      hiP[h]=hiP[par]; hpP[hiP[h]]=h;
+    }
+    hiP[h]=j; hpP[j]=h;
+  }
+
+  inline void FactEPResidualQueue::siftDown(int h)
+  {
+    int c,j=heapInd[h];
+    double val=keys[j];
+    int* hiP=heapInd.p(),*hpP=heapPos.p();
+    const double* kP=keys.p();
+
+    while ((c=2*h+1)<numHeap) {
+      if (c+1<numHeap && kP[hiP[c+1]]>kP[hiP[c]]) c++;
+      if (kP[hiP[c]]<=val) break;
+      hiP[h]=hiP[c]; hpP[hiP[h]]=h;
+      h=c;
+    }
+    hiP[h]=j; hpP[j]=h;
+  }
+//ENDNS
+
+#endif
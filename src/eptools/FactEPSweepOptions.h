@@ -0,0 +1,87 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactEPSweepOptions
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTEPSWEEPOPTIONS_H
+#define EPTOOLS_FACTEPSWEEPOPTIONS_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/default.h"
+#include "lhotse/ArrayHandle.h"
+
+//BEGINNS(eptools)
+  /**
+   * Schedule options for 'FactorizedEPDriver::runSweeps':
+   * - mode:      Update mode for each sweep, see
+   *              'FactorizedEPDriver::modeXXX'. Def.: 'modeSequential'
+   * - doRefresh: Recompute marginals from EP parameters after each sweep.
+   *              Def.: true
+   * - doPermute: Random ordering of updates in each sweep. Otherwise,
+   *              the ordering is by potential index. Def.: true
+   * - seed:      Seed for random orderings ('XorShiftRandom')
+   * - potIds,    Potential type IDs of blocks, and block sizes (same as
+   *   numPot:    PM_POTIDS, PM_NUMPOT, see 'PotManagerFactory'). Only
+   *              required if 'skipIds' or 'firstIds' are given
+   * - skipIds:   Potentials of these types are not updated (for example,
+   *              Gaussian potentials). Optional
+   * - firstIds:  If given, the first sweep updates on potentials of these
+   *              types only (among those not excluded by 'skipIds').
+   *              Optional
+   * - packLayout: Switch 'FactorizedEPRepresentation' to packed layout
+   *              during the sweeps (see 'packLayout' there). Def.: false
+   * - dirtyRefresh: If 'doRefresh', only marginals of variables touched
+   *              by the sweep are recomputed (see
+   *              'FactorizedEPDriver::refreshMarginals'). Def.: false
+   * - driftTol:  Drift tolerance for 'dirtyRefresh'. Def.: 1e-6
+   * - maxFanout: 'modeResidual': Variables with more potentials than this
+   *              do not pass on priorities (see
+   *              'FactorizedEPRepresentation::markPotentials'). 0: No
+   *              limit. Def.: 0
+   * - freezeSweeps: Active-set freezing: A potential whose 'delta' is
+   *              below 'freezeEps' for this many consecutive sweeps is
+   *              frozen (not updated on), until the marginals of its
+   *              variables change by more than 'reactTol' (see
+   *              'FactorizedEPDriver::runSweeps'). 0: No freezing.
+   *              Def.: 0
+   * - freezeEps: S.a. 0: Use 'deltaEps'. Def.: 0
+   * - reactTol:  S.a. 0: Use 'freezeEps'. Def.: 0
+   * - warmStart: Switch on warm start state for local EP updates (see
+   *              'FactorizedEPDriver::setWarmStart'). It stays on after
+   *              the sweeps. Def.: false
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class FactEPSweepOptions
+  {
+  public:
+    // Members
+
+    int mode;
+    bool doRefresh,doPermute,packLayout,dirtyRefresh;
+    double driftTol;
+    int maxFanout;
+    int freezeSweeps;
+    double freezeEps,reactTol;
+    bool warmStart;
+    uint seed;
+    ArrayHandle<int> potIds,numPot;
+    ArrayHandle<int> skipIds,firstIds;
+
+    // Public methods
+
+    FactEPSweepOptions() : mode(0),doRefresh(true),doPermute(true),
+      packLayout(false),dirtyRefresh(false),driftTol(1e-6),
+      maxFanout(0),freezeSweeps(0),freezeEps(0.0),reactTol(0.0),
+      warmStart(false),seed(0) {}
+  };
+//ENDNS
+
+#endif
@@ -0,0 +1,79 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactEPSweepStats
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTEPSWEEPSTATS_H
+#define EPTOOLS_FACTEPSWEEPSTATS_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/default.h"
+#include "lhotse/ArrayHandle.h"
+
+//BEGINNS(eptools)
+  /**
+   * Statistics returned by 'FactorizedEPDriver::runSweeps', for each sweep
+   * done:
+   * - delta:     Convergence statistic: maximum of 'delta' (see
+   *              'FactorizedEPDriver::sequentialUpdate') over all updates
+   * - numSkip:   Histogram of return status over all updates ('numStatus'
+   *              entries per sweep, see 'FactorizedEPDriver::updXXX').
+   *              Entry 0 counts successful updates
+   * - numSelDamp: Number of successful updates which were selectively
+   *              damped (effective damping factor larger than 'dampFact').
+   *              0 if selective damping is not active
+   * - numRefresh: Number of variables whose marginals were recomputed
+   *              after the sweep (n for a full refresh, 0 if none)
+   * - numFrozen: Number of potentials not updated on in the sweep, since
+   *              they are frozen (see 'FactEPSweepOptions::freezeSweeps').
+   *              Not counted in 'numSkip'
+   * 'numIt' is the number of sweeps done, 'converged' is true iff the
+   * last sweep has 'delta' below the threshold.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class FactEPSweepStats
+  {
+  public:
+    // Constants
+
+    static const int numStatus=6;
+
+    // Members
+
+    int numIt;
+    bool converged;
+    ArrayHandle<double> delta;
+    ArrayHandle<int> numSkip;
+    ArrayHandle<int> numSelDamp;
+    ArrayHandle<int> numRefresh;
+    ArrayHandle<int> numFrozen;
+
+    // Public methods
+
+    FactEPSweepStats() : numIt(0),converged(false) {}
+
+    /**
+     * Resets statistics and allocates space for up to 'maxIt' sweeps.
+     *
+     * @param maxIt Maximum number of sweeps
+     */
+    void reset(int maxIt) {
+      numIt=0; converged=false;
+      if (delta.size()<maxIt) {
+	delta.changeRep(maxIt); numSkip.changeRep(maxIt*numStatus);
+	numSelDamp.changeRep(maxIt); numRefresh.changeRep(maxIt);
+	numFrozen.changeRep(maxIt);
+      }
+    }
+  };
+//ENDNS
+
+#endif
@@ -7,6 +7,11 @@
  * ------------------------------------------------------------------- */
 
 #include "src/eptools/FactorizedEPDriver.h"
+#include "src/eptools/potentials/ContainerPotManager.h"
+#include "src/eptools/XorShiftRandom.h"
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 //BEGINNS(eptools)
   const int FactorizedEPDriver::updSuccess;
@@ -14,4 +19,754 @@
   const int FactorizedEPDriver::updNumericalError;
   const int FactorizedEPDriver::updMarginalsInvalid;
   const int FactorizedEPDriver::updCavCondSkipped;
+  const int FactorizedEPDriver::updRetired;
+  const int FactorizedEPDriver::modeSequential;
+  const int FactorizedEPDriver::modeColored;
+  const int FactorizedEPDriver::modeParallel;
+  const int FactorizedEPDriver::modeAsync;
+  const int FactorizedEPDriver::modeResidual;
+  const int FactorizedEPDriver::margOverwrite;
+  const int FactorizedEPDriver::margAtomicAdd;
+  const int FactorizedEPDriver::margKeep;
+  const int FactEPSweepStats::numStatus;
+
+  void FactorizedEPDriver::setThreadPotentials(const ArrayHandle<Handle<PotentialManager> >& parr)
+  {
+    int i,j,num=parr.size();
+
+    for (i=0; i<num; i++) {
+      if (parr[i]==0 || parr[i]->size()!=epPots->size())
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      // Object shared between threads: Must support all of them
+      for (j=0; j<i; j++)
+	if (parr[j].p()==parr[i].p() && parr[i]->numThreads()<num)
+	  throw InvalidParameterException(EXCEPT_MSG("Potential manager shared by threads, but does not support that many"));
+    }
+    thrPots.copy(parr);
+    thrBuffVec.changeRep(std::max(num,1));
+  }
+
+  void FactorizedEPDriver::setWarmStart(bool on)
+  {
+    if (!on)
+      warmSt.changeRep(0);
+    else if (warmSt.size()==0) {
+      warmSt.changeRep(EPScalarPotential::maxWarmState*numPotentials());
+      std::fill(warmSt.p(),warmSt.p()+warmSt.size(),0.0);
+    }
+  }
+
+  /*
+   * One parallel region for the whole sweep. The worksharing loop over a
+   * batch ends with an implicit barrier, so batches are done one after
+   * the other.
+   * Exceptions must not leave the parallel region. The first one is
+   * stored and rethrown afterwards.
+   */
+  int FactorizedEPDriver::coloredSweep(const int* updInd,int nupd,
+				       int* schedInd,double dampFact,
+				       int* rstat,double* delta,
+				       double* effDamp)
+  {
+    int numB,numThr=std::max(thrPots.size(),1);
+    bool isError=false;
+    StandardException firstEx;
+
+    if (dampFact<0.0 || dampFact>=1.0 || nupd<=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (batchOff.size()<nupd+1)
+      batchOff.changeRep(nupd+1);
+    if (thrBuffVec.size()<numThr)
+      thrBuffVec.changeRep(numThr);
+    numB=epRepr->colorSchedule(updInd,nupd,schedInd,batchOff.p());
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThr)
+#endif
+    {
+      int b,p,t=0,irstat;
+#ifdef _OPENMP
+      t=omp_get_thread_num();
+#endif
+      const PotentialManager& pman=(thrPots.size()>0)?(*thrPots[t]):
+	(*epPots);
+      ArrayHandle<double>& buff=thrBuffVec[t];
+      const int* bOffP=batchOff.p();
+      for (b=0; b<numB; b++) {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+	for (p=bOffP[b]; p<bOffP[b+1]; p++) {
+	  try {
+	    irstat=updateInternal(schedInd[p],dampFact,
+				  (delta!=0)?(delta+p):0,
+				  (effDamp!=0)?(effDamp+p):0,pman,buff);
+	  } catch (StandardException ex) {
+#ifdef _OPENMP
+#pragma omp critical(factepdriver_except)
+#endif
+	    {
+	      if (!isError) {
+		firstEx=ex; isError=true;
+	      }
+	    }
+	    irstat=updNumericalError;
+	  }
+	  if (rstat!=0) rstat[p]=irstat;
+	  if (irstat!=updSuccess) {
+	    if (delta!=0) delta[p]=0.0;
+	    if (effDamp!=0) effDamp[p]=1.0;
+	  }
+	}
+      }
+    }
+    if (isError)
+      throw firstEx;
+
+    return numB;
+  }
+
+  /*
+   * Same structure as 'coloredSweep', but without batches and with
+   * atomic updates of marginals.
+   */
+  void FactorizedEPDriver::asyncSweep(const int* updInd,int nupd,
+				      double dampFact,int* rstat,
+				      double* delta)
+  {
+    int p,numThr=std::max(thrPots.size(),1);
+    bool isError=false;
+    StandardException firstEx;
+
+    if (dampFact<0.0 || dampFact>=1.0 || nupd<=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (!(epMaxPi==0) || !(epMaxA==0) || !(epMaxC==0))
+      throw WrongStatusException(EXCEPT_MSG("Selective damping not supported"));
+    // Entries of 'updInd' must be distinct
+    ArrayHandle<int> isUsed(numPotentials());
+    std::fill(isUsed.p(),isUsed.p()+numPotentials(),0);
+    for (p=0; p<nupd; p++) {
+      if (isUsed[updInd[p]]!=0)
+	throw InvalidParameterException(EXCEPT_MSG("updInd: Entries must be distinct"));
+      isUsed[updInd[p]]=1;
+    }
+    if (thrBuffVec.size()<numThr)
+      thrBuffVec.changeRep(numThr);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThr)
+#endif
+    {
+      int q,t=0,irstat;
+#ifdef _OPENMP
+      t=omp_get_thread_num();
+#endif
+      const PotentialManager& pman=(thrPots.size()>0)?(*thrPots[t]):
+	(*epPots);
+      ArrayHandle<double>& buff=thrBuffVec[t];
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+      for (q=0; q<nupd; q++) {
+	try {
+	  irstat=updateInternal(updInd[q],dampFact,(delta!=0)?(delta+q):0,0,
+				pman,buff,margAtomicAdd);
+	} catch (StandardException ex) {
+#ifdef _OPENMP
+#pragma omp critical(factepdriver_except)
+#endif
+	  {
+	    if (!isError) {
+	      firstEx=ex; isError=true;
+	    }
+	  }
+	  irstat=updNumericalError;
+	}
+	if (rstat!=0) rstat[q]=irstat;
+	if (irstat!=updSuccess && delta!=0) delta[q]=0.0;
+      }
+    }
+    // Remove drift in marginals (also if an exception occurred)
+    epRepr->compMarginals(margBeta.p(),margPi.p(),false,numThr);
+    if (epRepr->numPrecVariables()>0)
+      epRepr->compTauMarginals(margA.p(),margC.p(),false,numThr);
+    if (isError)
+      throw firstEx;
+  }
+
+  /*
+   * One parallel region for all phases. Worksharing loops end with an
+   * implicit barrier. With selective damping, the second phase is done by
+   * one thread, in the ordering of 'updInd'.
+   * For each update, 'parBuff' contains 'aux' (size 8), followed by
+   * 'buff' (size 4*|V_j|), see 'compUpdate'. The status is kept in
+   * 'parOff' (after the offsets).
+   */
+  void FactorizedEPDriver::parallelSweep(const int* updInd,int nupd,
+					 double dampFact,int* rstat,
+					 double* delta,double* effDamp)
+  {
+    int p,numN=numVariables();
+    bool isError=false,selDamp;
+    StandardException firstEx;
+    int* statP;
+
+    if (dampFact<0.0 || dampFact>=1.0 || nupd<=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    selDamp=(!(epMaxPi==0) || !(epMaxA==0) || !(epMaxC==0));
+    // Entries of 'updInd' must be distinct. Offsets into 'parBuff'
+    if (parOff.size()<2*nupd+1)
+      parOff.changeRep(2*nupd+1);
+    ArrayHandle<int> isUsed(numPotentials());
+    std::fill(isUsed.p(),isUsed.p()+numPotentials(),0);
+    parOff[0]=0;
+    for (p=0; p<nupd; p++) {
+      if (isUsed[updInd[p]]!=0)
+	throw InvalidParameterException(EXCEPT_MSG("updInd: Entries must be distinct"));
+      isUsed[updInd[p]]=1;
+      parOff[p+1]=parOff[p]+8+4*epRepr->rowSize(updInd[p]);
+    }
+    statP=parOff.p()+(nupd+1);
+    if (parBuff.size()<parOff[nupd])
+      parBuff.changeRep(parOff[nupd]);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(std::max(thrPots.size(),1))
+#endif
+    {
+      int q,i,t=0;
+      double mBeta,mPi;
+      double* auxP;
+#ifdef _OPENMP
+      t=omp_get_thread_num();
+#endif
+      const PotentialManager& pman=(thrPots.size()>0)?(*thrPots[t]):
+	(*epPots);
+      // Cavity marginals and local EP updates
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+      for (q=0; q<nupd; q++) {
+	auxP=parBuff.p()+parOff[q];
+	try {
+	  statP[q]=compUpdate(updInd[q],pman,auxP+8,auxP);
+	} catch (StandardException ex) {
+#ifdef _OPENMP
+#pragma omp critical(factepdriver_except)
+#endif
+	  {
+	    if (!isError) {
+	      firstEx=ex; isError=true;
+	    }
+	  }
+	  statP[q]=updNumericalError;
+	}
+      }
+      // Write back new EP parameters
+      if (!selDamp) {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+	for (q=0; q<nupd; q++) {
+	  if (statP[q]==updSuccess) {
+	    auxP=parBuff.p()+parOff[q];
+	    try {
+	      statP[q]=applyUpdate(updInd[q],dampFact,
+				   (delta!=0)?(delta+q):0,
+				   (effDamp!=0)?(effDamp+q):0,auxP+8,auxP,
+				   margKeep);
+	    } catch (StandardException ex) {
+#ifdef _OPENMP
+#pragma omp critical(factepdriver_except)
+#endif
+	      {
+		if (!isError) {
+		  firstEx=ex; isError=true;
+		}
+	      }
+	      statP[q]=updNumericalError;
+	    }
+	  }
+	}
+      } else {
+#ifdef _OPENMP
+#pragma omp single
+#endif
+	{
+	  for (q=0; q<nupd; q++)
+	    if (statP[q]==updSuccess) {
+	      auxP=parBuff.p()+parOff[q];
+	      try {
+		statP[q]=applyUpdate(updInd[q],dampFact,
+				     (delta!=0)?(delta+q):0,
+				     (effDamp!=0)?(effDamp+q):0,auxP+8,auxP,
+				     margAtomicAdd);
+	      } catch (StandardException ex) {
+		if (!isError) {
+		  firstEx=ex; isError=true;
+		}
+		statP[q]=updNumericalError;
+	      }
+	    }
+	}
+      }
+      // Recompute marginals (also if an exception occurred)
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (i=0; i<numN; i++) {
+	epRepr->compMarginal(i,mBeta,mPi);
+	margPi[i]=mPi; margBeta[i]=mBeta;
+      }
+    }
+    if (epRepr->numPrecVariables()>0)
+      epRepr->compTauMarginals(margA.p(),margC.p());
+    for (p=0; p<nupd; p++) {
+      if (rstat!=0) rstat[p]=statP[p];
+      if (statP[p]!=updSuccess) {
+	if (delta!=0) delta[p]=0.0;
+	if (effDamp!=0) effDamp[p]=1.0;
+      }
+    }
+    if (isError)
+      throw firstEx;
+  }
+
+  /*
+   * Thread managers equal to 'epPots' (or to each other) remain shared
+   * after appending.
+   */
+  int FactorizedEPDriver::appendPotentials(const Handle<PotentialManager>& ppots,
+					   int num,const int* prowOff,
+					   const int* pind,const double* pbvals,
+					   const double* pbeta,const double* ppi)
+  {
+    int t,s,k,j0,numThr=thrPots.size();
+
+    if (ppots==0 || ppots->size()!=num || num<=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (ppots->numArgumentGroup(EPScalarPotential::atypeUnivariate)!=num)
+      throw InvalidParameterException(EXCEPT_MSG("Potentials must be in group 'atypeUnivariate'"));
+    if (numThr>1 && ppots->numThreads()<numThr)
+      throw InvalidParameterException(EXCEPT_MSG("Potential manager shared by threads, but does not support that many"));
+    j0=epRepr->appendPotentials(num,prowOff,pind,pbvals);
+    ArrayHandle<const PotentialManager*> orig(std::max(numThr,1));
+    const PotentialManager* origPots=epPots.p();
+    for (t=0; t<numThr; t++)
+      orig[t]=thrPots[t].p();
+    appendPotManager(epPots,ppots);
+    for (t=0; t<numThr; t++) {
+      for (s=0; s<t && orig[s]!=orig[t]; s++);
+      if (s<t)
+	thrPots[t]=thrPots[s];
+      else if (orig[t]==origPots)
+	thrPots[t]=epPots;
+      else
+	appendPotManager(thrPots[t],ppots);
+    }
+    // Warm start states for new potentials
+    if (warmSt.size()>0) {
+      ArrayHandle<double> temp(EPScalarPotential::maxWarmState*(j0+num));
+      std::copy(warmSt.p(),warmSt.p()+warmSt.size(),temp.p());
+      std::fill(temp.p()+warmSt.size(),temp.p()+temp.size(),0.0);
+      warmSt=temp;
+    }
+    // Initial messages
+    if (pbeta!=0 || ppi!=0 || !(epMaxPi==0))
+      for (k=0; k<num; k++)
+	addMessages<FactEPFlatRow>(j0+k,(pbeta!=0)?(pbeta+prowOff[k]):0,
+				   (ppi!=0)?(ppi+prowOff[k]):0);
+
+    return j0;
+  }
+
+  void FactorizedEPDriver::appendPotManager(Handle<PotentialManager>& pman,
+					    const Handle<PotentialManager>& ppots)
+  {
+    ContainerPotManager* cpm=DYNCAST(ContainerPotManager,pman.p());
+
+    if (cpm!=0)
+      cpm->appendChild(ppots);
+    else {
+      ArrayHandle<Handle<PotentialManager> > parr(2);
+      parr[0]=pman; parr[1]=ppots;
+      pman.changeRep(new ContainerPotManager(parr));
+    }
+  }
+
+  void FactorizedEPDriver::retirePotentials(const int* ind,int num)
+  {
+    int p,j;
+
+    if (ind==0 || num<=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (epRepr->numPrecVariables()>0)
+      throw WrongStatusException(EXCEPT_MSG("Bivariate precision potentials"));
+    for (p=0; p<num; p++) {
+      j=ind[p];
+      if (j<0 || j>=numPotentials())
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      if (epRepr->isPacked())
+	retirePotential<FactEPPackedRow>(j);
+      else if (epRepr->isIndex64())
+	retirePotential<FactEPFlatRow64>(j);
+      else if (epRepr->isSingle())
+	retirePotential<FactEPFlatRowF>(j);
+      else
+	retirePotential<FactEPFlatRow>(j);
+    }
+  }
+
+  /*
+   * Variables to be recomputed are collected in 'refList' (marks in
+   * 'refMark', which are all zero between calls).
+   */
+  int FactorizedEPDriver::refreshMarginals(const int* ind,int num,
+					   const int* rstat,double driftTol)
+  {
+    int p,numList=0,numN=numVariables(),numThr=std::max(thrPots.size(),1);
+    double maxDrift=0.0;
+
+    if (num<0 || (num>0 && ind==0) || driftTol<0.0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (refMark.size()!=numN) {
+      refMark.changeRep(numN); refList.changeRep(numN);
+      std::fill(refMark.p(),refMark.p()+numN,(char) 0);
+    }
+    for (p=0; p<num; p++)
+      if (rstat==0 || rstat[p]==updSuccess)
+	epRepr->markVariables(ind+p,1,refMark.p(),refList.p(),numList);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,64) num_threads(numThr) reduction(max:maxDrift) if(numThr>1)
+#endif
+    for (p=0; p<numList; p++) {
+      int i=refList[p];
+      double drift;
+      if (epRepr->isIndex64())
+	drift=refreshVariableT<int64_t,double>(i);
+      else if (epRepr->isSingle())
+	drift=refreshVariableT<int,float>(i);
+      else
+	drift=refreshVariableT<int,double>(i);
+      maxDrift=std::max(maxDrift,drift);
+      refMark[i]=0;
+    }
+    if (epRepr->numPrecVariables()>0)
+      epRepr->compTauMarginals(margA.p(),margC.p(),false,numThr);
+    if (maxDrift>driftTol) {
+      // Incremental marginals out of sync: Full refresh
+      epRepr->compMarginals(margBeta.p(),margPi.p(),false,numThr);
+      return numN;
+    }
+
+    return numList;
+  }
+
+  int FactorizedEPDriver::residualSave(int j)
+  {
+    int p,i,vjSz=0;
+    double* oldP=resOld.p();
+
+    epRepr->markVariables(&j,1,resVMark.p(),resVList.p(),vjSz);
+    for (p=0; p<vjSz; p++) {
+      resVMark[i=resVList[p]]=0;
+      oldP[2*p]=margBeta[i]; oldP[2*p+1]=margPi[i];
+    }
+
+    return vjSz;
+  }
+
+#define MAXRELDIFF(a,b) (fabs((a)-(b))/std::max(fabs(a),std::max(fabs(b),1e-8)))
+
+  /*
+   * Changes of x_i are relative changes of mean and stddev., computed
+   * from the marginals before ('resOld') and after the update. The key
+   * of j itself is not raised, since its cavity has not changed.
+   */
+  void FactorizedEPDriver::residualRaise(int j,int vjSz,double delta,
+					 double deltaEps,int maxFanout)
+  {
+    int p,q,i,k,numList;
+    double chg,pi,oldPi;
+    const double* oldP=resOld.p();
+
+    resQueue.setKey(j,delta);
+    for (p=0; p<vjSz; p++) {
+      i=resVList[p]; pi=margPi[i]; oldPi=oldP[2*p+1];
+      chg=std::max(MAXRELDIFF(margBeta[i]/pi,oldP[2*p]/oldPi),
+		   MAXRELDIFF(1.0/sqrt(pi),1.0/sqrt(oldPi)));
+      if (chg>=deltaEps) {
+	numList=0;
+	epRepr->markPotentials(&i,1,maxFanout,resMark.p(),resList.p(),
+			       numList);
+	for (q=0; q<numList; q++) {
+	  if ((k=resList[q])!=j) resQueue.raiseKey(k,chg);
+	  resMark[k]=0;
+	}
+      }
+    }
+    if (epRepr->numPrecVariables()>0 && delta>=deltaEps &&
+	j>=numPotentials()-epRepr->numBVPrecPotentials()) {
+      double* aP,*cP;
+      const double* caP,*ccP;
+      const int* jInd;
+      int startPos=numPotentials()-epRepr->numBVPrecPotentials();
+      k=epRepr->accessTauRow(j,aP,cP);
+      numList=epRepr->accessTauCol(k,jInd,caP,ccP);
+      for (q=0; q<numList; q++)
+	if ((k=startPos+jInd[q])!=j) resQueue.raiseKey(k,delta);
+    }
+  }
+
+  /*
+   * Reference marginals 'frzRef' are stored as (beta_i, pi_i), as in
+   * 'resOld'.
+   */
+  int FactorizedEPDriver::freezeSweep(const int* ind,int num,
+				      const int* rstat,const double* delta,
+				      int freezeK,double frzEps,
+				      double reactTol)
+  {
+    int p,q,i,j,numV=0,numList=0,numReact=0;
+    int startPrec=numPotentials()-epRepr->numBVPrecPotentials();
+    double chg,pi,refPi;
+    double* refP=frzRef.p();
+
+    for (p=0; p<num; p++) {
+      j=ind[p];
+      if (rstat[p]==updSuccess) {
+	if (delta[p]<frzEps && j<startPrec)
+	  frzCount[j]++;
+	else
+	  frzCount[j]=0;
+	epRepr->markVariables(&j,1,frzVMark.p(),frzVList.p(),numV);
+      } else
+	frzCount[j]=0;
+    }
+    for (p=0; p<numV; p++) {
+      i=frzVList[p]; frzVMark[i]=0;
+      pi=margPi[i]; refPi=refP[2*i+1];
+      chg=std::max(MAXRELDIFF(margBeta[i]/pi,refP[2*i]/refPi),
+		   MAXRELDIFF(1.0/sqrt(pi),1.0/sqrt(refPi)));
+      if (chg>reactTol) {
+	epRepr->markPotentials(&i,1,0,frzMark.p(),frzList.p(),numList);
+	refP[2*i]=margBeta[i]; refP[2*i+1]=pi;
+      }
+    }
+    for (q=0; q<numList; q++) {
+      j=frzList[q]; frzMark[j]=0;
+      if (frzCount[j]>=freezeK) {
+	frzCount[j]=0; numReact++;
+      }
+    }
+
+    return numReact;
+  }
+
+#undef MAXRELDIFF
+
+  /*
+   * Candidate potentials (not excluded by 'skipIds') are kept in
+   * 'swpInd[0:numAll]', those for the first sweep in
+   * 'swpInd[numM:(numM+numFirst)]'. Orderings are permuted in place, so
+   * the ordering of the previous sweep is the starting point of the next
+   * one.
+   * 'modeResidual': The potentials updated on are written to 'swpSched'
+   * (in the ordering of 'rstatP', 'deltaP').
+   * Freezing: Before each sweep, potentials not frozen are moved to the
+   * front of 'updP', and only these are updated on.
+   */
+  int FactorizedEPDriver::runSweeps(int maxIt,double deltaEps,
+				    double dampFact,
+				    const FactEPSweepOptions& opts,
+				    FactEPSweepStats& stats)
+  {
+    int b,k,j,p,numAll,numFirst,nupd,irstat,vjSz=0,numM=numPotentials();
+    int freezeK=opts.freezeSweeps;
+    int numSkipIds=opts.skipIds.size(),numFirstIds=opts.firstIds.size();
+    bool selDamp,isSkip,isFirst,doPack,isResid;
+    double maxDelta,frzEps=0.0,reactTol=0.0;
+    int* updP,*rstatP,*histP;
+    double* deltaP,*dampP;
+    XorShiftRandom rng(opts.seed);
+
+    if (maxIt<1 || deltaEps<=0.0 || dampFact<0.0 || dampFact>=1.0 ||
+	opts.mode<modeSequential || opts.mode>modeResidual ||
+	opts.maxFanout<0 || freezeK<0 || opts.freezeEps<0.0 ||
+	opts.reactTol<0.0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (freezeK>0 && opts.mode==modeResidual)
+      throw InvalidParameterException(EXCEPT_MSG("Freezing not supported for modeResidual"));
+    selDamp=(!(epMaxPi==0) || !(epMaxA==0) || !(epMaxC==0));
+    if (swpInd.size()<2*numM) {
+      swpInd.changeRep(2*numM); swpSched.changeRep(numM);
+      swpRstat.changeRep(numM); swpDelta.changeRep(numM);
+      swpDamp.changeRep(numM);
+    }
+    // Filter potentials by type IDs
+    if (numSkipIds>0 || numFirstIds>0) {
+      if (opts.potIds.size()==0 || opts.numPot.size()!=opts.potIds.size())
+	throw InvalidParameterException(EXCEPT_MSG("potIds, numPot: Required for filtering"));
+      for (b=numAll=numFirst=j=0; b<opts.potIds.size(); b++) {
+	if (opts.numPot[b]<0 || j+opts.numPot[b]>numM)
+	  throw InvalidParameterException(EXCEPT_MSG("numPot: Wrong sizes"));
+	for (k=0,isSkip=false; k<numSkipIds && !isSkip; k++)
+	  isSkip=(opts.skipIds[k]==opts.potIds[b]);
+	for (k=0,isFirst=(numFirstIds==0); k<numFirstIds && !isFirst; k++)
+	  isFirst=(opts.firstIds[k]==opts.potIds[b]);
+	for (k=0; k<opts.numPot[b]; k++,j++)
+	  if (!isSkip && !epRepr->isRetired(j)) {
+	    swpInd[numAll++]=j;
+	    if (isFirst) swpInd[numM+(numFirst++)]=j;
+	  }
+      }
+      if (j!=numM)
+	throw InvalidParameterException(EXCEPT_MSG("numPot: Wrong sizes"));
+    } else {
+      for (j=numAll=0; j<numM; j++)
+	if (!epRepr->isRetired(j))
+	  swpInd[numAll++]=j;
+      numFirst=numAll;
+    }
+    if (numAll==0 || (numFirstIds>0 && numFirst==0))
+      throw InvalidParameterException(EXCEPT_MSG("No potentials to update on"));
+    if (opts.mode==modeResidual) {
+      int numN=numVariables();
+      resQueue.reset(numM);
+      for (p=0; p<numAll; p++)
+	resQueue.insert(swpInd[p],DBL_MAX);
+      if (resMark.size()!=numM) {
+	resMark.changeRep(numM); resList.changeRep(numM);
+	std::fill(resMark.p(),resMark.p()+numM,(char) 0);
+      }
+      if (resVMark.size()!=numN) {
+	resVMark.changeRep(numN); resVList.changeRep(numN);
+	resOld.changeRep(2*numN);
+	std::fill(resVMark.p(),resVMark.p()+numN,(char) 0);
+      }
+    }
+    if (freezeK>0) {
+      int i,numN=numVariables();
+      frzEps=(opts.freezeEps>0.0)?opts.freezeEps:deltaEps;
+      reactTol=(opts.reactTol>0.0)?opts.reactTol:frzEps;
+      if (frzCount.size()!=numM) {
+	frzCount.changeRep(numM); frzMark.changeRep(numM);
+	frzList.changeRep(numM);
+	std::fill(frzMark.p(),frzMark.p()+numM,(char) 0);
+      }
+      std::fill(frzCount.p(),frzCount.p()+numM,0);
+      if (frzVMark.size()!=numN) {
+	frzVMark.changeRep(numN); frzVList.changeRep(numN);
+	frzRef.changeRep(2*numN);
+	std::fill(frzVMark.p(),frzVMark.p()+numN,(char) 0);
+      }
+      for (i=0; i<numN; i++) {
+	frzRef[2*i]=margBeta[i]; frzRef[2*i+1]=margPi[i];
+      }
+    }
+    if (opts.warmStart)
+      setWarmStart(true);
+    // Sweeps
+    rstatP=swpRstat.p(); deltaP=swpDelta.p();
+    dampP=selDamp?swpDamp.p():0;
+    stats.reset(maxIt);
+    if ((doPack=(opts.packLayout && !epRepr->isPacked() &&
+		 !epRepr->isIndex64() && !epRepr->isSingle() &&
+		 epRepr->numAppended()==0)))
+      epRepr->packLayout();
+    try {
+      while (stats.numIt<maxIt) {
+	if (stats.numIt==0 && numFirstIds>0) {
+	  updP=swpInd.p()+numM; nupd=numFirst;
+	} else {
+	  updP=swpInd.p(); nupd=numAll;
+	}
+	stats.numFrozen[stats.numIt]=0;
+	if (freezeK>0) {
+	  for (p=k=0; p<nupd; p++)
+	    if (frzCount[updP[p]]<freezeK)
+	      std::swap(updP[k++],updP[p]);
+	  stats.numFrozen[stats.numIt]=nupd-k;
+	  nupd=k;
+	}
+	// Residual scheduling from the second sweep on
+	isResid=(opts.mode==modeResidual && stats.numIt>0);
+	if (opts.doPermute && !isResid)
+	  rng.shuffle(updP,nupd);
+	if (nupd==0)
+	  ; // All potentials frozen
+	else if (opts.mode==modeSequential || opts.mode==modeResidual) {
+	  for (p=0; p<nupd; p++) {
+	    if (isResid) {
+	      if (resQueue.topKey()<deltaEps) break;
+	      j=resQueue.top();
+	    } else
+	      j=updP[p];
+	    if (opts.mode==modeResidual)
+	      vjSz=residualSave(j);
+	    irstat=sequentialUpdate(j,dampFact,deltaP+p,
+				    (dampP!=0)?(dampP+p):0);
+	    rstatP[p]=irstat;
+	    if (irstat!=updSuccess) {
+	      deltaP[p]=0.0;
+	      if (dampP!=0) dampP[p]=1.0;
+	    }
+	    if (opts.mode==modeResidual) {
+	      swpSched[p]=j;
+	      residualRaise(j,vjSz,deltaP[p],deltaEps,opts.maxFanout);
+	    }
+	  }
+	  nupd=p;
+	} else if (opts.mode==modeColored)
+	  coloredSweep(updP,nupd,swpSched.p(),dampFact,rstatP,deltaP,dampP);
+	else if (opts.mode==modeParallel)
+	  parallelSweep(updP,nupd,dampFact,rstatP,deltaP,dampP);
+	else
+	  asyncSweep(updP,nupd,dampFact,rstatP,deltaP);
+	// Statistics
+	histP=stats.numSkip.p()+stats.numIt*FactEPSweepStats::numStatus;
+	std::fill(histP,histP+FactEPSweepStats::numStatus,0);
+	stats.numSelDamp[stats.numIt]=0;
+	for (p=0,maxDelta=0.0; p<nupd; p++) {
+	  maxDelta=std::max(maxDelta,deltaP[p]);
+	  histP[rstatP[p]]++;
+	  if (dampP!=0 && rstatP[p]==updSuccess && dampP[p]>dampFact)
+	    stats.numSelDamp[stats.numIt]++;
+	}
+	if (nupd==0 || (!opts.doRefresh && opts.mode!=modeParallel &&
+			opts.mode!=modeAsync))
+	  stats.numRefresh[stats.numIt]=0;
+	else if (opts.mode==modeParallel || opts.mode==modeAsync)
+	  stats.numRefresh[stats.numIt]=numVariables();
+	else if (opts.dirtyRefresh)
+	  // Scheduled ordering for 'modeColored', 'modeResidual' ('rstatP'
+	  // refers to it)
+	  stats.numRefresh[stats.numIt]=
+	    refreshMarginals((opts.mode==modeColored ||
+			      opts.mode==modeResidual)?swpSched.p():updP,nupd,
+			     rstatP,opts.driftTol);
+	else {
+	  int numThr=std::max(thrPots.size(),1);
+	  epRepr->compMarginals(margBeta.p(),margPi.p(),false,numThr);
+	  if (epRepr->numPrecVariables()>0)
+	    epRepr->compTauMarginals(margA.p(),margC.p(),false,numThr);
+	  stats.numRefresh[stats.numIt]=numVariables();
+	}
+	if (freezeK>0)
+	  freezeSweep((opts.mode==modeColored)?swpSched.p():updP,nupd,rstatP,
+		      deltaP,freezeK,frzEps,reactTol);
+	if (opts.mode==modeResidual)
+	  maxDelta=resQueue.topKey();
+	stats.delta[stats.numIt++]=maxDelta;
+	if (maxDelta<deltaEps) {
+	  stats.converged=true;
+	  break;
+	}
+      }
+    } catch (...) {
+      if (doPack) epRepr->unpackLayout();
+      throw;
+    }
+    if (doPack)
+      epRepr->unpackLayout();
+
+    return stats.numIt;
+  }
 //ENDNS
@@ -18,10 +18,112 @@
 #include "src/eptools/FactEPMaximumPiValues.h"
 #include "src/eptools/FactEPMaximumAValues.h"
 #include "src/eptools/FactEPMaximumCValues.h"
+#include "src/eptools/FactEPSweepOptions.h"
+#include "src/eptools/FactEPSweepStats.h"
+#include "src/eptools/FactEPResidualQueue.h"
 
 //BEGINNS(eptools)
 #define MAXRELDIFF(a,b) (fabs((a)-(b))/std::max(fabs(a),std::max(fabs(b),1e-8)))
 
+  /**
+   * Row views for 'FactorizedEPDriver::compUpdateT', 'applyUpdateT': Data
+   * for potential j, in the flat layout of 'FactorizedEPRepresentation'
+   * ('FactEPFlatRow', 'FactEPFlatRow64' for 64-bit index,
+   * 'FactEPFlatRowF' for single precision) or in the packed layout
+   * ('FactEPPackedRow'). 'j' is not range-checked.
+   * 'stored' maps a value to the one read back after storing it in the
+   * row.
+   */
+  template<class I,class V> class FactEPFlatRowT
+  {
+  protected:
+    const I* vjInd;
+    const V* bP;
+    V* betaP,*piP;
+
+  public:
+    int access(FactorizedEPRepresentation& repr,int j) {
+      int vjSz;
+
+      repr.accessRowFast(j,vjSz,vjInd,bP,betaP,piP);
+      return vjSz;
+    }
+
+    int ind(int ii) const { return (int) vjInd[ii]; }
+    double b(int ii) const { return bP[ii]; }
+    double pi(int ii) const { return piP[ii]; }
+    double beta(int ii) const { return betaP[ii]; }
+    void setPi(int ii,double val) { piP[ii]=(V) val; }
+    void setBeta(int ii,double val) { betaP[ii]=(V) val; }
+    static double stored(double val) { return (double) ((V) val); }
+  };
+
+  typedef FactEPFlatRowT<int,double> FactEPFlatRow;
+  typedef FactEPFlatRowT<int64_t,double> FactEPFlatRow64;
+  typedef FactEPFlatRowT<int,float> FactEPFlatRowF;
+
+  class FactEPPackedRow
+  {
+  protected:
+    FactEPPackedEntry* entP;
+    const int* mPos;     // Column-major mirror, written as well
+    double* mPiP,*mBetaP;
+
+  public:
+    int access(FactorizedEPRepresentation& repr,int j) {
+      int vjSz;
+
+      entP=repr.accessRowPacked(j,vjSz,mPos,mPiP,mBetaP);
+      return vjSz;
+    }
+
+    int ind(int ii) const { return entP[ii].ind; }
+    double b(int ii) const { return entP[ii].bval; }
+    double pi(int ii) const { return entP[ii].pi; }
+    double beta(int ii) const { return entP[ii].beta; }
+    void setPi(int ii,double val) { entP[ii].pi=mPiP[mPos[ii]]=val; }
+    void setBeta(int ii,double val) { entP[ii].beta=mBetaP[mPos[ii]]=val; }
+    static double stored(double val) { return val; }
+  };
+
+  /**
+   * Access policy for 'FactorizedEPDriver::compUpdateT', 'applyUpdateT':
+   * Virtual calls of 'EPScalarPotential::compMoments', range check on
+   * the potential index.
+   */
+  class FactEPGenericAccess
+  {
+  public:
+    typedef EPScalarPotential PotType;
+
+    static bool compMoments(const EPScalarPotential& pot,const double* inp,
+			    double* ret) {
+      return pot.compMoments(inp,ret);
+    }
+
+    static void checkRow(const FactorizedEPRepresentation& repr,int j) {
+      if (j<0 || j>=repr.numPotentials())
+	throw InvalidParameterException(EXCEPT_MSG(""));
+    }
+  };
+
+  /**
+   * Access policy for potentials of type 'P' (see
+   * 'FactorizedEPDriverSpec'): 'P::compMoments' is called non-virtually,
+   * so it can be inlined. 'j' is not range-checked.
+   */
+  template<class P> class FactEPSpecAccess
+  {
+  public:
+    typedef P PotType;
+
+    static bool compMoments(const P& pot,const double* inp,double* ret) {
+      return pot.P::compMoments(inp,ret);
+    }
+
+    static void checkRow(const FactorizedEPRepresentation& repr,int j) {}
+  };
+
   /**
    * Driver for expectation propagation with factorized backbone. Two
    * different cases are supported here (selected at construction):
@@ -61,6 +163,7 @@
    * - updMarginalsInvalid: Require pi_i >= eps/2 for all i in V_j, for the
    *   new marginals after the (damped) update.
    *   Also: a_k >= 0.5*'aMinThres', c_k >= 0.5*'cMinThres'.
+   * - updRetired: Potential j has been retired (see below)
    * <p>
    * Selective damping/skipping:
    * This is done iff the corresponding 'MaximumValuesService' objects are
@@ -76,6 +179,62 @@
    * is skipped.
    * Same for a's (c's) with 'aMinThres' ('cMinThres') respectively. We
    * use the smallest damping factor s.t. all constraints are fulfilled.
+   * <p>
+   * Parallel sweeps:
+   * EP updates on potentials which do not share variables can be done in
+   * parallel. 'coloredSweep' partitions a list of potentials into such
+   * batches and distributes the updates of a batch over several threads
+   * (OpenMP). Each thread needs its own potential manager, or a manager
+   * which supports several threads (see 'PotentialManager::numThreads'
+   * and 'setThreadPotentials').
+   * 'asyncSweep' runs updates in parallel without any coordination
+   * (Hogwild), marginals are updated atomically and recomputed at the end.
+   * 'parallelSweep' does parallel (synchronous) EP updates: all local
+   * updates are w.r.t. the same marginals, which are recomputed at the
+   * end.
+   * <p>
+   * Complete runs:
+   * 'runSweeps' runs sweeps over all potentials (random orderings, using
+   * one of the modes above), until convergence or a maximum number of
+   * sweeps is reached. Statistics are collected for each sweep.
+   * Marginals can be refreshed after each sweep, either all of them or
+   * only those touched by the sweep ('refreshMarginals').
+   * 'modeResidual' is residual scheduling: potentials are updated in
+   * the order of a priority queue keyed on their last 'delta'
+   * ('FactEPResidualQueue'), so that potentials which have converged are
+   * not updated on again until their cavities change. Active-set
+   * freezing ('FactEPSweepOptions::freezeSweeps') is simpler: potentials
+   * which have not changed for some sweeps are dropped from the sweeps,
+   * until the marginals of their variables move.
+   * <p>
+   * Incremental models:
+   * 'appendPotentials' adds potentials to a live model (see
+   * 'FactorizedEPRepresentation::appendPotentials'), 'retirePotentials'
+   * removes them. In both cases, the marginals are updated by the
+   * messages added or removed (and 'epMaxPi' by the pi_ji changed), so
+   * the current EP state is a warm start for further updates. The cost
+   * is proportional to the number of nonzeros added or removed. Retired
+   * potentials are skipped by all updates ('updRetired') and are not
+   * part of the sweeps of 'runSweeps'. Only for univariate potentials.
+   * <p>
+   * Warm start:
+   * If 'setWarmStart' is active, a state of size
+   * 'EPScalarPotential::maxWarmState' is kept for each potential j
+   * alongside its EP parameters, and passed to the potential object for
+   * local EP updates on j (see 'EPScalarPotential::setWarmState'). For
+   * potentials based on 'EPPotQuadLaplaceApprox', this is the last
+   * proximal map solution, so that the inner Newton solver is started
+   * close to the new solution.
+   * <p>
+   * Specialization:
+   * 'compUpdate', 'applyUpdate' are implemented by templates over an
+   * access policy ('FactEPGenericAccess') and a row view for the layout
+   * of 'epRepr' ('FactEPFlatRow', 'FactEPFlatRow64', 'FactEPFlatRowF',
+   * 'FactEPPackedRow', see 'FactorizedEPRepresentation::packLayout',
+   * 'isIndex64', 'isSingle').
+   * 'FactorizedEPDriverSpec'
+   * inlines the potential access for one potential type, see also
+   * 'FactEPDriverFactory'.
    *
    * @author  Matthias Seeger
    * @version %I% %G%
@@ -90,8 +249,23 @@
     static const int updNumericalError  =2;
     static const int updMarginalsInvalid=3;
     static const int updCavCondSkipped  =4;
+    static const int updRetired         =5;
+
+    // Update modes for 'runSweeps'
+
+    static const int modeSequential=0; // 'sequentialUpdate'
+    static const int modeColored   =1; // 'coloredSweep'
+    static const int modeParallel  =2; // 'parallelSweep'
+    static const int modeAsync     =3; // 'asyncSweep'
+    static const int modeResidual  =4; // Residual scheduling
 
   protected:
+    // Modes for 'applyUpdate'
+
+    static const int margOverwrite=0;
+    static const int margAtomicAdd=1;
+    static const int margKeep     =2;
+
     // Members
 
     Handle<PotentialManager> epPots;       // Potential manager
@@ -104,6 +278,24 @@
     Handle<FactEPMaximumAValues> epMaxA;
     Handle<FactEPMaximumCValues> epMaxC;
     ArrayHandle<double> buffVec;
+    ArrayHandle<Handle<PotentialManager> > thrPots; // 'coloredSweep'
+    ArrayHandle<ArrayHandle<double> > thrBuffVec;    // "
+    ArrayHandle<int> batchOff;                       // "
+    ArrayHandle<int> parOff;                         // 'parallelSweep'
+    ArrayHandle<double> parBuff;                     // "
+    ArrayHandle<int> swpInd,swpSched,swpRstat;       // 'runSweeps'
+    ArrayHandle<double> swpDelta,swpDamp;            // "
+    ArrayHandle<char> refMark;                       // 'refreshMarginals'
+    ArrayHandle<int> refList;                        // "
+    FactEPResidualQueue resQueue;                    // 'modeResidual'
+    ArrayHandle<char> resMark,resVMark;              // "
+    ArrayHandle<int> resList,resVList;               // "
+    ArrayHandle<double> resOld;                      // "
+    ArrayHandle<int> frzCount;                       // Freezing ('runSweeps')
+    ArrayHandle<char> frzMark,frzVMark;              // "
+    ArrayHandle<int> frzList,frzVList;               // "
+    ArrayHandle<double> frzRef;                      // "
+    ArrayHandle<double> warmSt;                      // 'setWarmStart'
 
   public:
     // Public methods
@@ -203,10 +395,22 @@
       return numK;
     }
 
+    /**
+     * @return Number of threads used by 'coloredSweep' (and the other
+     *         parallel modes), see 'setThreadPotentials'
+     */
+    virtual int numThreads() const {
+      return std::max(thrPots.size(),1);
+    }
+
     virtual const PotentialManager& getEPPotentials() const {
       return *epPots;
     }
 
+    virtual PotentialManager& getEPPotentials() {
+      return *epPots;
+    }
+
     virtual const ArrayHandle<double>& getMarginalsBeta() const {
       return margBeta;
     }
@@ -243,64 +447,510 @@
      * @return         Return status ('updSuccess' for success)
      */
     virtual int sequentialUpdate(int j,double dampFact=0.0,double* delta=0,
-				 double* effDamp=0);
+				 double* effDamp=0) {
+      if (dampFact<0.0 || dampFact>=1.0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      return updateInternal(j,dampFact,delta,effDamp,*epPots,buffVec);
+    }
+
+    /**
+     * Potential managers to be used by 'coloredSweep', one for each
+     * thread. All must represent the same potentials as 'epPots', but must
+     * not share any state (see 'PotentialManager'). The same manager can be
+     * passed for several (or all) threads if its 'numThreads' is at least
+     * the size of 'parr'. The number of threads
+     * used by 'coloredSweep' is the size of 'parr'. If 'parr' is empty,
+     * 'coloredSweep' runs in the calling thread, using 'epPots'.
+     *
+     * @param parr Potential managers, one per thread
+     */
+    virtual void setThreadPotentials(const ArrayHandle<Handle<PotentialManager> >& parr);
+
+    /**
+     * Switches warm start state for local EP updates on or off (see header
+     * comment). If switched on, states are zero initially (no state).
+     * Switching off discards the states.
+     *
+     * @param on S.a.
+     */
+    virtual void setWarmStart(bool on);
+
+    /**
+     * @return Is warm start state active?
+     */
+    bool isWarmStart() const {
+      return (warmSt.size()>0);
+    }
+
+    /**
+     * Runs EP updates on all potentials in 'updInd', in the sense of
+     * 'sequentialUpdate'. The potentials are partitioned into batches by
+     * 'FactorizedEPRepresentation::colorSchedule', so that potentials in
+     * a batch do not share variables. Batches are processed one after the
+     * other, the updates within a batch are distributed over threads (see
+     * 'setThreadPotentials'). This requires OpenMP, otherwise all updates
+     * are done in the calling thread.
+     * The batch ordering is returned in 'schedInd'. Results are the same
+     * as for running 'sequentialUpdate' on 'schedInd' in this order, which
+     * in turn gives the same result as the ordering in 'updInd'. Return
+     * arguments 'rstat', 'delta', 'effDamp' are w.r.t. 'schedInd'. For
+     * skipped updates, 'delta' is 0 and 'effDamp' is 1.
+     *
+     * @param updInd   Potential indexes
+     * @param nupd     Size of 'updInd'
+     * @param schedInd Batch ordering of 'updInd' ret. here
+     * @param dampFact Damping factor in [0,1)
+     * @param rstat    Return status for each update. Optional
+     * @param delta    See 'sequentialUpdate'. Optional
+     * @param effDamp  See 'sequentialUpdate'. Optional
+     * @return         Number of batches
+     */
+    virtual int coloredSweep(const int* updInd,int nupd,int* schedInd,
+			     double dampFact=0.0,int* rstat=0,double* delta=0,
+			     double* effDamp=0);
+
+    /**
+     * Asynchronous ("Hogwild") variant of 'coloredSweep'. Updates on all
+     * potentials in 'updInd' are distributed over threads (see
+     * 'setThreadPotentials') without any coordination. Cavity marginals
+     * are computed from the current marginals, which may be modified by
+     * other threads at the same time. New marginals are written back by
+     * atomically adding the changes in EP parameters. Only the EP
+     * parameters of potential j are owned by the thread updating on j, so
+     * entries of 'updInd' must be distinct.
+     * Marginals drift from the EP parameters this way. They are
+     * recomputed from scratch at the end ('compMarginals',
+     * 'compTauMarginals').
+     * Results are not deterministic and not the same as for sequential
+     * updates. Return arguments are w.r.t. 'updInd'. For skipped updates,
+     * 'delta' is 0.
+     * NOTE: Selective damping is not supported ('epMaxXXX' must be zero).
+     *
+     * @param updInd   Potential indexes (distinct)
+     * @param nupd     Size of 'updInd'
+     * @param dampFact Damping factor in [0,1)
+     * @param rstat    Return status for each update. Optional
+     * @param delta    See 'sequentialUpdate'. Optional
+     */
+    virtual void asyncSweep(const int* updInd,int nupd,double dampFact=0.0,
+			    int* rstat=0,double* delta=0);
+
+    /**
+     * Parallel (synchronous) EP updates on all potentials in 'updInd'
+     * (distinct entries). Different to 'sequentialUpdate', all updates
+     * are done w.r.t. the same marginals. Three phases:
+     * - Cavity marginals (from marginals before the sweep) and local EP
+     *   updates ('EPScalarPotential::compMoments') for all potentials.
+     *   These are distributed over threads
+     * - New EP parameters (damping, selective damping) are written back.
+     *   Without selective damping, this is distributed over threads as
+     *   well, and marginals are not modified. With selective damping, it
+     *   is done in the ordering of 'updInd', and the marginals are updated
+     *   after each update, so that the constraints in the header comment
+     *   are maintained
+     * - Marginals are recomputed from the EP parameters, distributed over
+     *   threads (variables i)
+     * Threads as in 'coloredSweep' (see 'setThreadPotentials').
+     * Return status as for 'sequentialUpdate'. Without selective damping,
+     * the condition for 'updMarginalsInvalid' is checked for each update
+     * on its own, combined updates may still lead to pi_i < eps/2. Use
+     * damping or selective damping in this case.
+     * Return arguments are w.r.t. 'updInd'. For skipped updates, 'delta'
+     * is 0 and 'effDamp' is 1.
+     *
+     * @param updInd   Potential indexes (distinct)
+     * @param nupd     Size of 'updInd'
+     * @param dampFact Damping factor in [0,1)
+     * @param rstat    Return status for each update. Optional
+     * @param delta    See 'sequentialUpdate'. Optional
+     * @param effDamp  See 'sequentialUpdate'. Optional
+     */
+    virtual void parallelSweep(const int* updInd,int nupd,double dampFact=0.0,
+			       int* rstat=0,double* delta=0,
+			       double* effDamp=0);
+
+    /**
+     * Appends 'num' potentials to the model, given by the potential
+     * manager 'ppots' (of size 'num', group 'atypeUnivariate') and rows
+     * of B (see 'FactorizedEPRepresentation::appendPotentials'). Their
+     * EP parameters are 'pbeta', 'ppi' (same layout as 'pbvals'), or
+     * zero if not given. Marginals (and 'epMaxPi') are updated by these
+     * messages.
+     * 'ppots' is appended to 'epPots', and to the managers passed to
+     * 'setThreadPotentials'. If these are several, 'ppots' is shared by
+     * all threads and has to support this (see
+     * 'PotentialManager::numThreads').
+     * NOTE: Not for bivariate precision potentials. The representation
+     * must not be in packed mode.
+     *
+     * @param ppots   Potential manager for new potentials
+     * @param num     Number of new potentials
+     * @param prowOff See 'FactorizedEPRepresentation::appendPotentials'
+     * @param pind    "
+     * @param pbvals  "
+     * @param pbeta   EP parameters beta. Optional
+     * @param ppi     EP parameters pi. Optional
+     * @return        Index of first new potential
+     */
+    virtual int appendPotentials(const Handle<PotentialManager>& ppots,
+				 int num,const int* prowOff,const int* pind,
+				 const double* pbvals,const double* pbeta=0,
+				 const double* ppi=0);
+
+    /**
+     * Retires the potentials in 'ind': their messages are removed from
+     * the marginals, their EP parameters set to zero (and 'epMaxPi'
+     * updated), and they are flagged in 'epRepr' (see
+     * 'FactorizedEPRepresentation::markRetired'). Potentials already
+     * retired are ignored.
+     * Potentials are retired one after the other. If the marginal
+     * pi_i of some i in V_j would drop below 'piMinThres', an exception
+     * is thrown, and j and the remaining potentials are not retired.
+     * NOTE: Not for bivariate precision potentials.
+     *
+     * @param ind Potential indexes
+     * @param num Size of 'ind'
+     */
+    virtual void retirePotentials(const int* ind,int num);
+
+    /**
+     * Dirty-tracked refresh: Recomputes the marginals [beta_i], [pi_i]
+     * from the EP parameters, for the variables touched by the
+     * potentials in 'ind' only (i in V_j), skipping those with 'rstat'
+     * other than 'updSuccess' (if given). Since marginals of other
+     * variables have not been changed, the result is the same as for
+     * 'FactorizedEPRepresentation::compMarginals', at a cost proportional
+     * to the nonzeros of the rows in 'ind'. Marginals for tau (if any)
+     * are recomputed in full (cheap).
+     * Drift check: For each recomputed variable, the difference between
+     * the old (incrementally updated) and new marginal is compared to the
+     * exact sum (compensated summation), relative to the sum of absolute
+     * values of the terms. If this exceeds 'driftTol' for some i, the
+     * incremental marginals were out of sync beyond rounding errors (for
+     * example, EP parameters modified from outside), and a full refresh
+     * is done.
+     *
+     * @param ind      Potential indexes
+     * @param num      Size of 'ind'
+     * @param rstat    Return status for 'ind'. Optional
+     * @param driftTol S.a. Nonnegative
+     * @return         Number of variables recomputed (n for full
+     *                 refresh)
+     */
+    virtual int refreshMarginals(const int* ind,int num,const int* rstat=0,
+				 double driftTol=1e-6);
+
+    /**
+     * Runs sweeps of EP updates, until convergence or 'maxIt' sweeps are
+     * done. In each sweep, all potentials are updated on (in random
+     * ordering), except for those excluded by potential type (see
+     * 'FactEPSweepOptions'). The update mode 'opts.mode' selects
+     * 'sequentialUpdate', 'coloredSweep', 'parallelSweep', 'asyncSweep'
+     * or residual scheduling (see below). If 'opts.doRefresh', marginals
+     * are recomputed from the EP parameters after each sweep (this is
+     * done anyway for 'modeParallel', 'modeAsync'), only for the
+     * variables touched by the sweep if 'opts.dirtyRefresh' (see
+     * 'refreshMarginals'). If
+     * 'opts.packLayout', the representation is in packed layout during
+     * the sweeps (unless it is already, it is switched back at the end).
+     * 'opts.packLayout' is ignored for a 64-bit index, single precision
+     * or if potentials have been appended. Retired potentials are not
+     * updated on.
+     * After each sweep, the statistics in 'stats' are determined (see
+     * 'FactEPSweepStats'). We stop once 'stats.delta' for the sweep is
+     * below 'deltaEps'.
+     * 'modeResidual': Sequential updates, scheduled by a priority queue
+     * over all potentials to be updated on. The key of j is its 'delta'
+     * from its last update. An update on j changes the cavities of all
+     * potentials k sharing a variable x_i with j, by the relative change
+     * of the marginal of x_i (mean and stddev., as for 'delta'), and the
+     * key of k is raised to at least this value (for tau_k(j): at least
+     * 'delta'). Changes below 'deltaEps' are not passed on, and
+     * variables with more than 'opts.maxFanout' potentials are skipped
+     * (see 'FactorizedEPRepresentation::markPotentials'). The first
+     * sweep is a normal sequential sweep (potentials not updated then
+     * have key +infinity). Each further sweep pops up to as many
+     * potentials as a normal sweep, but stops early once the largest key
+     * is below 'deltaEps'. For this mode, 'stats.delta' is the largest
+     * key after the sweep, so that convergence means that no potential
+     * is expected to change by more than 'deltaEps'. The number of
+     * updates done in a sweep is the sum over 'stats.numSkip' for the
+     * sweep.
+     * Freezing: If 'opts.freezeSweeps'=k>0, a potential j whose last k
+     * updates were successful with 'delta' below 'opts.freezeEps' is
+     * frozen: it is not updated on in further sweeps (counted in
+     * 'stats.numFrozen'). After each sweep, the marginals of variables
+     * touched by the sweep are compared against reference values (mean
+     * and stddev., relative change as for 'delta'). If a marginal has
+     * moved by more than 'opts.reactTol', all potentials on this
+     * variable are reactivated, and the reference is set to the current
+     * marginal. References are initialized at the start, so a potential
+     * may be reactivated early (never late). 'stats.delta' is over
+     * the potentials updated on, so a run converges once all others are
+     * frozen. Not for 'modeResidual'. Bivariate precision potentials are
+     * not frozen.
+     * If 'opts.warmStart', 'setWarmStart' is switched on before the first
+     * sweep.
+     *
+     * @param maxIt    Maximum number of sweeps
+     * @param deltaEps Convergence threshold. Positive
+     * @param dampFact Damping factor in [0,1)
+     * @param opts     Schedule options
+     * @param stats    Statistics for each sweep ret. here
+     * @return         Number of sweeps done
+     */
+    virtual int runSweeps(int maxIt,double deltaEps,double dampFact,
+			  const FactEPSweepOptions& opts,
+			  FactEPSweepStats& stats);
+
+  protected:
+    // Internal methods
+
+    /**
+     * Implements 'sequentialUpdate', using potential manager 'pman' and
+     * buffer 'buff' (resized if required). Concurrent calls are fine if
+     * different potential managers and buffers are used, and if the
+     * potentials do not share variables (x_i or tau_k).
+     * 'dampFact' is not checked. Calls 'compUpdate', then 'applyUpdate'.
+     * 'margMode' determines how marginals are updated (see 'applyUpdate').
+     */
+    int updateInternal(int j,double dampFact,double* delta,double* effDamp,
+		       const PotentialManager& pman,ArrayHandle<double>& buff,
+		       int margMode=margOverwrite);
+
+    /**
+     * First part of EP update on t_j(.): Cavity marginals, local EP update
+     * and new EP parameters (without damping). Nothing is written back.
+     * 'buff' must have size 4*|V_j|, it is passed on to 'applyUpdate'
+     * together with 'aux' (size 8).
+     * Concurrent calls are fine if different potential managers and
+     * buffers are used.
+     * Calls 'compUpdateT' with 'FactEPGenericAccess'. Subclasses can use
+     * more specific access policies.
+     *
+     * @param j    Potential index
+     * @param pman Potential manager
+     * @param buff Buffer, s.a.
+     * @param aux  Auxiliary values ret. here, s.a.
+     * @return     Return status
+     */
+    virtual int compUpdate(int j,const PotentialManager& pman,double* buff,
+			   double* aux) {
+      if (epRepr->isPacked())
+	return compUpdateT<FactEPGenericAccess,FactEPPackedRow>(j,pman.getPot(j),
+								buff,aux);
+      if (epRepr->isIndex64())
+	return compUpdateT<FactEPGenericAccess,FactEPFlatRow64>(j,pman.getPot(j),
+								buff,aux);
+      if (epRepr->isSingle())
+	return compUpdateT<FactEPGenericAccess,FactEPFlatRowF>(j,pman.getPot(j),
+							       buff,aux);
+      return compUpdateT<FactEPGenericAccess,FactEPFlatRow>(j,pman.getPot(j),
+							    buff,aux);
+    }
+
+    /**
+     * Implements 'compUpdate' for potential 'epPot' (the one for j),
+     * with access policy 'A' (see 'FactEPGenericAccess') and row view
+     * 'R' (see 'FactEPFlatRow').
+     */
+    template<class A,class R> int compUpdateT(int j,
+					      const typename A::PotType& epPot,
+					      double* buff,double* aux);
+
+    /**
+     * Second part of EP update on t_j(.), after 'compUpdate' (with
+     * 'buff', 'aux'): Selective damping, damping, write back of EP
+     * parameters. Marginals are:
+     * - margOverwrite: Overwritten by cavity plus new EP parameters
+     * - margAtomicAdd: Changes in EP parameters are added atomically.
+     *   Potentials may share variables in this case (see 'asyncSweep')
+     * - margKeep: Not modified
+     *
+     * @param j        Potential index
+     * @param dampFact Damping factor
+     * @param delta    See 'sequentialUpdate'. Optional
+     * @param effDamp  See 'sequentialUpdate'. Optional
+     * @param buff     Buffer from 'compUpdate'
+     * @param aux      Aux. values from 'compUpdate'
+     * @param margMode S.a.
+     * @return         Return status
+     */
+    virtual int applyUpdate(int j,double dampFact,double* delta,
+			    double* effDamp,double* buff,const double* aux,
+			    int margMode) {
+      if (epRepr->isPacked())
+	return applyUpdateT<FactEPGenericAccess,FactEPPackedRow>(j,dampFact,
+								 delta,effDamp,
+								 buff,aux,
+								 margMode);
+      if (epRepr->isIndex64())
+	return applyUpdateT<FactEPGenericAccess,FactEPFlatRow64>(j,dampFact,
+								 delta,effDamp,
+								 buff,aux,
+								 margMode);
+      if (epRepr->isSingle())
+	return applyUpdateT<FactEPGenericAccess,FactEPFlatRowF>(j,dampFact,
+								delta,effDamp,
+								buff,aux,
+								margMode);
+      return applyUpdateT<FactEPGenericAccess,FactEPFlatRow>(j,dampFact,delta,
+							     effDamp,buff,aux,
+							     margMode);
+    }
+
+    /**
+     * Implements 'applyUpdate', with access policy 'A' (see
+     * 'FactEPGenericAccess') and row view 'R' (see 'FactEPFlatRow').
+     */
+    template<class A,class R> int applyUpdateT(int j,double dampFact,
+					       double* delta,double* effDamp,
+					       double* buff,const double* aux,
+					       int margMode);
+
+    /**
+     * Appends 'ppots' to 'pman'. If 'pman' is not a
+     * 'ContainerPotManager', it is replaced by a new container with
+     * children 'pman', 'ppots'.
+     */
+    static void appendPotManager(Handle<PotentialManager>& pman,
+				 const Handle<PotentialManager>& ppots);
+
+    /**
+     * Adds EP parameters 'pbeta', 'ppi' to new potential j (parameters
+     * are zero before) and to the marginals, with row view 'R'.
+     */
+    template<class R> void addMessages(int j,const double* pbeta,
+				       const double* ppi);
+
+    /**
+     * Implements 'retirePotentials' for potential j, with row view 'R'.
+     */
+    template<class R> void retirePotential(int j);
+
+    /**
+     * Recomputes marginal for variable i (same summation order as
+     * 'FactorizedEPRepresentation::compMarginal'), see
+     * 'refreshMarginals'.
+     *
+     * @param i Variable index
+     * @return  Relative drift of old marginal
+     */
+    template<class I,class V> double refreshVariableT(int i);
+
+    /**
+     * 'modeResidual': Stores marginals of x_i, i in V_j, in 'resOld'
+     * (V_j in 'resVList'), before an update on j.
+     *
+     * @param j Potential to be updated on
+     * @return  |V_j|
+     */
+    int residualSave(int j);
+
+    /**
+     * 'modeResidual': After the update on j, sets key of j in 'resQueue'
+     * to 'delta' and raises keys of potentials whose cavities have
+     * changed by at least 'deltaEps' (see 'runSweeps').
+     *
+     * @param j         Potential updated on
+     * @param vjSz      Return value of 'residualSave'
+     * @param delta     'delta' of the update (0 if it failed)
+     * @param deltaEps  S.a.
+     * @param maxFanout S.a. 'FactEPSweepOptions'
+     */
+    void residualRaise(int j,int vjSz,double delta,double deltaEps,
+		       int maxFanout);
+
+    /**
+     * Freezing (see 'runSweeps'): Updates 'frzCount' after a sweep over
+     * 'ind' (return stati 'rstat', changes 'delta'), where potential j is
+     * frozen iff 'frzCount[j]' >= 'freezeK'. Then, potentials on
+     * variables whose marginals moved by more than 'reactTol' (against
+     * 'frzRef') are reactivated.
+     *
+     * @param ind      Potentials updated on in the sweep
+     * @param num      Size of 'ind'
+     * @param rstat    Return stati
+     * @param delta    Changes ('delta')
+     * @param freezeK  S.a.
+     * @param frzEps   Threshold for 'delta'
+     * @param reactTol S.a.
+     * @return         Number of potentials reactivated
+     */
+    int freezeSweep(const int* ind,int num,const int* rstat,
+		    const double* delta,int freezeK,double frzEps,
+		    double reactTol);
   };
 
   // Inline methods
 
+  inline int
+  FactorizedEPDriver::updateInternal(int j,double dampFact,double* delta,
+				     double* effDamp,
+				     const PotentialManager& pman,
+				     ArrayHandle<double>& buff,int margMode)
+  {
+    int vjSz,irstat;
+    double aux[8];
+
+    vjSz=epRepr->rowSize(j);
+    if (buff.size()<4*vjSz)
+      buff.changeRep(4*vjSz);
+    if ((irstat=compUpdate(j,pman,buff.p(),aux))!=updSuccess)
+      return irstat;
+    return applyUpdate(j,dampFact,delta,effDamp,buff.p(),aux,margMode);
+  }
+
   /*
    * Arrays: XX is 'beta', 'pi'
    * - vjInd:  V_j
    * - bP:     b_ji
-   * - XXP:    XX_ji, EP parameters (overwritten only at end)
-   * - mXXP:   XX_i, marginals (overwritten only at end)
-   * - cXXP:   First cavity, then updated EP pars
-   * - mprXXP: First updated EP pars (without damping), then
-   *           new XX_i, marginals
-   * Required, because an update can be skipped until the very end.
+   * - XXP:    XX_ji, EP parameters (not modified here)
+   * - mXXP:   XX_i, marginals (not modified here)
+   * - cXXP:   Cavity
+   * - mprXXP: Updated EP pars (without damping)
    */
-  inline int FactorizedEPDriver::sequentialUpdate(int j,double dampFact,
-						  double* delta,double* effDamp)
+  template<class A,class R> inline int
+  FactorizedEPDriver::compUpdateT(int j,const typename A::PotType& epPot,
+				  double* buff,double* aux)
   {
-    int i,ii,vjSz,k=0;
-    double temp,temp2,cH,cRho,bval,nu,alpha,cPi,cBeta,pi,beta,tilPi,tilBeta,
-      prPi,prBeta,kappa,thres2=0.5*piMinThres,mH,mRho,cA=0.0,cC=0.0,hatA,hatC,
-      prA,prC,mnTau=0.0,stdTau=0.0,eta;
-    const int* vjInd;
-    const double* bP;
-    double* betaP,*piP,*cBetaP,*cPiP,*mBetaP,*mPiP,*mprBetaP,*mprPiP,*aP,*cP;
+    int i,ii,vjSz,k=-1;
+    double temp,temp2,cH,cRho,bval,nu,alpha,cPi,cBeta,tilPi,tilBeta,
+      thres2=0.5*piMinThres,mH,mRho,cA=0.0,cC=0.0,mnTau=0.0,stdTau=0.0;
+    R row;
+    double* cBetaP,*cPiP,*mBetaP,*mPiP,*mprBetaP,*mprPiP,*aP,*cP;
     double inp[4],ret[4];
-    bool isBVPrec=(epPots->getPot(j).getArgumentGroup()==
-		   EPScalarPotential::atypeBivarPrec);
+    double* wst;
+    bool isBVPrec=(epPot.getArgumentGroup()==
+		   EPScalarPotential::atypeBivarPrec),succ;
     char debMsg[200]; // DEBUG!
 
-    if (dampFact<0.0 || dampFact>=1.0)
-      throw InvalidParameterException(EXCEPT_MSG(""));
-    // Access to data for j. Temporary arrays
-    epRepr->accessRow(j,vjSz,vjInd,bP,betaP,piP);
+    // Access to data for j
+    A::checkRow(*epRepr,j);
+    if (epRepr->isRetired(j))
+      return updRetired;
+    vjSz=row.access(*epRepr,j);
     if (isBVPrec) {
       // 'k' is k(j). 'aP', 'cP' point to message parameters
-      // a_{j k}, c_{j k} (read and write access). Note that different to x,
-      // the update only effects the marginal on a single tau_k
+      // a_{j k}, c_{j k}. Note that different to x, the update only effects
+      // the marginal on a single tau_k
       k=epRepr->accessTauRow(j,aP,cP);
       mnTau=margA[k]/margC[k]; // For '*delta' below
       stdTau=sqrt(margA[k])/margC[k];
     }
     mBetaP=margBeta.p(); mPiP=margPi.p();
-    if (buffVec.size()<4*vjSz)
-      buffVec.changeRep(4*vjSz);
-    cBetaP=buffVec.p(); cPiP=cBetaP+vjSz;
+    cBetaP=buff; cPiP=cBetaP+vjSz;
     mprBetaP=cPiP+vjSz; mprPiP=mprBetaP+vjSz;
     // Compute cavity marginals
     // The marginal moments on s_j ('mH', 'mRho') are required to compute
     // '*delta' below
     cH=cRho=mH=mRho=0.0;
     for (ii=0; ii<vjSz; ii++) {
-      i=vjInd[ii];
-      if ((cPiP[ii]=cPi=mPiP[i]-piP[ii])<thres2)
+      i=row.ind(ii);
+      if ((cPiP[ii]=cPi=mPiP[i]-row.pi(ii))<thres2)
 	return updCavityInvalid; // EP update failed
-      cBetaP[ii]=cBeta=mBetaP[i]-betaP[ii];
-      bval=bP[ii]; temp=bval/cPi;
+      cBetaP[ii]=cBeta=mBetaP[i]-row.beta(ii);
+      bval=row.b(ii); temp=bval/cPi;
       cRho+=bval*temp;
       cH+=temp*cBeta;
       temp=bval/mPiP[i];
@@ -318,7 +968,13 @@
     if (isBVPrec) {
       inp[2]=cA; inp[3]=cC;
     }
-    if (!epPots->getPot(j).compMoments(inp,ret)) {
+    wst=(warmSt.size()>0)?(warmSt.p()+EPScalarPotential::maxWarmState*j):0;
+    if (wst!=0)
+      epPot.setWarmState(wst);
+    succ=A::compMoments(epPot,inp,ret);
+    if (wst!=0)
+      epPot.setWarmState(0);
+    if (!succ) {
       // DEBUG:
       if (!isBVPrec)
 	sprintf(debMsg,"UUPS: j=%d, cH=%f,cRho=%f",j,cH,cRho);
@@ -329,18 +985,9 @@
       return updNumericalError; // EP update failed
     }
     alpha=ret[0]; nu=ret[1];
-    if (isBVPrec) {
-      // New marginal a, c parameters (without damping)
-      hatA=ret[2]; hatC=ret[3];
-    }
-    // Compute new EP parameters without damping (to 'mprXXP'). If
-    // selective damping is active, we also determine the effective damping
-    // factor (overwrites 'dampFact')
+    // Compute new EP parameters without damping (to 'mprXXP')
     for (ii=0; ii<vjSz; ii++) {
-      // Undamped EP update
-      i=vjInd[ii];
-      bval=bP[ii]; // b_{ji}
-      pi=piP[ii]; beta=betaP[ii]; // pi_{ji}, beta_{ji}
+      bval=row.b(ii); // b_{ji}
       cPi=cPiP[ii]; cBeta=cBetaP[ii]; // pi_{-ji}, beta_{-ji}
       // 'tilPi', 'tilBeta': tilde{pi}_{ji}, tilde{beta}_{ji}, EP updates
       // without damping
@@ -368,47 +1015,109 @@
 	tilPi=temp*bval*nu*cPi;
 	tilBeta=temp*(cBeta*bval*nu+cPi*alpha);
       }
-      mprPiP[ii]=tilPi; mprBetaP[ii]=tilBeta; // Intermed. storage
-      if (!(epMaxPi==0) && tilPi<pi) {
-	// Selective damping to ensure that pi_{-ki} >= eps for all k,i
-	kappa=epMaxPi->getMaxValue(i); // kappa_i
-	if (kappa<=0.0) {
-	  sprintf(debMsg,"ERROR(maxPi,j=%d,i=%d): kappa_i=%f (negative)",j,i,
-		  kappa);
-	  printMsgStdout(debMsg);
-	  return updNumericalError;
-	}
-	// Value for eta:
-	eta=1.0-std::min((mPiP[i]-kappa-piMinThres)/(pi-tilPi),1.0);
-	if (eta>=0.98) {
-	  // EP update has to be skipped
-	  if (effDamp!=0) *effDamp=1.0;
-	  return updCavCondSkipped;
-	}
-	if (kappa==pi) {
-	  // This should not happen often. Have to ensure that new kappa_i is
-	  // positive. If this is not the case, the update is skipped.
-	  // ATTENTION: If this case happens frequently, have to choose better
-	  // response, f.ex. increasing 'eta' in small steps.
-	  prPi=eta*pi+(1.0-eta)*tilPi; // pi_{ji}' for current 'eta'
-	  piP[ii]=prPi;
-	  epMaxPi->update(i,j,prPi);
-	  kappa=epMaxPi->getMaxValue(i); // kappa_i'
-	  piP[ii]=pi; // Back to old state
-	  epMaxPi->update(i,j,pi);
+      mprPiP[ii]=tilPi; mprBetaP[ii]=tilBeta;
+    }
+    aux[0]=(double) k;
+    if (isBVPrec) {
+      // New a, c message parameters (without damping)
+      aux[1]=ret[2]-cA; aux[2]=ret[3]-cC;
+    } else
+      aux[1]=aux[2]=0.0;
+    aux[3]=mH; aux[4]=mRho; aux[5]=mnTau; aux[6]=stdTau;
+
+    return updSuccess;
+  }
+
+  /*
+   * Arrays: XX is 'beta', 'pi'
+   * - row:    XX_ji, EP parameters (overwritten only at end)
+   * - mXXP:   XX_i, marginals (overwritten only at end)
+   * - cXXP:   First cavity (w.r.t. current marginals), then updated EP
+   *           pars
+   * - mprXXP: First updated EP pars (without damping), then
+   *           new XX_i, marginals
+   * Required, because an update can be skipped until the very end.
+   * The cavity is recomputed here, since marginals may have changed
+   * since 'compUpdate' ('margAtomicAdd'). Otherwise, the values are the
+   * same.
+   */
+  template<class A,class R> inline int
+  FactorizedEPDriver::applyUpdateT(int j,double dampFact,double* delta,
+				   double* effDamp,double* buff,
+				   const double* aux,int margMode)
+  {
+    int i,ii,vjSz,k=(int) aux[0];
+    double temp,temp2,bval,cPi,cBeta,pi,beta,tilPi,prPi,prBeta,kappa,
+      thres2=0.5*piMinThres,cA=0.0,cC=0.0,prA=0.0,prC=0.0,eta;
+    R row;
+    double* cBetaP,*cPiP,*mBetaP,*mPiP,*mprBetaP,*mprPiP,*aP,*cP;
+    bool isBVPrec=(k>=0);
+    char debMsg[200]; // DEBUG!
+
+    // Access to data for j
+    A::checkRow(*epRepr,j);
+    vjSz=row.access(*epRepr,j);
+    if (isBVPrec)
+      epRepr->accessTauRow(j,aP,cP);
+    mBetaP=margBeta.p(); mPiP=margPi.p();
+    cBetaP=buff; cPiP=cBetaP+vjSz;
+    mprBetaP=cPiP+vjSz; mprPiP=mprBetaP+vjSz;
+    // Cavity marginals
+    for (ii=0; ii<vjSz; ii++) {
+      i=row.ind(ii);
+      cPiP[ii]=mPiP[i]-row.pi(ii);
+      cBetaP[ii]=mBetaP[i]-row.beta(ii);
+    }
+    if (isBVPrec) {
+      cA=margA[k]-(*aP); cC=margC[k]-(*cP);
+    }
+    // If selective damping is active, we determine the effective damping
+    // factor (overwrites 'dampFact')
+    if (!(epMaxPi==0))
+      for (ii=0; ii<vjSz; ii++) {
+	i=row.ind(ii);
+	pi=row.pi(ii); tilPi=mprPiP[ii];
+	if (tilPi<pi) {
+	  // Selective damping to ensure that pi_{-ki} >= eps for all k,i
+	  kappa=epMaxPi->getMaxValue(i); // kappa_i
 	  if (kappa<=0.0) {
-	    // Assuming this case almost never happens, we just skip the update
-	    printMsgStdout("UUPS(pi selective damping; skipping update due to negative kappa)");
+	    sprintf(debMsg,"ERROR(maxPi,j=%d,i=%d): kappa_i=%f (negative)",j,
+		    i,kappa);
+	    printMsgStdout(debMsg);
+	    return updNumericalError;
+	  }
+	  // Value for eta:
+	  eta=1.0-std::min((mPiP[i]-kappa-piMinThres)/(pi-tilPi),1.0);
+	  if (eta>=0.98) {
+	    // EP update has to be skipped
 	    if (effDamp!=0) *effDamp=1.0;
 	    return updCavCondSkipped;
 	  }
+	  if (kappa==pi) {
+	    // This should not happen often. Have to ensure that new kappa_i
+	    // is positive. If this is not the case, the update is skipped.
+	    // ATTENTION: If this case happens frequently, have to choose
+	    // better response, f.ex. increasing 'eta' in small steps.
+	    prPi=eta*pi+(1.0-eta)*tilPi; // pi_{ji}' for current 'eta'
+	    row.setPi(ii,prPi);
+	    epMaxPi->update(i,j,row.pi(ii));
+	    kappa=epMaxPi->getMaxValue(i); // kappa_i'
+	    row.setPi(ii,pi); // Back to old state
+	    epMaxPi->update(i,j,pi);
+	    if (kappa<=0.0) {
+	      // Assuming this case almost never happens, we just skip the
+	      // update
+	      printMsgStdout("UUPS(pi selective damping; skipping update due to negative kappa)");
+	      if (effDamp!=0) *effDamp=1.0;
+	      return updCavCondSkipped;
+	    }
+	  }
+	  dampFact=std::max(dampFact,eta);
 	}
-	dampFact=std::max(dampFact,eta);
       }
-    }
     if (isBVPrec) {
       // Selective damping
-      prA=hatA-cA; prC=hatC-cC;
+      prA=aux[1]; prC=aux[2];
       if (!(epMaxA==0) && prA<*aP) {
 	// Selective damping to ensure that a_{-jk} >= 'aMinThres' for all j,k
 	kappa=epMaxA->getMaxValue(k); // kappa_k
@@ -481,7 +1190,7 @@
     // new marginals (to 'mprXXP'). This is done because the update can
     // still fail ('updMarginalsInvalid')
     for (ii=0; ii<vjSz; ii++) {
-      pi=piP[ii]; beta=betaP[ii]; // Current parameters
+      pi=row.pi(ii); beta=row.beta(ii); // Current parameters
       cPi=cPiP[ii]; cBeta=cBetaP[ii]; // Cavity
       prPi=mprPiP[ii]; prBeta=mprBetaP[ii]; // Undamped update
       // Damping
@@ -489,6 +1198,8 @@
 	prPi+=dampFact*(pi-prPi);
 	prBeta+=dampFact*(beta-prBeta);
       }
+      // Values as stored (marginals must be consistent with them)
+      prPi=R::stored(prPi); prBeta=R::stored(prBeta);
       // New marginals (overwrite 'mprXXP') and EP parameters (overwrite
       // 'cXXP')
       if ((mprPiP[ii]=cPi+prPi)<thres2)
@@ -498,15 +1209,27 @@
     }
     // New EP parameters and marginals for Gamma parameters: Write back
     if (isBVPrec) {
-      prA=hatA-cA; prC=hatC-cC;
+      prA=aux[1]; prC=aux[2];
       if (dampFact>0.0) {
 	prA+=dampFact*(*aP-prA);
 	prC+=dampFact*(*cP-prC);
       }
       if (cA+prA<0.5*aMinThres || cC+prC<0.5*cMinThres)
 	return updMarginalsInvalid; // EP update failed
+      if (margMode==margOverwrite) {
+	margA[k]=cA+prA; margC[k]=cC+prC;
+      } else if (margMode==margAtomicAdd) {
+	temp=prA-*aP; temp2=prC-*cP;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	margA[k]+=temp;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	margC[k]+=temp2;
+      }
       *aP=prA; *cP=prC;
-      margA[k]=cA+prA; margC[k]=cC+prC;
       if (!(epMaxA==0))
 	epMaxA->update(k,j,prA);
       if (!(epMaxC==0))
@@ -515,30 +1238,128 @@
     // Update succeeded: Write back new EP parameters and marginals
     double mprH=0.0,mprRho=0.0; // For '*delta'
     for (ii=0; ii<vjSz; ii++) {
-      i=vjInd[ii];
-      betaP[ii]=cBetaP[ii]; piP[ii]=cPiP[ii]; // New EP pars
-      mBetaP[i]=mprBetaP[ii]; mPiP[i]=mprPiP[ii]; // New marginals
+      i=row.ind(ii);
+      if (margMode==margOverwrite) {
+	mBetaP[i]=mprBetaP[ii]; mPiP[i]=mprPiP[ii]; // New marginals
+      } else if (margMode==margAtomicAdd) {
+	// Marginals may have changed since the cavity was computed: Add
+	// differences in EP parameters
+	temp=cBetaP[ii]-row.beta(ii); temp2=cPiP[ii]-row.pi(ii);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	mBetaP[i]+=temp;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	mPiP[i]+=temp2;
+      }
+      row.setBeta(ii,cBetaP[ii]); row.setPi(ii,cPiP[ii]); // New EP pars
       // For '*delta':
-      bval=bP[ii]; temp=bval/mprPiP[ii];
+      bval=row.b(ii); temp=bval/mprPiP[ii];
       mprRho+=bval*temp;
       mprH+=temp*mprBetaP[ii];
       if (!(epMaxPi==0))
-	epMaxPi->update(i,j,piP[ii]); // Update max-pi object
+	epMaxPi->update(i,j,row.pi(ii)); // Update max-pi object
     }
     if (delta!=0) {
-      mRho=sqrt(mRho); mprRho=sqrt(mprRho);
+      double mH=aux[3],mRho=sqrt(aux[4]);
+      mprRho=sqrt(mprRho);
       *delta=std::max(MAXRELDIFF(mH,mprH),MAXRELDIFF(mRho,mprRho));
       if (isBVPrec) {
-	temp=margA[k]/margC[k]; temp2=sqrt(margA[k])/margC[k];
-	*delta=std::max(*delta,MAXRELDIFF(mnTau,temp));
-	*delta=std::max(*delta,MAXRELDIFF(stdTau,temp2));
+	temp=cA+prA; temp2=cC+prC; // New marginal a, c
+	*delta=std::max(*delta,MAXRELDIFF(aux[5],temp/temp2));
+	*delta=std::max(*delta,MAXRELDIFF(aux[6],sqrt(temp)/temp2));
       }
     }
 
     return updSuccess;
   }
 
+  template<class R> inline void
+  FactorizedEPDriver::addMessages(int j,const double* pbeta,
+				  const double* ppi)
+  {
+    int i,ii,vjSz;
+    R row;
+    double* mBetaP=margBeta.p(),*mPiP=margPi.p();
+
+    vjSz=row.access(*epRepr,j);
+    for (ii=0; ii<vjSz; ii++) {
+      i=row.ind(ii);
+      if (pbeta!=0) {
+	row.setBeta(ii,pbeta[ii]); mBetaP[i]+=row.beta(ii);
+      }
+      if (ppi!=0) {
+	row.setPi(ii,ppi[ii]); mPiP[i]+=row.pi(ii);
+      }
+      if (!(epMaxPi==0))
+	epMaxPi->update(i,j,row.pi(ii));
+    }
+  }
+
+  template<class R> inline void
+  FactorizedEPDriver::retirePotential(int j)
+  {
+    int i,ii,vjSz;
+    R row;
+    double* mBetaP=margBeta.p(),*mPiP=margPi.p();
+
+    if (epRepr->isRetired(j))
+      return;
+    vjSz=row.access(*epRepr,j);
+    for (ii=0; ii<vjSz; ii++)
+      if (mPiP[row.ind(ii)]-row.pi(ii)<piMinThres)
+	throw InvalidParameterException(EXCEPT_MSG("Retiring potential would make marginals invalid"));
+    epRepr->markRetired(j);
+    for (ii=0; ii<vjSz; ii++) {
+      i=row.ind(ii);
+      mBetaP[i]-=row.beta(ii); mPiP[i]-=row.pi(ii);
+      row.setBeta(ii,0.0); row.setPi(ii,0.0);
+      if (!(epMaxPi==0))
+	epMaxPi->update(i,j,0.0);
+    }
+  }
+
 #undef MAXRELDIFF
+
+  /*
+   * The sums are computed twice: plainly (same as 'compMarginal', this
+   * is written back) and compensated (Kahan), which serves as exact
+   * reference for the drift check. 'sclXXX' is the sum of absolute
+   * values, the rounding error of the plain sum is a small multiple of
+   * DBL_EPSILON times this.
+   */
+  template<class I,class V> inline double
+  FactorizedEPDriver::refreshVariableT(int i)
+  {
+    int k,p,viSz;
+    double mBeta,mPi,kBeta,kPi,cBeta,cPi,sclBeta,sclPi,pi,beta,bval,y,t;
+    const I* viInd,*jiInd;
+    const V* bP,*betaP,*piP;
+
+    viSz=epRepr->accessCol(i,viInd,jiInd,bP,betaP,piP);
+    mBeta=mPi=kBeta=kPi=cBeta=cPi=sclBeta=sclPi=0.0;
+    for (k=0; k<viSz; k++) {
+      pi=piP[jiInd[k]]; beta=betaP[jiInd[k]];
+      mPi+=pi; mBeta+=beta;
+      sclPi+=fabs(pi); sclBeta+=fabs(beta);
+      y=pi-cPi; t=kPi+y; cPi=(t-kPi)-y; kPi=t;
+      y=beta-cBeta; t=kBeta+y; cBeta=(t-kBeta)-y; kBeta=t;
+    }
+    for (p=epRepr->firstColExt(i); p>=0; p=epRepr->nextColExt(p)) {
+      epRepr->colExtEntry(p,bval,beta,pi);
+      mPi+=pi; mBeta+=beta;
+      sclPi+=fabs(pi); sclBeta+=fabs(beta);
+      y=pi-cPi; t=kPi+y; cPi=(t-kPi)-y; kPi=t;
+      y=beta-cBeta; t=kBeta+y; cBeta=(t-kBeta)-y; kBeta=t;
+    }
+    t=std::max(fabs(margPi[i]-kPi)/std::max(sclPi,1e-300),
+	       fabs(margBeta[i]-kBeta)/std::max(sclBeta,1e-300));
+    margPi[i]=mPi; margBeta[i]=mBeta;
+
+    return t;
+  }
 //ENDNS
 
 #endif
@@ -0,0 +1,218 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactorizedEPDriverSpec
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTORIZEDEPDRIVERSPEC_H
+#define EPTOOLS_FACTORIZEDEPDRIVERSPEC_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/FactorizedEPDriver.h"
+#include "src/eptools/potentials/DefaultPotManager.h"
+#include "src/eptools/potentials/ContainerPotManager.h"
+
+//BEGINNS(eptools)
+  /**
+   * Variant of 'FactorizedEPDriver' (univariate potentials only) for
+   * models where most potentials are of type 'P', a subclass of
+   * 'EPScalarPotential' (for example, a single likelihood type and a
+   * Gaussian prior).
+   * <p>
+   * For potentials in a 'DefaultPotManager' block whose potential object
+   * is of type 'P' exactly (see 'DefaultPotManager::isPotType'), the
+   * generic path (virtual 'PotentialManager::getPot',
+   * 'EPScalarPotential::setPars', 'EPScalarPotential::compMoments',
+   * range checks on the potential index) is replaced by non-virtual
+   * calls which can be inlined (see 'FactEPSpecAccess'). All
+   * other potentials are updated as in 'FactorizedEPDriver'. Results are
+   * the same.
+   * <p>
+   * Blocks are determined for 'epPots' and for the potential managers
+   * passed to 'setThreadPotentials' (and rebuilt by 'appendPotentials').
+   * A manager is either a 'DefaultPotManager' or a 'ContainerPotManager'
+   * whose children are 'DefaultPotManager' objects (children of other
+   * types are updated by the generic path). Use 'FactEPDriverFactory' to
+   * select 'P' automatically.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  template<class P> class FactorizedEPDriverSpec : public FactorizedEPDriver
+  {
+  protected:
+    // Members
+
+    int numM;                                  // Number of potentials
+    int numSpec;                               // Managers with block tables
+    ArrayHandle<const PotentialManager*> specMan;
+    ArrayHandle<ArrayHandle<int> > specStart;  // Block start positions
+    ArrayHandle<ArrayHandle<const DefaultPotManager*> > specBlk; // 0: generic
+
+  public:
+    // Public methods
+
+    /**
+     * Constructor. Same as univariate constructor of 'FactorizedEPDriver'.
+     */
+    FactorizedEPDriverSpec(const Handle<PotentialManager>& pepPots,
+			   const Handle<FactorizedEPRepresentation>& pepRepr,
+			   const ArrayHandle<double>& pmargBeta,
+			   const ArrayHandle<double>& pmargPi,
+			   double ppiMinThres,
+			   const Handle<FactEPMaximumPiValues>& pepMaxPi=
+			   HandleZero<FactEPMaximumPiValues>::get()) :
+      FactorizedEPDriver(pepPots,pepRepr,pmargBeta,pmargPi,ppiMinThres,
+			 pepMaxPi),numM(pepPots->size()) {
+      buildTables();
+    }
+
+    void setThreadPotentials(const ArrayHandle<Handle<PotentialManager> >& parr) {
+      FactorizedEPDriver::setThreadPotentials(parr);
+      buildTables();
+    }
+
+    int appendPotentials(const Handle<PotentialManager>& ppots,int num,
+			 const int* prowOff,const int* pind,
+			 const double* pbvals,const double* pbeta=0,
+			 const double* ppi=0) {
+      int ret=FactorizedEPDriver::appendPotentials(ppots,num,prowOff,pind,
+						   pbvals,pbeta,ppi);
+      numM=epPots->size();
+      buildTables();
+
+      return ret;
+    }
+
+    /**
+     * @return Number of potentials updated by the specialized path
+     */
+    int numSpecPotentials() const {
+      int b,ret=0;
+
+      if (numSpec>0 && specMan[0]==epPots.p())
+	for (b=0; b<specBlk[0].size(); b++)
+	  if (specBlk[0][b]!=0)
+	    ret+=specBlk[0][b]->size();
+
+      return ret;
+    }
+
+  protected:
+    // Internal methods
+
+    int compUpdate(int j,const PotentialManager& pman,double* buff,
+		   double* aux) {
+      int jrel;
+      const DefaultPotManager* dpm;
+
+      if (j>=0 && j<numM && (dpm=findBlock(pman,j,jrel))!=0) {
+	if (epRepr->isPacked())
+	  return compUpdateT<FactEPSpecAccess<P>,FactEPPackedRow>
+	    (j,dpm->getPotTyped<P>(jrel),buff,aux);
+	if (epRepr->isIndex64())
+	  return compUpdateT<FactEPSpecAccess<P>,FactEPFlatRow64>
+	    (j,dpm->getPotTyped<P>(jrel),buff,aux);
+	if (epRepr->isSingle())
+	  return compUpdateT<FactEPSpecAccess<P>,FactEPFlatRowF>
+	    (j,dpm->getPotTyped<P>(jrel),buff,aux);
+	return compUpdateT<FactEPSpecAccess<P>,FactEPFlatRow>
+	  (j,dpm->getPotTyped<P>(jrel),buff,aux);
+      }
+
+      return FactorizedEPDriver::compUpdate(j,pman,buff,aux);
+    }
+
+    int applyUpdate(int j,double dampFact,double* delta,double* effDamp,
+		    double* buff,const double* aux,int margMode) {
+      if (j>=0 && j<numM) {
+	if (epRepr->isPacked())
+	  return applyUpdateT<FactEPSpecAccess<P>,FactEPPackedRow>
+	    (j,dampFact,delta,effDamp,buff,aux,margMode);
+	if (epRepr->isIndex64())
+	  return applyUpdateT<FactEPSpecAccess<P>,FactEPFlatRow64>
+	    (j,dampFact,delta,effDamp,buff,aux,margMode);
+	if (epRepr->isSingle())
+	  return applyUpdateT<FactEPSpecAccess<P>,FactEPFlatRowF>
+	    (j,dampFact,delta,effDamp,buff,aux,margMode);
+	return applyUpdateT<FactEPSpecAccess<P>,FactEPFlatRow>
+	  (j,dampFact,delta,effDamp,buff,aux,margMode);
+      }
+
+      return FactorizedEPDriver::applyUpdate(j,dampFact,delta,effDamp,buff,
+					     aux,margMode);
+    }
+
+    /**
+     * @param pman Potential manager
+     * @param j    Potential index (must be valid)
+     * @param jrel Index within block ret. here
+     * @return     Block of j if of type 'P', 0 otherwise
+     */
+    const DefaultPotManager* findBlock(const PotentialManager& pman,int j,
+				       int& jrel) const {
+      int t,b;
+
+      for (t=0; t<numSpec; t++)
+	if (specMan[t]==&pman) {
+	  const int* stP=specStart[t].p();
+	  for (b=specStart[t].size()-1; j<stP[b]; b--);
+	  jrel=j-stP[b];
+	  return specBlk[t][b];
+	}
+
+      return 0;
+    }
+
+    /**
+     * Block tables for 'epPots' and all distinct managers in 'thrPots'.
+     * Managers without blocks of type 'P' are not listed.
+     */
+    void buildTables() {
+      int t,s,num=thrPots.size()+1;
+      const PotentialManager* pm;
+
+      specMan.changeRep(num); specStart.changeRep(num);
+      specBlk.changeRep(num);
+      for (t=numSpec=0; t<num; t++) {
+	pm=(t==0)?epPots.p():thrPots[t-1].p();
+	for (s=0; s<numSpec; s++)
+	  if (specMan[s]==pm) break;
+	if (s==numSpec && buildTable(*pm,specStart[numSpec],specBlk[numSpec]))
+	  specMan[numSpec++]=pm;
+      }
+    }
+
+    /**
+     * @param pm    Potential manager
+     * @param start Block start positions ret. here
+     * @param blk   Blocks ret. here (0 if not of type 'P')
+     * @return      Is there a block of type 'P'?
+     */
+    static bool buildTable(const PotentialManager& pm,ArrayHandle<int>& start,
+			   ArrayHandle<const DefaultPotManager*>& blk) {
+      int ic,nb;
+      bool ret=false;
+      const ContainerPotManager* cpm=DYNCAST(const ContainerPotManager,&pm);
+
+      nb=(cpm!=0)?cpm->numChildren():1;
+      start.changeRep(nb); blk.changeRep(nb);
+      for (ic=0; ic<nb; ic++) {
+	const PotentialManager& child=(cpm!=0)?cpm->getChild(ic):pm;
+	const DefaultPotManager* dpm=DYNCAST(const DefaultPotManager,&child);
+	start[ic]=(cpm!=0)?cpm->getStartPos(ic):0;
+	blk[ic]=(dpm!=0 && dpm->isPotType<P>())?dpm:0;
+	ret|=(blk[ic]!=0);
+      }
+
+      return ret;
+    }
+  };
+//ENDNS
+
+#endif
@@ -17,6 +17,17 @@
 #include "src/eptools/potentials/PotManagerFactory.h"
 
 //BEGINNS(eptools)
+  /**
+   * Entry of packed row layout, see 'FactorizedEPRepresentation'
+   */
+  struct FactEPPackedEntry
+  {
+    int ind;     // i in V_j
+    double bval; // b_ji
+    double pi;   // pi_ji
+    double beta; // beta_ji
+  };
+
   /**
    * Represents coupling factor B (sparsity pattern and content) for
    * expectation propagation with factorized backbone. The EP
@@ -78,6 +89,60 @@
    * - For each k=0:(K-1): Start offset of J_k = {j | k(j)==k} [K]
    * - Dummy entry (start offset of J_K if it existed) [1]
    * - J_k, k=0:(K-1), each ascending order [m_prec]
+   * <p>
+   * Packed layout:
+   * Optional, switched on by 'packLayout', off by 'unpackLayout'. For
+   * each nonzero (in the ordering of 'bmatVals'), 'rowPack' contains
+   * (i, b_ji, pi_ji, beta_ji) (see 'FactEPPackedEntry'), so that an EP
+   * update on j touches a single contiguous block. In packed mode,
+   * 'rowPack' holds the EP parameters, while 'betaVals', 'piVals' are
+   * not up to date (see 'syncFlat'), and 'accessRow' cannot be used
+   * (use 'accessRowPacked' instead).
+   * 'accessCol' returns a column-major mirror of b, pi, beta. EP
+   * parameters are written to 'rowPack' and the mirror (see
+   * 'accessRowPacked'), so that the mirror is always up to date, and
+   * 'compMarginals' accumulates over 'rowPack' in row order (same
+   * summation order as the column pass, so results are the same).
+   * <p>
+   * 64-bit index:
+   * 'colInd' has 2*nnz+n+1 entries, so 32-bit indexes overflow at about
+   * 1e9 nonzeros. The 64-bit constructor takes 'rowInd', 'colInd' with
+   * 'int64_t' entries (same layout as above) and flat arrays as plain
+   * pointers (their sizes are not limited by 'ArrayHandle'). Index arrays
+   * are accessed by 'accessRowFast', 'accessCol' with 'int64_t' index
+   * pointers then (see 'isIndex64'). Bivariate precision potentials and
+   * the packed layout are not supported in this case. Use the 32-bit
+   * index whenever possible, it needs less memory bandwidth.
+   * <p>
+   * Single precision:
+   * The flat arrays dominate memory use and bandwidth of EP updates. The
+   * single precision constructor takes 'bmatVals', 'betaVals', 'piVals'
+   * as 'float' arrays (32-bit index). Marginals and all computations
+   * remain in double precision, only stored values are rounded: EP
+   * updates round new pi_ji, beta_ji before the marginals are updated
+   * (see 'FactEPFlatRowT::stored'), so marginals remain consistent with
+   * the stored EP parameters. Use 'accessRowFast', 'accessCol' with
+   * 'float' value pointers then (see 'isSingle'). Bivariate precision
+   * potentials and the packed layout are not supported in this case.
+   * <p>
+   * Appended and retired potentials:
+   * 'appendPotentials' adds potentials m, m+1, ... to a live
+   * representation, without rebuilding 'rowInd', 'colInd' (the flat
+   * arrays are passed from outside and cannot grow). Their B values and
+   * EP parameters are kept in extension arrays owned by this object
+   * ('extXXX'), in the same row layout. For each variable i, the
+   * extension entries of column i are chained ('extColHead',
+   * 'extColNext'), so that appending costs time proportional to the new
+   * nonzeros. 'accessRowFast', 'accessRow', 'rowSize', 'compMarginal'
+   * cover appended potentials, while 'accessCol' returns the part in the
+   * flat arrays only (use 'firstColExt', 'nextColExt', 'colExtEntry' for
+   * the rest).
+   * 'markRetired' flags a potential as retired. The caller has to remove
+   * its messages from the marginals and set its EP parameters to zero
+   * (see 'FactorizedEPDriver::retirePotentials'), its storage is kept.
+   * Potentials can only be appended for a 32-bit index, double
+   * precision, no bivariate precision potentials, and not in packed
+   * mode. Packed mode is not available once potentials are appended.
    *
    * @author  Matthias Seeger
    * @version %I% %G%
@@ -92,9 +157,28 @@
     ArrayHandle<int> colInd;              // "
     ArrayHandle<double> bmatVals;
     ArrayHandle<double> betaVals,piVals;
+    bool isIdx64;                         // 64-bit index?
+    const int64_t* rowIndL,*colIndL;      // Only if 64-bit index
+    int64_t numNZ;                        // Number nonzeros
+    const double* bmatValP;               // Flat arrays
+    double* betaValP,*piValP;             // "
+    bool isFlt;                           // Single precision?
+    ArrayHandle<float> bmatValsF;         // Only if single precision
+    ArrayHandle<float> betaValsF,piValsF; // "
     int numK;                             // Number of precision variables
     ArrayHandle<double> aVals,cVals;      // Only if precision potentials
     ArrayHandle<int> tauInd;              // "
+    bool isPack;                          // Packed layout?
+    ArrayHandle<FactEPPackedEntry> rowPack; // Only in packed mode
+    ArrayHandle<int> colMirOff,colMirPos;   // "
+    ArrayHandle<int> rowMirPos;             // "
+    ArrayHandle<double> colMirB,colMirPi,colMirBeta; // "
+    int numMBase;                         // Potentials in flat arrays
+    ArrayHandle<int> extRowOff,extInd;    // Appended potentials
+    ArrayHandle<double> extB,extBeta,extPi; // "
+    ArrayHandle<int> extColHead,extColNext,extPot; // "
+    ArrayHandle<char> potRetired;         // Only if potentials retired
+    int numRetd;                          // Number retired potentials
 
   public:
     // Public methods
@@ -121,7 +205,10 @@
 			       const ArrayHandle<double>& pbetaVals,
 			       const ArrayHandle<double>& ppiVals) :
       numN(pnumN),numM(pnumM),rowInd(prowInd),colInd(pcolInd),
-      bmatVals(pbmatVals),betaVals(pbetaVals),piVals(ppiVals),numK(0)
+      bmatVals(pbmatVals),betaVals(pbetaVals),piVals(ppiVals),isIdx64(false),
+      rowIndL(0),colIndL(0),numNZ(pbmatVals.size()),bmatValP(pbmatVals.p()),
+      betaValP(pbetaVals.p()),piValP(ppiVals.p()),isFlt(false),numK(0),
+      isPack(false),numMBase(pnumM),numRetd(0)
     {
       checkInternalRepres(pnumN,pnumM,prowInd,pcolInd,pbmatVals,pbetaVals,
 			  ppiVals);
@@ -153,8 +240,11 @@
 			       const ArrayHandle<double>& pcVals,
 			       const ArrayHandle<int>& ptauInd) :
       numN(pnumN),numM(pnumM),rowInd(prowInd),colInd(pcolInd),
-      bmatVals(pbmatVals),betaVals(pbetaVals),piVals(ppiVals),aVals(paVals),
-      cVals(pcVals),tauInd(ptauInd)
+      bmatVals(pbmatVals),betaVals(pbetaVals),piVals(ppiVals),isIdx64(false),
+      rowIndL(0),colIndL(0),numNZ(pbmatVals.size()),bmatValP(pbmatVals.p()),
+      betaValP(pbetaVals.p()),piValP(ppiVals.p()),isFlt(false),aVals(paVals),
+      cVals(pcVals),tauInd(ptauInd),isPack(false),numMBase(pnumM),
+      numRetd(0)
     {
       checkInternalRepres(pnumN,pnumM,prowInd,pcolInd,pbmatVals,pbetaVals,
 			  ppiVals);
@@ -167,6 +257,69 @@
       numK=ptauInd[numBVPrec];
     }
 
+    /**
+     * Constructor (64-bit index, no bivariate precision potentials). Same
+     * checks as for the 32-bit index. Arrays are not copied, and they are
+     * not owned by this object. The caller must make sure they remain
+     * valid.
+     *
+     * @param pnumN     Number variables n
+     * @param pnumM     Number potentials m
+     * @param prowInd
+     * @param prowIndSz Size of 'prowInd'
+     * @param pcolInd
+     * @param pcolIndSz Size of 'pcolInd'
+     * @param pbmatVals
+     * @param pbetaVals
+     * @param ppiVals
+     * @param pnumNZ    Size of flat arrays (number nonzeros)
+     */
+    FactorizedEPRepresentation(int pnumN,int pnumM,const int64_t* prowInd,
+			       int64_t prowIndSz,const int64_t* pcolInd,
+			       int64_t pcolIndSz,const double* pbmatVals,
+			       double* pbetaVals,double* ppiVals,
+			       int64_t pnumNZ) :
+      numN(pnumN),numM(pnumM),isIdx64(true),rowIndL(prowInd),
+      colIndL(pcolInd),numNZ(pnumNZ),bmatValP(pbmatVals),betaValP(pbetaVals),
+      piValP(ppiVals),isFlt(false),numK(0),isPack(false),numMBase(pnumM),
+      numRetd(0)
+    {
+      if (prowInd==0 || pcolInd==0 || pbmatVals==0 || pbetaVals==0 ||
+	  ppiVals==0 || pnumNZ<=0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      checkIndex(prowInd,prowIndSz,pcolInd,pcolIndSz);
+    }
+
+    /**
+     * Constructor (single precision flat arrays, no bivariate precision
+     * potentials). Same as default constructor otherwise.
+     *
+     * @param pnumN     Number variables n
+     * @param pnumM     Number potentials m
+     * @param prowInd
+     * @param pcolInd
+     * @param pbmatVals
+     * @param pbetaVals
+     * @param ppiVals
+     */
+    FactorizedEPRepresentation(int pnumN,int pnumM,
+			       const ArrayHandle<int>& prowInd,
+			       const ArrayHandle<int>& pcolInd,
+			       const ArrayHandle<float>& pbmatVals,
+			       const ArrayHandle<float>& pbetaVals,
+			       const ArrayHandle<float>& ppiVals) :
+      numN(pnumN),numM(pnumM),rowInd(prowInd),colInd(pcolInd),isIdx64(false),
+      rowIndL(0),colIndL(0),numNZ(pbmatVals.size()),bmatValP(0),betaValP(0),
+      piValP(0),isFlt(true),bmatValsF(pbmatVals),betaValsF(pbetaVals),
+      piValsF(ppiVals),numK(0),isPack(false),numMBase(pnumM),numRetd(0)
+    {
+      int nnz=pbmatVals.size();
+
+      if (pbetaVals.size()!=nnz || ppiVals.size()!=nnz)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      checkIndex(prowInd.p(),prowInd.size(),pcolInd.p(),pcolInd.size());
+    }
+
   private:
     void checkInternalRepres(int pnumN,int pnumM,
 			     const ArrayHandle<int>& prowInd,
@@ -174,6 +327,101 @@
 			     const ArrayHandle<double>& pbmatVals,
 			     const ArrayHandle<double>& pbetaVals,
 			     const ArrayHandle<double>& ppiVals);
+
+    template<class I> void checkIndex(const I* prowInd,int64_t prowIndSz,
+				      const I* pcolInd,int64_t pcolIndSz) const;
+
+    void getIndex(const int*& riP,const int*& ciP) const {
+      riP=rowInd.p(); ciP=colInd.p();
+    }
+
+    void getIndex(const int64_t*& riP,const int64_t*& ciP) const {
+      riP=rowIndL; ciP=colIndL;
+    }
+
+    void getValues(const double*& bP,double*& betaP,double*& piP) const {
+      bP=bmatValP; betaP=betaValP; piP=piValP;
+    }
+
+    void getValues(const float*& bP,float*& betaP,float*& piP) const {
+      bP=bmatValsF.p(); betaP=betaValsF.p(); piP=piValsF.p();
+    }
+
+    template<class I,class V> int accessColT(int i,const I*& viInd,
+					     const I*& jiInd,const V*& bP,
+					     const V*& betaP,const V*& piP);
+
+    void colMirror(int i,const int*& jiInd,const double*& bP,
+		   const double*& betaP,const double*& piP);
+
+    template<class I,class V> void colMirror(int i,const I*& jiInd,
+					     const V*& bP,const V*& betaP,
+					     const V*& piP) {
+      // Packed layout only for 32-bit index, double precision
+      throw WrongStatusException(EXCEPT_MSG("Packed layout"));
+    }
+
+    template<class I,class V> void compMarginalT(int i,double& mBeta,
+						 double& mPi);
+
+    template<class I> int colorScheduleT(const int* updInd,int nupd,
+					 int* schedInd,int* batchOff);
+
+    template<class I> void markVariablesT(const int* ind,int num,char* mark,
+					  int* list,int& numList) const;
+
+    template<class I> void markPotentialsT(const int* ind,int num,
+					   int maxFanout,char* mark,int* list,
+					   int& numList) const;
+
+    /**
+     * Row access for appended potential j (see 'accessRowFast'). Only
+     * for 32-bit index, double precision. The offset returned is
+     * 'numNZ' plus the offset into the extension arrays.
+     */
+    int accessRowExt(int j,int& vjSz,const int*& vjInd,const double*& bP,
+		     double*& betaP,double*& piP) {
+      int off=extRowOff.p()[j-numMBase];
+
+      vjSz=extRowOff.p()[j-numMBase+1]-off;
+      vjInd=extInd.p()+off; bP=extB.p()+off;
+      betaP=extBeta.p()+off; piP=extPi.p()+off;
+
+      return ((int) numNZ)+off;
+    }
+
+    template<class I,class V> I accessRowExt(int j,int& vjSz,const I*& vjInd,
+					     const V*& bP,V*& betaP,V*& piP) {
+      // Appended potentials only for 32-bit index, double precision
+      throw WrongStatusException(EXCEPT_MSG("Appended potentials"));
+    }
+
+    void extRowIndex(int j,int& vjSz,const int*& vjInd) const {
+      int off=extRowOff[j-numMBase];
+
+      vjSz=extRowOff[j-numMBase+1]-off;
+      vjInd=extInd.p()+off;
+    }
+
+    template<class I> void extRowIndex(int j,int& vjSz,
+				       const I*& vjInd) const {
+      throw WrongStatusException(EXCEPT_MSG("Appended potentials"));
+    }
+
+    /**
+     * Ensures that 'arr' has size >= 'sz' (at least doubled if it has to
+     * grow). The first 'used' entries are retained.
+     */
+    template<class T> static void growArray(ArrayHandle<T>& arr,int sz,
+					    int used) {
+      if (arr.size()<sz) {
+	ArrayHandle<T> temp(std::max(sz,2*arr.size()));
+	if (used>0)
+	  std::copy(arr.p(),arr.p()+used,temp.p());
+	arr=temp;
+      }
+    }
+
   public:
 
     virtual ~FactorizedEPRepresentation() {}
@@ -194,9 +442,66 @@
       return numK;
     }
 
+    /**
+     * @return Number of potentials appended by 'appendPotentials'
+     */
+    int numAppended() const {
+      return numM-numMBase;
+    }
+
+    /**
+     * @return Number of potentials retired by 'markRetired'
+     */
+    int numRetired() const {
+      return numRetd;
+    }
+
+    /**
+     * @param j Potential index (not range-checked)
+     * @return  Has j been retired?
+     */
+    bool isRetired(int j) const {
+      return (numRetd>0 && potRetired.p()[j]!=0);
+    }
+
+    /**
+     * @return Number of nonzeros of B
+     */
+    int64_t numNonzeros() const {
+      return numNZ;
+    }
+
+    /**
+     * @return 64-bit index? See header comment
+     */
+    bool isIndex64() const {
+      return isIdx64;
+    }
+
+    /**
+     * @return Single precision flat arrays? See header comment
+     */
+    bool isSingle() const {
+      return isFlt;
+    }
+
+    /**
+     * @param j Potential index
+     * @return  Size |V_j|
+     */
+    int rowSize(int j) const {
+      if (j<0 || j>=numM) throw InvalidParameterException(EXCEPT_MSG(""));
+      if (j>=numMBase)
+	return extRowOff[j-numMBase+1]-extRowOff[j-numMBase];
+      return isIdx64?((int) (rowIndL[j+1]-rowIndL[j])):
+	(rowInd[j+1]-rowInd[j]);
+    }
+
     /**
      * Access to data for potential j.
      * NOTE: Use this for write access to EP parameters.
+     * NOTE: Not in packed mode, not for 64-bit index or single precision
+     * (see header comment).
      * The nonzeros of B(j,:) form a contiguous part in a flat array, same
      * for beta, pi. We return the start offset into this flat array for
      * j.
@@ -212,8 +517,101 @@
     virtual int accessRow(int j,int& vjSz,const int*& vjInd,const double*& bP,
 			  double*& betaP,double*& piP);
 
+    /**
+     * Same as 'accessRow', but not virtual and without range check on 'j'.
+     * For inner loops which have checked 'j' before (see
+     * 'FactorizedEPDriverSpec'). Not in packed mode.
+     * I must be 'int' for 32-bit, 'int64_t' for 64-bit index, V must be
+     * 'float' for single, 'double' for double precision (not checked).
+     */
+    template<class I,class V> I accessRowFast(int j,int& vjSz,
+					      const I*& vjInd,const V*& bP,
+					      V*& betaP,V*& piP) {
+      if (j>=numMBase)
+	return accessRowExt(j,vjSz,vjInd,bP,betaP,piP);
+      const I* riP,*ciP;
+      getIndex(riP,ciP);
+      getValues(bP,betaP,piP);
+      I jOff=riP[j];
+
+      vjSz=(int) (riP[j+1]-jOff);
+      bP+=jOff; betaP+=jOff; piP+=jOff;
+      vjInd=riP+(jOff+numMBase+1);
+
+      return jOff;
+    }
+
+    /**
+     * Packed mode only. Access to data for potential j, without range
+     * check on 'j'. Use this for write access to EP parameters.
+     *
+     * @param j    Potential index
+     * @param vjSz Size |V_j| ret. here
+     * @return     Entries for j
+     */
+    FactEPPackedEntry* accessRowPacked(int j,int& vjSz) {
+      const int* riP=rowInd.p();
+      int jOff=riP[j];
+
+      vjSz=riP[j+1]-jOff;
+      return rowPack.p()+jOff;
+    }
+
+    /**
+     * Same as above. Also returns the positions of the entries for j in
+     * the column-major mirror, and the mirror arrays for pi, beta. EP
+     * parameters must be written to both places.
+     *
+     * @param j      Potential index
+     * @param vjSz   Size |V_j| ret. here
+     * @param mPos   Positions in mirror ret. here
+     * @param mPiP   Mirror for pi ret. here
+     * @param mBetaP Mirror for beta ret. here
+     * @return       Entries for j
+     */
+    FactEPPackedEntry* accessRowPacked(int j,int& vjSz,const int*& mPos,
+				       double*& mPiP,double*& mBetaP) {
+      FactEPPackedEntry* entP=accessRowPacked(j,vjSz);
+
+      mPos=rowMirPos.p()+rowInd[j];
+      mPiP=colMirPi.p(); mBetaP=colMirBeta.p();
+      return entP;
+    }
+
+    /**
+     * @return Packed layout?
+     */
+    bool isPacked() const {
+      return isPack;
+    }
+
+    /**
+     * Switches to packed layout (see header comment). The EP parameters
+     * are copied from 'betaVals', 'piVals'. Nothing is done if already in
+     * packed mode. Not for 64-bit index or single precision.
+     */
+    void packLayout();
+
+    /**
+     * Switches back from packed layout, the EP parameters are copied to
+     * 'betaVals', 'piVals'. Nothing is done if not in packed mode.
+     */
+    void unpackLayout();
+
+    /**
+     * Packed mode: Copies EP parameters to 'betaVals', 'piVals', without
+     * leaving packed mode. Nothing is done if not in packed mode.
+     */
+    void syncFlat();
+
     /**
      * Access to data for variable i.
+     * In packed mode, the flat arrays are the column-major mirror, and
+     * 'jiInd' indexes into them (see header comment).
+     * NOTE: Not for 64-bit index or single precision, use the variants
+     * below then.
+     * NOTE: Entries of appended potentials are not included, see
+     * 'firstColExt'.
      *
      * @param i     Variable index
      * @param viInd Support index V_i
@@ -227,16 +625,98 @@
 			  const double*& bP,const double*& betaP,
 			  const double*& piP);
 
+    /**
+     * Same as 'accessCol', for 64-bit index only.
+     */
+    int accessCol(int i,const int64_t*& viInd,const int64_t*& jiInd,
+		  const double*& bP,const double*& betaP,const double*& piP);
+
+    /**
+     * Same as 'accessCol', for single precision only.
+     */
+    int accessCol(int i,const int*& viInd,const int*& jiInd,const float*& bP,
+		  const float*& betaP,const float*& piP);
+
+    /**
+     * Extension entries of column i (appended potentials, see header
+     * comment), as a chain of positions p:
+     *   for (p=firstColExt(i); p>=0; p=nextColExt(p)) ...
+     *
+     * @param i Variable index (not range-checked)
+     * @return  First position, or -1 if there are none
+     */
+    int firstColExt(int i) const {
+      return (numM>numMBase)?extColHead.p()[i]:-1;
+    }
+
+    /**
+     * @param p Position
+     * @return  Next position in the chain, or -1
+     */
+    int nextColExt(int p) const {
+      return extColNext.p()[p];
+    }
+
+    /**
+     * @param p     Position (see 'firstColExt')
+     * @param bval  b_ji ret. here
+     * @param beta  beta_ji ret. here
+     * @param pi    pi_ji ret. here
+     * @return      Potential index j
+     */
+    int colExtEntry(int p,double& bval,double& beta,double& pi) const {
+      bval=extB.p()[p]; beta=extBeta.p()[p]; pi=extPi.p()[p];
+      return extPot.p()[p];
+    }
+
+    /**
+     * Appends potentials m,...,m+'num'-1 (see header comment). Potential
+     * m+k has support index V_{m+k} in 'pind[prowOff[k]:(prowOff[k+1]-1)]'
+     * (ascending, not empty), with B values in 'pbvals' at the same
+     * positions. Their EP parameters are set to zero, so the marginals
+     * do not change. Arrays are copied.
+     *
+     * @param num     Number of new potentials
+     * @param prowOff Row offsets (size 'num'+1, 'prowOff[0]'==0)
+     * @param pind    Support indexes V_j, concatenated
+     * @param pbvals  B values, concatenated
+     * @return        Index m of first new potential
+     */
+    int appendPotentials(int num,const int* prowOff,const int* pind,
+			 const double* pbvals);
+
+    /**
+     * Flags potential j as retired (see header comment). Nothing is done
+     * if it is already.
+     *
+     * @param j Potential index
+     */
+    void markRetired(int j);
+
+    /**
+     * Computes Gaussian marginal for variable i from 'betaVals', 'piVals'.
+     * Concurrent calls for different i are fine.
+     *
+     * @param i     Variable index
+     * @param mBeta Marginal par. beta ret. here
+     * @param mPi   Marginal par. pi ret. here
+     */
+    void compMarginal(int i,double& mBeta,double& mPi);
+
     /**
      * Compute Gaussian marginals on variables from 'betaVals', 'piVals'.
      * If 'increm'==true, the marginals are added to 'margBeta', 'margPi'.
+     * If 'numThr'>1, columns are distributed over this many threads (in
+     * packed mode, the column pass is used then instead of the row pass).
+     * Results do not depend on 'numThr'.
      *
      * @param margBeta Marginal pars. beta ret. here
      * @param margPi   Marginal pars. pi ret. here
      * @param increm   Incremental? Def.: false
+     * @param numThr   Number of threads. Def.: 1
      */
     virtual void compMarginals(double* margBeta,double* margPi,
-			       bool increm=false);
+			       bool increm=false,int numThr=1);
 
     /**
      * Only if bivar. prec. potentials.
@@ -275,10 +755,79 @@
      * @param margA  Marginal pars. a ret. here
      * @param margC  Marginal pars. c ret. here
      * @param increm Incremental? Def.: false
+     * @param numThr Number of threads (see 'compMarginals'). Def.: 1
      */
     virtual void compTauMarginals(double* margA,double* margC,
-				  bool increm=false);
-    
+				  bool increm=false,int numThr=1);
+
+    /**
+     * Partitions the potentials in 'updInd' into batches, so that no two
+     * potentials within a batch share a variable x_i (or, for bivariate
+     * precision potentials, a precision variable tau_k). EP updates on
+     * the potentials of one batch can then be done in parallel.
+     * The potentials are written to 'schedInd', batch after batch. Batch
+     * b is 'schedInd[batchOff[b]:(batchOff[b+1]-1)]'.
+     * Greedy coloring in one pass over 'updInd': the batch of j is the
+     * smallest one larger than the batches of all potentials before j
+     * in 'updInd' which share a variable with j. Within a batch, the
+     * ordering of 'updInd' is retained. Therefore, sequential updates
+     * in the order of 'schedInd' give the same result as in the order
+     * of 'updInd'.
+     * NOTE: Potentials in 'updInd' may appear several times.
+     *
+     * @param updInd   Potential indexes
+     * @param nupd     Size of 'updInd'
+     * @param schedInd Batches ret. here. Size 'nupd'
+     * @param batchOff Batch offsets ret. here. Size >= 'nupd'+1
+     * @return         Number of batches
+     */
+    virtual int colorSchedule(const int* updInd,int nupd,int* schedInd,
+			      int* batchOff);
+
+    /**
+     * Marks all variables i in V_j, j in 'ind': 'mark[i]' is set to 1.
+     * Variables not marked before are appended to 'list' (starting at
+     * position 'numList', which is increased accordingly). The cost is
+     * proportional to the number of nonzeros in the rows of 'ind', not
+     * to n. Used for dirty tracking of marginals.
+     *
+     * @param ind     Potential indexes
+     * @param num     Size of 'ind'
+     * @param mark    Marks [n]
+     * @param list    Newly marked variables appended here. Size n
+     * @param numList S.a.
+     */
+    void markVariables(const int* ind,int num,char* mark,int* list,
+		       int& numList) const {
+      if (isIdx64)
+	markVariablesT<int64_t>(ind,num,mark,list,numList);
+      else
+	markVariablesT<int>(ind,num,mark,list,numList);
+    }
+
+    /**
+     * Marks all potentials j with i in V_j, i in 'ind' (inverse of
+     * 'markVariables'): 'mark[j]' is set to 1, and newly marked
+     * potentials are appended to 'list' (starting at position 'numList',
+     * which is increased accordingly). Variables i with |V_i| >
+     * 'maxFanout' are skipped (unless 'maxFanout'==0). The cost is
+     * proportional to the sum of |V_i| over the variables not skipped.
+     * Used for residual scheduling (see 'FactorizedEPDriver::runSweeps').
+     *
+     * @param ind       Variable indexes
+     * @param num       Size of 'ind'
+     * @param maxFanout S.a. 0: No limit
+     * @param mark      Marks [m]
+     * @param list      Newly marked potentials appended here. Size m
+     * @param numList   S.a.
+     */
+    void markPotentials(const int* ind,int num,int maxFanout,char* mark,
+			int* list,int& numList) const {
+      if (isIdx64)
+	markPotentialsT<int64_t>(ind,num,maxFanout,mark,list,numList);
+      else
+	markPotentialsT<int>(ind,num,maxFanout,mark,list,numList);
+    }
   };
 
   // Inline methods
@@ -286,29 +835,40 @@
   inline  void
   FactorizedEPRepresentation::checkInternalRepres(int pnumN,int pnumM,const ArrayHandle<int>& prowInd,const ArrayHandle<int>& pcolInd,const ArrayHandle<double>& pbmatVals,const ArrayHandle<double>& pbetaVals,const ArrayHandle<double>& ppiVals)
   {
-    int j,sz,off,nnz=pbmatVals.size();
+    int nnz=pbmatVals.size();
 
-    if (pnumN==0 || pnumM==0 || pbetaVals.size()!=nnz ||
-	ppiVals.size()!=nnz || prowInd.size()<=pnumM+1 ||
-	pcolInd.size()<=pnumN+1)
+    if (pbetaVals.size()!=nnz || ppiVals.size()!=nnz)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    checkIndex(prowInd.p(),prowInd.size(),pcolInd.p(),pcolInd.size());
+  }
+
+  template<class I> inline void
+  FactorizedEPRepresentation::checkIndex(const I* prowInd,int64_t prowIndSz,
+					 const I* pcolInd,int64_t pcolIndSz)
+    const
+  {
+    int j;
+    I sz,off;
+
+    if (numN==0 || numM==0 || prowIndSz<=numM+1 || pcolIndSz<=numN+1)
       throw InvalidParameterException(EXCEPT_MSG(""));
     // Run some basic checks
-    if (prowInd[pnumM]!=nnz || prowInd[0]!=0)
+    if (prowInd[numM]!=numNZ || prowInd[0]!=0)
       throw InvalidParameterException(EXCEPT_MSG(""));
-    for (j=0; j<pnumM; j++) {
+    for (j=0; j<numM; j++) {
       off=prowInd[j]; sz=prowInd[j+1]-off;
       // NOTE: Zero rows are not allowed!
-      if (sz<=0 || sz>pnumN)
+      if (sz<=0 || sz>numN)
 	throw InvalidParameterException(EXCEPT_MSG(""));
     }
-    if (pcolInd[pnumN]!=2*nnz+pnumN+1 || pcolInd[0]!=pnumN+1)
-      for (j=0; j<pnumN; j++) {
+    if (pcolInd[numN]!=2*numNZ+numN+1 || pcolInd[0]!=numN+1)
+      for (j=0; j<numN; j++) {
 	off=pcolInd[j]; sz=pcolInd[j+1]-off;
 	if (sz%2==1)
 	  throw InvalidParameterException(EXCEPT_MSG(""));
 	sz/=2;
 	// NOTE: Zero columns are allowed
-	if (sz<0 || sz>pnumM)
+	if (sz<0 || sz>numM)
 	  throw InvalidParameterException(EXCEPT_MSG(""));
       }
   }
@@ -318,16 +878,12 @@
 					const double*& bP,double*& betaP,
 					double*& piP)
   {
-    int jOff;
-
     if (j<0 || j>=numM) throw InvalidParameterException(EXCEPT_MSG(""));
-    jOff=rowInd[j];
-    vjSz=rowInd[j+1]-jOff;
-    bP=bmatVals.p()+jOff;
-    betaP=betaVals.p()+jOff; piP=piVals.p()+jOff;
-    vjInd=rowInd.p()+(jOff+numM+1);
+    if (isPack) throw WrongStatusException(EXCEPT_MSG("Packed layout"));
+    if (isIdx64) throw WrongStatusException(EXCEPT_MSG("64-bit index"));
+    if (isFlt) throw WrongStatusException(EXCEPT_MSG("Single precision"));
 
-    return jOff;
+    return accessRowFast(j,vjSz,vjInd,bP,betaP,piP);
   }
 
   inline int
@@ -335,34 +891,132 @@
 					const int*& jiInd,const double*& bP,
 					const double*& betaP,const double*& piP)
   {
-    int iOff,viSz;
+    if (isIdx64) throw WrongStatusException(EXCEPT_MSG("64-bit index"));
+    if (isFlt) throw WrongStatusException(EXCEPT_MSG("Single precision"));
+
+    return accessColT(i,viInd,jiInd,bP,betaP,piP);
+  }
+
+  inline int
+  FactorizedEPRepresentation::accessCol(int i,const int64_t*& viInd,
+					const int64_t*& jiInd,
+					const double*& bP,const double*& betaP,
+					const double*& piP)
+  {
+    if (!isIdx64) throw WrongStatusException(EXCEPT_MSG("32-bit index"));
+
+    return accessColT(i,viInd,jiInd,bP,betaP,piP);
+  }
+
+  inline int
+  FactorizedEPRepresentation::accessCol(int i,const int*& viInd,
+					const int*& jiInd,const float*& bP,
+					const float*& betaP,const float*& piP)
+  {
+    if (!isFlt) throw WrongStatusException(EXCEPT_MSG("Double precision"));
+
+    return accessColT(i,viInd,jiInd,bP,betaP,piP);
+  }
+
+  template<class I,class V> inline int
+  FactorizedEPRepresentation::accessColT(int i,const I*& viInd,
+					 const I*& jiInd,const V*& bP,
+					 const V*& betaP,const V*& piP)
+  {
+    int viSz;
+    I iOff;
+    const I* riP,*ciP;
 
     if (i<0 || i>=numN) throw InvalidParameterException(EXCEPT_MSG(""));
-    iOff=colInd[i];
-    viSz=(colInd[i+1]-iOff)>>1;
-    viInd=colInd.p()+iOff;
-    jiInd=colInd.p()+(iOff+viSz);
-    bP=bmatVals.p();
-    betaP=betaVals.p(); piP=piVals.p();
+    getIndex(riP,ciP);
+    iOff=ciP[i];
+    viSz=(int) ((ciP[i+1]-iOff)>>1);
+    viInd=ciP+iOff;
+    jiInd=ciP+(iOff+viSz);
+    if (!isPack) {
+      V* wbetaP,*wpiP;
+      getValues(bP,wbetaP,wpiP);
+      betaP=wbetaP; piP=wpiP;
+    } else
+      colMirror(i,jiInd,bP,betaP,piP);
 
     return viSz;
   }
 
+  /*
+   * Column i of mirror (packed layout)
+   */
+  inline void
+  FactorizedEPRepresentation::colMirror(int i,const int*& jiInd,
+					const double*& bP,const double*& betaP,
+					const double*& piP)
+  {
+    jiInd=colMirPos.p()+colMirOff[i];
+    bP=colMirB.p();
+    betaP=colMirBeta.p(); piP=colMirPi.p();
+  }
+
+  inline void
+  FactorizedEPRepresentation::compMarginal(int i,double& mBeta,double& mPi)
+  {
+    if (isIdx64)
+      compMarginalT<int64_t,double>(i,mBeta,mPi);
+    else if (isFlt)
+      compMarginalT<int,float>(i,mBeta,mPi);
+    else
+      compMarginalT<int,double>(i,mBeta,mPi);
+  }
+
+  template<class I,class V> inline void
+  FactorizedEPRepresentation::compMarginalT(int i,double& mBeta,double& mPi)
+  {
+    int j,viSz;
+    const I* viInd,*jiInd;
+    const V* bP,*betaP,*piP;
+
+    viSz=accessColT(i,viInd,jiInd,bP,betaP,piP);
+    for (j=0,mBeta=mPi=0.0; j<viSz; j++) {
+      mPi+=piP[jiInd[j]]; mBeta+=betaP[jiInd[j]];
+    }
+    for (j=firstColExt(i); j>=0; j=extColNext.p()[j]) {
+      mPi+=extPi.p()[j]; mBeta+=extBeta.p()[j];
+    }
+  }
+
   inline void
   FactorizedEPRepresentation::compMarginals(double* margBeta,double* margPi,
-					    bool increm)
+					    bool increm,int numThr)
   {
-    int i,j,jj,viSz;
+    int i;
     double mBeta,mPi;
-    const double* bP,*betaP,*piP;
-    const int* viInd,*jiInd;
-
-    for (i=0; i<numVariables(); i++) {
-      viSz=accessCol(i,viInd,jiInd,bP,betaP,piP);
-      for (j=0,mBeta=mPi=0.0; j<viSz; j++) {
-	jj=jiInd[j];
-	mPi+=piP[jj]; mBeta+=betaP[jj];
+
+    if (isPack && numThr<=1) {
+      // Row order: for each i, the same summation order as below
+      const FactEPPackedEntry* entP=rowPack.p();
+      int k,nnz=rowPack.size();
+      double* accBeta=margBeta,*accPi=margPi;
+      ArrayHandle<double> tmpAcc;
+      if (increm) {
+	tmpAcc.changeRep(2*numN);
+	accBeta=tmpAcc.p(); accPi=accBeta+numN;
+      }
+      std::fill(accBeta,accBeta+numN,0.0);
+      std::fill(accPi,accPi+numN,0.0);
+      for (k=0; k<nnz; k++,entP++) {
+	accPi[entP->ind]+=entP->pi; accBeta[entP->ind]+=entP->beta;
       }
+      if (increm)
+	for (i=0; i<numN; i++) {
+	  margPi[i]+=accPi[i]; margBeta[i]+=accBeta[i];
+	}
+      return;
+    }
+    // 'compMarginal' for different i can run concurrently
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,64) num_threads(std::max(numThr,1)) private(mBeta,mPi) if(numThr>1)
+#endif
+    for (i=0; i<numN; i++) {
+      compMarginal(i,mBeta,mPi);
       if (!increm) {
 	margPi[i]=mPi; margBeta[i]=mBeta;
       } else {
@@ -401,13 +1055,16 @@
 
   inline void
   FactorizedEPRepresentation::compTauMarginals(double* margA,double* margC,
-					       bool increm)
+					       bool increm,int numThr)
   {
     int k,j,jj,sz;
     double mA,mC;
     const double* aP,*cP;
     const int* jInd;
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,64) num_threads(std::max(numThr,1)) private(j,jj,sz,mA,mC,aP,cP,jInd) if(numThr>1)
+#endif
     for (k=0; k<numK; k++) {
       sz=accessTauCol(k,jInd,aP,cP);
       for (j=0,mA=mC=0.0; j<sz; j++) {
@@ -421,6 +1078,257 @@
       }
     }
   }
+
+  template<class I> inline void
+  FactorizedEPRepresentation::markVariablesT(const int* ind,int num,
+					     char* mark,int* list,
+					     int& numList) const
+  {
+    int p,j,ii,i,vjSz;
+    const I* vjInd,*riP,*ciP;
+
+    getIndex(riP,ciP);
+    for (p=0; p<num; p++) {
+      j=ind[p];
+      if (j<0 || j>=numM) throw InvalidParameterException(EXCEPT_MSG(""));
+      if (j<numMBase) {
+	vjSz=(int) (riP[j+1]-riP[j]);
+	vjInd=riP+(riP[j]+numMBase+1);
+      } else
+	extRowIndex(j,vjSz,vjInd);
+      for (ii=0; ii<vjSz; ii++)
+	if (mark[i=(int) vjInd[ii]]==0) {
+	  mark[i]=1; list[numList++]=i;
+	}
+    }
+  }
+
+  /*
+   * Potentials of appended entries of column i are reached via the
+   * chain of extension entries ('firstColExt').
+   */
+  template<class I> inline void
+  FactorizedEPRepresentation::markPotentialsT(const int* ind,int num,
+					      int maxFanout,char* mark,
+					      int* list,int& numList) const
+  {
+    int q,i,j,p,viSz;
+    const I* viInd,*riP,*ciP;
+    double bval,beta,pi;
+
+    if (maxFanout<0) throw InvalidParameterException(EXCEPT_MSG(""));
+    getIndex(riP,ciP);
+    for (q=0; q<num; q++) {
+      i=ind[q];
+      if (i<0 || i>=numN) throw InvalidParameterException(EXCEPT_MSG(""));
+      viSz=(int) ((ciP[i+1]-ciP[i])>>1);
+      if (maxFanout>0 && viSz>maxFanout)
+	continue;
+      viInd=ciP+ciP[i];
+      for (p=0; p<viSz; p++)
+	if (mark[j=(int) viInd[p]]==0) {
+	  mark[j]=1; list[numList++]=j;
+	}
+      for (p=firstColExt(i); p>=0; p=nextColExt(p))
+	if (mark[j=colExtEntry(p,bval,beta,pi)]==0) {
+	  mark[j]=1; list[numList++]=j;
+	}
+    }
+  }
+
+  /*
+   * 'nextBatch[i]' is the smallest batch which does not contain a
+   * potential touching variable i so far. Precision variables tau_k have
+   * entries 'numN+k'.
+   */
+  inline int
+  FactorizedEPRepresentation::colorSchedule(const int* updInd,int nupd,
+					    int* schedInd,int* batchOff)
+  {
+    if (isIdx64)
+      return colorScheduleT<int64_t>(updInd,nupd,schedInd,batchOff);
+
+    return colorScheduleT<int>(updInd,nupd,schedInd,batchOff);
+  }
+
+  template<class I> inline int
+  FactorizedEPRepresentation::colorScheduleT(const int* updInd,int nupd,
+					     int* schedInd,int* batchOff)
+  {
+    int p,j,ii,k,b,vjSz,numB=0,startPos=numM-aVals.size();
+    const I* vjInd,*riP,*ciP;
+    double* aP,*cP;
+
+    if (nupd<=0) throw InvalidParameterException(EXCEPT_MSG(""));
+    getIndex(riP,ciP);
+    ArrayHandle<int> nextBatch(numN+numK),potBatch(nupd);
+    std::fill(nextBatch.p(),nextBatch.p()+(numN+numK),0);
+    for (p=0; p<nupd; p++) {
+      j=updInd[p];
+      if (j<0 || j>=numM) throw InvalidParameterException(EXCEPT_MSG(""));
+      if (j<numMBase) {
+	vjSz=(int) (riP[j+1]-riP[j]);
+	vjInd=riP+(riP[j]+numMBase+1);
+      } else
+	extRowIndex(j,vjSz,vjInd);
+      for (ii=0,b=0; ii<vjSz; ii++)
+	b=std::max(b,nextBatch[(int) vjInd[ii]]);
+      if (j>=startPos) {
+	k=numN+accessTauRow(j,aP,cP);
+	b=std::max(b,nextBatch[k]);
+	nextBatch[k]=b+1;
+      }
+      for (ii=0; ii<vjSz; ii++)
+	nextBatch[(int) vjInd[ii]]=b+1;
+      potBatch[p]=b;
+      numB=std::max(numB,b+1);
+    }
+    // Stable counting sort w.r.t. batch number
+    std::fill(batchOff,batchOff+(numB+1),0);
+    for (p=0; p<nupd; p++)
+      batchOff[potBatch[p]+1]++;
+    for (b=0; b<numB; b++)
+      batchOff[b+1]+=batchOff[b];
+    nextBatch.changeRep(numB); // Insert positions
+    std::copy(batchOff,batchOff+numB,nextBatch.p());
+    for (p=0; p<nupd; p++)
+      schedInd[nextBatch[potBatch[p]]++]=updInd[p];
+
+    return numB;
+  }
+
+  inline void
+  FactorizedEPRepresentation::packLayout()
+  {
+    int i,k,viSz,off,nnz=(int) numNZ;
+    const int* vjInd=rowInd.p()+(numMBase+1);
+    const int* jiInd;
+    const double* bP=bmatValP,*piP=piValP,*betaP=betaValP;
+    FactEPPackedEntry* entP;
+
+    if (isPack) return;
+    if (isIdx64) throw WrongStatusException(EXCEPT_MSG("64-bit index"));
+    if (isFlt) throw WrongStatusException(EXCEPT_MSG("Single precision"));
+    if (numM>numMBase)
+      throw WrongStatusException(EXCEPT_MSG("Appended potentials"));
+    rowPack.changeRep(nnz);
+    for (k=0,entP=rowPack.p(); k<nnz; k++,entP++) {
+      entP->ind=vjInd[k]; entP->bval=bP[k];
+      entP->pi=piP[k]; entP->beta=betaP[k];
+    }
+    colMirOff.changeRep(numN+1); colMirPos.changeRep(nnz);
+    rowMirPos.changeRep(nnz);
+    colMirB.changeRep(nnz); colMirPi.changeRep(nnz);
+    colMirBeta.changeRep(nnz);
+    for (i=off=0; i<numN; i++) {
+      colMirOff[i]=off;
+      viSz=(colInd[i+1]-colInd[i])>>1;
+      jiInd=colInd.p()+(colInd[i]+viSz);
+      for (k=0; k<viSz; k++,off++) {
+	colMirPos[off]=off; rowMirPos[jiInd[k]]=off;
+	colMirB[off]=bP[jiInd[k]];
+	colMirPi[off]=piP[jiInd[k]]; colMirBeta[off]=betaP[jiInd[k]];
+      }
+    }
+    colMirOff[numN]=off;
+    isPack=true;
+  }
+
+  inline void
+  FactorizedEPRepresentation::syncFlat()
+  {
+    int k,nnz=rowPack.size();
+    const FactEPPackedEntry* entP=rowPack.p();
+    double* piP=piValP,*betaP=betaValP;
+
+    if (!isPack) return;
+    for (k=0; k<nnz; k++,entP++) {
+      piP[k]=entP->pi; betaP[k]=entP->beta;
+    }
+  }
+
+  inline void
+  FactorizedEPRepresentation::unpackLayout()
+  {
+    if (!isPack) return;
+    syncFlat();
+    isPack=false;
+    rowPack.changeRep(0); colMirOff.changeRep(0); colMirPos.changeRep(0);
+    rowMirPos.changeRep(0);
+    colMirB.changeRep(0); colMirPi.changeRep(0); colMirBeta.changeRep(0);
+  }
+
+  /*
+   * Extension arrays grow by doubling, so appending is amortized linear
+   * in the number of new nonzeros. New entries are put in front of the
+   * column chains.
+   */
+  inline int
+  FactorizedEPRepresentation::appendPotentials(int num,const int* prowOff,
+					       const int* pind,
+					       const double* pbvals)
+  {
+    int k,ii,i,p,sz,numE=numM-numMBase,nnzE,nnzA,ret=numM;
+
+    if (isIdx64) throw WrongStatusException(EXCEPT_MSG("64-bit index"));
+    if (isFlt) throw WrongStatusException(EXCEPT_MSG("Single precision"));
+    if (isPack) throw WrongStatusException(EXCEPT_MSG("Packed layout"));
+    if (numK>0)
+      throw WrongStatusException(EXCEPT_MSG("Bivariate precision potentials"));
+    if (num<=0 || prowOff==0 || pind==0 || pbvals==0 || prowOff[0]!=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    for (k=0; k<num; k++) {
+      sz=prowOff[k+1]-prowOff[k];
+      // NOTE: Zero rows are not allowed!
+      if (sz<=0 || sz>numN)
+	throw InvalidParameterException(EXCEPT_MSG("prowOff: Invalid row size"));
+      for (ii=prowOff[k]; ii<prowOff[k+1]; ii++)
+	if (pind[ii]<0 || pind[ii]>=numN ||
+	    (ii>prowOff[k] && pind[ii]<=pind[ii-1]))
+	  throw InvalidParameterException(EXCEPT_MSG("pind: Out of range or not ascending"));
+    }
+    nnzA=prowOff[num];
+    if (numE==0) {
+      extRowOff.changeRep(num+1); extRowOff[0]=0;
+      extColHead.changeRep(numN);
+      std::fill(extColHead.p(),extColHead.p()+numN,-1);
+    }
+    nnzE=extRowOff[numE];
+    growArray(extRowOff,numE+num+1,numE+1);
+    growArray(extInd,nnzE+nnzA,nnzE); growArray(extB,nnzE+nnzA,nnzE);
+    growArray(extBeta,nnzE+nnzA,nnzE); growArray(extPi,nnzE+nnzA,nnzE);
+    growArray(extColNext,nnzE+nnzA,nnzE); growArray(extPot,nnzE+nnzA,nnzE);
+    for (k=0,p=nnzE; k<num; k++) {
+      for (ii=prowOff[k]; ii<prowOff[k+1]; ii++,p++) {
+	i=pind[ii];
+	extInd[p]=i; extB[p]=pbvals[ii];
+	extBeta[p]=extPi[p]=0.0;
+	extPot[p]=numM+k;
+	extColNext[p]=extColHead[i]; extColHead[i]=p;
+      }
+      extRowOff[numE+k+1]=p;
+    }
+    if (potRetired.size()>0) {
+      growArray(potRetired,numM+num,numM);
+      std::fill(potRetired.p()+numM,potRetired.p()+(numM+num),0);
+    }
+    numM+=num;
+
+    return ret;
+  }
+
+  inline void
+  FactorizedEPRepresentation::markRetired(int j)
+  {
+    if (j<0 || j>=numM) throw InvalidParameterException(EXCEPT_MSG(""));
+    if (potRetired.size()<numM) {
+      potRetired.changeRep(numM);
+      std::fill(potRetired.p(),potRetired.p()+numM,0);
+    }
+    if (potRetired[j]==0) {
+      potRetired[j]=1; numRetd++;
+    }
+  }
 //ENDNS
 
 #endif
@@ -0,0 +1,146 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Definition of class FactorizedEPSession
+ * ------------------------------------------------------------------- */
+
+#include "src/eptools/FactorizedEPSession.h"
+
+//BEGINNS(eptools)
+  const int FactorizedEPSession::modeSequential;
+  const int FactorizedEPSession::modeColored;
+  const int FactorizedEPSession::modeParallel;
+  const int FactorizedEPSession::modeAsync;
+  const int FactorizedEPSession::modeResidual;
+
+  /*
+   * 'modeColored': Return arguments of 'coloredSweep' are w.r.t. the
+   * batch ordering 'schedInd' and have to be permuted back. Potentials
+   * may appear several times in 'updInd', but their occurrences are in
+   * the same order in 'schedInd' (the coloring is stable, and
+   * occurrences of the same potential end up in different batches). We
+   * chain the positions of each potential in 'schedInd' ('schedNext',
+   * heads in the first 'numM' entries) and consume them in the ordering
+   * of 'updInd'.
+   */
+  void FactorizedEPSession::runUpdates(const int* updInd,int nupd,
+				       double dampFact,int mode,int* rstat,
+				       double* delta,double* effDamp)
+  {
+    int p,q,j,irstat,numM=epDriver->numPotentials();
+
+    if (nupd<=0 || dampFact<0.0 || dampFact>=1.0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    if (!(epMaxPi==0))
+      epMaxPi->resetStats();
+    if (mode==modeSequential) {
+      for (p=0; p<nupd; p++) {
+	irstat=epDriver->sequentialUpdate(updInd[p],dampFact,
+					  (delta!=0)?(delta+p):0,
+					  (effDamp!=0)?(effDamp+p):0);
+	if (rstat!=0) rstat[p]=irstat;
+	if (irstat!=FactorizedEPDriver::updSuccess) {
+	  if (delta!=0) delta[p]=0.0;
+	  if (effDamp!=0) effDamp[p]=1.0;
+	}
+      }
+    } else if (mode==modeColored) {
+      if (schedInd.size()<nupd) {
+	schedInd.changeRep(nupd); schedRstat.changeRep(nupd);
+	schedDelta.changeRep(nupd); schedDamp.changeRep(nupd);
+      }
+      if (schedNext.size()<numM+nupd)
+	schedNext.changeRep(numM+nupd);
+      epDriver->coloredSweep(updInd,nupd,schedInd.p(),dampFact,
+			     schedRstat.p(),schedDelta.p(),schedDamp.p());
+      int* headP=schedNext.p();
+      int* nextP=headP+numM;
+      for (q=0; q<nupd; q++)
+	headP[schedInd[q]]=-1;
+      for (q=nupd-1; q>=0; q--) {
+	j=schedInd[q];
+	nextP[q]=headP[j]; headP[j]=q;
+      }
+      for (p=0; p<nupd; p++) {
+	j=updInd[p];
+	q=headP[j]; headP[j]=nextP[q];
+	if (rstat!=0) rstat[p]=schedRstat[q];
+	if (delta!=0) delta[p]=schedDelta[q];
+	if (effDamp!=0) effDamp[p]=schedDamp[q];
+      }
+    } else if (mode==modeParallel)
+      epDriver->parallelSweep(updInd,nupd,dampFact,rstat,delta,effDamp);
+    else if (mode==modeAsync) {
+      if (effDamp!=0)
+	throw InvalidParameterException(EXCEPT_MSG("effDamp not supported for modeAsync"));
+      epDriver->asyncSweep(updInd,nupd,dampFact,rstat,delta);
+    } else
+      throw InvalidParameterException(EXCEPT_MSG("mode: Unknown"));
+    if (epMaxPiHeap!=0)
+      epMaxPiHeap->syncTopLists();
+  }
+
+  void FactorizedEPSession::setPotentialTypes(const int* ppotIds,
+					      const int* pnumPot,int nb)
+  {
+    if (nb<=0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    potIds.changeRep(nb); numPot.changeRep(nb);
+    std::copy(ppotIds,ppotIds+nb,potIds.p());
+    std::copy(pnumPot,pnumPot+nb,numPot.p());
+  }
+
+  int FactorizedEPSession::appendPotentials(const Handle<PotentialManager>& ppots,
+					    const int* ppotIds,
+					    const int* pnumPot,int nb,int num,
+					    const int* prowOff,const int* pind,
+					    const double* pbvals,
+					    const double* pbeta,const double* ppi)
+  {
+    int b,sz,ret;
+
+    if (nb<=0 || ppotIds==0 || pnumPot==0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    for (b=sz=0; b<nb; b++)
+      sz+=pnumPot[b];
+    if (sz!=num)
+      throw InvalidParameterException(EXCEPT_MSG("pnumPot: Wrong sizes"));
+    if (epMaxPiHeap!=0)
+      throw WrongStatusException(EXCEPT_MSG("Not supported with FactEPMaximumPiHeap"));
+    ret=epDriver->appendPotentials(ppots,num,prowOff,pind,pbvals,pbeta,ppi);
+    if (potIds.size()>0) {
+      int nold=potIds.size();
+      ArrayHandle<int> newIds(nold+nb),newNum(nold+nb);
+      std::copy(potIds.p(),potIds.p()+nold,newIds.p());
+      std::copy(numPot.p(),numPot.p()+nold,newNum.p());
+      std::copy(ppotIds,ppotIds+nb,newIds.p()+nold);
+      std::copy(pnumPot,pnumPot+nb,newNum.p()+nold);
+      potIds=newIds; numPot=newNum;
+    }
+
+    return ret;
+  }
+
+  int FactorizedEPSession::runSweeps(int maxIt,double deltaEps,
+				     double dampFact,
+				     const FactEPSweepOptions& opts,
+				     FactEPSweepStats& stats)
+  {
+    int ret;
+
+    if (!(epMaxPi==0))
+      epMaxPi->resetStats();
+    if (opts.potIds.size()==0 && potIds.size()>0) {
+      FactEPSweepOptions topts(opts);
+      topts.potIds=potIds; topts.numPot=numPot;
+      ret=epDriver->runSweeps(maxIt,deltaEps,dampFact,topts,stats);
+    } else
+      ret=epDriver->runSweeps(maxIt,deltaEps,dampFact,opts,stats);
+    if (epMaxPiHeap!=0)
+      epMaxPiHeap->syncTopLists();
+
+    return ret;
+  }
+//ENDNS
@@ -0,0 +1,212 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class FactorizedEPSession
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_FACTORIZEDEPSESSION_H
+#define EPTOOLS_FACTORIZEDEPSESSION_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/FactorizedEPDriver.h"
+#include "src/eptools/FactEPMaximumPiHeap.h"
+
+//BEGINNS(eptools)
+  /**
+   * Persistent state for EP with factorized backbone, to be kept between
+   * calls from Matlab/Python (see EPTWRAP_FACT_SESSION_CREATE). Without
+   * it, each call has to create the potential manager, the
+   * representation, the selective damping structure ('epMaxPi') and the
+   * driver from scratch, which dominates the running time if updates are
+   * run in small batches.
+   * <p>
+   * The session consists of a 'FactorizedEPDriver' (which maintains the
+   * other objects) and 'epMaxPi' (optional). All arrays are referred to,
+   * not copied (see 'FactorizedEPRepresentation'), so they must not be
+   * deallocated or moved while the session exists. If the selective
+   * damping representation is recomputed, a new session is required.
+   * <p>
+   * If 'epMaxPi' is a 'FactEPMaximumPiHeap', its heaps persist between
+   * calls. Its top-K lists are written back at the end of 'runUpdates',
+   * 'runSweeps' (for variables changed in the call), so the arrays
+   * passed by the caller are up to date in between. 'appendPotentials'
+   * is not supported then.
+   * <p>
+   * 'runUpdates' runs EP updates in one of several modes (see
+   * 'FactorizedEPDriver'):
+   * - modeSequential: 'sequentialUpdate', in the ordering given
+   * - modeColored:    'coloredSweep'. Same results as 'modeSequential'
+   * - modeParallel:   'parallelSweep'
+   * - modeAsync:      'asyncSweep'
+   * Threads are given by 'FactorizedEPDriver::setThreadPotentials'.
+   * <p>
+   * 'runSweeps' runs complete sweeps until convergence (see
+   * 'FactorizedEPDriver::runSweeps'). Potential types (for filtering) are
+   * given by 'setPotentialTypes'. In addition to the modes above, sweeps
+   * can use 'modeResidual' (residual scheduling).
+   * <p>
+   * 'appendPotentials', 'retirePotentials' modify the model while
+   * keeping the EP state (see 'FactorizedEPDriver'). The new potentials
+   * are updated on by passing their indexes to 'runUpdates', at a cost
+   * proportional to their number.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class FactorizedEPSession
+  {
+  public:
+    // Constants
+
+    static const int modeSequential=FactorizedEPDriver::modeSequential;
+    static const int modeColored   =FactorizedEPDriver::modeColored;
+    static const int modeParallel  =FactorizedEPDriver::modeParallel;
+    static const int modeAsync     =FactorizedEPDriver::modeAsync;
+    static const int modeResidual  =FactorizedEPDriver::modeResidual;
+
+  protected:
+    // Members
+
+    Handle<FactorizedEPDriver> epDriver;
+    Handle<FactEPMaximumPiValues> epMaxPi; // Optional
+    FactEPMaximumPiHeap* epMaxPiHeap;      // 'epMaxPi' if heap, 0 otherwise
+    ArrayHandle<int> schedInd,schedNext;   // 'modeColored'
+    ArrayHandle<int> schedRstat;           // "
+    ArrayHandle<double> schedDelta,schedDamp; // "
+    ArrayHandle<int> potIds,numPot;        // Potential types (optional)
+
+  public:
+    // Public methods
+
+    /**
+     * Constructor. 'pepMaxPi' must be the selective damping object used
+     * by 'pepDriver' (if any).
+     *
+     * @param pepDriver EP driver
+     * @param pepMaxPi  Optional
+     */
+    FactorizedEPSession(const Handle<FactorizedEPDriver>& pepDriver,
+			const Handle<FactEPMaximumPiValues>& pepMaxPi=
+			HandleZero<FactEPMaximumPiValues>::get()) :
+      epDriver(pepDriver),epMaxPi(pepMaxPi) {
+      if (pepDriver==0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      epMaxPiHeap=DYNCAST(FactEPMaximumPiHeap,epMaxPi.p());
+    }
+
+    virtual ~FactorizedEPSession() {}
+
+    virtual FactorizedEPDriver& getDriver() {
+      return *epDriver;
+    }
+
+    virtual bool isSelectiveDamping() const {
+      return !(epMaxPi==0);
+    }
+
+    /**
+     * Only if selective damping is active. See
+     * 'MaximumValuesService::getStats'. Statistics are reset at the start
+     * of each 'runUpdates' call.
+     *
+     * @param nupd S.a.
+     * @param nrec S.a.
+     */
+    virtual void getSelDampStats(int& nupd,int& nrec) const {
+      if (epMaxPi==0)
+	throw WrongStatusException(EXCEPT_MSG(""));
+      epMaxPi->getStats(nupd,nrec);
+    }
+
+    /**
+     * Runs EP updates on potentials in 'updInd', using mode 'mode' (see
+     * header comment). Return arguments are w.r.t. the ordering in
+     * 'updInd' for all modes. For skipped updates, 'delta' is 0 and
+     * 'effDamp' is 1. 'effDamp' is not supported for 'modeAsync'.
+     *
+     * @param updInd   Potential indexes
+     * @param nupd     Size of 'updInd'
+     * @param dampFact Damping factor in [0,1)
+     * @param mode     S.a.
+     * @param rstat    Return status for each update. Optional
+     * @param delta    See 'FactorizedEPDriver::sequentialUpdate'. Optional
+     * @param effDamp  S.a. Optional
+     */
+    virtual void runUpdates(const int* updInd,int nupd,double dampFact,
+			    int mode,int* rstat=0,double* delta=0,
+			    double* effDamp=0);
+
+    /**
+     * Sets potential type IDs of blocks and block sizes, as PM_POTIDS,
+     * PM_NUMPOT passed to 'PotManagerFactory'. The arrays are copied.
+     *
+     * @param ppotIds Potential type IDs of blocks
+     * @param pnumPot Block sizes
+     * @param nb      Number of blocks
+     */
+    virtual void setPotentialTypes(const int* ppotIds,const int* pnumPot,
+				   int nb);
+
+    /**
+     * Appends potentials to the model, see
+     * 'FactorizedEPDriver::appendPotentials'. If potential types have
+     * been set by 'setPotentialTypes', the blocks 'ppotIds', 'pnumPot'
+     * of 'ppots' are appended to them. Not if 'epMaxPi' is a
+     * 'FactEPMaximumPiHeap'.
+     *
+     * @param ppots   Potential manager for new potentials
+     * @param ppotIds Potential type IDs of blocks of 'ppots'
+     * @param pnumPot Block sizes
+     * @param nb      Number of blocks
+     * @param num     Number of new potentials
+     * @param prowOff See 'FactorizedEPDriver::appendPotentials'
+     * @param pind    "
+     * @param pbvals  "
+     * @param pbeta   " Optional
+     * @param ppi     " Optional
+     * @return        Index of first new potential
+     */
+    virtual int appendPotentials(const Handle<PotentialManager>& ppots,
+				 const int* ppotIds,const int* pnumPot,int nb,
+				 int num,const int* prowOff,const int* pind,
+				 const double* pbvals,const double* pbeta=0,
+				 const double* ppi=0);
+
+    /**
+     * Retires potentials, see 'FactorizedEPDriver::retirePotentials'.
+     *
+     * @param ind Potential indexes
+     * @param num Size of 'ind'
+     */
+    virtual void retirePotentials(const int* ind,int num) {
+      epDriver->retirePotentials(ind,num);
+      if (epMaxPiHeap!=0)
+	epMaxPiHeap->syncTopLists();
+    }
+
+    /**
+     * Runs sweeps of EP updates until convergence, see
+     * 'FactorizedEPDriver::runSweeps'. If 'opts.potIds' is not given, the
+     * potential types passed to 'setPotentialTypes' are used.
+     * Selective damping statistics (see 'getSelDampStats') are reset at
+     * the start.
+     *
+     * @param maxIt    Maximum number of sweeps
+     * @param deltaEps Convergence threshold
+     * @param dampFact Damping factor in [0,1)
+     * @param opts     Schedule options
+     * @param stats    Statistics for each sweep ret. here
+     * @return         Number of sweeps done
+     */
+    virtual int runSweeps(int maxIt,double deltaEps,double dampFact,
+			  const FactEPSweepOptions& opts,
+			  FactEPSweepStats& stats);
+  };
+//ENDNS
+
+#endif
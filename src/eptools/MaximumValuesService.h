@@ -14,6 +14,7 @@
 #endif
 
 #include <algorithm>
+#include <stdint.h>
 
 //BEGINNS(eptools)
   /**
@@ -40,6 +41,12 @@
    * Read access to graph structure and values (V_i, {x_ji}) is via pure
    * virtual methods 'numVariables', 'numFactors', 'getFactorValues'. These
    * must be implemented by subclasses (f.ex., 'FactEPMaximumPiValues').
+   * If the indexes V_i, J_i are 64-bit ('isIndex64' returns true),
+   * 'getFactorValues64' is used instead of 'getFactorValues'. If the
+   * values x_ji are single precision ('isSingle' returns true),
+   * 'getFactorValuesF' is used. Factors not covered by 'getFactorValues'
+   * (for example, potentials appended to a 'FactorizedEPRepresentation')
+   * are inserted by 'recomputeExtra'.
    * <p>
    * Top-K lists maintained in arrays 'topVal', 'topInd' (size n*(K+1))
    * each, entries for i start at i*(K+1), first 'numValid[i]' are valid.
@@ -52,9 +59,12 @@
    * If 'subInd' is given, max_j x_ji does not run over all j. If
    * 'subExcl'==false, max_j runs over 'subInd'. If 'subExcl'==true, max_j
    * runs over the complement of 'subInd'. 'subInd' must be sorted in
-   * ascending order.
-   * NOTE: Involves binary search over 'subInd' for every 'update' and
-   * 'recompute' call, so choose 'subExcl' to keep 'subInd' small.
+   * ascending order. Membership in 'subInd' is tested with a bit mask
+   * over the m factors ('subMask', see 'isExcluded').
+   * <p>
+   * 'update' and 'recompute' for different variables i may be called
+   * concurrently from several threads (OpenMP). Only the statistics
+   * counters are shared between variables.
    *
    * @author  Matthias Seeger
    * @version %I% %G%
@@ -70,6 +80,7 @@
     ArrayHandle<double> topVal;
     ArrayHandle<int> subInd;
     bool subExcl;
+    ArrayHandle<uint> subMask; // Bit j set iff j in 'subInd'
     int statNUpd,statNRec;
 
   public:
@@ -111,6 +122,10 @@
 	  throw InvalidParameterException(EXCEPT_MSG("psubInd: Out of range"));
 	if ((!psubExcl && sz<pmaxSize) || (psubExcl && pm-sz<pmaxSize))
 	  throw InvalidParameterException(EXCEPT_MSG("psubInd: Too small"));
+	subMask.changeRep((pm+31)/32);
+	std::fill(subMask.p(),subMask.p()+subMask.size(),0);
+	for (int k=0; k<sz; k++)
+	  subMask[psubInd[k]>>5]|=(1u<<(psubInd[k]&31));
       }
       resetStats();
     }
@@ -147,6 +162,48 @@
     virtual int getFactorValues(int i,const int*& vind,const int*& jind,
 				const double*& xarr) const = 0;
 
+    /**
+     * Same as 'getFactorValues', for 64-bit indexes. Has to be implemented
+     * by subclasses for which 'isIndex64' returns true.
+     */
+    virtual int getFactorValues64(int i,const int64_t*& vind,
+				  const int64_t*& jind,
+				  const double*& xarr) const {
+      throw NotImplemException(EXCEPT_MSG(""));
+    }
+
+    /**
+     * Same as 'getFactorValues', for single precision values. Has to be
+     * implemented by subclasses for which 'isSingle' returns true.
+     */
+    virtual int getFactorValuesF(int i,const int*& vind,const int*& jind,
+				 const float*& xarr) const {
+      throw NotImplemException(EXCEPT_MSG(""));
+    }
+
+    /**
+     * @return Are indexes V_i, J_i 64-bit? Def.: false
+     */
+    virtual bool isIndex64() const {
+      return false;
+    }
+
+    /**
+     * @return Are values x_ji single precision? Def.: false
+     */
+    virtual bool isSingle() const {
+      return false;
+    }
+
+    /**
+     * Called by 'recompute' for variable i, after the entries given by
+     * 'getFactorValues'. Subclasses insert further entries x_ji here,
+     * using 'insertValue'. Def.: Nothing
+     *
+     * @param i Variable index
+     */
+    virtual void recomputeExtra(int i) {}
+
     /**
      * Recompute top-K list for variable i. If i is not used, all top-K
      * lists are recomputed.
@@ -200,6 +257,47 @@
   protected:
     // Helper methods
 
+    template<class I,class V> void recomputeT(int i);
+
+    int factorValues(int i,const int*& vind,const int*& jind,
+		     const double*& xarr) const {
+      return getFactorValues(i,vind,jind,xarr);
+    }
+
+    int factorValues(int i,const int64_t*& vind,const int64_t*& jind,
+		     const double*& xarr) const {
+      return getFactorValues64(i,vind,jind,xarr);
+    }
+
+    int factorValues(int i,const int*& vind,const int*& jind,
+		     const float*& xarr) const {
+      return getFactorValuesF(i,vind,jind,xarr);
+    }
+
+    /**
+     * Factors j>=m (not covered by 'subMask') count as not in 'subInd'.
+     *
+     * @param j Factor index
+     * @return  Is j excluded by 'subInd'?
+     */
+    bool isExcluded(int j) const {
+      if (subMask==0)
+	return false;
+      bool inSub=(j<(subMask.size()<<5) &&
+		  ((subMask.p()[j>>5]>>(j&31))&1u)!=0);
+      return (inSub==subExcl);
+    }
+
+    /**
+     * Insert entry (val,j) into top-K list for i during 'recompute',
+     * unless j is excluded by 'subInd'. Assumes that j is not in
+     * 'topInd' for i.
+     */
+    void insertValue(int i,int j,double val) {
+      if (!isExcluded(j))
+	insertEntry(i,j,val);
+    }
+
     /**
      * Insert entry (val,j) into top-K list for i. Assumes that j is not
      * in 'topInd' for i, and that j is not excluded by 'subInd'.
@@ -220,20 +318,29 @@
 
   inline void MaximumValuesService::recompute(int i)
   {
-    int j,jj,k,viSz;
-    const double* xP;
-    const int* viInd,*jiInd;
+    if (isIndex64())
+      recomputeT<int64_t,double>(i);
+    else if (isSingle())
+      recomputeT<int,float>(i);
+    else
+      recomputeT<int,double>(i);
+  }
+
+  template<class I,class V> inline void
+  MaximumValuesService::recomputeT(int i)
+  {
+    int j,k,viSz;
+    I jj;
+    const V* xP;
+    const I* viInd,*jiInd;
 
-    viSz=getFactorValues(i,viInd,jiInd,xP);
+    viSz=factorValues(i,viInd,jiInd,xP);
     numValid[i]=0;
     for (k=0; k<viSz; k++) {
-      jj=jiInd[k]; j=viInd[k];
-      // Skip j if excluded by 'subInd'
-      if (!(subInd==0) &&
-	  std::binary_search(subInd.p(),subInd.p()+subInd.size(),j)==subExcl)
-	continue;
-      insertEntry(i,j,xP[jj]);
+      jj=jiInd[k]; j=(int) viInd[k];
+      insertValue(i,j,xP[jj]); // Skips j if excluded by 'subInd'
     }
+    recomputeExtra(i);
     if (numValid[i]==0)
       throw WrongStatusException(EXCEPT_MSG("Cannot have numValid[i]==0. Representation invalid now!"));
   }
@@ -248,6 +355,9 @@
 	// If top-K list is empty: Have to recompute
 	if (numValid[i]==0) {
 	  recompute(i);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
 	  statNRec++;
 	}
       }
@@ -256,6 +366,9 @@
       removeEntry(i,j); // Remove entry for j, if present
       insertEntry(i,j,val);
     }
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
     statNUpd++;
   }
 
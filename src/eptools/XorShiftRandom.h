@@ -0,0 +1,109 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class XorShiftRandom
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_XORSHIFTRANDOM_H
+#define EPTOOLS_XORSHIFTRANDOM_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/default.h"
+
+//BEGINNS(eptools)
+  /**
+   * Small and fast pseudo-random number generator (Marsaglia's xorshift128,
+   * period 2^128-1), used for random update orderings in
+   * 'FactorizedEPDriver::runSweeps'. Not suitable for statistical
+   * simulations, but much better than 'rand' and reproducible across
+   * platforms (only 32-bit unsigned arithmetic).
+   * <p>
+   * The state is initialized from a 32-bit seed by a linear congruential
+   * generator, so that similar seeds give unrelated sequences.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class XorShiftRandom
+  {
+  protected:
+    // Members
+
+    uint stX,stY,stZ,stW;
+
+  public:
+    // Public methods
+
+    /**
+     * Constructor.
+     *
+     * @param seed Seed value
+     */
+    explicit XorShiftRandom(uint seed=0) {
+      setSeed(seed);
+    }
+
+    /**
+     * Reinitializes the state from 'seed'.
+     *
+     * @param seed Seed value
+     */
+    void setSeed(uint seed) {
+      uint s=(seed^0x9e3779b9U)&0xffffffffU;
+
+      s=(1664525U*s+1013904223U)&0xffffffffU; stX=s;
+      s=(1664525U*s+1013904223U)&0xffffffffU; stY=s;
+      s=(1664525U*s+1013904223U)&0xffffffffU; stZ=s;
+      s=(1664525U*s+1013904223U)&0xffffffffU; stW=s|1U; // State not all 0
+    }
+
+    /**
+     * @return Next 32-bit random number
+     */
+    uint next() {
+      uint t=(stX^(stX<<11))&0xffffffffU;
+
+      stX=stY; stY=stZ; stZ=stW;
+      stW=(stW^(stW>>19)^t^(t>>8))&0xffffffffU;
+      return stW;
+    }
+
+    /**
+     * @return Uniform random number in [0,1)
+     */
+    double uniform() {
+      return ((double) next())*(1.0/4294967296.0);
+    }
+
+    /**
+     * @param n Positive
+     * @return  Uniform random integer in {0,...,n-1}
+     */
+    int uniformInt(int n) {
+      int k=(int) (uniform()*((double) n));
+      return (k<n)?k:(n-1);
+    }
+
+    /**
+     * Random permutation of 'arr' in place (Fisher-Yates).
+     *
+     * @param arr Array
+     * @param n   Size of 'arr'
+     */
+    void shuffle(int* arr,int n) {
+      int i,k,temp;
+
+      for (i=n-1; i>0; i--) {
+	k=uniformInt(i+1);
+	temp=arr[i]; arr[i]=arr[k]; arr[k]=temp;
+      }
+    }
+  };
+//ENDNS
+
+#endif
@@ -16,6 +16,7 @@
 
 // Module includes
 
+#include <stdint.h>
 #include "lhotse/global.h"
 #include "src/eptools/predecl.h"
 #include "src/eptools/exceptions.h"
@@ -18,6 +18,9 @@
 //BEGINNS(eptools)
   /**
    * Container class for 'PotentialManager'.
+   * <p>
+   * The container itself has no mutable state, so it can be used by as
+   * many threads concurrently as all of its children (see 'numThreads').
    *
    * @author  Matthias Seeger
    * @version %I% %G%
@@ -73,6 +76,65 @@
       return ret;
     }
 
+    int numThreads() const {
+      int ret=pmArr[0]->numThreads();
+
+      for (int i=1; i<pmArr.size(); i++)
+	ret=std::min(ret,pmArr[i]->numThreads());
+
+      return ret;
+    }
+
+    /**
+     * @return Number of child objects
+     */
+    int numChildren() const {
+      return pmArr.size();
+    }
+
+    /**
+     * Appends child object 'pman', its potentials follow the existing
+     * ones. Not allowed if the container ends with potentials of group
+     * 'atypeBivarPrec', unless all of 'pman' are of that group.
+     * NOTE: Must not be called while the container is used by other
+     * threads.
+     *
+     * @param pman New child object
+     */
+    void appendChild(const Handle<PotentialManager>& pman) {
+      int num=pmArr.size(),sz;
+
+      if (pman==0) throw InvalidParameterException(EXCEPT_MSG(""));
+      sz=pman->size();
+      if (pmArr[num-1]->numArgumentGroup(EPScalarPotential::atypeBivarPrec)>0
+	  && pman->numArgumentGroup(EPScalarPotential::atypeBivarPrec)<sz)
+	throw InvalidParameterException(EXCEPT_MSG("'atypeBivarPrec' potentials must form suffix"));
+      ArrayHandle<Handle<PotentialManager> > newArr(num+1);
+      ArrayHandle<int> newStart(num+1);
+      std::copy(pmArr.p(),pmArr.p()+num,newArr.p());
+      std::copy(startPos.p(),startPos.p()+num,newStart.p());
+      newArr[num]=pman; newStart[num]=size();
+      pmArr=newArr; startPos=newStart;
+    }
+
+    /**
+     * @param ic Child index
+     * @return   Child object
+     */
+    const PotentialManager& getChild(int ic) const {
+      if (ic<0 || ic>=pmArr.size()) throw OutOfRangeException(EXCEPT_MSG(""));
+      return *pmArr[ic];
+    }
+
+    /**
+     * @param ic Child index
+     * @return   Index of first potential of child 'ic'
+     */
+    int getStartPos(int ic) const {
+      if (ic<0 || ic>=pmArr.size()) throw OutOfRangeException(EXCEPT_MSG(""));
+      return startPos[ic];
+    }
+
     const EPScalarPotential& getPot(int j) const {
       int i,ic;
 
@@ -82,6 +144,36 @@
       return pmArr[ic]->getPot(i);
     }
 
+    /**
+     * Splits the range into parts for the child objects.
+     */
+    void compMomentsBatch(int j0,int num,const double* cmu,
+			  const double* crho,double* alpha,double* nu,
+			  double* logz,int* rstat,double eta=1.0) const {
+      int i,ic,sz,off;
+
+      if (j0<0 || num<0 || j0+num>size())
+	throw OutOfRangeException(EXCEPT_MSG(""));
+      for (off=0; off<num; off+=sz) {
+	i=getRelPos(j0+off,ic);
+	sz=std::min(num-off,pmArr[ic]->size()-i);
+	pmArr[ic]->compMomentsBatch(i,sz,cmu+off,crho+off,alpha+off,nu+off,
+				    (logz!=0)?(logz+off):0,rstat+off,eta);
+      }
+    }
+
+    /**
+     * Calls 'setMomentTables' for all child objects.
+     */
+    int setMomentTables(const PotMomentTableOptions* opts) {
+      int ret=0;
+
+      for (int i=0; i<pmArr.size(); i++)
+	ret+=pmArr[i]->setMomentTables(opts);
+
+      return ret;
+    }
+
   protected:
     // Internal methods
 
@@ -7,14 +7,60 @@
  * ------------------------------------------------------------------- */
 
 #include "src/eptools/potentials/DefaultPotManager.h"
+#include <algorithm>
 
 //BEGINNS(eptools)
+  /*
+   * Lexicographic ordering of potentials by their individual parameters
+   * (used by 'setMomentTables').
+   */
+  class DefaultPotManager_parLess
+  {
+  protected:
+    const double* parVec;
+    const int* parOff;
+    const int* parShrd;
+    int np;
+
+  public:
+    DefaultPotManager_parLess(const double* pparVec,const int* pparOff,
+			      const int* pparShrd,int pnp) :
+      parVec(pparVec),parOff(pparOff),parShrd(pparShrd),np(pnp) {}
+
+    bool operator()(int j1,int j2) const {
+      double v1,v2;
+
+      for (int k=0; k<np; k++)
+	if (!parShrd[k]) {
+	  v1=parVec[parOff[k]+j1]; v2=parVec[parOff[k]+j2];
+	  if (v1!=v2) return (v1<v2);
+	}
+      return false;
+    }
+  };
+
+  /*
+   * Orders groups by decreasing size, 'grpStart' as in 'setMomentTables'.
+   */
+  class DefaultPotManager_grpLarger
+  {
+  protected:
+    const int* grpStart;
+
+  public:
+    DefaultPotManager_grpLarger(const int* pgrpStart) : grpStart(pgrpStart) {}
+
+    bool operator()(int g1,int g2) const {
+      return (grpStart[g1+1]-grpStart[g1]>grpStart[g2+1]-grpStart[g2]);
+    }
+  };
+
   DefaultPotManager::DefaultPotManager(const Handle<EPScalarPotential>& peppot,
 				       int pnum,
 				       const ArrayHandle<double>& ppvec,
 				       const ArrayHandle<int>& ppshd,
 				       bool checkValid) :
-    epPot(peppot),num(pnum),parVec(ppvec),parShrd(ppshd)
+    epPot(peppot),num(pnum),parVec(ppvec),parShrd(ppshd),allShared(false)
   {
     int i,np=ppshd.size(),off;
 
@@ -35,5 +81,144 @@
 	  throw InvalidParameterException(EXCEPT_MSG(""));
       }
     }
+    // If all parameters are shared, 'epPot' is configured here. If they are
+    // not valid, this is left to 'getPot' (which then throws an exception)
+    for (i=0; i<np && ppshd[i]; i++);
+    if (i==np) {
+      getPotPars(0,tmpVec.p());
+      allShared=(np==0 || peppot->isValidPars(tmpVec.p()));
+      if (allShared && np>0)
+	epPot->setPars(tmpVec.p());
+    }
+    potObj.changeRep(1);
+    potObj[0]=epPot;
+  }
+
+  void DefaultPotManager::setThreadPotentials(const ArrayHandle<Handle<EPScalarPotential> >& parr)
+  {
+    int i,nthr=parr.size(),np=parOff.size();
+    ArrayHandle<double> pv(np);
+
+    for (i=0; i<nthr; i++)
+      if (parr[i]==0 || parr[i]->numPars()!=np ||
+	  parr[i]->getArgumentGroup()!=epPot->getArgumentGroup() ||
+	  parr[i].p()==epPot.p())
+	throw InvalidParameterException(EXCEPT_MSG(""));
+    potObj.changeRep(nthr+1);
+    potObj[0]=epPot;
+    for (i=0; i<nthr; i++) {
+      potObj[i+1]=parr[i];
+      if (allShared && np>0) {
+	getPotPars(0,pv.p());
+	parr[i]->setPars(pv.p());
+      }
+    }
+    tmpVec.changeRep((nthr+1)*np);
+    if (momTab.size()>0)
+      momProxy.changeRep(nthr+1);
+  }
+
+  int DefaultPotManager::setMomentTables(const PotMomentTableOptions* opts)
+  {
+    int i,k,ng,ntab,np=parOff.size();
+
+    momTab.changeRep(0); momTabInd.changeRep(0); momProxy.changeRep(0);
+    if (opts==0)
+      return 0;
+    opts->check();
+    if (epPot->getArgumentGroup()!=EPScalarPotential::atypeUnivariate)
+      throw WrongStatusException(EXCEPT_MSG("Only for group 'atypeUnivariate'"));
+    ArrayHandle<int> tabInd(num);
+    std::fill(tabInd.p(),tabInd.p()+num,-1);
+    if (allShared || np==0) {
+      // Single table
+      if (num<opts->minShare)
+	return 0;
+      std::fill(tabInd.p(),tabInd.p()+num,0);
+      ntab=1;
+    } else {
+      // Sort potentials by parameters, determine groups of equal ones
+      DefaultPotManager_parLess less(parVec.p(),parOff.p(),parShrd.p(),np);
+      ArrayHandle<int> perm(num),grpStart(num+1),grpOrd(num);
+      for (i=0; i<num; i++)
+	perm[i]=i;
+      std::sort(perm.p(),perm.p()+num,less);
+      for (i=ng=0; i<num; i++)
+	if (i==0 || less(perm[i-1],perm[i]))
+	  grpStart[ng++]=i;
+      grpStart[ng]=num;
+      // Largest groups first (stable, so ties are broken by parameters)
+      for (k=0; k<ng; k++)
+	grpOrd[k]=k;
+      std::stable_sort(grpOrd.p(),grpOrd.p()+ng,
+		       DefaultPotManager_grpLarger(grpStart.p()));
+      for (k=ntab=0; k<ng && ntab<opts->maxTables; k++) {
+	int g=grpOrd[k];
+	if (grpStart[g+1]-grpStart[g]<opts->minShare)
+	  break;
+	for (i=grpStart[g]; i<grpStart[g+1]; i++)
+	  tabInd[perm[i]]=ntab;
+	ntab++;
+      }
+      if (ntab==0)
+	return 0;
+    }
+    momTab.changeRep(ntab);
+    for (k=0; k<ntab; k++)
+      momTab[k].changeRep(new PotMomentTable(*opts));
+    momTabInd=tabInd;
+    momProxy.changeRep(potObj.size());
+
+    return ntab;
+  }
+
+  void DefaultPotManager::getMomentTableStats(int& nint,int& nexc,
+					      int& nevl,int& ncel) const
+  {
+    int k,a,b,c,d;
+
+    nint=nexc=nevl=ncel=0;
+    for (k=0; k<momTab.size(); k++) {
+      momTab[k]->getStats(a,b,c,d);
+      nint+=a; nexc+=b; nevl+=c; ncel+=d;
+    }
+  }
+
+  void DefaultPotManager::compMomentsBatch(int j0,int nump,const double* cmu,
+					   const double* crho,double* alpha,
+					   double* nu,double* logz,int* rstat,
+					   double eta) const
+  {
+    int k,np=parOff.size();
+    // Parameter pointers on the stack, unless there are many (no heap
+    // allocation when called by many threads)
+    const double* parPB[16];
+    int parStrB[16];
+    const double** parP=parPB;
+    int* parStr=parStrB;
+    ArrayHandle<const double*> parPA;
+    ArrayHandle<int> parStrA;
+
+    if (j0<0 || nump<0 || j0+nump>num)
+      throw OutOfRangeException(EXCEPT_MSG(""));
+    if (momTab.size()>0) {
+      PotentialManager::compMomentsBatch(j0,nump,cmu,crho,alpha,nu,logz,
+					 rstat,eta);
+      return;
+    }
+    EPScalarPotential* pot=potObj[threadIndex()].p();
+    if (pot->getArgumentGroup()!=EPScalarPotential::atypeUnivariate)
+      throw WrongStatusException(EXCEPT_MSG("Only for group 'atypeUnivariate'"));
+    if (nump==0)
+      return;
+    if (np>16) {
+      parPA.changeRep(np); parStrA.changeRep(np);
+      parP=parPA.p(); parStr=parStrA.p();
+    }
+    for (k=0; k<np; k++) {
+      parP[k]=parVec.p()+parOff[k]+(parShrd[k]?0:j0);
+      parStr[k]=parShrd[k]?0:1;
+    }
+    pot->compMomentsBatch(nump,cmu,crho,parP,parStr,alpha,nu,logz,rstat,eta);
   }
 //ENDNS
@@ -14,6 +14,11 @@
 #endif
 
 #include "src/eptools/potentials/PotentialManager.h"
+#include "src/eptools/potentials/PotMomentTable.h"
+#include <typeinfo>
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 //BEGINNS(eptools)
   /**
@@ -31,9 +36,30 @@
    * either 1 (shared; 'parShrd[k]' true) or N (individual;
    * 'parShrd[k]' false).
    * <p>
-   * ATTENTION: This implementation is not thread-safe. 'epPot' is
-   * used by all 'getPot' calls, and the object is reconfigured
-   * accordingly.
+   * If all parameters are shared (or there are none), 'epPot' is
+   * configured once upon construction, and 'getPot' does not call
+   * 'setPars'. Otherwise, 'getPot' reconfigures a potential object for
+   * each call.
+   * <p>
+   * Threads:
+   * By default, a single potential object 'epPot' is used by all
+   * 'getPot' calls, so the manager is not thread-safe. If further
+   * objects are passed via 'setThreadPotentials', there is one
+   * potential object (and one parameter buffer) per thread, selected by
+   * 'omp_get_thread_num'. Then, 'getPot' and 'compMomentsBatch' can be
+   * called concurrently by threads 0,...,'numThreads()'-1 of an OpenMP
+   * team (see 'PotentialManager').
+   * <p>
+   * Moment tables:
+   * If enabled by 'setMomentTables', potentials with the same parameter
+   * vector share a 'PotMomentTable', which answers local EP updates by
+   * interpolation where possible. Tables are created for the
+   * 'opts.maxTables' largest groups of potentials with equal parameters
+   * of size >= 'opts.minShare' (a single table if all parameters are
+   * shared). 'getPot' returns a 'PotMomentTableProxy' then, and
+   * 'compMomentsBatch' calls 'getPot' for each potential. This is meant
+   * for potentials whose updates are expensive (numerical quadrature).
+   * NOTE: 'getPotTyped' bypasses the tables.
    * <p>
    * TODO: Currently, parameter values are fixed upon construction.
    * Should allow them to be modified later on.
@@ -46,12 +72,17 @@
   protected:
     // Members
 
-    mutable Handle<EPScalarPotential> epPot;  // Potential object
+    Handle<EPScalarPotential> epPot;          // Potential object
     int num;                                  // Number of potentials N
     ArrayHandle<double> parVec;               // See header comment
     ArrayHandle<int> parOff;                  // "
     ArrayHandle<int> parShrd;                 // Is parameter shared?
-    mutable ArrayHandle<double> tmpVec;
+    bool allShared;                           // Objects configured once
+    ArrayHandle<Handle<EPScalarPotential> > potObj; // Per thread, [0]: epPot
+    mutable ArrayHandle<double> tmpVec;       // Per thread, 'numPars' each
+    ArrayHandle<Handle<PotMomentTable> > momTab; // Moment tables
+    ArrayHandle<int> momTabInd;               // Table for j (-1: none)
+    ArrayHandle<PotMomentTableProxy> momProxy; // Per thread
 
   public:
     // Public methods
@@ -78,19 +109,112 @@
       return (epPot->getArgumentGroup()==atype)?num:0;
     }
 
+    int numThreads() const {
+      return potObj.size();
+    }
+
     const EPScalarPotential& getPot(int j) const {
+      int t=threadIndex(),np=parOff.size();
+      EPScalarPotential* pot=potObj[t].p();
+
       if (j<0 || j>=size()) throw OutOfRangeException(EXCEPT_MSG(""));
-      if (parOff.size()>0) {
-	getPotPars(j,tmpVec.p());
-	epPot->setPars(tmpVec.p());
+      if (!allShared) {
+	double* pv=tmpVec.p()+t*np;
+	getPotPars(j,pv);
+	pot->setPars(pv);
+      }
+      if (momTab.size()>0) {
+	PotMomentTableProxy& proxy=momProxy.p()[t];
+	proxy.pot=pot;
+	proxy.tab=(momTabInd[j]>=0)?momTab[momTabInd[j]].p():0;
+	return proxy;
+      }
+
+      return *pot;
+    }
+
+    /**
+     * @return Is 'epPot' of type 'P' (exactly, not a subclass)?
+     */
+    template<class P> bool isPotType() const {
+      return (typeid(*epPot.p())==typeid(P));
+    }
+
+    /**
+     * Same as 'getPot', but 'P::setPars' is not called virtually, and
+     * 'j' is not range-checked. Requires 'isPotType<P>()'.
+     *
+     * @param j Potential index
+     * @return  Potential object for calling thread, configured for j
+     */
+    template<class P> const P& getPotTyped(int j) const {
+      int t=threadIndex(),np=parOff.size();
+      P* pot=static_cast<P*>(potObj[t].p());
+
+      if (!allShared) {
+	double* pv=tmpVec.p()+t*np;
+	getPotPars(j,pv);
+	pot->P::setPars(pv);
       }
 
-      return *epPot;
+      return *pot;
     }
 
+    /**
+     * Calls 'EPScalarPotential::compMomentsBatch' once on the potential
+     * object of the calling thread, with strides 0 for shared, 1 for
+     * individual parameters. If moment tables are used, the default
+     * implementation is called instead.
+     */
+    void compMomentsBatch(int j0,int nump,const double* cmu,
+			  const double* crho,double* alpha,double* nu,
+			  double* logz,int* rstat,double eta=1.0) const;
+
+    /**
+     * Makes this manager thread-safe for 'parr.size()'+1 threads (see
+     * header comment). The objects in 'parr' are used by threads
+     * 1,2,..., they must be of the same type as 'epPot' (created by
+     * 'EPPotentialFactory::createDefault' with the same construction
+     * parameters), and must not be shared with anything else. Replaces
+     * objects passed by an earlier call.
+     *
+     * @param parr Potential objects for threads 1,2,...
+     */
+    void setThreadPotentials(const ArrayHandle<Handle<EPScalarPotential> >& parr);
+
+    /**
+     * See header comment. Existing tables are discarded. Only for
+     * potentials of group 'atypeUnivariate'.
+     */
+    int setMomentTables(const PotMomentTableOptions* opts);
+
+    /**
+     * Statistics summed over all tables, see 'PotMomentTable::getStats'.
+     *
+     * @param nint S.a.
+     * @param nexc S.a.
+     * @param nevl S.a.
+     * @param ncel S.a.
+     */
+    void getMomentTableStats(int& nint,int& nexc,int& nevl,int& ncel) const;
+
   protected:
     // Internal methods
 
+    /**
+     * @return Index of potential object for calling thread
+     */
+    int threadIndex() const {
+      int t=0;
+
+#ifdef _OPENMP
+      if (potObj.size()>1 && (t=omp_get_thread_num())>=potObj.size())
+	throw WrongStatusException(EXCEPT_MSG("Not enough potential objects for threads"));
+#endif
+
+      return t;
+    }
+
     /**
      * @param j   Potential index
      * @param arr Parameters written here
@@ -80,7 +80,52 @@
 
       return true;
     }
+
+    void compMomentsBatch(int num,const double* cmu,const double* crho,
+			  const double* const* pars,const int* parStr,
+			  double* alpha,double* nu,double* logz,int* rstat,
+			  double eta=1.0);
   };
+
+  /*
+   * Branch-free loops (status is computed, not tested), so that they can
+   * be vectorized. Same expressions as in 'compMoments'.
+   */
+  inline void
+  EPPotGaussian::compMomentsBatch(int num,const double* cmu,
+				  const double* crho,const double* const* pars,
+				  const int* parStr,double* alpha,double* nu,
+				  double* logz,int* rstat,double eta)
+  {
+    int l;
+    const double* yP=pars[0],*ssqP=pars[1];
+    int yStr=parStr[0],ssqStr=parStr[1];
+
+    if (eta>1.0 || eta<=0.0) {
+      std::fill(rstat,rstat+num,0);
+      return;
+    }
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+    for (l=0; l<num; l++) {
+      double nuv=1.0/(crho[l]+ssqP[l*ssqStr]/eta);
+      alpha[l]=nuv*(yP[l*yStr]-cmu[l]);
+      nu[l]=nuv;
+      rstat[l]=(crho[l]>0.0);
+    }
+    if (logz!=0) {
+      double lgeta=log(eta);
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (l=0; l<num; l++) {
+	double temp=yP[l*yStr]-cmu[l];
+	logz[l]=-0.5*(nu[l]*temp*temp-log(nu[l])+SpecfunServices::m_ln2pi+
+		      lgeta);
+      }
+    }
+  }
 //ENDNS
 
 #endif
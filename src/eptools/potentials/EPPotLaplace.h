@@ -105,6 +105,24 @@
       return rstat;
     }
 
+    void compMomentsBatch(int num,const double* cmu,const double* crho,
+			  const double* const* pars,const int* parStr,
+			  double* alpha,double* nu,double* logz,int* rstat,
+			  double eta=1.0) {
+      static const double kappa=0.5;
+
+      if (eta<1e-10 || eta>1.0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      EPPotQuantileRegress::compMomentsBatchInt(num,cmu,crho,pars[1],
+						parStr[1],2.0*eta,pars[0],
+						parStr[0],&kappa,0,alpha,nu,
+						logz);
+      if (logz!=0)
+	for (int l=0; l<num; l++)
+	  logz[l] += eta*log(0.5*pars[1][l*parStr[1]]);
+      std::fill(rstat,rstat+num,1);
+    }
+
     // 'QuadPotProximal' methods
 
     bool hasFirstDerivatives() const {
@@ -99,6 +99,11 @@
     bool compMoments(const double* inp,double* ret,double* logz=0,
 		     double eta=1.0) const;
 
+    void compMomentsBatch(int num,const double* cmu,const double* crho,
+			  const double* const* pars,const int* parStr,
+			  double* alpha,double* nu,double* logz,int* rstat,
+			  double eta=1.0);
+
     // 'QuadPotProximalNewton' methods
 
     bool hasFirstDerivatives() const {
@@ -180,6 +185,56 @@
 
     return true;
   }
+
+  /*
+   * Chunks of size 'batchChunk'. The arithmetic before and after the
+   * special function calls is done in branch-free loops, which can be
+   * vectorized. Special functions are evaluated by the array methods of
+   * 'SpecfunServices'.
+   */
+  inline void
+  EPPotProbit::compMomentsBatch(int num,const double* cmu,const double* crho,
+				const double* const* pars,const int* parStr,
+				double* alpha,double* nu,double* logz,
+				int* rstat,double eta)
+  {
+    int l0,l,i,nb;
+    const double* yP=pars[0],*soffP=pars[1];
+    int yStr=parStr[0],soffStr=parStr[1];
+    double minRho=hardStep?1e-12:0.0,addRho=hardStep?0.0:1.0;
+    double zArg[batchChunk],fctV[batchChunk],cRatio[batchChunk];
+
+    if (eta!=1.0)
+      throw NotImplemException(EXCEPT_MSG(""));
+    for (l0=0; l0<num; l0+=batchChunk) {
+      nb=std::min(batchChunk,num-l0);
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (i=0; i<nb; i++) {
+	double cmupbt,crhop1;
+	int isOK;
+	l=l0+i;
+	isOK=(crho[l]>minRho);
+	cmupbt=cmu[l]+soffP[l*soffStr];
+	crhop1=isOK?(crho[l]+addRho):1.0; // Special functions need valid args
+	fctV[i]=yP[l*yStr]/sqrt(crhop1);
+	zArg[i]=cmupbt*fctV[i];
+	cRatio[i]=cmupbt/crhop1;
+	rstat[l]=isOK;
+      }
+      if (logz!=0)
+	SpecfunServices::logCdfNormal(zArg,logz+l0,nb);
+      SpecfunServices::derivLogCdfNormal(zArg,zArg,nb);
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (i=0; i<nb; i++) {
+	double av=fctV[i]*zArg[i];
+	alpha[l0+i]=av; nu[l0+i]=av*(av+cRatio[i]);
+      }
+    }
+  }
 //ENDNS
 
 #endif
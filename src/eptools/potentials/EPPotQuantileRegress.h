@@ -112,6 +112,30 @@
     static bool compMomentsInt(double cmu,double crho,double xi,double yscal,
 			       double kappa,double& alpha,double& nu,
 			       double* logz);
+
+    void compMomentsBatch(int num,const double* cmu,const double* crho,
+			  const double* const* pars,const int* parStr,
+			  double* alpha,double* nu,double* logz,int* rstat,
+			  double eta=1.0) {
+      if (eta<1e-10 || eta>1.0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      compMomentsBatchInt(num,cmu,crho,pars[1],parStr[1],eta,pars[0],
+			  parStr[0],pars[2],parStr[2],alpha,nu,logz);
+      std::fill(rstat,rstat+num,1);
+    }
+
+    /**
+     * Batched variant of 'compMomentsInt', implements 'compMomentsBatch'.
+     * Called by 'EPPotLaplace' as well. For potential l, xi is
+     * 'xiFact*xiP[l*xiStr]', y is 'yP[l*yStr]', kappa is
+     * 'kapP[l*kapStr]'. Updates never fail. An exception is thrown if
+     * some 'crho[l]' is too small.
+     */
+    static void compMomentsBatchInt(int num,const double* cmu,
+				    const double* crho,const double* xiP,
+				    int xiStr,double xiFact,const double* yP,
+				    int yStr,const double* kapP,int kapStr,
+				    double* alpha,double* nu,double* logz);
   };
 
   inline bool
@@ -146,6 +170,81 @@
 
     return true;
   }
+
+  /*
+   * Chunks of size 'batchChunk'. Same expressions as in 'compMomentsInt',
+   * the branch on li01>=li02 is replaced by selections, so that loops can
+   * be vectorized. Special functions are evaluated by the array methods of
+   * 'SpecfunServices'.
+   */
+  inline void
+  EPPotQuantileRegress::compMomentsBatchInt(int num,const double* cmu,
+					    const double* crho,
+					    const double* xiP,int xiStr,
+					    double xiFact,const double* yP,
+					    int yStr,const double* kapP,
+					    int kapStr,double* alpha,
+					    double* nu,double* logz)
+  {
+    int l0,l,i,nb;
+    double li01[batchChunk],li02[batchChunk],argf[batchChunk];
+    double sqrhor[batchChunk],sfArg1[batchChunk],sfArg2[batchChunk];
+
+    for (l=0; l<num; l++)
+      if (crho[l]<1e-14)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+    for (l0=0; l0<num; l0+=batchChunk) {
+      nb=std::min(batchChunk,num-l0);
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (i=0; i<nb; i++) {
+	double xi,kappa,kapc,hh,hr,rhor;
+	l=l0+i;
+	xi=xiP[l*xiStr]*xiFact; kappa=kapP[l*kapStr];
+	kapc = 1.0-kappa;
+	hh = yP[l*yStr]-cmu[l];
+	hr = xi*hh; rhor=xi*xi*crho[l];
+	sqrhor[i] = xi*sqrt(crho[l]);
+	argf[i] = kappa*sqrhor[i]-hr/sqrhor[i];
+	li01[i] = 0.5*kappa*(kappa*rhor-2*hr);
+	li02[i] = 0.5*kapc*(kapc*rhor+2*hr);
+      }
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (i=0; i<nb; i++) {
+	sfArg1[i] = -argf[i];
+	sfArg2[i] = argf[i]-sqrhor[i];
+      }
+      SpecfunServices::logCdfNormal(sfArg1,sfArg1,nb);
+      SpecfunServices::logCdfNormal(sfArg2,sfArg2,nb);
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (i=0; i<nb; i++) {
+	li01[i] += sfArg1[i];
+	li02[i] += sfArg2[i];
+      }
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+      for (i=0; i<nb; i++) {
+	double xi,kappa,hh,temp,logi0,q;
+	bool isFirst=(li01[i]>=li02[i]);
+	l=l0+i;
+	xi=xiP[l*xiStr]*xiFact; kappa=kapP[l*kapStr];
+	hh = yP[l*yStr]-cmu[l];
+	temp = exp(isFirst?(li02[i]-li01[i]):(li01[i]-li02[i]));
+	logi0 = (isFirst?li01[i]:li02[i])+log1p(temp);
+	q = (isFirst?temp:1.0)/(1.0+temp);
+	if (logz!=0) logz[l]=logi0;
+	alpha[l] = xi*(kappa-q);
+	nu[l] = xi*xi*(exp(-0.5*(hh*hh/crho[l]+SpecfunServices::m_ln2pi)-
+			   logi0)/sqrhor[i] - q*(1.0-q));
+      }
+    }
+  }
 //ENDNS
 
 #endif
@@ -13,6 +13,12 @@
 #include "src/eptools/potentials/EPPotLaplace.h"
 #include "src/eptools/potentials/EPPotGaussMixture.h"
 #include "src/eptools/potentials/EPPotSpikeSlab.h"
+#ifndef HAVE_WORKAROUND
+#include "src/eptools/potentials/quad/EPPotQuadLaplaceApprox.h"
+#include "src/eptools/potentials/quad/EPPotPoissonExpRate.h"
+#include "src/eptools/potentials/quad/EPPotGaussianPrecision.h"
+#include "src/eptools/potentials/quad/GaussHermiteQuadServices.h"
+#endif
 
 //BEGINNS(eptools)
   const int EPPotentialFactory::potGaussian;
@@ -24,10 +30,39 @@
   const int EPPotentialFactory::potGaussMixture;
   const int EPPotentialFactory::potSpikeSlab;
   const int EPPotentialFactory::potLast;
-#ifdef HAVE_WORKAROUND
+#ifndef HAVE_WORKAROUND
+  const int EPPotentialFactory::potPoissonExpRate;
+  const int EPPotentialFactory::potGaussianPrecision;
+#else
 #include "src/eptools/potentials/EPPotentialFactory_workaround.cc"
 #endif
 
+#ifndef HAVE_WORKAROUND
+  /*
+   * Quadrature potentials of the default build use
+   * 'GaussHermiteQuadServices' (no error estimate), univariate ones via
+   * the Laplace transformation of 'EPPotQuadLaplaceApprox' (order 20).
+   * 'EPPotGaussianPrecision' needs order 40 for the Gamma tail if the
+   * cavity shape is small.
+   * Annotations are not used. Each potential gets its own services
+   * object, they are tiny.
+   */
+  static EPScalarPotential* createPoissonExpRate(double y)
+  {
+    Handle<QuadPotProximal> qpot(new EPPotPoissonExpRate(y,1e-10,1e-12));
+    Handle<QuadratureServices> qserv(new GaussHermiteQuadServices());
+
+    return new EPPotQuadLaplaceApprox(qpot,qserv);
+  }
+
+  static EPScalarPotential* createGaussianPrecision(double y)
+  {
+    Handle<QuadratureServices> qserv(new GaussHermiteQuadServices(40));
+
+    return new EPPotGaussianPrecision(qserv,y);
+  }
+#endif
+
   /*
    * We call the static method 'getArgumentGroup_static'.
   */
@@ -60,7 +95,14 @@
     case potSpikeSlab:
       ret = EPPotSpikeSlab::getArgumentGroup_static();
       break;
-#ifdef HAVE_WORKAROUND
+#ifndef HAVE_WORKAROUND
+    case potPoissonExpRate:
+      ret = EPScalarPotential::atypeUnivariate;
+      break;
+    case potGaussianPrecision:
+      ret = EPPotGaussianPrecision::getArgumentGroup_static();
+      break;
+#else
     default:
       ret = getArgumentGroup_workaround(pid);
 #endif
@@ -106,7 +148,14 @@
     case potSpikeSlab:
       rpot = new EPPotSpikeSlab(pv[0],pv[1]);
       break;
-#ifdef HAVE_WORKAROUND
+#ifndef HAVE_WORKAROUND
+    case potPoissonExpRate:
+      rpot = createPoissonExpRate(pv[0]);
+      break;
+    case potGaussianPrecision:
+      rpot = createGaussianPrecision(pv[0]);
+      break;
+#else
     default:
       rpot = create_workaround(pid,pv,annot);
 #endif
@@ -151,7 +200,14 @@
     case potSpikeSlab:
       rpot = new EPPotSpikeSlab();
       break;
-#ifdef HAVE_WORKAROUND
+#ifndef HAVE_WORKAROUND
+    case potPoissonExpRate:
+      rpot = createPoissonExpRate(0.0);
+      break;
+    case potGaussianPrecision:
+      rpot = createGaussianPrecision(0.0);
+      break;
+#else
     default:
       rpot = createDefault_workaround(pid,pv,annot);
 #endif
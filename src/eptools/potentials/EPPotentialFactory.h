@@ -51,7 +51,14 @@
     static const int potQuantRegress=5;
     static const int potGaussMixture=6;
     static const int potSpikeSlab   =7;
+#ifndef HAVE_WORKAROUND
+    static const int potPoissonExpRate=8;
+    static const int potGaussianPrecision=9;
+    static const int potLast        =9;
+#else
+    // The workaround registers its own quadrature potentials
     static const int potLast        =7;
+#endif
 #ifdef HAVE_WORKAROUND
 #include "src/eptools/potentials/EPPotentialFactory_workaround.h"
 #endif
@@ -31,7 +31,12 @@
       potIDs[potGaussMixture]  = "GaussMixture";
       potNames["SpikeSlab"]    = potSpikeSlab;
       potIDs[potSpikeSlab]     = "SpikeSlab";
-#ifdef HAVE_WORKAROUND
+#ifndef HAVE_WORKAROUND
+      potNames["PoissonExpRate"] = potPoissonExpRate;
+      potIDs[potPoissonExpRate]  = "PoissonExpRate";
+      potNames["GaussianPrecision"] = potGaussianPrecision;
+      potIDs[potGaussianPrecision]  = "GaussianPrecision";
+#else
       setup_workaround();
 #endif
     }
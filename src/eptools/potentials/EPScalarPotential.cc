@@ -13,4 +13,44 @@
 
   const int EPScalarPotential::atypeUnivariate;
   const int EPScalarPotential::atypeBivarPrec;
+  const int EPScalarPotential::maxWarmState;
+  const int EPScalarPotential::batchChunk;
+
+  void EPScalarPotential::compMomentsBatch(int num,const double* cmu,
+					   const double* crho,
+					   const double* const* pars,
+					   const int* parStr,double* alpha,
+					   double* nu,double* logz,int* rstat,
+					   double eta)
+  {
+    int l,k,np=numPars();
+    double inp[2],ret[2];
+
+    if (getArgumentGroup()!=atypeUnivariate)
+      throw WrongStatusException(EXCEPT_MSG("Only for group 'atypeUnivariate'"));
+    if (np==0) {
+      for (l=0; l<num; l++) {
+	inp[0]=cmu[l]; inp[1]=crho[l]; ret[0]=ret[1]=0.0;
+	rstat[l]=compMoments(inp,ret,(logz!=0)?(logz+l):0,eta)?1:0;
+	alpha[l]=ret[0]; nu[l]=ret[1];
+      }
+      return;
+    }
+    ArrayHandle<double> oldPars(np),potPars(np);
+    getPars(oldPars.p());
+    try {
+      for (l=0; l<num; l++) {
+	for (k=0; k<np; k++)
+	  potPars[k]=pars[k][l*parStr[k]];
+	setPars(potPars.p());
+	inp[0]=cmu[l]; inp[1]=crho[l]; ret[0]=ret[1]=0.0;
+	rstat[l]=compMoments(inp,ret,(logz!=0)?(logz+l):0,eta)?1:0;
+	alpha[l]=ret[0]; nu[l]=ret[1];
+      }
+    } catch (...) {
+      setPars(oldPars.p());
+      throw;
+    }
+    setPars(oldPars.p());
+  }
 //ENDNS
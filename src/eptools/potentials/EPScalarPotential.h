@@ -76,6 +76,9 @@
     static const int atypeUnivariate=0;
     static const int atypeBivarPrec =1;
 
+    // Maximum size of warm start state (see 'setWarmState')
+    static const int maxWarmState=4;
+
     /**
      * See header comment.
      *
@@ -144,6 +147,63 @@
      */
     virtual bool compMoments(const double* inp,double* ret,double* logz=0,
 			     double eta=1.0) const = 0;
+
+    /**
+     * Batched variant of 'compMoments' for argument group
+     * 'atypeUnivariate'. Local EP updates are done for 'num' potentials
+     * of this type, which may have different parameters. Parameter k of
+     * potential l is 'pars[k][l*parStr[k]]', where 'parStr[k]'==0 for a
+     * parameter shared by all potentials. 'pars', 'parStr' have size
+     * 'numPars()' (can be 0 if this is 0).
+     * Cavity moments are 'cmu[l]', 'crho[l]'. We return alpha, nu, log Z
+     * in 'alpha[l]', 'nu[l]', 'logz[l]' ('logz' optional), and 1 (success)
+     * or 0 (failure) in 'rstat[l]'. For failed updates, the other return
+     * values are undefined. Exceptions are thrown in the same cases as
+     * for 'compMoments'.
+     * <p>
+     * The default implementation calls 'compMoments' for each potential,
+     * after configuring this object by 'setPars' (parameters are restored
+     * at the end). Subclasses override this by loops which do not require
+     * virtual calls or parameter setting per potential, and which can be
+     * vectorized by the compiler. Results must be the same as for
+     * 'compMoments', up to rounding errors (special functions may be
+     * evaluated by the array methods of 'SpecfunServices').
+     *
+     * @param num    Number of potentials
+     * @param cmu    Cavity means
+     * @param crho   Cavity variances
+     * @param pars   Parameter values, s.a.
+     * @param parStr Parameter strides, s.a.
+     * @param alpha  Alpha values ret. here
+     * @param nu     Nu values ret. here
+     * @param logz   log Z values ret. here. Optional
+     * @param rstat  Success flags ret. here
+     * @param eta    See 'compMoments'. Def.: 1
+     */
+    virtual void compMomentsBatch(int num,const double* cmu,
+				  const double* crho,const double* const* pars,
+				  const int* parStr,double* alpha,double* nu,
+				  double* logz,int* rstat,double eta=1.0);
+
+    /**
+     * Warm start for 'compMoments': The caller keeps a state of size
+     * 'maxWarmState' for each potential (initialized to zeros), and passes
+     * it here before 'compMoments' is called for this potential. It is
+     * read and updated by 'compMoments' (for example, to start an inner
+     * solver at the solution of the last update). Passing 0 switches this
+     * off. Results must not depend on the state, up to solver accuracy.
+     * The default implementation ignores the state.
+     * NOTE: This is 'const', since potential objects are passed as const
+     * references (see 'PotentialManager::getPot').
+     *
+     * @param wst Warm start state. Optional
+     */
+    virtual void setWarmState(double* wst) const {}
+
+  protected:
+    // Batched methods process potentials in chunks of this size, so that
+    // intermediates fit into fixed-size local arrays
+    static const int batchChunk=64;
   };
 //ENDNS
 
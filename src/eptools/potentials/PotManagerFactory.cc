@@ -16,7 +16,8 @@
 					      const ArrayHandle<int>& numPot,
 					      const ArrayHandle<double>& parVec,
 					      const ArrayHandle<int>& parShrd,
-					      const ArrayHandle<void*>& annObj)
+					      const ArrayHandle<void*>& annObj,
+					      int numThreads)
   {
     int i,j,k,numk=potIDs.size(),atype;
     ArrayHandle<Handle<PotentialManager> > parr;
@@ -27,7 +28,7 @@
     bool hasBVPrec=false;
     //char debStr[128]; // DEBUG
 
-    if (numPot.size()!=numk || annObj.size()!=numk)
+    if (numPot.size()!=numk || annObj.size()!=numk || numThreads<1)
       throw InvalidParameterException(EXCEPT_MSG(""));
     for (k=0; k<numk; k++)
       if (!EPPotentialFactory::isValidID(potIDs[k]) || numPot[k]<=0)
@@ -44,8 +45,12 @@
       // without having to prepare a parameter vector or even knowing the
       // size. These parameters must form the prefix
       Handle<EPScalarPotential> epPot;
+      ArrayHandle<Handle<EPScalarPotential> > thrPot(numThreads-1);
       try {
 	epPot.changeRep(EPPotentialFactory::createDefault(pid,pvecP,annObj[k]));
+	for (i=0; i<numThreads-1; i++)
+	  thrPot[i].changeRep(EPPotentialFactory::createDefault(pid,pvecP,
+								annObj[k]));
       } catch (StandardException ex) {
 	throw InvalidParameterException(EXCEPT_MSG("Cannot create potential object"));
       }
@@ -77,8 +82,10 @@
       hasBVPrec=(atype==EPScalarPotential::atypeBivarPrec);
       // ATTENTION: 'shrdMsk', 'pvecMsk' do not own their buffers, and
       // they do not copy 'parShrd', 'parVec' content!
-      PotentialManager* pmanP=
+      DefaultPotManager* pmanP=
 	new DefaultPotManager(epPot,npot,pvecMsk,shrdMsk,false);
+      if (numThreads>1)
+	pmanP->setThreadPotentials(thrPot);
       //printMsgStdout("C");
       if (numk==1)
 	return pmanP; // Single 'DefaultPotManager'
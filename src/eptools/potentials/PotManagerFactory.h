@@ -73,19 +73,27 @@
      * or deallocated, the PM becomes invalid.
      * ==> Use only to create temporary potential managers, not to be
      *     kept around.
+     * <p>
+     * If 'numThreads'>1, each 'DefaultPotManager' obtains 'numThreads'
+     * potential objects (see 'DefaultPotManager::setThreadPotentials'), so
+     * that the manager can be used by this many threads concurrently (see
+     * 'PotentialManager::numThreads'). Annotation objects are shared by
+     * these potential objects, so they must be thread-safe themselves.
      *
      * @param potIDs
      * @param numPot
      * @param parVec
      * @param parShrd
      * @param annObj
+     * @param numThreads S.a. Def.: 1
      * @return          New potential manager
      */
     static PotentialManager* create(const ArrayHandle<int>& potIDs,
 				    const ArrayHandle<int>& numPot,
 				    const ArrayHandle<double>& parVec,
 				    const ArrayHandle<int>& parShrd,
-				    const ArrayHandle<void*>& annObj);
+				    const ArrayHandle<void*>& annObj,
+				    int numThreads=1);
 
     /**
      * Check representation (as passed to 'create') for validity. If an
@@ -0,0 +1,233 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Definition of class PotMomentTable
+ * ------------------------------------------------------------------- */
+
+#include "src/eptools/potentials/PotMomentTable.h"
+#include <cfloat>
+#include <algorithm>
+
+//BEGINNS(eptools)
+  // Definition of constants
+
+  const int PotMomentTable::numOuts;
+  const int PotMomentTable::numPnts;
+  const int PotMomentTable::cellSz;
+  const int PotMomentTable::statUnres;
+  const int PotMomentTable::statInterp;
+  const int PotMomentTable::statSplit;
+  const int PotMomentTable::statExact;
+
+  PotMomentTable::PotMomentTable(const PotMomentTableOptions& popts) :
+    opts(popts),numCells(0),numInterp(0),numExact(0),numEval(0)
+  {
+    int ix,iy,nb;
+
+    popts.check();
+    lrMin=log(popts.rhoMin); lrMax=log(popts.rhoMax);
+    nb=popts.baseRes;
+    wdMu=(popts.muMax-popts.muMin)/((double) nb);
+    wdLr=(lrMax-lrMin)/((double) nb);
+    // Base cells: Cell index is iy*baseRes+ix
+    baseCell.changeRep(nb*nb);
+    for (iy=0; iy<nb; iy++)
+      for (ix=0; ix<nb; ix++)
+	initCell(baseCell[iy*nb+ix],popts.muMin+ix*wdMu,lrMin+iy*wdLr,0);
+#ifdef _OPENMP
+    omp_init_lock(&lock);
+#endif
+  }
+
+  PotMomentTable::~PotMomentTable()
+  {
+    for (int c=0; c<baseCell.size(); c++)
+      freeChildren(baseCell[c]);
+#ifdef _OPENMP
+    omp_destroy_lock(&lock);
+#endif
+  }
+
+  void PotMomentTable::initCell(Cell& cell,double x0,double y0,int depth)
+  {
+    cell.known=0; cell.stat=statUnres; cell.child=0;
+    cell.x0=x0; cell.y0=y0; cell.depth=depth;
+    numCells++;
+  }
+
+  void PotMomentTable::freeChildren(Cell& cell)
+  {
+    if (cell.child!=0) {
+      for (int k=0; k<4; k++)
+	freeChildren(cell.child[k]);
+      delete[] cell.child;
+      cell.child=0;
+    }
+  }
+
+  bool PotMomentTable::evalExact(const EPScalarPotential& pot,double x,
+				 double y,double* out)
+  {
+    double inp[2],ret[2],lz,rho=exp(y);
+    bool succ;
+
+    inp[0]=x; inp[1]=rho; ret[0]=ret[1]=0.0;
+    numEval++;
+    // Exceptions must not leave 'lookup' with 'lock' held. The exact
+    // computation done by the caller throws them again
+    try {
+      succ=pot.compMoments(inp,ret,&lz,1.0);
+    } catch (...) {
+      succ=false;
+    }
+    if (!succ)
+      return false;
+    out[0]=sqrt(rho)*ret[0]; out[1]=rho*ret[1]; out[2]=lz+0.5*y;
+
+    return (fabs(out[0])<=DBL_MAX && fabs(out[1])<=DBL_MAX &&
+	    fabs(out[2])<=DBL_MAX);
+  }
+
+  void PotMomentTable::interpolate(const Cell& cell,double u,double v,
+				   double* out)
+  {
+    int i,j,k;
+    double lu[3],lv[3],w;
+    const double* val=cell.val;
+
+    // Lagrange basis for nodes 0, 1/2, 1
+    lu[0]=2.0*(u-0.5)*(u-1.0); lu[1]=-4.0*u*(u-1.0); lu[2]=2.0*u*(u-0.5);
+    lv[0]=2.0*(v-0.5)*(v-1.0); lv[1]=-4.0*v*(v-1.0); lv[2]=2.0*v*(v-0.5);
+    for (k=0; k<numOuts; k++)
+      out[k]=0.0;
+    for (j=0; j<3; j++)
+      for (i=0; i<3; i++) {
+	w=lu[i]*lv[j];
+	for (k=0; k<numOuts; k++)
+	  out[k]+=w*val[(3*j+i)*numOuts+k];
+      }
+  }
+
+  /*
+   * Point k<9 is on the 3 x 3 grid (k = 3*iy+ix), point 9+2*qy+qx is the
+   * center of quarter (qx,qy).
+   */
+  void PotMomentTable::resolveCell(const EPScalarPotential& pot,Cell& cell)
+  {
+    int k,qx,qy,a,b,depth=cell.depth;
+    double w=wdMu/((double) (1<<depth)),h=wdLr/((double) (1<<depth));
+    double x0=cell.x0,y0=cell.y0,x,y,err,temp[numOuts];
+    double* val;
+    Cell* ch;
+
+    for (k=0; k<numPnts; k++)
+      if (!(cell.known & (1<<k))) {
+	if (k<9) {
+	  x=x0+0.5*w*(k%3); y=y0+0.5*h*(k/3);
+	} else {
+	  x=x0+0.25*w*(2*((k-9)%2)+1); y=y0+0.25*h*(2*((k-9)/2)+1);
+	}
+	if (!evalExact(pot,x,y,cell.val+k*numOuts)) {
+	  storeStat(cell,statExact);
+	  return;
+	}
+	cell.known|=(1<<k);
+      }
+    // Error of interpolant at quarter centers
+    for (k=9,err=0.0; k<numPnts; k++) {
+      interpolate(cell,0.25*(2*((k-9)%2)+1),0.25*(2*((k-9)/2)+1),temp);
+      val=cell.val+k*numOuts;
+      for (a=0; a<numOuts; a++)
+	err=std::max(err,fabs(temp[a]-val[a]));
+    }
+    if (err<=opts.tol)
+      storeStat(cell,statInterp);
+    else if (depth<opts.maxDepth) {
+      // Split into four children. Child (qx,qy) inherits corners and center
+      cell.child=new Cell[4];
+      for (qy=0; qy<2; qy++)
+	for (qx=0; qx<2; qx++) {
+	  ch=cell.child+2*qy+qx;
+	  initCell(*ch,x0+0.5*w*qx,y0+0.5*h*qy,depth+1);
+	  for (b=0; b<2; b++)
+	    for (a=0; a<2; a++)
+	      std::copy(cell.val+(3*(qy+b)+qx+a)*numOuts,
+			cell.val+(3*(qy+b)+qx+a+1)*numOuts,
+			ch->val+(6*b+2*a)*numOuts);
+	  std::copy(cell.val+(9+2*qy+qx)*numOuts,
+		    cell.val+(10+2*qy+qx)*numOuts,ch->val+4*numOuts);
+	  ch->known=(1<<0)|(1<<2)|(1<<4)|(1<<6)|(1<<8);
+	}
+      storeStat(cell,statSplit);
+    } else
+      storeStat(cell,statExact);
+  }
+
+  /*
+   * The lock is taken only if the cell reached is unresolved. Status values
+   * other than 'statUnres' are final, so that cells can be read without the
+   * lock once 'loadStat' returns such a value.
+   */
+  bool PotMomentTable::lookup(const EPScalarPotential& pot,double cmu,
+			      double crho,double& alpha,double& nu,
+			      double* logz,double eta)
+  {
+    int ix,iy,st,nb=opts.baseRes;
+    double y,w,h,u,v,out[numOuts];
+    Cell* cell;
+    bool ret=false;
+
+    y=(crho>0.0)?log(crho):lrMin-1.0;
+    if (eta==1.0 && cmu>=opts.muMin && cmu<=opts.muMax && y>=lrMin &&
+	y<=lrMax) {
+      ix=std::min((int) ((cmu-opts.muMin)/wdMu),nb-1);
+      iy=std::min((int) ((y-lrMin)/wdLr),nb-1);
+      cell=baseCell.p()+(iy*nb+ix);
+      for (;;) {
+	if ((st=loadStat(*cell))==statUnres) {
+#ifdef _OPENMP
+	  omp_set_lock(&lock);
+#endif
+	  if (cell->stat==statUnres)
+	    resolveCell(pot,*cell);
+	  st=cell->stat;
+#ifdef _OPENMP
+	  omp_unset_lock(&lock);
+#endif
+	}
+	w=wdMu/((double) (1<<cell->depth));
+	h=wdLr/((double) (1<<cell->depth));
+	u=std::min(std::max((cmu-cell->x0)/w,0.0),1.0);
+	v=std::min(std::max((y-cell->y0)/h,0.0),1.0);
+	if (st==statSplit)
+	  cell=cell->child+(2*(v>=0.5)+(u>=0.5));
+	else {
+	  if (st==statInterp) {
+	    interpolate(*cell,u,v,out);
+	    ret=true;
+	  }
+	  break;
+	}
+      }
+    }
+    if (ret) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+      numInterp++;
+      alpha=out[0]/sqrt(crho);
+      nu=out[1]/crho;
+      if (logz!=0)
+	*logz=out[2]-0.5*y;
+    } else {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+      numExact++;
+    }
+
+    return ret;
+  }
+//ENDNS
@@ -0,0 +1,309 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class PotMomentTable
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_POTMOMENTTABLE_H
+#define EPTOOLS_POTMOMENTTABLE_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/potentials/EPScalarPotential.h"
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+//BEGINNS(eptools)
+  /**
+   * Options for 'PotMomentTable', see there.
+   * - muMin, muMax:   Range of cavity means mu covered
+   * - rhoMin, rhoMax: Range of cavity variances rho covered
+   * - baseRes:        Base grid has 'baseRes' x 'baseRes' cells
+   * - maxDepth:       Maximum number of refinements of a base cell
+   * - tol:            Error tolerance (standardized outputs)
+   * - minShare:       Tables only for parameter settings shared by at
+   *                   least this many potentials (see 'DefaultPotManager')
+   * - maxTables:      Maximum number of tables per 'DefaultPotManager'
+   */
+  class PotMomentTableOptions
+  {
+  public:
+    double muMin,muMax;
+    double rhoMin,rhoMax;
+    int baseRes,maxDepth;
+    double tol;
+    int minShare,maxTables;
+
+    PotMomentTableOptions() : muMin(-10.0),muMax(10.0),rhoMin(1e-4),
+      rhoMax(100.0),baseRes(8),maxDepth(6),tol(1e-5),minShare(2),
+      maxTables(64) {}
+
+    void check() const {
+      if (muMin>=muMax || rhoMin<=0.0 || rhoMin>=rhoMax || baseRes<1 ||
+	  maxDepth<0 || maxDepth>20 || tol<=0.0 || minShare<1 ||
+	  maxTables<1)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+    }
+  };
+
+  /**
+   * Cache for local EP updates ('EPScalarPotential::compMoments', group
+   * 'atypeUnivariate', eta==1) of a potential with fixed parameters.
+   * For fixed parameters, (alpha, nu, log Z) are smooth functions of the
+   * cavity moments (mu, rho). They are tabulated over the box
+   *   [muMin,muMax] x [log rhoMin, log rhoMax]
+   * in (mu, log rho), in standardized form:
+   *   [sqrt(rho) alpha, rho nu, log Z + log(rho)/2].
+   * These are O(1) for typical potentials, so that 'tol' is an absolute
+   * tolerance.
+   * <p>
+   * The box is split into 'baseRes' x 'baseRes' base cells, which are
+   * refined adaptively (quadtree) and lazily: a cell is resolved only
+   * once a query falls into it. Each cell has values at the 3 x 3 grid of
+   * its corners, edge midpoints and center, and interpolation is
+   * biquadratic. To resolve a cell, we also compute exact values at the
+   * centers of its four quarters, and compare them against the
+   * interpolant. If the maximum error is <= 'tol', the cell is used for
+   * interpolation. Otherwise, it is split into four children (which
+   * inherit 5 of their 9 grid values), unless its depth is 'maxDepth'.
+   * Such cells, as well as cells for which an exact computation failed,
+   * are answered by exact computation.
+   * <p>
+   * 'lookup' returns false for queries outside the box, for eta!=1, and
+   * for cells which cannot be interpolated (the potential is not smooth
+   * there at the resolution 'maxDepth', or an exact computation failed). The caller does the exact
+   * computation then. Exact values for building the table are computed
+   * by the potential passed to 'lookup', which must be configured with
+   * the parameters the table is for.
+   * <p>
+   * Threads:
+   * 'lookup' can be called concurrently. Each table has its own lock, which
+   * is taken only to resolve a cell (exact computations included). Resolved
+   * cells are read without the lock: a cell's status is written last (OpenMP
+   * flush, then atomic write) and read first (atomic read, then flush), so
+   * values and children are visible once the status is. Cells never move:
+   * children are allocated in blocks of four and freed with the table.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class PotMomentTable
+  {
+  public:
+    // Constants
+
+    static const int numOuts=3;   // Outputs per grid point
+    static const int numPnts=13;  // 3 x 3 grid, 4 quarter centers
+    static const int cellSz=numOuts*numPnts;
+    static const int statUnres=0; // Cell status
+    static const int statInterp=1;
+    static const int statSplit=2;
+    static const int statExact=3;
+
+  protected:
+    // Internal types
+
+    /**
+     * Cell of the quadtree. 'stat' is published last, see header comment.
+     */
+    struct Cell {
+      double val[cellSz];  // Values
+      double x0,y0;        // Lower left corner (mu, log rho)
+      int known;           // Bit mask of known points
+      int depth;
+      int stat;            // Status
+      Cell* child;         // First of four children
+    };
+
+    // Members
+
+    PotMomentTableOptions opts;
+    double lrMin,lrMax;          // Range for log rho
+    double wdMu,wdLr;            // Widths of base cells
+    ArrayHandle<Cell> baseCell;  // Base cells, index iy*baseRes+ix
+    int numCells;
+    int numInterp,numExact,numEval; // Statistics
+#ifdef _OPENMP
+    omp_lock_t lock;             // For resolving cells
+#endif
+
+  public:
+    // Public methods
+
+    /**
+     * Constructor
+     *
+     * @param popts Options
+     */
+    PotMomentTable(const PotMomentTableOptions& popts);
+
+    virtual ~PotMomentTable();
+
+    /**
+     * Answers local EP update for cavity 'cmu', 'crho' by interpolation.
+     * See header comment.
+     *
+     * @param pot   Potential, configured with the parameters of the table
+     * @param cmu   Cavity mean
+     * @param crho  Cavity variance
+     * @param alpha Alpha ret. here
+     * @param nu    Nu ret. here
+     * @param logz  log Z ret. here. Optional
+     * @param eta   See 'EPScalarPotential::compMoments'
+     * @return      Answered? If false, exact computation is required
+     */
+    bool lookup(const EPScalarPotential& pot,double cmu,double crho,
+		double& alpha,double& nu,double* logz,double eta=1.0);
+
+    /**
+     * @param nint Number of 'lookup' calls answered by interpolation
+     * @param nexc Number of 'lookup' calls which returned false
+     * @param nevl Number of exact computations for resolving cells
+     * @param ncel Number of cells
+     */
+    void getStats(int& nint,int& nexc,int& nevl,int& ncel) const {
+      nint=numInterp; nexc=numExact; nevl=numEval; ncel=numCells;
+    }
+
+  protected:
+    // Internal methods
+
+    /**
+     * Initializes cell (status 'statUnres', no points known).
+     */
+    void initCell(Cell& cell,double x0,double y0,int depth);
+
+    /**
+     * Frees children of 'cell', recursively.
+     */
+    static void freeChildren(Cell& cell);
+
+    /**
+     * Computes unknown points of 'cell' exactly, then determines its
+     * status. Called with 'lock' held.
+     */
+    void resolveCell(const EPScalarPotential& pot,Cell& cell);
+
+    /**
+     * Biquadratic interpolation for 'cell' at (u,v) in [0,1]^2
+     * (relative coordinates).
+     */
+    static void interpolate(const Cell& cell,double u,double v,double* out);
+
+    static int loadStat(const Cell& cell) {
+      int st;
+
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+      st=cell.stat;
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+      return st;
+    }
+
+    static void storeStat(Cell& cell,int st) {
+#ifdef _OPENMP
+#pragma omp flush
+#pragma omp atomic write
+#endif
+      cell.stat=st;
+    }
+
+    /**
+     * Exact computation of standardized outputs at (x,y).
+     *
+     * @return Success?
+     */
+    bool evalExact(const EPScalarPotential& pot,double x,double y,
+		   double* out);
+
+  private:
+    PotMomentTable(const PotMomentTable&);
+    PotMomentTable& operator=(const PotMomentTable&);
+  };
+
+  /**
+   * Returned by 'DefaultPotManager::getPot' if moment tables are used.
+   * Wraps the potential object 'pot' (configured for the potential j),
+   * 'compMoments' is answered by 'tab->lookup' if possible, otherwise by
+   * 'pot'. All other services are passed to 'pot'. If 'tab'==0, all
+   * services are passed to 'pot'. A warm start state ('setWarmState') is
+   * passed to 'pot' for the exact computation only, not for building
+   * 'tab'.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class PotMomentTableProxy : public EPScalarPotential
+  {
+  public:
+    // Members
+
+    EPScalarPotential* pot;
+    PotMomentTable* tab;
+    mutable double* warmSt;
+
+  public:
+    // Public methods
+
+    PotMomentTableProxy() : pot(0),tab(0),warmSt(0) {}
+
+    int numPars() const {
+      return pot->numPars();
+    }
+
+    int numConstPars() const {
+      return pot->numConstPars();
+    }
+
+    void getPars(double* pv) const {
+      pot->getPars(pv);
+    }
+
+    void setPars(const double* pv) {
+      pot->setPars(pv);
+    }
+
+    bool isValidPars(const double* pv) const {
+      return pot->isValidPars(pv);
+    }
+
+    bool isLogConcave() const {
+      return pot->isLogConcave();
+    }
+
+    bool suppFractional() const {
+      return pot->suppFractional();
+    }
+
+    int getArgumentGroup() const {
+      return pot->getArgumentGroup();
+    }
+
+    bool compMoments(const double* inp,double* ret,double* logz=0,
+		     double eta=1.0) const {
+      bool succ;
+
+      if (tab!=0 && tab->lookup(*pot,inp[0],inp[1],ret[0],ret[1],logz,eta))
+	return true;
+      pot->setWarmState(warmSt);
+      succ=pot->compMoments(inp,ret,logz,eta);
+      pot->setWarmState(0);
+
+      return succ;
+    }
+
+    void setWarmState(double* wst) const {
+      warmSt=wst;
+    }
+  };
+//ENDNS
+
+#endif
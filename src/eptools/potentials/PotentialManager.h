@@ -23,10 +23,15 @@
    * A typical implementation has to serve 'getPot' being called by
    * a sequential loop over all or a subset of potentials.
    * <p>
-   * ATTENTION: At present, implementations are typically not thread-safe.
    * 'getPot' returns a reference to 'EPScalarPotential'. This object must
-   * not be used once 'getPot' is called again.
-   * TODO: Thread-safe variant.
+   * not be used once 'getPot' is called again (by the same thread).
+   * <p>
+   * Threads:
+   * 'numThreads' returns the number T of threads which can use the
+   * manager concurrently. Then, 'getPot' and 'compMomentsBatch' can be
+   * called by threads 0,...,T-1 of an OpenMP team (thread index
+   * 'omp_get_thread_num') at the same time. If T==1 (default), the
+   * manager is not thread-safe, and each thread needs its own copy.
    * <p>
    * A PM may contain potentials of different argument groups (see
    * 'EPScalarPotential'). If it contains bivariate precision potentials
@@ -59,6 +64,15 @@
      */
     virtual int numArgumentGroup(int atype) const = 0;
 
+    /**
+     * See header comment.
+     *
+     * @return Number of threads which can use this manager concurrently
+     */
+    virtual int numThreads() const {
+      return 1;
+    }
+
     /**
      * NOTE: The returned object should be read-accessed only. In particular,
      * 'setPars' must not be used: the object returned is typically a temp.
@@ -68,7 +82,66 @@
      * @return  Potential object t_j(.)
      */
     virtual const EPScalarPotential& getPot(int j) const = 0;
+
+    /**
+     * Local EP updates on potentials j0,...,j0+num-1, which must be in
+     * argument group 'EPScalarPotential::atypeUnivariate'. Arguments are
+     * as for 'EPScalarPotential::compMomentsBatch', indexed by j-j0.
+     * The default implementation calls 'compMoments' on 'getPot(j)' for
+     * each j. Implementations should use 'compMomentsBatch' on blocks of
+     * potentials of the same type.
+     *
+     * @param j0    First potential index
+     * @param num   Number of potentials
+     * @param cmu   Cavity means
+     * @param crho  Cavity variances
+     * @param alpha Alpha values ret. here
+     * @param nu    Nu values ret. here
+     * @param logz  log Z values ret. here. Optional
+     * @param rstat Success flags (1 or 0) ret. here
+     * @param eta   See 'EPScalarPotential::compMoments'. Def.: 1
+     */
+    virtual void compMomentsBatch(int j0,int num,const double* cmu,
+				  const double* crho,double* alpha,double* nu,
+				  double* logz,int* rstat,double eta=1.0) const;
+
+    /**
+     * Enables moment tables (see 'PotMomentTable') for local EP updates,
+     * or disables them if 'opts'==0. Tables are a cache, they do not
+     * change the potentials represented. Must not be called while the
+     * manager is used by other threads. The default implementation does
+     * nothing.
+     *
+     * @param opts Table options. Optional
+     * @return     Number of tables created
+     */
+    virtual int setMomentTables(const PotMomentTableOptions* opts) {
+      return 0;
+    }
   };
+
+  // Inline methods
+
+  inline void
+  PotentialManager::compMomentsBatch(int j0,int num,const double* cmu,
+				     const double* crho,double* alpha,
+				     double* nu,double* logz,int* rstat,
+				     double eta) const
+  {
+    int l;
+    double inp[2],ret[2];
+
+    if (j0<0 || num<0 || j0+num>size())
+      throw OutOfRangeException(EXCEPT_MSG(""));
+    for (l=0; l<num; l++) {
+      const EPScalarPotential& pot=getPot(j0+l);
+      if (pot.getArgumentGroup()!=EPScalarPotential::atypeUnivariate)
+	throw WrongStatusException(EXCEPT_MSG("Only for group 'atypeUnivariate'"));
+      inp[0]=cmu[l]; inp[1]=crho[l]; ret[0]=ret[1]=0.0;
+      rstat[l]=pot.compMoments(inp,ret,(logz!=0)?(logz+l):0,eta)?1:0;
+      alpha[l]=ret[0]; nu[l]=ret[1];
+    }
+  }
 //ENDNS
 
 #endif
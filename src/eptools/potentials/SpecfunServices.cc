@@ -7,6 +7,97 @@
  * ------------------------------------------------------------------- */
 
 #include "src/eptools/potentials/SpecfunServices.h"
+#include <cstring>
+#include <algorithm>
+
+// SIMD kernels for array methods (see 'SpecfunServices_vec.h'). The generic
+// kernels use GCC vector extensions with 16-byte vectors (SSE2 on x86-64).
+// AVX2 and AVX-512 kernels are compiled with target pragmas, and selected
+// at run time by '__builtin_cpu_supports' (GCC on x86 only). FMA
+// contraction is switched off, so that rounding is the same as for the
+// scalar methods (the kernels contain exp(log N(z)), which amplifies
+// relative errors for large |z|).
+#if defined(__GNUC__)
+#define SPECFUN_HAVE_VECEXT 1
+#if !defined(__clang__) && (__GNUC__>=5) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SPECFUN_HAVE_X86_DISPATCH 1
+#endif
+#endif
+
+#ifdef SPECFUN_HAVE_VECEXT
+// Scalar methods, compiled for the default target. Called by all kernels
+// for arguments outside their range, so results do not depend on the
+// instruction set there
+namespace specfun_scalar {
+#define SPECFUN_SCALAR_FUNC(fname) \
+  __attribute__((noinline)) double fname(double z) \
+  { \
+    return SpecfunServices::fname(z); \
+  }
+  SPECFUN_SCALAR_FUNC(logPdfNormal)
+  SPECFUN_SCALAR_FUNC(cdfNormal)
+  SPECFUN_SCALAR_FUNC(logCdfNormal)
+  SPECFUN_SCALAR_FUNC(derivLogCdfNormal)
+#undef SPECFUN_SCALAR_FUNC
+}
+
+#define SPECFUN_VEC_NS specfun_vec_generic
+#define SPECFUN_VEC_WIDTH 2
+#include "src/eptools/potentials/SpecfunServices_vec.h"
+#undef SPECFUN_VEC_WIDTH
+#undef SPECFUN_VEC_NS
+#endif
+
+#ifdef SPECFUN_HAVE_X86_DISPATCH
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define SPECFUN_VEC_NS specfun_vec_avx2
+#define SPECFUN_VEC_WIDTH 4
+#include "src/eptools/potentials/SpecfunServices_vec.h"
+#undef SPECFUN_VEC_WIDTH
+#undef SPECFUN_VEC_NS
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#define SPECFUN_VEC_NS specfun_vec_avx512
+#define SPECFUN_VEC_WIDTH 8
+#include "src/eptools/potentials/SpecfunServices_vec.h"
+#undef SPECFUN_VEC_WIDTH
+#undef SPECFUN_VEC_NS
+#pragma GCC pop_options
+#endif
+
+// Defines array method 'fname' of 'SpecfunServices', which dispatches to
+// the kernels in the namespaces above
+#ifdef SPECFUN_HAVE_X86_DISPATCH
+#define SPECFUN_CASES_X86(fname) \
+    case simdAvx512: \
+      specfun_vec_avx512::fname(z,res,n); return; \
+    case simdAvx2: \
+      specfun_vec_avx2::fname(z,res,n); return;
+#else
+#define SPECFUN_CASES_X86(fname)
+#endif
+#ifdef SPECFUN_HAVE_VECEXT
+#define SPECFUN_CASES_GENERIC(fname) \
+    case simdGeneric: \
+      specfun_vec_generic::fname(z,res,n); return;
+#else
+#define SPECFUN_CASES_GENERIC(fname)
+#endif
+#define SPECFUN_ARRAY_METHOD(fname) \
+  void SpecfunServices::fname(const double* z,double* res,int n) \
+  { \
+    switch (getSimdLevel()) { \
+    SPECFUN_CASES_X86(fname) \
+    SPECFUN_CASES_GENERIC(fname) \
+    } \
+    for (int i=0; i<n; i++) \
+      res[i]=fname(z[i]); \
+  }
 
 //BEGINNS(eptools)
   // Definition of constants
@@ -15,4 +106,51 @@
   const double SpecfunServices::m_ln2;
   const double SpecfunServices::m_sqrtpi;
   const double SpecfunServices::m_sqrt2;
+  const int SpecfunServices::simdScalar;
+  const int SpecfunServices::simdGeneric;
+  const int SpecfunServices::simdAvx2;
+  const int SpecfunServices::simdAvx512;
+
+  // Static members
+
+  int SpecfunServices::maxSimdLevel=SpecfunServices::simdAvx512;
+
+  // Public static methods
+
+  SPECFUN_ARRAY_METHOD(logPdfNormal)
+
+  SPECFUN_ARRAY_METHOD(cdfNormal)
+
+  SPECFUN_ARRAY_METHOD(logCdfNormal)
+
+  SPECFUN_ARRAY_METHOD(derivLogCdfNormal)
+
+  int SpecfunServices::getSimdLevel()
+  {
+    int lev=simdScalar;
+
+#if defined(SPECFUN_HAVE_X86_DISPATCH)
+    if (__builtin_cpu_supports("avx512f"))
+      lev=simdAvx512;
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      lev=simdAvx2;
+    else
+      lev=simdGeneric;
+#elif defined(SPECFUN_HAVE_VECEXT)
+    lev=simdGeneric;
+#endif
+
+    return std::min(lev,maxSimdLevel);
+  }
+
+  void SpecfunServices::setSimdLevel(int lev)
+  {
+    if (lev<simdScalar || lev>simdAvx512)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    maxSimdLevel=lev;
+  }
 //ENDNS
+
+#undef SPECFUN_ARRAY_METHOD
+#undef SPECFUN_CASES_GENERIC
+#undef SPECFUN_CASES_X86
@@ -34,6 +34,12 @@
     static const double m_sqrtpi = 1.77245385090551602729816748334;
     static const double m_sqrt2  = 1.41421356237309504880168872421;
 
+    // Instruction sets for array methods (see 'getSimdLevel')
+    static const int simdScalar=0;
+    static const int simdGeneric=1;
+    static const int simdAvx2=2;
+    static const int simdAvx512=3;
+
     // Static methods
 
     /**
@@ -72,6 +78,49 @@
      */
     static double derivLogCdfNormal(double z);
 
+    /**
+     * Array versions of 'logPdfNormal', 'cdfNormal', 'logCdfNormal',
+     * 'derivLogCdfNormal': res[i] = f(z[i]), i=0,...,n-1. 'res' can be
+     * equal to 'z' (in-place), but must not overlap otherwise.
+     * <p>
+     * These are evaluated with SIMD kernels, where the instruction set is
+     * chosen at run time (see 'getSimdLevel'). The kernels evaluate the
+     * same rational approximations as the scalar methods without branches,
+     * and use exp, log approximations with errors below 1 ulp. Results
+     * agree with the scalar methods up to a few ulp (they are not
+     * bit-identical). Arguments which are not finite, or with |z| > 37
+     * (except for 'logPdfNormal'), are passed to the scalar methods.
+     *
+     * @param z   Arguments
+     * @param res Function values ret. here
+     * @param n   Size of 'z', 'res'
+     */
+    static void logPdfNormal(const double* z,double* res,int n);
+
+    static void cdfNormal(const double* z,double* res,int n);
+
+    static void logCdfNormal(const double* z,double* res,int n);
+
+    static void derivLogCdfNormal(const double* z,double* res,int n);
+
+    /**
+     * Returns instruction set used by the array methods (one of
+     * 'simdXXX'): the best one supported by the CPU (AVX-512 and AVX2 only
+     * with GCC on x86), but not above the limit set by 'setSimdLevel'.
+     * 'simdScalar' means that scalar methods are called in a loop.
+     *
+     * @return Instruction set for array methods
+     */
+    static int getSimdLevel();
+
+    /**
+     * Sets upper limit for 'getSimdLevel'. Used for testing and
+     * benchmarking. Def.: 'simdAvx512' (no limit)
+     *
+     * @param lev Limit (one of 'simdXXX')
+     */
+    static void setSimdLevel(int lev);
+
     /**
      * Computes natural log of Gamma(z) for z>0. Note that if z is a
      * natural number, then z! = Gamma(z+1).
@@ -100,6 +149,10 @@
 				    double& x1,double& x2);
 
   protected:
+    // Internal members
+
+    static int maxSimdLevel;
+
     // Internal static methods
 
     /**
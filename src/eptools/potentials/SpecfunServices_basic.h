@@ -1,13 +1,38 @@
 inline double SpecfunServices::logGamma(double z)
 {
-  // TODO: Implement!
-  throw NotImplemException(EXCEPT_MSG(""));
+  if (z<=0.0)
+    throw InvalidParameterException(EXCEPT_MSG(""));
+  return lgamma(z);
 }
 
 inline int
 SpecfunServices::rootsCubicPolynomial(double a,double b,double c,double& x0,
 				      double& x1,double& x2)
 {
-  // TODO: Implement!
-  throw NotImplemException(EXCEPT_MSG(""));
+  // Trigonometric (3 roots) or Cardano (1 root) solution, as in GSL
+  // 'gsl_poly_solve_cubic'
+  double q=(a*a-3.0*b)/9.0,r=(2.0*a*a*a-9.0*a*b+27.0*c)/54.0;
+  double q3=q*q*q,r2=r*r,temp;
+
+  if (r2<q3) {
+    const double twopi3=2.09439510239319549230842892219; // 2 pi/3
+    double theta=acos(r/sqrt(q3))/3.0,norm=-2.0*sqrt(q);
+    x0=norm*cos(theta)-a/3.0;
+    x1=norm*cos(theta+twopi3)-a/3.0;
+    x2=norm*cos(theta-twopi3)-a/3.0;
+    if (x0>x1) {
+      temp=x0; x0=x1; x1=temp;
+    }
+    if (x1>x2) {
+      temp=x1; x1=x2; x2=temp;
+      if (x0>x1) {
+	temp=x0; x0=x1; x1=temp;
+      }
+    }
+    return 3;
+  }
+  temp=-((r>=0.0)?1.0:-1.0)*cbrt(fabs(r)+sqrt(r2-q3));
+  x0=temp+((temp!=0.0)?(q/temp):0.0)-a/3.0;
+
+  return 1;
 }
@@ -0,0 +1,284 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Vectorized kernels for array methods of SpecfunServices
+ * ------------------------------------------------------------------- */
+
+// NOTE: This file is included several times by 'SpecfunServices.cc', once
+// for each instruction set. Before inclusion, define
+// - SPECFUN_VEC_NS:    Namespace for the kernels
+// - SPECFUN_VEC_WIDTH: Number of doubles in a vector
+// and select the target (for example, '#pragma GCC target("avx2,fma")').
+// Scalar fallbacks are taken from namespace 'specfun_scalar'.
+// Uses GCC vector extensions. Do not include anywhere else.
+
+namespace SPECFUN_VEC_NS {
+  typedef double vdouble __attribute__((vector_size(8*SPECFUN_VEC_WIDTH)));
+  typedef __typeof__(vdouble()<vdouble()) vint;
+
+  const int width=SPECFUN_VEC_WIDTH;
+
+  /*
+   * Bitwise selection: m ? a : b, where lanes of 'm' are 0 or -1
+   */
+  inline vdouble vsel(vint m,vdouble a,vdouble b)
+  {
+    return (vdouble) ((m&((vint) a))|((~m)&((vint) b)));
+  }
+
+  inline vdouble vabs(vdouble x)
+  {
+    return (vdouble) (((vint) x)&0x7fffffffffffffffLL);
+  }
+
+  /*
+   * exp(x) for -708 < x < 708. Range reduction and rational approximation
+   * as in fdlibm (error below 1 ulp)
+   */
+  inline vdouble vexp(vdouble x)
+  {
+    const double magic=6755399441055744.0; // 1.5*2^52
+    vdouble t,kd,hi,lo,r,rr,c,y;
+    vint k;
+
+    t=x*1.44269504088896338700e+00+magic;
+    kd=t-magic; // round(x/log(2))
+    k=((vint) t)-((vint) (vdouble()+magic));
+    hi=x-kd*6.93147180369123816490e-01;
+    lo=kd*1.90821492927058770002e-10;
+    r=hi-lo; rr=r*r;
+    c=r-rr*(1.66666666666666019037e-01+rr*(-2.77777777770155933842e-03+
+      rr*(6.61375632143793436117e-05+rr*(-1.65339022054652515390e-06+
+      rr*4.13813679705723846039e-08))));
+    y=1.0-((lo-(r*c)/(2.0-c))-hi);
+    return y*((vdouble) ((k+1023)<<52)); // y*2^k
+  }
+
+  /*
+   * log(x) for positive normal x. Reduction to [sqrt(2)/2,sqrt(2)] and
+   * polynomial as in fdlibm (error below 1 ulp)
+   */
+  inline vdouble vlog(vdouble x)
+  {
+    vint u,k;
+    vdouble f,dk,s,z,w,t1,t2,hfsq;
+
+    u=((vint) x)+(0x3ff0000000000000LL-0x3fe6a09e00000000LL);
+    k=(u>>52)-0x3ff;
+    u=(u&0x000fffffffffffffLL)+0x3fe6a09e00000000LL;
+    f=((vdouble) u)-1.0;
+    dk=((vdouble) (k+0x4338000000000000LL))-6755399441055744.0;
+    hfsq=0.5*f*f;
+    s=f/(2.0+f); z=s*s; w=z*z;
+    t1=w*(3.999999999940941908e-01+w*(2.222219843214978396e-01+
+			       w*1.531383769920937332e-01));
+    t2=z*(6.666666666666735130e-01+w*(2.857142874366239149e-01+
+      w*(1.818357216161805012e-01+w*1.479819860511658591e-01)));
+    return s*(hfsq+t2+t1)+dk*1.90821492927058770002e-10-hfsq+f+
+      dk*6.93147180369123816490e-01;
+  }
+
+  /*
+   * Same as 'SpecfunServices::erfRationalHelperR3'
+   */
+  inline vdouble vratR3(vdouble y)
+  {
+    vdouble nom,den;
+
+    nom=y*1.85777706184603153e-1; den=y;
+    nom=(nom+3.16112374387056560)*y; den=(den+2.36012909523441209e+1)*y;
+    nom=(nom+1.13864154151050156e+2)*y; den=(den+2.44024637934444173e+2)*y;
+    nom=(nom+3.77485237685302021e+2)*y; den=(den+1.28261652607737228e+3)*y;
+    return (nom+3.20937758913846947e+3)/(den+2.84423683343917062e+3);
+  }
+
+  /*
+   * Same as 'SpecfunServices::erfRationalHelper' for x>0, both branches
+   * are evaluated
+   */
+  inline vdouble vratQ(vdouble x)
+  {
+    vdouble y,res1,den1,res2,den2;
+
+    // x >= ERF_CODY_LIMIT2
+    y=2.0/x/x;
+    res1=y*1.63153871373020978e-2; den1=y;
+    res1=(res1+3.05326634961232344e-1)*y; den1=(den1+2.56852019228982242)*y;
+    res1=(res1+3.60344899949804439e-1)*y; den1=(den1+1.87295284992346047)*y;
+    res1=(res1+1.25781726111229246e-1)*y;
+    den1=(den1+5.27905102951428412e-1)*y;
+    res1=(res1+1.60837851487422766e-2)*y;
+    den1=(den1+6.05183413124413191e-2)*y;
+    res1=1.0-SpecfunServices::m_sqrtpi*y*(res1+6.58749161529837803e-4)/
+      (den1+2.33520497626869185e-3);
+    // x < ERF_CODY_LIMIT2
+    y=x/SpecfunServices::m_sqrt2;
+    res2=y*2.15311535474403846e-8; den2=y;
+    res2=(res2+5.64188496988670089e-1)*y;
+    den2=(den2+1.57449261107098347e+1)*y;
+    res2=(res2+8.88314979438837594)*y; den2=(den2+1.17693950891312499e+2)*y;
+    res2=(res2+6.61191906371416295e+1)*y;
+    den2=(den2+5.37181101862009858e+2)*y;
+    res2=(res2+2.98635138197400131e+2)*y;
+    den2=(den2+1.62138957456669019e+3)*y;
+    res2=(res2+8.81952221241769090e+2)*y;
+    den2=(den2+3.29079923573345963e+3)*y;
+    res2=(res2+1.71204761263407058e+3)*y;
+    den2=(den2+4.36261909014324716e+3)*y;
+    res2=(res2+2.05107837782607147e+3)*y;
+    den2=(den2+3.43936767414372164e+3)*y;
+    res2=SpecfunServices::m_sqrtpi*y*(res2+1.23033935479799725e+3)/
+      (den2+1.23033935480374942e+3);
+    return vsel(x>=5.6569,res1,res2);
+  }
+
+  /*
+   * Kernels. The three cases of the scalar methods are: (A) |z| <
+   * ERF_CODY_LIMIT1, (B) z <= -ERF_CODY_LIMIT1, (C) z >= ERF_CODY_LIMIT1.
+   * All are evaluated, the result is selected.
+   */
+
+  inline vdouble vlogPdfNormal(vdouble z)
+  {
+    return -0.5*(SpecfunServices::m_ln2pi+z*z);
+  }
+
+  inline vdouble vcdfNormal(vdouble z)
+  {
+    vint mA=(vabs(z)<0.6629),mB=(z<0.0)&(~mA);
+    vdouble r3,eq;
+
+    r3=(z/SpecfunServices::m_sqrt2)*vratR3(0.5*z*z);
+    eq=vexp(vlogPdfNormal(z))*vratQ(vabs(z));
+    return vsel(mA,0.5*(1.0+r3),vsel(mB,eq/(-z),1.0-eq/z));
+  }
+
+  inline vdouble vlogCdfNormal(vdouble z)
+  {
+    vint mA=(vabs(z)<0.6629),mB=(z<0.0)&(~mA);
+    vdouble lp,q,u,w,lv,l1p;
+
+    lp=vlogPdfNormal(z);
+    q=vratQ(vabs(z));
+    // (A), (C): log1p(u) = log(w) + correction, w = 1+u
+    u=vsel(mA,(z/SpecfunServices::m_sqrt2)*vratR3(0.5*z*z),
+	   -vexp(lp)*q/z);
+    w=1.0+u;
+    // (B): log N(z) + log(Q(-z)/(-z))
+    lv=vlog(vsel(mB,q/(-z),w));
+    l1p=lv-((w-1.0)-u)/w;
+    return vsel(mB,lp+lv,vsel(mA,l1p-SpecfunServices::m_ln2,l1p));
+  }
+
+  inline vdouble vderivLogCdfNormal(vdouble z)
+  {
+    vint mA=(vabs(z)<0.6629),mB=(z<0.0)&(~mA);
+    vdouble e,q,r3;
+
+    e=vexp(vlogPdfNormal(z));
+    q=vratQ(vabs(z));
+    r3=(z/SpecfunServices::m_sqrt2)*vratR3(0.5*z*z);
+    return vsel(mA,2.0*e/(1.0+r3),vsel(mB,-z/q,e/(1.0-e*q/z)));
+  }
+
+  /*
+   * Kernel classes for 'apply'. The kernels do not treat underflow of
+   * exp(log N(z)), arguments with |z| > 'maxArg' are passed to the
+   * scalar method
+   */
+  struct KLogPdfNormal {
+    static double maxArg() { return DBL_MAX; }
+    static vdouble eval(vdouble z) { return vlogPdfNormal(z); }
+    static double scalar(double z) {
+      return specfun_scalar::logPdfNormal(z);
+    }
+  };
+  struct KCdfNormal {
+    static double maxArg() { return 37.0; }
+    static vdouble eval(vdouble z) { return vcdfNormal(z); }
+    static double scalar(double z) {
+      return specfun_scalar::cdfNormal(z);
+    }
+  };
+  struct KLogCdfNormal {
+    static double maxArg() { return 37.0; }
+    static vdouble eval(vdouble z) { return vlogCdfNormal(z); }
+    static double scalar(double z) {
+      return specfun_scalar::logCdfNormal(z);
+    }
+  };
+  struct KDerivLogCdfNormal {
+    static double maxArg() { return 37.0; }
+    static vdouble eval(vdouble z) { return vderivLogCdfNormal(z); }
+    static double scalar(double z) {
+      return specfun_scalar::derivLogCdfNormal(z);
+    }
+  };
+
+  inline bool anyLane(vint m)
+  {
+    int j;
+    bool ret=false;
+
+    for (j=0; j<width; j++)
+      ret|=(m[j]!=0);
+    return ret;
+  }
+
+  /*
+   * Applies kernel 'K' to z[0:n]. 'res'=='z' is allowed. Arguments with
+   * |z| > 'K::maxArg' or which are not finite are passed to the scalar
+   * method. The remainder is done in a zero-padded buffer.
+   */
+  template<class K> inline void apply(const double* z,double* res,int n)
+  {
+    const double maxArg=K::maxArg();
+    int i,j,nb;
+    double zt[SPECFUN_VEC_WIDTH],rt[SPECFUN_VEC_WIDTH];
+    vdouble zv,rv;
+    vint isOut;
+
+    for (i=0; i+width<=n; i+=width) {
+      memcpy(&zv,z+i,sizeof(zv));
+      rv=K::eval(zv);
+      memcpy(res+i,&rv,sizeof(rv));
+      isOut=~(vabs(zv)<=maxArg);
+      if (anyLane(isOut))
+	for (j=0; j<width; j++)
+	  if (isOut[j]!=0)
+	    res[i+j]=K::scalar(zv[j]);
+    }
+    if (i<n) {
+      nb=n-i;
+      for (j=0; j<width; j++)
+	zt[j]=(j<nb)?z[i+j]:0.0;
+      memcpy(&zv,zt,sizeof(zv));
+      rv=K::eval(zv);
+      memcpy(rt,&rv,sizeof(rv));
+      for (j=0; j<nb; j++)
+	res[i+j]=(fabs(zt[j])<=maxArg)?rt[j]:K::scalar(zt[j]);
+    }
+  }
+
+  void logPdfNormal(const double* z,double* res,int n)
+  {
+    apply<KLogPdfNormal>(z,res,n);
+  }
+
+  void cdfNormal(const double* z,double* res,int n)
+  {
+    apply<KCdfNormal>(z,res,n);
+  }
+
+  void logCdfNormal(const double* z,double* res,int n)
+  {
+    apply<KLogCdfNormal>(z,res,n);
+  }
+
+  void derivLogCdfNormal(const double* z,double* res,int n)
+  {
+    apply<KDerivLogCdfNormal>(z,res,n);
+  }
+}
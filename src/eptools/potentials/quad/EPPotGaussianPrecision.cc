@@ -28,7 +28,6 @@
     intFuncPars.cdrho=cc/crho;
     temp=cmu-yscal;
     intFuncPars.xi=temp*temp/crho;
-    intFuncPars.l=0;
     intFuncPars.init();
     // Laplace transformation if ca>0.5
     bool doLaplace=(ca>0.5001);
@@ -73,68 +72,45 @@
       // No transformation
       vstar=0.0; sigma=1.0;
     }
-    // Quadrature calls: log Z_tilde and kappa moments
-    // The integral are over [0,infty) (before transformation), and the
+    // Quadrature call: Z_tilde, kappa moments, v moments
+    // The integral is over [0,infty) (before transformation), and the
     // integrand is smooth. It has a singularity at 0 iff 'ca'<1/2.
-    double lztil,ex1,ex2,hvstar,limA;
+    // Since tau = v/rho (w.r.t. the tilted distribution), we have
+    // E[tau^k] = E[v^k]/rho^k.
+    double ival[5],lztil,ex1,ex2,hvstar,limA;
     intFuncPars.vstar=vstar;
     intFuncPars.sigma=sigma;
     hvstar=doLaplace?intFuncPars.getH(vstar):0.0;
     intFuncPars.off=hvstar;
     limA=-vstar/sigma;
-    if (quadServ->quad(intFunc,limA,false,limA,true,lztil,true)!=0) {
+    if (quadServ->quadVec(intFunc,5,limA,false,limA,true,ival,true)!=0) {
       if (verbose>0)
-	cout << "  Quad(lztil, l=0) fails" << endl;
+	cout << "  Quadrature fails" << endl;
       return false; // Quadrature failure
     }
-    if (lztil<(1e-12)) {
+    if (ival[0]<(1e-12)) {
       if (verbose>0)
-	cout << "  Z_til too small (" << lztil << ")" << endl;
+	cout << "  Z_til too small (" << ival[0] << ")" << endl;
       return false; // Z_til too small (failure of mode normalization?)
     }
-    lztil=log(lztil)-hvstar; // log Z_til
-    if (logz!=0)
+    lztil=log(ival[0])-hvstar; // log Z_til
+    if (logz!=0) {
       *logz = lztil-0.5*(log(crho)+SpecfunServices::m_ln2pi);
-    intFuncPars.off=-lztil; // New offset is -log Z_til
-    intFuncPars.l=1;
-    if (quadServ->quad(intFunc,limA,false,limA,true,ex1,true)!=0) {
-      if (verbose>0)
-	cout << "  Quad(ex1, l=1) fails" << endl;
-      return false; // Quadrature failure
-    }
-    intFuncPars.l=2;
-    if (quadServ->quad(intFunc,limA,false,limA,true,ex2,true)!=0) {
-      if (verbose>0)
-	cout << "  Quad(ex2, l=2) fails" << endl;
-      return false; // Quadrature failure
+      if (doLaplace)
+	*logz+=log(sigma); // d v = sigma d x
     }
+    ex1=ival[1]/ival[0];
+    ex2=ival[2]/ival[0];
     ret[0]=ex1*(yscal-cmu)/crho; // alpha
     ret[1]=(ex1-intFuncPars.xi*(ex2-ex1*ex1))/crho; // nu
     // tau moments -> a_hat, c_hat
-    intFuncPars.l=0; // Reset
-    intFuncPars.off=-lztil;
-    intFuncPars.a=ca+1.0;
-    intFuncPars.init();
-    if (quadServ->quad(intFunc,limA,false,limA,true,ex1,true)!=0) {
-      if (verbose>0)
-	cout << "  Quad(ex_tau1) fails" << endl;
-      return false; // Quadrature failure
-    }
-    ex1*=(ca/cc);
+    ex1=ival[3]/(ival[0]*crho); // E[tau]
     if (ex1<(1e-12)) {
       if (verbose>0)
 	cout << "  E[tau] too small (" << ex1 << ")" << endl;
       return false;
     }
-    intFuncPars.off=-log(ex1);
-    intFuncPars.a=ca+2.0;
-    intFuncPars.init();
-    if (quadServ->quad(intFunc,limA,false,limA,true,ex2,true)!=0) {
-      if (verbose>0)
-	cout << "  Quad(ex_tau2) fails" << endl;
-      return false; // Quadrature failure
-    }
-    ex2*=((ca+1.0)/cc);
+    ex2=ival[4]/(ival[0]*crho*crho*ex1); // E[tau^2]/E[tau]
     if (ex2-ex1<(1e-12)) {
       if (verbose>0)
 	cout << "  x2-x1 too small (" << ex2-ex1 << ")" << endl;
@@ -20,16 +20,17 @@
 //BEGINNS(eptools)
   /**
    * Represents integrand function g(x) and its parameters:
-   *   g(x) = exp( off - h_l(v_* + sigma*x) ),
-   * where h_l(v) depends on a, c/rho, xi and l:
-   *   h_l(v) = -log f_l(kappa,xi) - log G(v|a,c/rho),
+   *   g(x) = exp( off - h_0(v) ),  v = v_* + sigma*x,
+   * where h_0(v) depends on a, c/rho, xi:
+   *   h_0(v) = -log f_0(kappa,xi) - log G(v|a,c/rho),
    *   kappa = v/(1+v)
+   * The vector integrand is g(x) [1, kappa, kappa^2, v, v^2], all
+   * moments required by 'EPPotGaussianPrecision::compMoments'.
    */
   class EPPotGaussianPrecision_intFuncParams
   {
   public:
     double a,cdrho,xi;
-    int l;
     double vstar,sigma;
     double off,cnst;
 
@@ -37,15 +38,13 @@
      * Must be called whenever parameters a, c/rho or xi are changed.
      */
     void init() {
-      if (a<(1e-16) || cdrho<(1e-16) || xi<0.0 || l<0 || l>2)
+      if (a<(1e-16) || cdrho<(1e-16) || xi<0.0)
 	throw InvalidParameterException(EXCEPT_MSG(""));
       cnst=0.5*xi-a*log(cdrho)+SpecfunServices::logGamma(a);
     }
 
     double getH(double v) const {
-      int dl=(double) l;
-
-      return (dl+0.5)*log1p(v)-(a+dl-0.5)*log(v)-0.5*xi/(1.0+v)+cdrho*v+cnst;
+      return 0.5*log1p(v)-(a-0.5)*log(v)-0.5*xi/(1.0+v)+cdrho*v+cnst;
     }
 
     double getG(double x) const {
@@ -53,7 +52,18 @@
     }
 
     /**
-     * Second derivative h_0''(v). This does not depend on 'cdrho', 'l'.
+     * Writes g(x) [1, kappa, kappa^2, v, v^2] to 'fvals'.
+     */
+    void getGVec(double x,double* fvals) const {
+      double v=vstar+sigma*x,g=exp(off-getH(v)),kappa=v/(1.0+v);
+
+      fvals[0]=g;
+      fvals[1]=g*kappa; fvals[2]=fvals[1]*kappa;
+      fvals[3]=g*v; fvals[4]=fvals[3]*v;
+    }
+
+    /**
+     * Second derivative h_0''(v). This does not depend on 'cdrho'.
      */
     double getD2H(double v) const {
       double temp=v+1.0;
@@ -63,12 +73,13 @@
   };
 
   /**
-   * Integrand function g(x) passed to quadrature routine. See
+   * Vector integrand function passed to quadrature routine. See
    * 'EPPotGaussianPrecision_intFuncParams' comments.
    */
-  inline double EPPotGaussianPrecision_intFunc(double x,void* params)
+  inline void EPPotGaussianPrecision_intFunc(double x,void* params,
+					     double* fvals)
   {
-    return ((const EPPotGaussianPrecision_intFuncParams*) params)->getG(x);
+    ((const EPPotGaussianPrecision_intFuncParams*) params)->getGVec(x,fvals);
   }
 
   /**
@@ -92,7 +103,7 @@
 
     double yscal;
     Handle<QuadratureServices> quadServ; // Quadrature services
-    quad_function intFunc;               // Represents integrand g(x)
+    quad_vecfunction intFunc;            // Represents integrand g(x)
     mutable EPPotGaussianPrecision_intFuncParams intFuncPars;
 
   public:
@@ -108,7 +119,6 @@
 			   double py=0.0) : quadServ(qserv) {
       setY(py);
       // Integrand function
-      intFuncPars.l=0;
       intFunc.function=&EPPotGaussianPrecision_intFunc;
       intFunc.params=(void*) &intFuncPars;
     }
@@ -163,6 +173,9 @@
      * If 'ca'<=1/2, the integrand's mode is at 0 (left boundary), a
      * singularity if 'ca'<1/2. In this case, we do not apply a
      * transformation.
+     * <p>
+     * All moments (Z, kappa moments for alpha, nu, and tau moments for
+     * a_hat, c_hat) are obtained by a single 'quadVec' call.
      */
     bool compMoments(const double* inp,double* ret,double* logz=0,
 		     double eta=1.0) const;
@@ -67,6 +67,26 @@
 	throw InvalidParameterException(EXCEPT_MSG(""));
       l=h-rscal*rho; r=h+yscal*rho;
     }
+
+    /**
+     * Does not call 'setPars' (y, r are read from 'pars[0]', 'pars[1]').
+     */
+    void evalBatch(int num,const double* s,const double* const* pars,
+		   const int* parStr,double* dl,double* ddl);
+
+    /**
+     * Does not call 'setPars' (y, r are read from 'pars[0]', 'pars[1]').
+     */
+    void initBracketBatch(int num,const double* h,const double* rho,
+			  const double* const* pars,const int* parStr,
+			  double* l,double* r) {
+      for (int j=0; j<num; j++) {
+	if (rho[j]<(1e-16))
+	  throw InvalidParameterException(EXCEPT_MSG(""));
+	l[j]=h[j]-pars[1][j*parStr[1]]*rho[j];
+	r[j]=h[j]+pars[0][j*parStr[0]]*rho[j];
+      }
+    }
   };
 
   inline double EPPotNegBinomialExpRate::eval(double s,double* dl,
@@ -84,12 +104,39 @@
       ret=-yscal*s+(rscal+yscal)*(lgr+log1p(temp));
     }
     if (dl!=0)
-      (*dl) = (yscal+rscal)*sig;
+      (*dl) = (yscal+rscal)*sig-yscal;
     if (ddl!=0)
       (*ddl) = (yscal+rscal)*sig*(1.0-sig);
 
     return ret;
   }
+
+  inline void EPPotNegBinomialExpRate::evalBatch(int num,const double* s,
+						 const double* const* pars,
+						 const int* parStr,double* dl,
+						 double* ddl)
+  {
+    const double* yv=pars[0];
+    const double* rv=pars[1];
+    int ystr=parStr[0],rstr=parStr[1];
+
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+    for (int j=0; j<num; j++) {
+      double yr=yv[j*ystr]+rv[j*rstr],temp,sig;
+
+      temp=s[j]-log(rv[j*rstr]);
+      if (temp>=0.0)
+	sig=1.0/(1.0+exp(-temp));
+      else {
+	temp=exp(temp);
+	sig=temp/(1.0+temp);
+      }
+      dl[j]=yr*sig-yv[j*ystr];
+      ddl[j]=yr*sig*(1.0-sig);
+    }
+  }
 //ENDNS
 
 #endif
@@ -83,14 +83,68 @@
       return lam-yscal*log(lam)+logYFact;
     }
 
-    void initBracket(double h,double rho,double& l,double& r) const;
+    /**
+     * Does not call 'setPars' (y is read from 'pars[0]').
+     */
+    void evalBatch(int num,const double* s,const double* const* pars,
+		   const int* parStr,double* dl,double* ddl);
+
+    void initBracket(double h,double rho,double& l,double& r) const {
+      initBracketY(h,rho,yscal,l,r);
+    }
+
+    /**
+     * Does not call 'setPars' (y is read from 'pars[0]').
+     */
+    void initBracketBatch(int num,const double* h,const double* rho,
+			  const double* const* pars,const int* parStr,
+			  double* l,double* r) {
+      for (int j=0; j<num; j++)
+	initBracketY(h[j],rho[j],pars[0][j*parStr[0]],l[j],r[j]);
+    }
+
+  protected:
+    static void initBracketY(double h,double rho,double y,double& l,
+			     double& r);
   };
 
+  inline void EPPotPoissonLogisticRate::evalBatch(int num,const double* s,
+						  const double* const* pars,
+						  const int* parStr,double* dl,
+						  double* ddl)
+  {
+    const double* yv=pars[0];
+    int ystr=parStr[0];
+
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+    for (int j=0; j<num; j++) {
+      double sj=s[j],y=yv[j*ystr],temp,sig,lam,sgdlm;
+
+      if (sj>=0.0) {
+	temp=exp(-sj);
+	sig=1.0/(1.0+temp);
+	lam=sj+log1p(temp);
+	sgdlm=sig/lam;
+      } else {
+	temp=exp(sj);
+	sig=temp/(1.0+temp);
+	lam=log1p(temp);
+	sgdlm=(sj>-10.0)?(sig/lam):(1.0/(1.0+temp));
+      }
+      dl[j]=sig-y*sgdlm;
+      temp=1.0-sig;
+      ddl[j]=sig*temp+y*sgdlm*(sgdlm-temp);
+    }
+  }
+
   /*
    * Details in technical report
    */
-  inline void EPPotPoissonLogisticRate::initBracket(double h,double rho,
-						    double& l,double& r) const
+  inline void EPPotPoissonLogisticRate::initBracketY(double h,double rho,
+						     double y,double& l,
+						     double& r)
   {
     int i;
     double a,sga;
@@ -102,8 +156,8 @@
     for (i=0; i<5; i++) {
       a=acand[i]; sga=1.0/(1.0+exp(-a));
       r=h-sga*rho;
-      if (yscal>0.0)
-	r=0.5*(r+sqrt(r*r+4.0*yscal*rho));
+      if (y>0.0)
+	r=0.5*(r+sqrt(r*r+4.0*y*rho));
       if (r>a)
 	break;
     }
@@ -8,10 +8,11 @@
 
 #include "src/eptools/potentials/quad/EPPotQuadLaplaceApprox.h"
 #include "src/eptools/potentials/SpecfunServices.h"
+#include <algorithm>
 
 //BEGINNS(eptools)
 EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qpot,const Handle<QuadratureServices>& qserv) :
-  EPPotQuadrature(qpot),qpotProx(qpot.p()),quadServ(qserv)
+  EPPotQuadrature(qpot),qpotProx(qpot.p()),quadServ(qserv),warmSt(0)
   {
     if (!qpot->hasSecondDerivatives())
       throw InvalidParameterException(EXCEPT_MSG("Need 2nd derivatives"));
@@ -33,7 +34,6 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
     }
     // Integrand function
     intFuncPars.qpot=qpot.p();
-    intFuncPars.k=0;
     intFunc.function=&EPPotQuadLaplaceApprox_intFunc;
     intFunc.params=(void*) &intFuncPars;
   }
@@ -45,10 +45,8 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
   bool EPPotQuadLaplaceApprox::compMoments(const double* inp,double* ret,
 					   double* logz,double eta) const
   {
-    int i,wsz,verbose=quadServ->getVerbose();
-    double a,b,sstar,sigma,cmu=inp[0],crho=inp[1];
-    bool aInf,bInf,isCritical;
-    ArrayHandle<double> wayPts;
+    int verbose=quadServ->getVerbose();
+    double sstar,cmu=inp[0],crho=inp[1];
 
     if (crho<1e-14 || eta<1e-10 || eta>1.0)
       throw InvalidParameterException(EXCEPT_MSG(""));
@@ -61,12 +59,26 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
 	cout << ", eta=" << eta << endl;
     }
     // Determine mode of integrand
-    if (!qpotProx->proximal(cmu,eta*crho,sstar)) {
+    if (!((warmSt!=0)?qpotProx->proximalWarm(cmu,eta*crho,sstar,warmSt):
+	  qpotProx->proximal(cmu,eta*crho,sstar))) {
       if (verbose>0)
 	cout << "  Proximal map computation failed"
 	     << endl;
       return false; // Update fails if mode search not successful
     }
+
+    return compMomentsMode(cmu,crho,sstar,ret,logz,eta);
+  }
+
+  bool EPPotQuadLaplaceApprox::compMomentsMode(double cmu,double crho,
+					       double sstar,double* ret,
+					       double* logz,double eta) const
+  {
+    int i,wsz,verbose=quadServ->getVerbose();
+    double a,b,sigma;
+    bool aInf,bInf,isCritical;
+    ArrayHandle<double> wayPts;
+
     if (verbose>0)
       cout << "  s_star=" << sstar << endl;
     // Interval [a,b] and waypoints. Can we use 2nd derivative at 'sstar'?
@@ -91,7 +103,6 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
     intFuncPars.rho=crho;
     intFuncPars.eta=eta;
     intFuncPars.sstar=sstar;
-    intFuncPars.k=0; // Z (0th order) is first
     if (isCritical)
       sigma=sqrt(crho); // Sitting on critical point: Fallback
     else {
@@ -111,16 +122,18 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
     if (!bInf) b=(b-sstar)/sigma;
     for (i=0; i<wsz; i++)
       wayPts[i]=(wayPts[i]-sstar)/sigma;
-    // Run quadrature calls. We first estimate the normalization constant
-    // Z_til after mode normalization, then 1st and 2nd moment
+    // Run quadrature. The normalization constant Z_til after mode
+    // normalization, and the unnormalized 1st and 2nd moment are computed in
+    // one pass
     // TODO: Verbosity! React to errors appropriately.
-    double ztil,ex1,ex2;
-    if (quadServ->quad(intFunc,a,aInf,b,bInf,ztil,qpotProx->hasWayPoints(),
-		       wayPts)!=0) {
+    double ival[3],ztil,ex1,ex2;
+    if (quadServ->quadVec(intFunc,3,a,aInf,b,bInf,ival,
+			  qpotProx->hasWayPoints(),wayPts)!=0) {
       if (verbose>0)
-	cout << "  Quad(k=0) fails" << endl;
+	cout << "  Quadrature fails" << endl;
       return false; // Quadrature failure
     }
+    ztil=ival[0];
     if (ztil<(1e-12)) {
       if (verbose>0)
 	cout << "  Z_til too small (" << ztil << ")" << endl;
@@ -129,24 +142,8 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
     if (logz!=0)
       *logz = log(ztil)-intFuncPars.hsstar+log(sigma)-
 	0.5*(log(crho)+SpecfunServices::m_ln2pi);
-    // We fold Z_til into the 1st and 2nd moment computation by subtracting
-    // log Z_til from h(sstar) in 'intFuncPars'.
-    // NOTE: Do not call 'intFuncPars.init()', would overwrite 'hsstar'!
-    intFuncPars.hsstar-=log(ztil);
-    intFuncPars.k=1;
-    if (quadServ->quad(intFunc,a,aInf,b,bInf,ex1,qpotProx->hasWayPoints(),
-		       wayPts)!=0) {
-      if (verbose>0)
-	cout << "  Quad(k=1) fails" << endl;
-      return false; // Quadrature failure
-    }
-    intFuncPars.k=2;
-    if (quadServ->quad(intFunc,a,aInf,b,bInf,ex2,qpotProx->hasWayPoints(),
-		       wayPts)!=0) {
-      if (verbose>0)
-	cout << "  Quad(k=2) fails" << endl;
-      return false; // Quadrature failure
-    }
+    ex1=ival[1]/ztil;
+    ex2=ival[2]/ztil;
     // Can alpha, nu be estimated more directly? Here, we compute them from
     // E[x], E[x^2], expectation w.r.t. p_hat.
     ret[0]=(sigma*ex1+sstar-cmu)/crho; // alpha
@@ -155,4 +152,55 @@ EPPotQuadLaplaceApprox::EPPotQuadLaplaceApprox(const Handle<QuadPotProximal>& qp
 
     return true;
   }
+
+  void EPPotQuadLaplaceApprox::compMomentsBatch(int num,const double* cmu,
+						const double* crho,
+						const double* const* pars,
+						const int* parStr,
+						double* alpha,double* nu,
+						double* logz,int* rstat,
+						double eta)
+  {
+    int l,l0,nc,k,np=numPars();
+    double rhoB[batchChunk],sstar[batchChunk],ret[2];
+    ArrayHandle<const double*> cpars(np);
+    ArrayHandle<double> oldPars(np),potPars(np);
+
+    if (eta<1e-10 || eta>1.0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    for (l=0; l<num; l++)
+      if (crho[l]<1e-14)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+    if (np>0) getPars(oldPars.p());
+    try {
+      for (l0=0; l0<num; l0+=batchChunk) {
+	nc=std::min(batchChunk,num-l0);
+	// Modes of integrands
+	for (l=0; l<nc; l++)
+	  rhoB[l]=eta*crho[l0+l];
+	for (k=0; k<np; k++)
+	  cpars[k]=pars[k]+l0*parStr[k];
+	qpotProx->proximalBatch(nc,cmu+l0,rhoB,cpars.p(),parStr,sstar,
+				rstat+l0);
+	// Quadrature
+	for (l=0; l<nc; l++) {
+	  alpha[l0+l]=nu[l0+l]=0.0;
+	  if (rstat[l0+l]==0) continue;
+	  if (np>0) {
+	    for (k=0; k<np; k++)
+	      potPars[k]=cpars[k][l*parStr[k]];
+	    setPars(potPars.p());
+	  }
+	  ret[0]=ret[1]=0.0;
+	  rstat[l0+l]=compMomentsMode(cmu[l0+l],crho[l0+l],sstar[l],ret,
+				      (logz!=0)?(logz+l0+l):0,eta)?1:0;
+	  alpha[l0+l]=ret[0]; nu[l0+l]=ret[1];
+	}
+      }
+    } catch (...) {
+      if (np>0) setPars(oldPars.p());
+      throw;
+    }
+    if (np>0) setPars(oldPars.p());
+  }
 //ENDNS
@@ -20,8 +20,8 @@
 //BEGINNS(eptools)
   /**
    * Information passed to 'EPPotQuadLaplaceApprox_intFunc'.
-   * The integrand is
-   *   g(x) = x^k exp( h(s_*) - h(s_* + sigma*x) ),
+   * The integrand is [g(x), x g(x), x^2 g(x)],
+   *   g(x) = exp( h(s_*) - h(s_* + sigma*x) ),
    *   h(s) = eta*l(s) + (s-h)^2/(2*rho)
    * Here, l(s) = -log t(s) is represented by the 'QuadraturePotential'
    * object.
@@ -36,15 +36,13 @@
     double h,rho,eta;
     double sstar,sigma;
     double hsstar;
-    int k;
 
     /**
      * Must be called whenever parameters have been changed. Throws exception
      * if parameters invalid, does precomputations.
      */
     void init() {
-      if (qpot==0 || rho<(1e-16) || eta<=0.0 || eta>1.0 || sigma<(1e-16) ||
-	  k<0 || k>2)
+      if (qpot==0 || rho<(1e-16) || eta<=0.0 || eta>1.0 || sigma<(1e-16))
 	throw InvalidParameterException(EXCEPT_MSG(""));
       hsstar=getH(sstar);
     }
@@ -55,18 +53,16 @@
     }
 
     double getG(double x) const {
-      double ret=exp(hsstar-getH(sstar+sigma*x));
-
-      switch (k) {
-      case 1:
-	ret*=x;
-	break;
-      case 2:
-	ret*=(x*x);
-	break;
-      }
-
-      return ret;
+      return exp(hsstar-getH(sstar+sigma*x));
+    }
+
+    /**
+     * Writes [g(x), x g(x), x^2 g(x)] to 'fvals'.
+     */
+    void getGVec(double x,double* fvals) const {
+      double g=getG(x);
+
+      fvals[0]=g; fvals[1]=g*x; fvals[2]=g*x*x;
     }
 
     /**
@@ -80,12 +76,13 @@
   };
 
   /**
-   * Integrand function g(x) passed to quadrature routine. See
-   * 'EPPotQuadLaplaceApprox_intFuncParams' comments.
+   * Integrand function [g(x), x g(x), x^2 g(x)] passed to quadrature
+   * routine. See 'EPPotQuadLaplaceApprox_intFuncParams' comments.
    */
-  inline double EPPotQuadLaplaceApprox_intFunc(double x,void* params)
+  inline void EPPotQuadLaplaceApprox_intFunc(double x,void* params,
+					     double* fvals)
   {
-    return ((const EPPotQuadLaplaceApprox_intFuncParams*) params)->getG(x);
+    ((const EPPotQuadLaplaceApprox_intFuncParams*) params)->getGVec(x,fvals);
   }
 
   /**
@@ -108,6 +105,14 @@
    * waypoint or one of a, b. The normalized and transformed integrand g(x)
    * is represented by 'EPPotQuadLaplaceApprox_intFuncParams'. It is passed
    * to the quadrature code in 'quadServ' for computing 0th, 1st, 2nd moments.
+   * These are obtained by a single 'quadVec' call, so that g(x) is
+   * evaluated once per node.
+   * If a warm start state is given ('setWarmState'), the proximal map is
+   * started from the last solution for the potential.
+   * 'compMomentsBatch' determines the modes for a chunk of potentials by
+   * 'QuadPotProximal::proximalBatch' (lock-step Newton for
+   * 'QuadPotProximalNewton'), then runs the quadrature for each. The warm
+   * start state is not used there.
    * <p>
    * NOTE: Using the Laplace transformation together with sophisticated
    * adaptive quadrature code is probably overkill. But it can be combined
@@ -119,6 +124,9 @@
    *   int_a^b [g(x)/N(x|0,1)] N(x|0,1) d x,
    * where N(x|0,1) is the standardized weight function, and g(x)/N(x|0,1)
    * is (hopefully) well-approximated by a low-order polynomial.
+   * The class uses whatever is passed in 'quadServ'. 'GaussHermiteQuadServices'
+   * implements the idea above, and is used for the quadrature potentials
+   * of the default 'EPPotentialFactory'.
    *
    * @author  Matthias Seeger
    * @version %I% %G%
@@ -130,8 +138,9 @@
 
     QuadPotProximal* qpotProx;            // 'quadPot' with correct type
     Handle<QuadratureServices> quadServ;  // Quadrature services
-    quad_function intFunc;                // Represents integrand g(x)
+    quad_vecfunction intFunc;             // Represents integrand g(x)
     mutable EPPotQuadLaplaceApprox_intFuncParams intFuncPars;
+    mutable double* warmSt;               // See 'setWarmState'
 
   public:
     // Public methods
@@ -155,11 +164,34 @@
      * integrand at cmu and another dedicated place, normalizing by the
      * maximum for these, and transforming by crho.
      * <p>
-     * We also return with failure if any of the quadrature service calls
-     * returns with status !=0. Again, this may be too stringent.
+     * We also return with failure if the quadrature service call returns
+     * with status !=0. Again, this may be too stringent.
      */
     bool compMoments(const double* inp,double* ret,double* logz=0,
 		     double eta=1.0) const;
+
+    /**
+     * The state is that of 'QuadPotProximal::proximalWarm', used to
+     * determine the mode of the integrand.
+     */
+    void setWarmState(double* wst) const {
+      warmSt=wst;
+    }
+
+    void compMomentsBatch(int num,const double* cmu,const double* crho,
+			  const double* const* pars,const int* parStr,
+			  double* alpha,double* nu,double* logz,int* rstat,
+			  double eta=1.0);
+
+  protected:
+    // Internal methods
+
+    /**
+     * Part of 'compMoments' after the mode 'sstar' of the integrand has
+     * been determined.
+     */
+    bool compMomentsMode(double cmu,double crho,double sstar,double* ret,
+			 double* logz,double eta) const;
   };
 //ENDNS
 
@@ -0,0 +1,186 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Definition of class GaussHermiteQuadServices
+ * ------------------------------------------------------------------- */
+
+#include "src/eptools/potentials/quad/GaussHermiteQuadServices.h"
+#include "src/eptools/potentials/quad/GaussHermiteQuadServices_tables.h"
+#include <cfloat>
+#include <cstdio>
+#include <algorithm>
+
+//BEGINNS(eptools)
+  const int GaussHermiteQuadServices::numOrders;
+  const double GaussHermiteQuadServices::cutOff=8.0;
+  const double GaussHermiteQuadServices::legWidth=4.0;
+
+  /*
+   * Scalar integrand as vector of dimension 1 (used by 'quad').
+   */
+  static void gaussHermiteQuad_scalFunc(double x,void* params,double* fvals)
+  {
+    const quad_function* fun=(const quad_function*) params;
+
+    fvals[0]=(*fun->function)(x,fun->params);
+  }
+
+  /*
+   * Adds w*f(x) to 'acc'.
+   */
+  static inline void gaussHermiteQuad_node(const quad_vecfunction& fun,
+					   int dim,double x,double w,
+					   double* acc,double* fvals)
+  {
+    int k;
+
+    (*fun.function)(x,fun.params,fvals);
+    for (k=0; k<dim; k++)
+      acc[k]+=w*fvals[k];
+  }
+
+  /*
+   * Adds Gauss-Legendre over [a,b], order 10*('oind'+1), to 'acc'.
+   */
+  static inline void gaussHermiteQuad_legendre(const quad_vecfunction& fun,
+					       int dim,double a,double b,
+					       int oind,double* acc,
+					       double* fvals)
+  {
+    int i,n=10*(oind+1);
+    double mid=0.5*(a+b),hlen=0.5*(b-a);
+    const double* xP=gaussquad_tables::legX[oind];
+    const double* wP=gaussquad_tables::legW[oind];
+
+    if (hlen<=0.0) return;
+    for (i=0; i<n; i++)
+      gaussHermiteQuad_node(fun,dim,mid+hlen*xP[i],hlen*wP[i],acc,fvals);
+  }
+
+  /*
+   * Laguerre nodes are increasing, so we can stop at the first one beyond
+   * the finite far end.
+   */
+  void GaussHermiteQuadServices::quadPiece(const quad_vecfunction& fun,
+					   int dim,double a,bool aInf,
+					   double b,bool bInf,int oind,
+					   double* acc,double* fvals)
+  {
+    int i,n=10*(oind+1);
+    double x,u;
+    bool aFar=(aInf || a<=-cutOff),bFar=(bInf || b>=cutOff);
+    const double* xP,*wP;
+
+    if (aFar && bFar) {
+      xP=gaussquad_tables::hermX[oind]; wP=gaussquad_tables::hermW[oind];
+      for (i=0; i<n; i++) {
+	x=xP[i];
+	if ((aInf || x>=a) && (bInf || x<=b))
+	  gaussHermiteQuad_node(fun,dim,x,wP[i],acc,fvals);
+      }
+    } else if (bFar) {
+      u=std::max(a,0.0)+legWidth;
+      if (!bInf) u=std::min(u,b);
+      gaussHermiteQuad_legendre(fun,dim,a,u,oind,acc,fvals);
+      xP=gaussquad_tables::lagX[oind]; wP=gaussquad_tables::lagW[oind];
+      for (i=0; i<n; i++) {
+	x=u+xP[i];
+	if (!bInf && x>b) break;
+	gaussHermiteQuad_node(fun,dim,x,wP[i],acc,fvals);
+      }
+    } else if (aFar) {
+      u=std::min(b,0.0)-legWidth;
+      if (!aInf) u=std::max(u,a);
+      gaussHermiteQuad_legendre(fun,dim,u,b,oind,acc,fvals);
+      xP=gaussquad_tables::lagX[oind]; wP=gaussquad_tables::lagW[oind];
+      for (i=0; i<n; i++) {
+	x=u-xP[i];
+	if (!aInf && x<a) break;
+	gaussHermiteQuad_node(fun,dim,x,wP[i],acc,fvals);
+      }
+    } else
+      gaussHermiteQuad_legendre(fun,dim,a,b,oind,acc,fvals);
+  }
+
+  int GaussHermiteQuadServices::quad(const quad_function& fun,double a,
+				     bool aInf,double b,bool bInf,
+				     double& ival,bool hasWP,
+				     const ArrayHandle<double>& wayPts,
+				     double* abserr,string* errmsg)
+  {
+    quad_vecfunction vfun;
+
+    if (fun.function==0)
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    vfun.function=&gaussHermiteQuad_scalFunc;
+    vfun.params=(void*) &fun;
+
+    return quadVec(vfun,1,a,aInf,b,bInf,&ival,hasWP,wayPts,abserr,errmsg);
+  }
+
+  /*
+   * The first pass uses order 'ordInd', the second (if 'errEst') order
+   * 'ordInd'-1.
+   */
+  int GaussHermiteQuadServices::quadVec(const quad_vecfunction& fun,int dim,
+					double a,bool aInf,double b,bool bInf,
+					double* ival,bool hasWP,
+					const ArrayHandle<double>& wayPts,
+					double* abserr,string* errmsg)
+  {
+    int k,pass,numWP=hasWP?wayPts.size():0;
+    double lo,err,maxVal;
+    double ival2[maxVecDim],fvals[maxVecDim];
+    double* acc;
+    bool loInf;
+
+    if (fun.function==0 || dim<1 || dim>maxVecDim || ival==0 ||
+	(!aInf && !bInf && b<a))
+      throw InvalidParameterException(EXCEPT_MSG(""));
+    for (k=0; k<numWP; k++)
+      if ((k>0 && wayPts[k]<=wayPts[k-1]) || (!aInf && wayPts[k]<=a) ||
+	  (!bInf && wayPts[k]>=b))
+	throw InvalidParameterException(EXCEPT_MSG("Waypoints must be increasing, in (a,b)"));
+    for (pass=0; pass<(errEst?2:1); pass++) {
+      acc=(pass==0)?ival:ival2;
+      std::fill(acc,acc+dim,0.0);
+      lo=a; loInf=aInf;
+      for (k=0; k<numWP; k++) {
+	quadPiece(fun,dim,lo,loInf,wayPts[k],false,ordInd-pass,acc,fvals);
+	lo=wayPts[k]; loInf=false;
+      }
+      quadPiece(fun,dim,lo,loInf,b,bInf,ordInd-pass,acc,fvals);
+    }
+    for (k=0,maxVal=err=0.0; k<dim; k++) {
+      if (!(fabs(ival[k])<=DBL_MAX)) {
+	if (errmsg!=0)
+	  *errmsg="Integral value not finite";
+	if (verbose>0)
+	  cout << "GaussHermiteQuadServices::quad: Value not finite" << endl;
+	return 2;
+      }
+      maxVal=std::max(maxVal,fabs(ival[k]));
+      if (errEst)
+	err=std::max(err,fabs(ival[k]-ival2[k]));
+    }
+    if (errEst) {
+      if (abserr!=0) *abserr=err;
+      if (verbose>0)
+	cout << "GaussHermiteQuadServices::quad: I[0]=" << ival[0]
+	     << ", err=" << err << endl;
+      if (!(err<=std::max(epsAbs,epsRel*maxVal))) {
+	if (errmsg!=0) {
+	  char msg[128];
+	  sprintf(msg,"Error estimate %g above threshold",err);
+	  *errmsg=msg;
+	}
+	return 1;
+      }
+    } else if (verbose>0)
+      cout << "GaussHermiteQuadServices::quad: I[0]=" << ival[0] << endl;
+
+    return 0;
+  }
+//ENDNS
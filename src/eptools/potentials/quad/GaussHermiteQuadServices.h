@@ -0,0 +1,145 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Header class GaussHermiteQuadServices
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTOOLS_GAUSSHERMITEQUADSERVICES_H
+#define EPTOOLS_GAUSSHERMITEQUADSERVICES_H
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "src/eptools/potentials/quad/QuadratureServices.h"
+
+//BEGINNS(eptools)
+  /**
+   * Implementation of 'QuadratureServices' by fixed-order Gauss rules,
+   * without external dependencies. Node and weight tables are compiled
+   * in, for orders 10, 20, 30, 40.
+   * <p>
+   * The integrand f(x) is assumed to be standardized, as done by the
+   * Laplace transformation in 'EPPotQuadLaplaceApprox',
+   * 'EPPotGaussianPrecision': most of its mass lies within a few units
+   * of x=0, and f(x)/N(x|0,1) is smooth. An interval [a,b] (or a piece
+   * between waypoints) is treated as follows. An end is "far" if it is
+   * infinite or beyond +-'cutOff'=8:
+   * - Both ends far: Gauss-Hermite over the real line (weight function
+   *   N(x|0,1) folded into the weights), nodes outside [a,b] dropped
+   * - b far: Gauss-Legendre over [a,U], U = max(a,0)+'legWidth' (4),
+   *   and Gauss-Laguerre for the tail [U,infty), nodes beyond b dropped.
+   *   This covers the Gamma integrals of 'EPPotGaussianPrecision'
+   * - a far: Same, mirrored
+   * - No end far: Gauss-Legendre over [a,b]
+   * Waypoints split the interval into pieces. Integrable singularities
+   * at interval ends (such as x^(a-1), a<1) are not resolved well.
+   * <p>
+   * If 'errEst' is true, the integral is also computed with the rules of
+   * the next lower order, and the absolute difference is the error
+   * estimate. The cost is about 1.5 (order 20) to 1.75 (order 40) times
+   * larger then. 'quad' returns with failure if the
+   * estimate is above max('epsAbs','epsRel'*|I|). The estimate is
+   * that of the lower order rule, so it is pessimistic. Without 'errEst',
+   * 'quad' always succeeds (unless the result is not finite).
+   * <p>
+   * Different from adaptive services, an instance can be shared by
+   * several potential objects even if quadrature calls happen in parallel
+   * (no internal state is modified by 'quad').
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  class GaussHermiteQuadServices : public QuadratureServices
+  {
+  public:
+    // Constants
+
+    static const int numOrders=4;  // Orders 10, 20, 30, 40
+    static const double cutOff;    // S.a.
+    static const double legWidth;  // S.a.
+
+  protected:
+    // Members
+
+    int ordInd;              // Order is 10*(ordInd+1)
+    bool errEst;
+    double epsRel,epsAbs;
+    int verbose;
+
+  public:
+    // Public methods
+
+    /**
+     * Constructor
+     *
+     * @param order   Order of Gauss rules: 10, 20, 30, or 40. Def.: 20
+     * @param perrEst Compute error estimate? Needs 'order'>10. Def.: false
+     * @param pepsRel Relative error threshold (if 'errEst'). Def.: 1e-4
+     * @param pepsAbs Absolute error threshold (if 'errEst'). Def.: 1e-8
+     * @param pverb   Verbosity level. Def.: 0
+     */
+    GaussHermiteQuadServices(int order=20,bool perrEst=false,
+			     double pepsRel=1e-4,double pepsAbs=1e-8,
+			     int pverb=0) : errEst(perrEst),epsRel(pepsRel),
+      epsAbs(pepsAbs),verbose(pverb) {
+      if (order%10!=0 || order<10 || order>10*numOrders ||
+	  (perrEst && order==10) || pepsRel<0.0 || pepsAbs<0.0 || pverb<0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      ordInd=order/10-1;
+    }
+
+    int getOrder() const {
+      return 10*(ordInd+1);
+    }
+
+    bool hasAbsErrorEstimate() const {
+      return errEst;
+    }
+
+    int getVerbose() const {
+      return verbose;
+    }
+
+    int quad(const quad_function& fun,double a,bool aInf,double b,
+	     bool bInf,double& ival,bool hasWP,
+	     const ArrayHandle<double>& wayPts=ArrayHandleZero<double>::get(),
+	     double* abserr=0,string* errmsg=0);
+
+    /**
+     * All components share the nodes, so f(x) is evaluated once per node.
+     * For the error estimate, the maximum absolute difference over
+     * components is compared against max('epsAbs','epsRel'*max_k |I_k|).
+     */
+    int quadVec(const quad_vecfunction& fun,int dim,double a,bool aInf,
+		double b,bool bInf,double* ival,bool hasWP,
+		const ArrayHandle<double>& wayPts=
+		ArrayHandleZero<double>::get(),double* abserr=0,
+		string* errmsg=0);
+
+  protected:
+    // Internal methods
+
+    /**
+     * Adds integral of 'fun' over [a,b] (no waypoints) to 'acc', using
+     * rules of order 10*('oind'+1). See header comment.
+     *
+     * @param fun   Integrand
+     * @param dim   Dimension of f(x)
+     * @param a     Left end
+     * @param aInf  a = -infty?
+     * @param b     Right end
+     * @param bInf  b = +infty?
+     * @param oind  Order index
+     * @param acc   Integral values added here
+     * @param fvals Buffer for f(x) [dim]
+     */
+    static void quadPiece(const quad_vecfunction& fun,int dim,double a,
+			  bool aInf,double b,bool bInf,int oind,double* acc,
+			  double* fvals);
+  };
+//ENDNS
+
+#endif
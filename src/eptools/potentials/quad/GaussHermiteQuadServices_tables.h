@@ -0,0 +1,266 @@
+/* -------------------------------------------------------------------
+ * LHOTSE: Toolbox for adaptive statistical models
+ * -------------------------------------------------------------------
+ * Project source file
+ * Module: eptools
+ * Desc.:  Node and weight tables for GaussHermiteQuadServices
+ * ------------------------------------------------------------------- */
+
+// Included by 'GaussHermiteQuadServices.cc' only.
+// Gauss rules of orders 10, 20, 30, 40 (see 'GaussHermiteQuadServices').
+// Nodes are increasing. Weights are for the integral of f(x) d x, i.e. the
+// weight function is folded in:
+// - Hermite: int f(x) d x ~= sum_i w_i f(x_i), x_i roots of He_n
+//   (probabilists'), w_i = lambda_i*exp(x_i^2/2)*sqrt(2*pi)
+// - Laguerre: int_0^infty f(t) d t ~= sum_i w_i f(t_i), w_i =
+//   lambda_i*exp(t_i)
+// - Legendre: int_{-1}^1 f(x) d x ~= sum_i w_i f(x_i)
+// Here, lambda_i are the Gauss weights for the respective weight
+// function. Computed in 50-digit arithmetic (Newton on orthonormal
+// three-term recurrences, lambda_i = 1/sum_{k<n} p_k(x_i)^2), rounded to
+// double.
+
+namespace gaussquad_tables {
+  static const double hermX10[10]={
+    -4.8594628283323118,-3.5818234835519269,-2.4843258416389546,
+    -1.4659890943911582,-0.48493570751549764,0.48493570751549764,
+    1.4659890943911582,2.4843258416389546,3.5818234835519269,
+    4.8594628283323118};
+  static const double hermW10[10]={
+    1.4502076894878548,1.1605971661418844,1.048557235866699,
+    0.99461119850208868,0.97168047631834087,0.97168047631834087,
+    0.99461119850208868,1.048557235866699,1.1605971661418844,
+    1.4502076894878548};
+  static const double hermX20[20]={
+    -7.6190485416797582,-6.5105901570136542,-5.5787388058932015,
+    -4.7345813340460552,-3.9439673506573163,-3.1890148165533896,
+    -2.4586636111723679,-1.7452473208141268,-1.0429453488027511,
+    -0.34696415708135592,0.34696415708135592,1.0429453488027511,
+    1.7452473208141268,2.4586636111723679,3.1890148165533896,
+    3.9439673506573163,4.7345813340460552,5.5787388058932015,
+    6.5105901570136542,7.6190485416797582};
+  static const double hermW20[20]={
+    1.2708009389265447,0.99607722612283456,0.8800349717297421,
+    0.81354394860588752,0.77053672353451563,0.74116154008470148,
+    0.7207949926066336,0.70699487635715708,0.69840001313997879,
+    0.69426784430346433,0.69426784430346433,0.69840001313997879,
+    0.70699487635715708,0.7207949926066336,0.74116154008470148,
+    0.77053672353451563,0.81354394860588752,0.8800349717297421,
+    0.99607722612283456,1.2708009389265447};
+  static const double hermX30[30]={
+    -9.7062359973595242,-8.680837722732214,-7.8250517443528116,
+    -7.055396866960292,-6.339997686869598,-5.6623818500828742,
+    -5.0126005964865179,-4.3840203658980519,-3.7718944231592366,
+    -3.1726346394204032,-2.5834021002292733,-2.0018586129564309,
+    -1.4260056583741143,-0.85407335171097309,-0.28443876073620927,
+    0.28443876073620927,0.85407335171097309,1.4260056583741143,
+    2.0018586129564309,2.5834021002292733,3.1726346394204032,
+    3.7718944231592366,4.3840203658980519,5.0126005964865179,
+    5.6623818500828742,6.339997686869598,7.055396866960292,
+    7.8250517443528116,8.680837722732214,9.7062359973595242};
+  static const double hermW30[30]={
+    1.1798040878817031,0.91796316882304507,0.80525700940693112,
+    0.73896291654075208,0.69446087761861353,0.66238201220299586,
+    0.63826433008301475,0.61967588815568819,0.60516752818390984,
+    0.59382120905731806,0.58503096649274366,0.57838729013070356,
+    0.57361226637519469,0.57052177642512891,0.56900326429730108,
+    0.56900326429730108,0.57052177642512891,0.57361226637519469,
+    0.57838729013070356,0.58503096649274366,0.59382120905731806,
+    0.60516752818390984,0.61967588815568819,0.63826433008301475,
+    0.66238201220299586,0.69446087761861353,0.73896291654075208,
+    0.80525700940693112,0.91796316882304507,1.1798040878817031};
+  static const double hermX40[40]={
+    -11.453377841548731,-10.481560534674268,-9.6735563669340312,
+    -8.9495045438555536,-8.2789406236594765,-7.6461637645414617,
+    -7.0417384064538293,-6.4594233775837679,-5.8948056753720186,
+    -5.3446054457200862,-4.8062871920938735,-4.2778261563627495,
+    -3.7575597761689861,-3.2440887329998702,-2.7362083404654309,
+    -2.2328592186348719,-1.7330905906317213,-1.2360320047991582,
+    -0.74087072528593045,-0.24683289602272435,0.24683289602272435,
+    0.74087072528593045,1.2360320047991582,1.7330905906317213,
+    2.2328592186348719,2.7362083404654309,3.2440887329998702,
+    3.7575597761689861,4.2778261563627495,4.8062871920938735,
+    5.3446054457200862,5.8948056753720186,6.4594233775837679,
+    7.0417384064538293,7.6461637645414617,8.2789406236594765,
+    8.9495045438555536,9.6735563669340312,10.481560534674268,
+    11.453377841548731};
+  static const double hermW40[40]={
+    1.1203024090583602,0.86826165469478556,0.75889037613857369,
+    0.69390564145414579,0.64972418216243522,0.61735722779651181,
+    0.59251287357211946,0.57284183935389821,0.55693404566855886,
+    0.54388525432916723,0.53308631509532123,0.52411124389962793,
+    0.51665361766418938,0.5104884428096309,0.50544830347052816,
+    0.50140793805552908,0.49827402078709998,0.49597829611029737,
+    0.49447296746708808,0.49372767693634845,0.49372767693634845,
+    0.49447296746708808,0.49597829611029737,0.49827402078709998,
+    0.50140793805552908,0.50544830347052816,0.5104884428096309,
+    0.51665361766418938,0.52411124389962793,0.53308631509532123,
+    0.54388525432916723,0.55693404566855886,0.57284183935389821,
+    0.59251287357211946,0.61735722779651181,0.64972418216243522,
+    0.69390564145414579,0.75889037613857369,0.86826165469478556,
+    1.1203024090583602};
+
+  static const double lagX10[10]={
+    0.13779347054049243,0.72945454950317046,1.8083429017403161,
+    3.4014336978548996,5.5524961400638038,8.3301527467644974,
+    11.843785837900066,16.279257831378104,21.996585811980761,
+    29.920697012273891};
+  static const double lagW10[10]={
+    0.3540097386069963,0.83190230104358076,1.3302885617493281,
+    1.8630639031111309,2.4502555580830103,3.1227641551351826,
+    3.9341526955615209,4.9924148721930228,6.572202485130803,
+    9.7846958403746314};
+  static const double lagX20[20]={
+    0.070539889691988752,0.37212681800161146,0.91658210248327354,
+    1.707306531028344,2.7491992553094322,4.0489253138508872,
+    5.6151749708616165,7.4590174536710636,9.5943928695810961,
+    12.038802546964316,14.81429344263074,17.948895520519375,
+    21.478788240285009,25.451702793186904,29.932554631700611,
+    35.013434240479,40.83305705672857,47.619994047346502,55.810795750063896,
+    66.524416525615749};
+  static const double lagW20[20]={
+    0.18108006241898925,0.422556767878564,0.6669095467018481,
+    0.91535237278307369,1.169539707195546,1.431354985928206,
+    1.7029811379850228,1.9870158907927473,2.2866357812534308,
+    2.6058347275538334,2.949783734213951,3.3253957820093194,
+    3.7422554705898108,4.2142367102518801,4.7625184614902096,
+    5.4217260442455739,6.2540123569324209,7.3873143890544348,
+    9.1513287309874798,12.893388645939996};
+  static const double lagX30[30]={
+    0.047407180540804852,0.24992391675316022,0.61483345439276826,
+    1.1431958256661008,1.8364545546225723,2.6965218745572153,
+    3.7258145077795088,4.9272937658498828,6.3045155909650745,
+    7.8616932933702603,9.6037759854792615,11.536546597956139,
+    13.666744693064237,16.002221188981068,18.55213484014315,
+    21.327204321783128,24.340035764532693,27.605554796780961,
+    31.141586701111237,34.969652008249071,39.11608494906789,
+    43.613652908484831,48.5039861638042,53.841385406507506,
+    59.699121859235497,66.18061779443849,73.441238595559881,
+    81.736810506727679,91.556466522536837,104.15752443105889};
+  static const double lagW30[30]={
+    0.12167789536726178,0.28355688273493851,0.44643242667877342,
+    0.61053213007581286,0.77630347862220583,0.9442332886417194,
+    1.1148447016752114,1.2887054328326757,1.466439137624215,
+    1.6487394978543191,1.8363876778704111,2.0302742516771826,
+    2.2314271824432246,2.4410481130911217,2.6605602433750901,
+    2.8916726413773763,3.1364683338243844,3.397527595790641,
+    3.6781047295606726,3.9823886239009636,4.3158992448994562,
+    4.6861140091262978,5.1035026514834181,5.5833329816875512,
+    6.149044408657435,6.8391305457947587,7.7229478770061872,
+    8.9437424683710383,10.871872938377912,15.026111628122933};
+  static const double lagX40[40]={
+    0.035700394308888383,0.18816228315869851,0.46269428131457646,
+    0.8597729639729349,1.3800108205273371,2.0242091359228267,
+    2.7933693535068165,3.6887026779082701,4.7116411465549728,
+    5.863850878343718,7.1472479081022886,8.5640170175861634,
+    10.116634048451939,11.807892294004585,13.640933712537088,
+    15.619285893339073,17.746905950095663,20.02823283457489,
+    22.468249983498417,25.072560772426204,27.847480009168862,
+    30.800145739445462,33.938657084913721,37.272245880476007,
+    40.811492823886923,44.568603175334459,48.55776353305999,
+    52.795611187216934,57.301863323393626,62.100179072775113,
+    67.219370927127002,72.695158847612461,78.572802911571316,
+    84.91123113570498,91.789874671236376,99.320808717446809,
+    107.67244063938827,117.12230951269069,128.20184198825564,142.28004446916};
+  static const double lagW40[40]={
+    0.091625471157459892,0.21342058490501209,0.33571811668028467,
+    0.45854093503349758,0.58206816577910514,0.70649521636721935,
+    0.83202690300348525,0.95887819879444314,1.0872761620305498,
+    1.217462327977781,1.3496954913567654,1.4842549297768468,
+    1.6214441628118219,1.7615953746767696,1.9050746658947997,
+    2.0522883472617166,2.2036905532450959,2.3597925385232035,
+    2.5211741403764329,2.6884980554088425,2.8625278132104488,
+    3.0441506653115171,3.2344070972635319,3.4345293984277481,
+    3.6459928249940892,3.8705845972165167,4.1104986804328227,
+    4.3684687232540638,4.6479589840744673,4.9534461124098934,
+    5.2908484059007366,5.6682046090329772,6.0967964147434204,
+    6.5931088610399993,7.1824959955368932,7.906666311384229,
+    8.8408924928103474,10.140899265621169,12.210021299204604,
+    16.705520642024297};
+
+  static const double legX10[10]={
+    -0.97390652851717174,-0.86506336668898454,-0.67940956829902444,
+    -0.43339539412924721,-0.14887433898163122,0.14887433898163122,
+    0.43339539412924721,0.67940956829902444,0.86506336668898454,
+    0.97390652851717174};
+  static const double legW10[10]={
+    0.066671344308688138,0.14945134915058059,0.21908636251598204,
+    0.26926671930999635,0.29552422471475287,0.29552422471475287,
+    0.26926671930999635,0.21908636251598204,0.14945134915058059,
+    0.066671344308688138};
+  static const double legX20[20]={
+    -0.99312859918509488,-0.96397192727791381,-0.91223442825132595,
+    -0.83911697182221878,-0.7463319064601508,-0.63605368072651502,
+    -0.51086700195082713,-0.37370608871541955,-0.22778585114164507,
+    -0.076526521133497338,0.076526521133497338,0.22778585114164507,
+    0.37370608871541955,0.51086700195082713,0.63605368072651502,
+    0.7463319064601508,0.83911697182221878,0.91223442825132595,
+    0.96397192727791381,0.99312859918509488};
+  static const double legW20[20]={
+    0.017614007139152118,0.040601429800386939,0.062672048334109068,
+    0.083276741576704755,0.10193011981724044,0.11819453196151841,
+    0.13168863844917664,0.14209610931838204,0.14917298647260374,
+    0.15275338713072584,0.15275338713072584,0.14917298647260374,
+    0.14209610931838204,0.13168863844917664,0.11819453196151841,
+    0.10193011981724044,0.083276741576704755,0.062672048334109068,
+    0.040601429800386939,0.017614007139152118};
+  static const double legX30[30]={
+    -0.99689348407464951,-0.98366812327974718,-0.96002186496830755,
+    -0.92620004742927431,-0.88256053579205274,-0.82956576238276836,
+    -0.76777743210482619,-0.69785049479331585,-0.62052618298924289,
+    -0.53662414814201986,-0.44703376953808915,-0.35270472553087812,
+    -0.25463692616788985,-0.15386991360858354,-0.051471842555317698,
+    0.051471842555317698,0.15386991360858354,0.25463692616788985,
+    0.35270472553087812,0.44703376953808915,0.53662414814201986,
+    0.62052618298924289,0.69785049479331585,0.76777743210482619,
+    0.82956576238276836,0.88256053579205274,0.92620004742927431,
+    0.96002186496830755,0.98366812327974718,0.99689348407464951};
+  static const double legW30[30]={
+    0.007968192496166605,0.018466468311090958,0.028784707883323369,
+    0.03879919256962705,0.048402672830594053,0.057493156217619065,
+    0.065974229882180491,0.073755974737705204,0.080755895229420213,
+    0.086899787201082976,0.092122522237786122,0.096368737174644253,
+    0.099593420586795267,0.1017623897484055,0.10285265289355884,
+    0.10285265289355884,0.1017623897484055,0.099593420586795267,
+    0.096368737174644253,0.092122522237786122,0.086899787201082976,
+    0.080755895229420213,0.073755974737705204,0.065974229882180491,
+    0.057493156217619065,0.048402672830594053,0.03879919256962705,
+    0.028784707883323369,0.018466468311090958,0.007968192496166605};
+  static const double legX40[40]={
+    -0.99823770971055925,-0.99072623869945697,-0.9772599499837743,
+    -0.95791681921379168,-0.93281280827867652,-0.90209880696887434,
+    -0.86595950321225945,-0.8246122308333117,-0.77830565142651942,
+    -0.7273182551899271,-0.67195668461417957,-0.61255388966798019,
+    -0.54946712509512818,-0.4830758016861787,-0.41377920437160498,
+    -0.34199409082575849,-0.26815218500725369,-0.19269758070137111,
+    -0.11608407067525521,-0.038772417506050823,0.038772417506050823,
+    0.11608407067525521,0.19269758070137111,0.26815218500725369,
+    0.34199409082575849,0.41377920437160498,0.4830758016861787,
+    0.54946712509512818,0.61255388966798019,0.67195668461417957,
+    0.7273182551899271,0.77830565142651942,0.8246122308333117,
+    0.86595950321225945,0.90209880696887434,0.93281280827867652,
+    0.95791681921379168,0.9772599499837743,0.99072623869945697,
+    0.99823770971055925};
+  static const double legW40[40]={
+    0.0045212770985331909,0.010498284531152813,0.01642105838190789,
+    0.022245849194166958,0.0279370069800234,0.033460195282547844,
+    0.038782167974472016,0.043870908185673269,0.048695807635072232,
+    0.053227846983936823,0.057439769099391552,0.061306242492928938,
+    0.064804013456601042,0.067912045815233898,0.07061164739128678,
+    0.072886582395804062,0.074723169057968261,0.076110361900626242,
+    0.077039818164247972,0.077505947978424805,0.077505947978424805,
+    0.077039818164247972,0.076110361900626242,0.074723169057968261,
+    0.072886582395804062,0.07061164739128678,0.067912045815233898,
+    0.064804013456601042,0.061306242492928938,0.057439769099391552,
+    0.053227846983936823,0.048695807635072232,0.043870908185673269,
+    0.038782167974472016,0.033460195282547844,0.0279370069800234,
+    0.022245849194166958,0.01642105838190789,0.010498284531152813,
+    0.0045212770985331909};
+
+  static const double* const hermX[4]={hermX10,hermX20,hermX30,hermX40};
+  static const double* const hermW[4]={hermW10,hermW20,hermW30,hermW40};
+  static const double* const lagX[4]={lagX10,lagX20,lagX30,lagX40};
+  static const double* const lagW[4]={lagW10,lagW20,lagW30,lagW40};
+  static const double* const legX[4]={legX10,legX20,legX30,legX40};
+  static const double* const legW[4]={legW10,legW20,legW30,legW40};
+}
@@ -14,6 +14,7 @@
 #endif
 
 #include "src/eptools/potentials/quad/QuadraturePotential.h"
+#include "src/eptools/potentials/EPScalarPotential.h"
 
 //BEGINNS(eptools)
   /**
@@ -27,6 +28,10 @@
   class QuadPotProximal : public virtual QuadraturePotential
   {
   public:
+    // Constants
+
+    static const int warmSize=4; // See 'proximalWarm'
+
     // Public methods
 
     /**
@@ -43,7 +48,75 @@
      * @return      Successful?
      */
     virtual bool proximal(double h,double rho,double& sstar) const = 0;
+
+    /**
+     * Same as 'proximal', but with warm start state 'wst' (size
+     * 'warmSize'), kept for a potential between calls:
+     *   [valid, s_*, l'(s_*), l''(s_*)],
+     * where s_* is the last recent solution (the derivatives may be taken
+     * at a point close to s_*). If wst[0]==0, there is no solution yet.
+     * 'wst' is overwritten by the new solution.
+     * The default implementation ignores 'wst' and calls 'proximal'.
+     *
+     * @param h     Parameter
+     * @param rho   Parameter (positive)
+     * @param sstar Result s_* ret. here
+     * @param wst   Warm start state (s.a.)
+     * @return      Successful?
+     */
+    virtual bool proximalWarm(double h,double rho,double& sstar,
+			      double* wst) const {
+      return proximal(h,rho,sstar);
+    }
+
+    /**
+     * Batch version of 'proximal' over 'num' potentials of this type with
+     * different parameters (see 'QuadraturePotential::evalBatch' for
+     * 'pars', 'parStr'). For potential j, the proximal map for 'h[j]',
+     * 'rho[j]' is written to 'sstar[j]', and 'rstat[j]' is 1 if successful,
+     * 0 otherwise.
+     * The default implementation calls 'setPars' and 'proximal' for each j,
+     * and restores the parameters at the end.
+     *
+     * @param num    Number of potentials
+     * @param h      Parameters h
+     * @param rho    Parameters rho (positive)
+     * @param pars   Parameter vectors
+     * @param parStr Strides for 'pars'
+     * @param sstar  Results s_* ret. here
+     * @param rstat  Success flags ret. here
+     */
+    virtual void proximalBatch(int num,const double* h,const double* rho,
+			       const double* const* pars,const int* parStr,
+			       double* sstar,int* rstat) {
+      int j,k,np=numPars();
+
+      if (np==0) {
+	for (j=0; j<num; j++)
+	  rstat[j]=proximal(h[j],rho[j],sstar[j])?1:0;
+	return;
+      }
+      ArrayHandle<double> oldPars(np),potPars(np);
+      getPars(oldPars.p());
+      try {
+	for (j=0; j<num; j++) {
+	  for (k=0; k<np; k++)
+	    potPars[k]=pars[k][j*parStr[k]];
+	  setPars(potPars.p());
+	  rstat[j]=proximal(h[j],rho[j],sstar[j])?1:0;
+	}
+      } catch (...) {
+	setPars(oldPars.p());
+	throw;
+      }
+      setPars(oldPars.p());
+    }
   };
+
+  // Compile-time check: The warm start state must fit into what
+  // 'FactorizedEPDriver' keeps per potential (negative array size otherwise)
+  typedef char QuadPotProximal_checkWarmSize[
+    (EPScalarPotential::maxWarmState>=QuadPotProximal::warmSize)?1:-1];
 //ENDNS
 
 #endif
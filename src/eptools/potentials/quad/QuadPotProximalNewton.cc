@@ -8,8 +8,149 @@
 
 #include "src/eptools/potentials/quad/QuadPotProximalNewton.h"
 #include "lhotse/optimize/OneDimSolver.h"
+#include <algorithm>
+
+#define MAXIT 100 // As in 'OneDimSolver::newton'
+#define MY_SIGN(x) (((x)>=0.0)?1:-1)
 
 //BEGINNS(eptools)
+  /*
+   * State of one lane in 'QuadPotProximalNewton::proximalBatch'. 'advance'
+   * does what 'OneDimSolver::newton' does with f(x), f'(x) at the current
+   * point x, and determines the next point x. 'evalFailed' is called
+   * instead if the evaluation at x throws an exception. Phases:
+   * - phInitL: x = L (left bracket end)
+   * - phInitR: x = R (right bracket end, if given)
+   * - phSearch: Search for right bracket end
+   * - phBrack:  Newton/bisection steps within bracket [l,r]
+   * - phDone:   Solution in x
+   * - phFail:   Failed
+   */
+  class QuadPotProximalNewton_Lane
+  {
+  public:
+    static const int phInitL=0;
+    static const int phInitR=1;
+    static const int phSearch=2;
+    static const int phBrack=3;
+    static const int phDone=4;
+    static const int phFail=5;
+
+    int phase,lsgn,iter;
+    bool brReg,nextBisect,didNewton;
+    double l,r,fl,ratl,x,dx,olds;
+
+    void start(double pl,double pr) {
+      l=x=pl; r=pr; brReg=(pr>pl);
+      phase=phInitL;
+    }
+
+    void advance(double f,double df,double acc,double facc) {
+      double temp,alpha,rat=QuadPotProximalNewton_Func1D::ratio(f,df);
+
+      switch (phase) {
+      case phInitL:
+	lsgn=MY_SIGN(f);
+	if (fabs(f)<facc) {
+	  phase=phDone; return;
+	}
+	fl=f; ratl=rat;
+	if (brReg) {
+	  x=r; phase=phInitR;
+	} else {
+	  dx=acc; iter=0; // 'r' not given: First step
+	  phase=phSearch;
+	  nextSearch();
+	}
+	return;
+      case phInitR:
+	if (fabs(f)<facc)
+	  phase=phDone;
+	else if (MY_SIGN(f)==lsgn)
+	  phase=phFail; // Root not bracketed
+	else
+	  startBracket(acc);
+	return;
+      case phSearch:
+	if (fabs(f)<facc) {
+	  phase=phDone; return;
+	} else if (MY_SIGN(f)!=lsgn) {
+	  r=x; startBracket(acc); return;
+	}
+	// Quadratic or linear (Newton) step, otherwise use 'dx' again
+	alpha=(fl-f)/(l-x)-df;
+	if (MY_SIGN(alpha)==lsgn && fabs(alpha)>10.0*facc*(x-l)) {
+	  alpha/=(l-x);
+	  dx=(lsgn==-1)?(0.5*(sqrt(df*df-4.0*alpha*f)-df)/alpha):
+	    (-0.5*(sqrt(df*df-4.0*alpha*f)+df)/alpha);
+	} else if (rat<0.0)
+	  dx=-rat;
+	if (dx<acc) dx=acc;
+	l=x; fl=f; ratl=rat;
+	nextSearch();
+	return;
+      case phBrack:
+	if (fabs(f)<facc) {
+	  phase=phDone; return;
+	} else if (MY_SIGN(f)==lsgn)
+	  l=x;
+	else
+	  r=x;
+	if ((temp=r-l)<acc) {
+	  phase=phDone; return;
+	}
+	nextBisect=didNewton && (temp>0.85*olds);
+	olds=temp;
+	if (++iter>MAXIT)
+	  phase=phFail;
+	else
+	  nextBrack(f,rat);
+	return;
+      }
+    }
+
+    /*
+     * In the search for the right bracket end, we try again with step
+     * 'acc' (this does not count as iteration). Otherwise, the lane fails.
+     */
+    void evalFailed(double acc) {
+      if (phase==phSearch && dx!=acc) {
+	dx=acc; x=l+dx;
+      } else
+	phase=phFail;
+    }
+
+  protected:
+    void nextSearch() {
+      if (iter++>MAXIT)
+	phase=phFail;
+      else
+	x=l+dx;
+    }
+
+    // Start at x = l, with f(l), f(l)/f'(l) in 'fl', 'ratl'
+    void startBracket(double acc) {
+      x=l;
+      if ((olds=r-l)<acc) {
+	phase=phDone; return;
+      }
+      nextBisect=false; iter=0;
+      phase=phBrack;
+      nextBrack(fl,ratl);
+    }
+
+    // Bisection step if 'nextBisect' or Newton step falls out of bracket
+    void nextBrack(double f,double rat) {
+      double temp=x-rat;
+
+      if (nextBisect || temp<=l || temp>=r) {
+	x=0.5*(l+r); didNewton=false;
+      } else {
+	x=temp; didNewton=true;
+      }
+    }
+  };
+
   QuadPotProximalNewton::QuadPotProximalNewton(double pacc,double pfacc,
 					       int pverb) :
     acc(pacc),facc(pfacc),verbose(pverb)
@@ -45,4 +186,160 @@
 
     return true;
   }
+
+  bool QuadPotProximalNewton::proximalWarm(double h,double rho,double& sstar,
+					   double* wst) const
+  {
+    double bL,bR,x0,temp;
+    int brRight;
+
+    if (wst==0)
+      return proximal(h,rho,sstar);
+    if (wst[0]==0.0) {
+      if (!proximal(h,rho,sstar))
+	return false;
+    } else {
+      if (proxFun==0)
+	proxFun.changeRep(new QuadPotProximalNewton_Func1D(this));
+      proxFun->setPars(h,rho);
+      try {
+	// Newton step from last solution, with cached derivatives
+	initBracket(h,rho,bL,bR);
+	brRight=(bR>bL)?OneDimSolver::brackRightRegular:
+	  OneDimSolver::brackRightInfinite;
+	x0=wst[1];
+	if ((temp=rho*wst[3]+1.0)>1e-8)
+	  x0-=(rho*wst[2]+x0-h)/temp;
+	if (verbose>0)
+	  cout << "  QuadPotProximalNewton: Warm start x0=" << x0 << endl;
+	sstar = OneDimSolver::newtonWarm(proxFun.p(),x0,bL,bR,acc,facc,-1,
+					 brRight,0.0,"QuadPotProximalNewton");
+      } catch (...) {
+	// Fall back to cold start
+	if (!proximal(h,rho,sstar))
+	  return false;
+      }
+    }
+    // The last evaluation of 'proxFun' is at or close to 'sstar'
+    wst[0]=1.0; wst[1]=sstar;
+    proxFun->getLastDerivs(wst[2],wst[3]);
+
+    return true;
+  }
+
+  void QuadPotProximalNewton::proximalBatch(int num,const double* h,
+					    const double* rho,
+					    const double* const* pars,
+					    const int* parStr,double* sstar,
+					    int* rstat)
+  {
+    int i,j,k,l0,nc,nact,np=numPars();
+    int act[proxChunk];
+    bool failed[proxChunk];
+    double xa[proxChunk],ha[proxChunk],rhoa[proxChunk],dla[proxChunk],
+      ddla[proxChunk],bl[proxChunk],br[proxChunk];
+    QuadPotProximalNewton_Lane lane[proxChunk];
+    ArrayHandle<const double*> cpars(np),apars(np),spars(np);
+    ArrayHandle<int> astr(np);
+    ArrayHandle<double> abuff(np*proxChunk);
+
+    for (k=0; k<np; k++) {
+      apars[k]=abuff.p()+k*proxChunk; astr[k]=1;
+    }
+    for (l0=0; l0<num; l0+=proxChunk) {
+      nc=std::min(proxChunk,num-l0);
+      for (k=0; k<np; k++)
+	cpars[k]=pars[k]+l0*parStr[k];
+      try {
+	initBracketBatch(nc,h+l0,rho+l0,cpars.p(),parStr,bl,br);
+	for (j=0; j<nc; j++) {
+	  if (rho[l0+j]<(1e-16))
+	    throw InvalidParameterException(EXCEPT_MSG(""));
+	  lane[j].start(bl[j],br[j]);
+	}
+	for (;;) {
+	  // Gather lanes not done. Their parameters are copied to 'abuff'
+	  for (j=nact=0; j<nc; j++)
+	    if (lane[j].phase<QuadPotProximalNewton_Lane::phDone) {
+	      act[nact]=j; xa[nact]=lane[j].x; ha[nact]=h[l0+j];
+	      rhoa[nact++]=rho[l0+j];
+	    }
+	  if (nact==0) break;
+	  for (k=0; k<np; k++) {
+	    const double* src=cpars[k];
+	    double* dst=abuff.p()+k*proxChunk;
+	    int str=parStr[k];
+	    for (i=0; i<nact; i++)
+	      dst[i]=src[act[i]*str];
+	  }
+	  try {
+	    evalBatch(nact,xa,apars.p(),astr.p(),dla,ddla);
+	    std::fill(failed,failed+nact,false);
+	  } catch (...) {
+	    // Evaluate lanes one by one, to find out which ones failed
+	    for (i=0; i<nact; i++) {
+	      for (k=0; k<np; k++)
+		spars[k]=apars[k]+i;
+	      try {
+		evalBatch(1,xa+i,spars.p(),astr.p(),dla+i,ddla+i);
+		failed[i]=false;
+	      } catch (...) {
+		failed[i]=true;
+	      }
+	    }
+	  }
+	  // f(x) = rho l'(x) + x - h, f'(x) = rho l''(x) + 1
+#if defined(_OPENMP) && _OPENMP>=201307
+#pragma omp simd
+#endif
+	  for (i=0; i<nact; i++) {
+	    dla[i]=rhoa[i]*dla[i]+xa[i]-ha[i];
+	    ddla[i]=rhoa[i]*ddla[i]+1.0;
+	  }
+	  for (i=0; i<nact; i++)
+	    if (failed[i])
+	      lane[act[i]].evalFailed(acc);
+	    else
+	      lane[act[i]].advance(dla[i],ddla[i],acc,facc);
+	}
+	for (j=0; j<nc; j++) {
+	  sstar[l0+j]=lane[j].x;
+	  rstat[l0+j]=(lane[j].phase==QuadPotProximalNewton_Lane::phDone)?1:0;
+	}
+      } catch (...) {
+	// Bracket for some lane failed: Process chunk one by one
+	QuadPotProximal::proximalBatch(nc,h+l0,rho+l0,cpars.p(),parStr,
+				       sstar+l0,rstat+l0);
+      }
+    }
+  }
+
+  void QuadPotProximalNewton::initBracketBatch(int num,const double* h,
+					       const double* rho,
+					       const double* const* pars,
+					       const int* parStr,double* l,
+					       double* r)
+  {
+    int j,k,np=numPars();
+
+    if (np==0) {
+      for (j=0; j<num; j++)
+	initBracket(h[j],rho[j],l[j],r[j]);
+      return;
+    }
+    ArrayHandle<double> oldPars(np),potPars(np);
+    getPars(oldPars.p());
+    try {
+      for (j=0; j<num; j++) {
+	for (k=0; k<np; k++)
+	  potPars[k]=pars[k][j*parStr[k]];
+	setPars(potPars.p());
+	initBracket(h[j],rho[j],l[j],r[j]);
+      }
+    } catch (...) {
+      setPars(oldPars.p());
+      throw;
+    }
+    setPars(oldPars.p());
+  }
 //ENDNS
@@ -6,12 +6,6 @@
  * Desc.:  Header class QuadPotProximalNewton
  * ------------------------------------------------------------------- */
 
-/*
- * TODO:
- * - Mechanism to store the last recent proximal map solution and to use
- *   it in order to initialize the bracket
- */
-
 #ifndef EPTOOLS_QUADPOTPROXIMALNEWTON_H
 #define EPTOOLS_QUADPOTPROXIMALNEWTON_H
 
@@ -38,13 +32,14 @@
 
     const QuadraturePotential* quadPot; // Access to l'(s), l''(s)
     double h,rho;
+    double lastDl,lastDdl; // l'(s), l''(s) at last recent 'eval' point
 
   public:
     // Public methods
 
     QuadPotProximalNewton_Func1D(const QuadraturePotential* qpot,
 				 double ph=0.0,double prho=1.0) :
-      quadPot(qpot) {
+      quadPot(qpot),lastDl(0.0),lastDdl(0.0) {
       if (!qpot->hasSecondDerivatives())
 	throw InvalidParameterException(EXCEPT_MSG(""));
       setPars(ph,prho);
@@ -62,9 +57,31 @@
 
     void eval(double x,double* f,double* df) {
       quadPot->eval(x,f,df); // l'(s), l''(s) (l(s) not needed)
+      lastDl=*f; lastDdl=*df;
       (*f) = rho*(*f)+x-h;
       (*df) = rho*(*df)+1.0;
     }
+
+    /**
+     * Newton ratio f(s)/f'(s). Since f'(s) >= 1 for convex l(s), the
+     * default is stable. Also used by 'QuadPotProximalNewton::proximalBatch'.
+     */
+    static double ratio(double f,double df) {
+      return f/df;
+    }
+
+    void evalStable(double x,double* f,double* df,double* rat) {
+      eval(x,f,df);
+      (*rat) = ratio(*f,*df);
+    }
+
+    /**
+     * @param dl  l'(s) at last recent 'eval' point s ret. here
+     * @param ddl l''(s) at last recent 'eval' point s ret. here
+     */
+    void getLastDerivs(double& dl,double& ddl) const {
+      dl=lastDl; ddl=lastDdl;
+    }
   };
 
   /**
@@ -81,12 +98,37 @@
    *   f(L) < 0,  f(R) > 0
    * L must be supplied. If R is not supplied, it is determined
    * automatically. This may fail for non-convex l(s).
+   * <p>
+   * 'proximalWarm' starts from a Newton step on f(s) at the previous
+   * solution s_0, using the derivatives cached there (no evaluation):
+   *   s_0 - (rho l'(s_0) + s_0 - h)/(rho l''(s_0) + 1),
+   * and runs 'OneDimSolver::newtonWarm' within the bracket [L,R]. If
+   * (h, rho) changed little since the last call (as for EP updates close to
+   * convergence), this needs 2 or 3 evaluations of l'(s), l''(s). If the
+   * warm-started search fails, we fall back to 'proximal'.
+   * <p>
+   * 'proximalBatch' runs the iterations of 'OneDimSolver::newton' for
+   * chunks of 'proxChunk' potentials in lock-step: each potential (lane)
+   * has its own state (bracket, phase), and in each round, l'(s), l''(s)
+   * are evaluated for all lanes not yet converged by a single
+   * 'evalBatch' call. The steps are the same as in 'proximal', so are the
+   * results: Newton ratios come from 'QuadPotProximalNewton_Func1D::ratio'.
+   * If 'evalBatch' throws, the lanes are evaluated one by one. A lane whose
+   * evaluation fails while searching for the right bracket end retries
+   * with step 'acc' (as 'OneDimSolver::newton' does), otherwise it fails.
+   * Subclasses should override 'evalBatch' and 'initBracketBatch', so that
+   * 'setPars' is not called per lane and evaluation.
    *
    * @author  Matthias Seeger
    * @version %I% %G%
    */
   class QuadPotProximalNewton : public QuadPotProximal
   {
+  public:
+    // Constants
+
+    static const int proxChunk=64; // Lanes per chunk in 'proximalBatch'
+
   protected:
     // Members
 
@@ -111,6 +153,8 @@
 
     bool proximal(double h,double rho,double& sstar) const;
 
+    bool proximalWarm(double h,double rho,double& sstar,double* wst) const;
+
     /**
      * See header comment. The initial bracket is [L,R]. L has to be supplied,
      * R is optional ('r' is not used if <= 'l'). We require that
@@ -122,6 +166,27 @@
      * @param r   R ret. here (optional)
      */
     virtual void initBracket(double h,double rho,double& l,double& r) const = 0;
+
+    void proximalBatch(int num,const double* h,const double* rho,
+		       const double* const* pars,const int* parStr,
+		       double* sstar,int* rstat);
+
+    /**
+     * Batch version of 'initBracket' (see 'evalBatch' for 'pars',
+     * 'parStr'). The default implementation calls 'setPars' and
+     * 'initBracket' for each j, and restores the parameters at the end.
+     *
+     * @param num    Number of potentials
+     * @param h      Parameters h
+     * @param rho    Parameters rho
+     * @param pars   Parameter vectors
+     * @param parStr Strides for 'pars'
+     * @param l      L ret. here
+     * @param r      R ret. here (not used if <= 'l')
+     */
+    virtual void initBracketBatch(int num,const double* h,const double* rho,
+				  const double* const* pars,const int* parStr,
+				  double* l,double* r);
   };
 //ENDNS
 
@@ -79,6 +79,51 @@
      */
     virtual double eval(double s,double* dl=0,double* ddl=0) const = 0;
 
+    /**
+     * Batch version of 'eval' for derivatives only, over 'num' potentials
+     * of this type with different parameters. Parameter k for potential j
+     * is 'pars[k][j*parStr[k]]' (as in 'EPScalarPotential::compMomentsBatch').
+     * l'(s_j), l''(s_j) are written to 'dl[j]', 'ddl[j]', where s_j =
+     * 's[j]'. The value l(s_j) is not computed.
+     * The default implementation calls 'setPars' and 'eval' for each j, and
+     * restores the parameters at the end. Subclasses should override this
+     * if 'setPars' is expensive (say, normalization constants are computed
+     * there), or if the loop over j can be vectorized.
+     *
+     * @param num    Number of potentials
+     * @param s      Arguments s_j
+     * @param pars   Parameter vectors (s.a.)
+     * @param parStr Strides for 'pars'
+     * @param dl     l'(s_j) ret. here
+     * @param ddl    l''(s_j) ret. here
+     */
+    virtual void evalBatch(int num,const double* s,const double* const* pars,
+			   const int* parStr,double* dl,double* ddl) {
+      int j,k,np=numPars();
+
+      if (!hasSecondDerivatives())
+	throw WrongStatusException(EXCEPT_MSG("Need 2nd derivatives"));
+      if (np==0) {
+	for (j=0; j<num; j++)
+	  eval(s[j],dl+j,ddl+j);
+	return;
+      }
+      ArrayHandle<double> oldPars(np),potPars(np);
+      getPars(oldPars.p());
+      try {
+	for (j=0; j<num; j++) {
+	  for (k=0; k<np; k++)
+	    potPars[k]=pars[k][j*parStr[k]];
+	  setPars(potPars.p());
+	  eval(s[j],dl+j,ddl+j);
+	}
+      } catch (...) {
+	setPars(oldPars.p());
+	throw;
+      }
+      setPars(oldPars.p());
+    }
+
     /**
      * Returns endpoints of integration interval [a,b] in 'a', 'b'.
      * If a==-infty, 'aInf'=true and 'a' is ignored. Likewise with b,
@@ -14,6 +14,7 @@
 #endif
 
 #include "src/eptools/default.h"
+#include <algorithm>
 
 //BEGINNS(eptools)
   /**
@@ -28,6 +29,40 @@
     void* params;
   } quad_function;
 
+  /**
+   * Type for vector-valued integrand functions, used by
+   * 'QuadratureServices::quadVec'. 'function' writes f(x) to 'fvals'.
+   * Additional parameters can be passed via 'params'.
+   *
+   * @author  Matthias Seeger
+   * @version %I% %G%
+   */
+  typedef struct {
+    void (*function) (double x,void* params,double* fvals);
+    void* params;
+  } quad_vecfunction;
+
+  /**
+   * Used by the default implementation of 'QuadratureServices::quadVec':
+   * Component 'comp' of a vector-valued integrand.
+   */
+  class QuadratureServices_compParams
+  {
+  public:
+    const quad_vecfunction* fun;
+    int comp;
+    double* fvals;
+  };
+
+  inline double QuadratureServices_compFunc(double x,void* params)
+  {
+    const QuadratureServices_compParams* cpars=
+      (const QuadratureServices_compParams*) params;
+
+    (*cpars->fun->function)(x,cpars->fun->params,cpars->fvals);
+    return cpars->fvals[cpars->comp];
+  }
+
   /**
    * Base class for numerical quadrature services required by subclasses of
    * 'EPPotQuadrature'.
@@ -41,6 +76,10 @@
   class QuadratureServices
   {
   public:
+    // Constants
+
+    static const int maxVecDim=8; // Maximum dimension for 'quadVec'
+
     // Public methods
 
     virtual ~QuadratureServices() {}
@@ -97,6 +136,58 @@
 		     ArrayHandleZero<double>::get(),double* abserr=0,
 		     string* errmsg=0) = 0;
 
+    /**
+     * Vector-valued variant of 'quad':
+     *   I_k = int_a^b f_k(x) d x,  k=0,...,'dim'-1.
+     * Implementations should evaluate f(x) only once per node for all
+     * components, which is the point of this method (for example, moments
+     * of order 0, 1, 2 are obtained by one pass). Arguments are as for
+     * 'quad', the integral values are written to 'ival' (size 'dim'). The
+     * error estimate 'abserr' is the maximum over components.
+     * <p>
+     * The default implementation calls 'quad' for each component, so
+     * f(x) is evaluated 'dim' times as often.
+     *
+     * @param fun    Integrand function f
+     * @param dim    Dimension of f(x). At most 'maxVecDim'
+     * @param a      S.a.
+     * @param aInf   S.a.
+     * @param b      S.a.
+     * @param bInf   S.a.
+     * @param ival   Integral values I_k returned here
+     * @param hasWP  S.a.
+     * @param wayPts S.a.
+     * @param abserr S.a. Def.: 0
+     * @param errmsg S.a. Def.: 0
+     * @return       Return status (0: Success)
+     */
+    virtual int quadVec(const quad_vecfunction& fun,int dim,double a,
+			bool aInf,double b,bool bInf,double* ival,bool hasWP,
+			const ArrayHandle<double>& wayPts=
+			ArrayHandleZero<double>::get(),double* abserr=0,
+			string* errmsg=0) {
+      int k,stat;
+      double fvals[maxVecDim],err,maxErr=0.0;
+      QuadratureServices_compParams cpars;
+      quad_function cfun;
+
+      if (dim<1 || dim>maxVecDim || ival==0)
+	throw InvalidParameterException(EXCEPT_MSG(""));
+      cpars.fun=&fun; cpars.fvals=fvals;
+      cfun.function=&QuadratureServices_compFunc;
+      cfun.params=(void*) &cpars;
+      for (k=0; k<dim; k++) {
+	cpars.comp=k; err=0.0;
+	if ((stat=quad(cfun,a,aInf,b,bInf,ival[k],hasWP,wayPts,
+		       (abserr!=0)?&err:0,errmsg))!=0)
+	  return stat;
+	maxErr=std::max(maxErr,err);
+      }
+      if (abserr!=0) *abserr=maxErr;
+
+      return 0;
+    }
+
     virtual void debug_method() const {}; // DEBUG!
   };
 //ENDNS
@@ -23,6 +23,9 @@
   class DefaultPotManager;
   class ContainerPotManager;
   class PotManagerFactory;
+  class PotMomentTableOptions;
+  class PotMomentTable;
+  class PotMomentTableProxy;
   class EPPotLaplace;
   class EPPotProbit;
   class EPPotQuantileRegress;
@@ -34,6 +37,7 @@
   class QuadPotProximalNewton;
   class EPPotQuadrature;
   class QuadratureServices;
+  class GaussHermiteQuadServices;
   class EPPotQuadLaplaceApprox;
   class EPPotPoissonCommon;
   class EPPotPoissonExpRate;
@@ -45,6 +49,10 @@
   class FactEPMaximumPiValues;
   class FactorizedEPRepresentation;
   class FactorizedEPDriver;
+  class FactorizedEPSession;
+  class FactEPSweepOptions;
+  class FactEPSweepStats;
+  class XorShiftRandom;
 //ENDNS
 
 #endif
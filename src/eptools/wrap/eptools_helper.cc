@@ -8,6 +8,10 @@
 #include "src/eptools/wrap/eptools_helper.h"
 #include "src/eptools/potentials/PotManagerFactory.h"
 #include "src/eptools/FactorizedEPRepresentation.h"
+#include "src/eptools/FactorizedEPSession.h"
+#include "src/eptools/FactEPDriverFactory.h"
+#include "src/eptools/FactEPMaximumPiValues.h"
+#include "src/eptools/FactEPMaximumPiHeap.h"
 
 /*
  * Parses arguments POTIDS, NUMPOT, PARVEC, PARSHRD and creates a potential
@@ -42,6 +46,54 @@ void createPotentialManager(W_IARRAY(potids),W_IARRAY(numpot),W_DARRAY(parvec),
   }
 }
 
+/*
+ * Potential manager to be used by 'nthreads' threads of
+ * 'FactorizedEPDriver' (see 'PotManagerFactory::create'). 'potMan' is
+ * the manager, 'thrPots' contains it 'nthreads' times. If 'nthreads'==1,
+ * 'thrPots' is empty.
+ * Annotation objects are not supported for 'nthreads'>1, since they are
+ * shared by all threads.
+ */
+void createThreadPotManagers(W_IARRAY(potids),W_IARRAY(numpot),
+			     W_DARRAY(parvec),W_IARRAY(parshrd),
+			     W_ARRAY(annobj,void*),int nthreads,
+			     Handle<PotentialManager>& potMan,
+			     ArrayHandle<Handle<PotentialManager> >& thrPots,
+			     W_ERRORARGS)
+{
+  ArrayHandle<int> potidsA,numpotA,parshrdA;
+  ArrayHandle<double> parvecA;
+  ArrayHandle<void*> annobjA;
+  int i;
+
+  if (nthreads<1)
+    W_RETERROR(1,"NTHREADS must be positive");
+  if (nthreads>1)
+    for (i=0; i<nannobj; i++)
+      if (annobj[i]!=0)
+	W_RETERROR(1,"NTHREADS>1 not supported for potentials with annotation objects");
+  W_CHKSIZE(numpot,npotids,"NUMPOT");
+  W_MASKARRAY(potids);
+  W_MASKARRAY(numpot);
+  W_MASKARRAY(parvec);
+  W_MASKARRAY(parshrd);
+  W_MASKARRAY(annobj);
+  try {
+    potMan.changeRep(PotManagerFactory::create(potidsA,numpotA,parvecA,
+					       parshrdA,annobjA,nthreads));
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Cannot create potential manager:\n%s",ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Cannot create potential manager: Unspecified exception");
+  }
+  if (nthreads>1) {
+    thrPots.changeRep(nthreads);
+    for (i=0; i<nthreads; i++)
+      thrPots[i]=potMan;
+  } else
+    thrPots.changeRep(0);
+}
+
 /*
  * Creates 'FactorizedEPRepresentation' for a model with standard univariate
  * potentials only (argument group 'atypeUnivariate').
@@ -109,3 +161,169 @@ void createFactEPRepres_bvprec(int numN,int numM,W_IARRAY(rp_rowind),
     W_RETERROR(1,"Cannot create B representation: Unspecified exception");
   }
 }
+
+/*
+ * Same as 'createFactEPRepres', but RP_ROWIND, RP_COLIND are 64-bit
+ * indexes (see 'FactorizedEPRepresentation'). The flat arrays are not
+ * masked by 'ArrayHandle', their sizes can exceed the int range.
+ */
+void createFactEPRepres64(int numN,int numM,W_I64ARRAY(rp_rowind),
+			  W_I64ARRAY(rp_colind),W_DARRAY64(rp_bvals),
+			  W_DARRAY64(rp_pi),W_DARRAY64(rp_beta),
+			  Handle<FactorizedEPRepresentation>& epRepr,
+			  W_ERRORARGS)
+{
+  W_CHKSIZE(rp_pi,nrp_bvals,"RP_PI");
+  W_CHKSIZE(rp_beta,nrp_bvals,"RP_BETA");
+  try {
+    epRepr.changeRep(new FactorizedEPRepresentation(numN,numM,rp_rowind,
+						    nrp_rowind,rp_colind,
+						    nrp_colind,rp_bvals,
+						    rp_beta,rp_pi,nrp_bvals));
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Cannot create B representation:\n%s",ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Cannot create B representation: Unspecified exception");
+  }
+}
+
+/*
+ * Same as 'createFactEPRepres', but RP_BVALS, RP_PI, RP_BETA are single
+ * precision (see 'FactorizedEPRepresentation').
+ */
+void createFactEPRepresF32(int numN,int numM,W_IARRAY(rp_rowind),
+			   W_IARRAY(rp_colind),W_FARRAY(rp_bvals),
+			   W_FARRAY(rp_pi),W_FARRAY(rp_beta),
+			   Handle<FactorizedEPRepresentation>& epRepr,
+			   W_ERRORARGS)
+{
+  ArrayHandle<int> rp_rowindA,rp_colindA;
+  ArrayHandle<float> rp_bvalsA,rp_piA,rp_betaA;
+
+  W_CHKSIZE(rp_pi,nrp_bvals,"RP_PI");
+  W_CHKSIZE(rp_beta,nrp_bvals,"RP_BETA");
+  W_MASKARRAY(rp_rowind);
+  W_MASKARRAY(rp_colind);
+  W_MASKARRAY(rp_bvals);
+  W_MASKARRAY(rp_pi);
+  W_MASKARRAY(rp_beta);
+  try {
+    epRepr.changeRep(new FactorizedEPRepresentation(numN,numM,rp_rowindA,
+						    rp_colindA,rp_bvalsA,
+						    rp_betaA,rp_piA));
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Cannot create B representation:\n%s",ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Cannot create B representation: Unspecified exception");
+  }
+}
+
+/*
+ * Creates 'FactorizedEPSession' for EPTWRAP_FACT_SESSION_CREATE[_I64|_F32],
+ * given the representation 'epRepr'. The remaining arguments are
+ * described there, 'ain' is the number of input arguments.
+ */
+void createFactEPSession(int ain,int n,int m,W_IARRAY(pm_potids),
+			 W_IARRAY(pm_numpot),W_DARRAY(pm_parvec),
+			 W_IARRAY(pm_parshrd),W_ARRAY(pm_annobj,void*),
+			 const Handle<FactorizedEPRepresentation>& epRepr,
+			 W_DARRAY(margpi),W_DARRAY(margbeta),
+			 double piminthres,int nthreads,
+			 W_IARRAY(sd_numvalid),W_IARRAY(sd_topind),
+			 W_DARRAY(sd_topval),W_IARRAY(sd_subind),
+			 int sd_subexcl,int sd_heap,void** sess,W_ERRORARGS)
+{
+  if (ain>15) {
+    if (nthreads<1)
+      W_RETERROR(1,"NTHREADS must be positive");
+  } else
+    nthreads=1;
+  /* Potential manager, used by all threads (see
+     'PotManagerFactory::create'). It is created and validated once */
+  Handle<PotentialManager> potMan;
+  ArrayHandle<Handle<PotentialManager> > thrPots;
+  createThreadPotManagers(W_ARR(pm_potids),W_ARR(pm_numpot),
+			  W_ARR(pm_parvec),W_ARR(pm_parshrd),
+			  W_ARR(pm_annobj),nthreads,potMan,thrPots,W_ERRARGS);
+  if (potMan==0)
+    return;
+  if (potMan->size()!=m)
+    W_RETERROR(1,"PM_*: Potential manager has wrong size");
+  /* Variable marginals */
+  ArrayHandle<double> margpiA,margbetaA;
+  W_CHKSIZE(margpi,n,"MARGPI");
+  W_CHKSIZE(margbeta,n,"MARGBETA");
+  W_MASKARRAY(margpi);
+  W_MASKARRAY(margbeta);
+  if (piminthres<=0.0)
+    W_RETERROR(1,"PIMINTHRES must be positive");
+  int sd_k=0; // K of selective damping (0 if not active)
+  ArrayHandle<int> sd_numvalidA,sd_topindA,sd_subindA;
+  ArrayHandle<double> sd_topvalA;
+  if (ain>16) {
+    // Selective damping
+    if (ain<19)
+      W_RETERROR(1,"Need all SD_XXX or none");
+    W_CHKSIZE(sd_numvalid,n,"SD_NUMVALID");
+    W_MASKARRAY(sd_numvalid);
+    sd_k = (nsd_topind/n)-1;
+    if (sd_k<=0 || nsd_topind!=n*(sd_k+1))
+      W_RETERROR(1,"SD_TOPIND: Invalid size");
+    W_MASKARRAY(sd_topind);
+    W_CHKSIZE(sd_topval,nsd_topind,"SD_TOPVAL");
+    W_MASKARRAY(sd_topval);
+    if (ain>19) {
+      if ((nsd_subind==0 && ain<22) || nsd_subind>m)
+	W_RETERROR(1,"SD_SUBIND: Wrong size");
+      if (nsd_subind>0) {
+	W_MASKARRAY(sd_subind);
+      }
+      if (ain==20)
+	sd_subexcl=0;
+    }
+  }
+  if (ain<22)
+    sd_heap=0;
+  /* Create max_pi data structure (only if selective damping). The heaps
+     of 'FactEPMaximumPiHeap' are built once here and kept by the
+     session */
+  Handle<FactEPMaximumPiValues> epMaxPi;
+  if (sd_k>0) {
+    try {
+      if (sd_heap)
+	epMaxPi.changeRep(new FactEPMaximumPiHeap(epRepr,sd_k,sd_numvalidA,
+						  sd_topindA,sd_topvalA,
+						  sd_subindA,sd_subexcl));
+      else
+	epMaxPi.changeRep(new FactEPMaximumPiValues(epRepr,sd_k,
+						    sd_numvalidA,sd_topindA,
+						    sd_topvalA,sd_subindA,
+						    sd_subexcl));
+    } catch (StandardException ex) {
+      W_RETERROR_ARGS(1,"Cannot create FactEPMaximumPiValues (selective damping):\n%s",ex.msg());
+    } catch (...) {
+      W_RETERROR(1,"Cannot create FactEPMaximumPiValues (selective damping): Unspecified exception");
+    }
+  }
+  /* Create EP driver and session */
+  // The session is published in 'sess' only once fully set up. Before,
+  // it is owned here and deleted if an exception is thrown
+  Handle<FactorizedEPDriver> epDriver;
+  FactorizedEPSession* sessP=0;
+  try {
+    epDriver.changeRep(FactEPDriverFactory::create(potMan,epRepr,margbetaA,
+						   margpiA,piminthres,epMaxPi));
+    if (nthreads>1)
+      epDriver->setThreadPotentials(thrPots);
+    sessP=new FactorizedEPSession(epDriver,epMaxPi);
+    sessP->setPotentialTypes(pm_potids,pm_numpot,npm_potids);
+  } catch (StandardException ex) {
+    delete sessP;
+    W_RETERROR_ARGS(1,"Cannot create FactorizedEPSession:\n%s",ex.msg());
+  } catch (...) {
+    delete sessP;
+    W_RETERROR(1,"Cannot create FactorizedEPSession: Unspecified exception");
+  }
+  *sess=(void*) sessP;
+  W_RETOK;
+}
@@ -22,6 +22,13 @@ void createPotentialManager(W_IARRAY(potids),W_IARRAY(numpot),W_DARRAY(parvec),
 			    W_IARRAY(parshrd),W_ARRAY(annobj,void*),
 			    Handle<PotentialManager>& potMan,W_ERRORARGS);
 
+void createThreadPotManagers(W_IARRAY(potids),W_IARRAY(numpot),
+			     W_DARRAY(parvec),W_IARRAY(parshrd),
+			     W_ARRAY(annobj,void*),int nthreads,
+			     Handle<PotentialManager>& potMan,
+			     ArrayHandle<Handle<PotentialManager> >& thrPots,
+			     W_ERRORARGS);
+
 void createFactEPRepres(int numN,int numM,W_IARRAY(rp_rowind),
 			W_IARRAY(rp_colind),W_DARRAY(rp_bvals),W_DARRAY(rp_pi),
 			W_DARRAY(rp_beta),
@@ -35,4 +42,26 @@ void createFactEPRepres_bvprec(int numN,int numM,W_IARRAY(rp_rowind),
 			       Handle<FactorizedEPRepresentation>& epRepr,
 			       W_ERRORARGS);
 
+void createFactEPRepres64(int numN,int numM,W_I64ARRAY(rp_rowind),
+			  W_I64ARRAY(rp_colind),W_DARRAY64(rp_bvals),
+			  W_DARRAY64(rp_pi),W_DARRAY64(rp_beta),
+			  Handle<FactorizedEPRepresentation>& epRepr,
+			  W_ERRORARGS);
+
+void createFactEPRepresF32(int numN,int numM,W_IARRAY(rp_rowind),
+			   W_IARRAY(rp_colind),W_FARRAY(rp_bvals),
+			   W_FARRAY(rp_pi),W_FARRAY(rp_beta),
+			   Handle<FactorizedEPRepresentation>& epRepr,
+			   W_ERRORARGS);
+
+void createFactEPSession(int ain,int n,int m,W_IARRAY(pm_potids),
+			 W_IARRAY(pm_numpot),W_DARRAY(pm_parvec),
+			 W_IARRAY(pm_parshrd),W_ARRAY(pm_annobj,void*),
+			 const Handle<FactorizedEPRepresentation>& epRepr,
+			 W_DARRAY(margpi),W_DARRAY(margbeta),
+			 double piminthres,int nthreads,
+			 W_IARRAY(sd_numvalid),W_IARRAY(sd_topind),
+			 W_DARRAY(sd_topval),W_IARRAY(sd_subind),
+			 int sd_subexcl,int sd_heap,void** sess,W_ERRORARGS);
+
 #endif
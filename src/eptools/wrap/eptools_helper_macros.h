@@ -10,6 +10,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <stdint.h>
 
 // Macros for wrapper functions
 
@@ -20,8 +21,17 @@
 
 #define W_IARRAY(NAM) W_ARRAY(NAM,int)
 
+#define W_FARRAY(NAM) W_ARRAY(NAM,float)
+
 #define W_ARR(NAM) NAM,n ## NAM
 
+// Arrays with 64-bit size (not limited by 'ArrayHandle'):
+#define W_ARRAY64(NAM,TYP) TYP* NAM,int64_t n ## NAM
+
+#define W_DARRAY64(NAM) W_ARRAY64(NAM,double)
+
+#define W_I64ARRAY(NAM) W_ARRAY64(NAM,int64_t)
+
 // Dealing with errors. Requires arguments 'errcode' (int*) and 'errstr'
 // (char*), latter a buffer of sufficient size (typically 512)
 #define W_ERRCODE errcode
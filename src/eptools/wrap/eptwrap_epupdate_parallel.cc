@@ -28,7 +28,8 @@
  *            [int32 array]
  * - ALPHA:   Vector of alpha values
  * - NU:      Vector of nu values
- * - LOGZ:    Vector of log Z values (optional)
+ * - LOGZ:    Vector of log Z values (optional). Undefined where RSTAT
+ *            is 0
  * -------------------------------------------------------------------
  * Matlab MEX Function
  * Author: Matthias Seeger
@@ -46,10 +47,8 @@ void eptwrap_epupdate_parallel(int ain,int aout,W_IARRAY(potids),
 			       W_IARRAY(rstat),W_DARRAY(alpha),W_DARRAY(nu),
 			       W_DARRAY(logz),W_ERRORARGS)
 {
-  int i,j,totsz;
-  double temp;
+  int i,j,num,totsz;
   Handle<PotentialManager> potMan;
-  double inp[2],ret[2];
 
   try {
     /* Read arguments */
@@ -87,15 +86,16 @@ void eptwrap_epupdate_parallel(int ain,int aout,W_IARRAY(potids),
     else
       logz=0;
 
-    /* Main loop over all potentials */
-    for (i=0; i<totsz; i++) {
+    /* Main loop over all potentials. Runs of consecutive potentials are
+       done by 'compMomentsBatch' */
+    for (i=0; i<totsz; i+=num) {
       j=(updind==0)?i:updind[i];
-      //cout << "i=" << i << endl;
-      inp[0]=cmu[i]; inp[1]=crho[i];
-      rstat[i] = potMan->getPot(j).compMoments(inp,ret,&temp);
-      alpha[i]=ret[0]; nu[i]=ret[1];
-      if (rstat[i] && aout>3)
-	logz[i]=temp;
+      if (updind==0)
+	num=totsz;
+      else
+	for (num=1; i+num<totsz && updind[i+num]==j+num; num++);
+      potMan->compMomentsBatch(j,num,cmu+i,crho+i,alpha+i,nu+i,
+			       (logz!=0)?(logz+i):0,rstat+i);
     }
     W_RETOK;
   } catch (StandardException ex) {
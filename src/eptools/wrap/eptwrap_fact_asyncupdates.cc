@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_ASYNCUPDATES
+ *
+ * EP with factorized Gaussian backbone. Run a number of updates on
+ * potentials asynchronously ("Hogwild").
+ * Same as EPTWRAP_FACT_SEQUPDATES, except that updates on the potentials
+ * in UPDJIND are distributed over NTHREADS threads without any
+ * coordination. Cavity marginals are computed from marginals which may
+ * be modified by other threads at the same time, and new marginals are
+ * written back by atomic additions. At the end, MARGPI, MARGBETA are
+ * recomputed from the EP parameters (as EPTWRAP_FACT_COMPMARGINALS), in
+ * order to remove drift. See 'FactorizedEPDriver::asyncSweep' for
+ * details.
+ * This makes sense for very sparse B, where potentials updated at the
+ * same time rarely share variables. Results are not deterministic.
+ *
+ * NOTE: Multi-threading requires the code to be compiled with OpenMP.
+ * Otherwise, NTHREADS is ignored and updates are done one after the
+ * other. Potentials with annotation objects (PM_ANNOBJ) are not supported
+ * with NTHREADS>1, since these objects would be shared between threads.
+ * Entries of UPDJIND must be distinct. Selective damping is not
+ * supported.
+ *
+ * Input:
+ * - N:           Number of variables
+ * - M:           Number of factors
+ * - UPDJIND:     Update on these potentials [int32 array]
+ * - PM_POTIDS:   Potential manager [int32 array]
+ * - PM_NUMPOT:   " [int32 array]
+ * - PM_PARVEC:   " [double array]
+ * - PM_PARSHRD:  " [int32 array]
+ * - PM_ANNOBJ:   " [void* array]
+ * - RP_ROWIND:   Factorized EP representation [int32 array]
+ * - RP_COLIND:   " [int32 array]
+ * - RP_BVALS:    " [double array]
+ * - RP_PI:       " [double array; I/O]
+ * - RP_BETA:     " [double array; I/O]
+ * - MARGPI:      Variable marginals [I/O]
+ * - MARGBETA:    " [I/O]
+ * - PIMINTHRES:  See EPTWRAP_FACT_SEQUPDATES. Positive
+ * - DAMPFACT:    Damping factor, in [0,1). Optional, def. is 0
+ * - NTHREADS:    Number of threads. Optional, def. is 1
+ *
+ * Return:
+ * - RSTAT:       Return stati for each update. Optional [int32]
+ * - DELTA:       See EPTWRAP_FACT_SEQUPDATES. Optional
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_asyncupdates.h"
+#include "src/eptools/FactorizedEPDriver.h"
+#include "src/eptools/FactEPDriverFactory.h"
+
+void eptwrap_fact_asyncupdates(int ain,int aout,int n,int m,
+			       W_IARRAY(updjind),W_IARRAY(pm_potids),
+			       W_IARRAY(pm_numpot),W_DARRAY(pm_parvec),
+			       W_IARRAY(pm_parshrd),W_ARRAY(pm_annobj,void*),
+			       W_IARRAY(rp_rowind),W_IARRAY(rp_colind),
+			       W_DARRAY(rp_bvals),W_DARRAY(rp_pi),
+			       W_DARRAY(rp_beta),W_DARRAY(margpi),
+			       W_DARRAY(margbeta),double piminthres,
+			       double dampfact,int nthreads,W_IARRAY(rstat),
+			       W_DARRAY(delta),W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<16 || ain>18)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout>2)
+      W_RETERROR(2,"Too many return arguments");
+    if (n<1) W_RETERROR(1,"N wrong");
+    if (m<1) W_RETERROR(1,"M wrong");
+    if (nupdjind==0)
+      W_RETERROR(1,"UPDJIND must not be empty");
+    Interval<int> ivM(0,m-1,IntVal::ivClosed,IntVal::ivClosed);
+    if (ivM.check(updjind,nupdjind)!=0)
+      W_RETERROR(1,"UPDJIND: Entries of out range");
+    /* Representation of B */
+    Handle<FactorizedEPRepresentation> epRepr;
+    createFactEPRepres(n,m,W_ARR(rp_rowind),W_ARR(rp_colind),W_ARR(rp_bvals),
+		       W_ARR(rp_pi),W_ARR(rp_beta),epRepr,W_ERRARGS);
+    /* Variable marginals */
+    ArrayHandle<double> margpiA,margbetaA;
+    W_CHKSIZE(margpi,n,"MARGPI");
+    W_CHKSIZE(margbeta,n,"MARGBETA");
+    W_MASKARRAY(margpi);
+    W_MASKARRAY(margbeta);
+    if (piminthres<=0.0)
+      W_RETERROR(1,"PIMINTHRES must be positive");
+    if (ain>16) {
+      if (dampfact<0.0 || dampfact>=1.0)
+	W_RETERROR(1,"DAMPFACT: Out of range");
+      if (ain>17) {
+	if (nthreads<1)
+	  W_RETERROR(1,"NTHREADS must be positive");
+      } else
+	nthreads=1;
+    } else {
+      dampfact=0.0; nthreads=1;
+    }
+    /* Potential manager */
+    // A single manager serves all threads (see 'PotManagerFactory::create')
+    Handle<PotentialManager> potMan;
+    ArrayHandle<Handle<PotentialManager> > thrPots;
+    createThreadPotManagers(W_ARR(pm_potids),W_ARR(pm_numpot),
+			    W_ARR(pm_parvec),W_ARR(pm_parshrd),
+			    W_ARR(pm_annobj),nthreads,potMan,thrPots,
+			    W_ERRARGS);
+    if (potMan==0)
+      return;
+    if (potMan->size()!=m)
+      W_RETERROR(1,"PM_*: Potential manager has wrong size");
+    /* Return arguments: Default values and check sizes */
+    if (aout<2) {
+      delta=0;
+      if (aout==0)
+	rstat=0;
+    }
+    if (aout>0) {
+      W_CHKSIZE(rstat,nupdjind,"RSTAT");
+      if (aout>1)
+	W_CHKSIZE(delta,nupdjind,"DELTA");
+    }
+    /* Create EP driver */
+    Handle<FactorizedEPDriver> epDriver;
+    try {
+      epDriver.changeRep(FactEPDriverFactory::create(potMan,epRepr,margbetaA,
+						   margpiA,piminthres));
+      if (nthreads>1)
+	epDriver->setThreadPotentials(thrPots);
+    } catch (StandardException ex) {
+      W_RETERROR_ARGS(1,"Cannot create FactorizedEPDriver:\n%s",ex.msg());
+    } catch (...) {
+      W_RETERROR(1,"Cannot create FactorizedEPDriver: Unspecified exception");
+    }
+
+    /* Run updates */
+    epDriver->asyncSweep(updjind,nupdjind,dampfact,rstat,delta);
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
@@ -0,0 +1,222 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_COLUPDATES
+ *
+ * EP with factorized Gaussian backbone. Run a number of updates on
+ * potentials, in parallel where possible.
+ * Same as EPTWRAP_FACT_SEQUPDATES, except that the potentials in
+ * UPDJIND are first partitioned into batches, so that no two potentials
+ * in a batch share a variable (greedy graph coloring). The batches are
+ * processed one after the other, the updates within a batch are
+ * distributed over NTHREADS threads. See
+ * 'FactorizedEPDriver::coloredSweep' for details.
+ * The batch ordering of UPDJIND is returned in SCHEDJIND, the number of
+ * batches in NBATCH. Batch b is SCHEDJIND(BOFF(b):(BOFF(b+1)-1)), where
+ * BOFF is not returned. The results are the same as running
+ * EPTWRAP_FACT_SEQUPDATES on SCHEDJIND, which in turn gives the same
+ * results as running it on UPDJIND. All return arguments RSTAT, DELTA,
+ * SD_DAMPFACT are w.r.t. SCHEDJIND (not UPDJIND).
+ *
+ * NOTE: Multi-threading requires the code to be compiled with OpenMP.
+ * Otherwise, NTHREADS is ignored and updates are done one after the
+ * other. Potentials with annotation objects (PM_ANNOBJ) are not supported
+ * with NTHREADS>1, since these objects would be shared between threads.
+ *
+ * Input:
+ * - N:           Number of variables
+ * - M:           Number of factors
+ * - UPDJIND:     Update on these potentials [int32 array]
+ * - PM_POTIDS:   Potential manager [int32 array]
+ * - PM_NUMPOT:   " [int32 array]
+ * - PM_PARVEC:   " [double array]
+ * - PM_PARSHRD:  " [int32 array]
+ * - PM_ANNOBJ:   " [void* array]
+ * - RP_ROWIND:   Factorized EP representation [int32 array]
+ * - RP_COLIND:   " [int32 array]
+ * - RP_BVALS:    " [double array]
+ * - RP_PI:       " [double array; I/O]
+ * - RP_BETA:     " [double array; I/O]
+ * - MARGPI:      Variable marginals [I/O]
+ * - MARGBETA:    " [I/O]
+ * - PIMINTHRES:  See EPTWRAP_FACT_SEQUPDATES. Positive
+ * - DAMPFACT:    Damping factor, in [0,1). Optional, def. is 0
+ * - NTHREADS:    Number of threads. Optional, def. is 1
+ * - SD_NUMVALID: Selective damping. Optional [int32 array; I/O]
+ * - SD_TOPIND:   " [int32 array; I/O]
+ * - SD_TOPVAL:   " [double array; I/O]
+ * - SD_SUBIND    " [int32 array]
+ * - SD_SUBEXCL   ". Def.: false
+ *
+ * Return:
+ * - SCHEDJIND:   Batch ordering of UPDJIND [int32]
+ * - NBATCH:      Number of batches [int32]
+ * - RSTAT:       Return stati for each update. Optional [int32]
+ * - DELTA:       See EPTWRAP_FACT_SEQUPDATES. Optional
+ * - SD_DAMPFACT: " Optional, only if selective damping
+ * - SD_NUPD:     " [int32]
+ * - SD_NREC:     " [int32]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_colupdates.h"
+#include "src/eptools/FactorizedEPDriver.h"
+#include "src/eptools/FactEPDriverFactory.h"
+#include "src/eptools/FactEPMaximumPiValues.h"
+
+void eptwrap_fact_colupdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
+			     W_IARRAY(pm_potids),W_IARRAY(pm_numpot),
+			     W_DARRAY(pm_parvec),W_IARRAY(pm_parshrd),
+			     W_ARRAY(pm_annobj,void*),W_IARRAY(rp_rowind),
+			     W_IARRAY(rp_colind),W_DARRAY(rp_bvals),
+			     W_DARRAY(rp_pi),W_DARRAY(rp_beta),W_DARRAY(margpi),
+			     W_DARRAY(margbeta),double piminthres,
+			     double dampfact,int nthreads,
+			     W_IARRAY(sd_numvalid),W_IARRAY(sd_topind),
+			     W_DARRAY(sd_topval),W_IARRAY(sd_subind),
+			     int sd_subexcl,W_IARRAY(schedjind),int* nbatch,
+			     W_IARRAY(rstat),W_DARRAY(delta),
+			     W_DARRAY(sd_dampfact),int* sd_nupd,int* sd_nrec,
+			     W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<16 || ain>23)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout<2 || aout>7)
+      W_RETERROR(2,"Wrong number of return arguments");
+    if (n<1) W_RETERROR(1,"N wrong");
+    if (m<1) W_RETERROR(1,"M wrong");
+    if (nupdjind==0)
+      W_RETERROR(1,"UPDJIND must not be empty");
+    Interval<int> ivM(0,m-1,IntVal::ivClosed,IntVal::ivClosed);
+    if (ivM.check(updjind,nupdjind)!=0)
+      W_RETERROR(1,"UPDJIND: Entries of out range");
+    /* Representation of B */
+    Handle<FactorizedEPRepresentation> epRepr;
+    createFactEPRepres(n,m,W_ARR(rp_rowind),W_ARR(rp_colind),W_ARR(rp_bvals),
+		       W_ARR(rp_pi),W_ARR(rp_beta),epRepr,W_ERRARGS);
+    /* Variable marginals */
+    ArrayHandle<double> margpiA,margbetaA;
+    W_CHKSIZE(margpi,n,"MARGPI");
+    W_CHKSIZE(margbeta,n,"MARGBETA");
+    W_MASKARRAY(margpi);
+    W_MASKARRAY(margbeta);
+    if (piminthres<=0.0)
+      W_RETERROR(1,"PIMINTHRES must be positive");
+    int sd_k=0; // K of selective damping (0 if not active)
+    ArrayHandle<int> sd_numvalidA,sd_topindA,sd_subindA;
+    ArrayHandle<double> sd_topvalA;
+    if (ain>16) {
+      if (dampfact<0.0 || dampfact>=1.0)
+	W_RETERROR(1,"DAMPFACT: Out of range");
+      if (ain>17) {
+	if (nthreads<1)
+	  W_RETERROR(1,"NTHREADS must be positive");
+	if (ain>18) {
+	  // Selective damping
+	  if (ain<21)
+	    W_RETERROR(1,"Need all SD_XXX or none");
+	  W_CHKSIZE(sd_numvalid,n,"SD_NUMVALID");
+	  W_MASKARRAY(sd_numvalid);
+	  sd_k = (nsd_topind/n)-1;
+	  if (sd_k<=0 || nsd_topind!=n*(sd_k+1))
+	    W_RETERROR(1,"SD_TOPIND: Invalid size");
+	  W_MASKARRAY(sd_topind);
+	  W_CHKSIZE(sd_topval,nsd_topind,"SD_TOPVAL");
+	  W_MASKARRAY(sd_topval);
+	  if (ain>21) {
+	    if (nsd_subind==0 || nsd_subind>m)
+	      W_RETERROR(1,"SD_SUBIND: Wrong size");
+	    W_MASKARRAY(sd_subind);
+	    if (ain==22)
+	      sd_subexcl=0;
+	  }
+	}
+      } else
+	nthreads=1;
+    } else {
+      dampfact=0.0; nthreads=1;
+    }
+    /* Potential manager */
+    // A single manager serves all threads (see 'PotManagerFactory::create')
+    Handle<PotentialManager> potMan;
+    ArrayHandle<Handle<PotentialManager> > thrPots;
+    createThreadPotManagers(W_ARR(pm_potids),W_ARR(pm_numpot),
+			    W_ARR(pm_parvec),W_ARR(pm_parshrd),
+			    W_ARR(pm_annobj),nthreads,potMan,thrPots,
+			    W_ERRARGS);
+    if (potMan==0)
+      return;
+    if (potMan->size()!=m)
+      W_RETERROR(1,"PM_*: Potential manager has wrong size");
+    /* Return arguments: Default values and check sizes */
+    if (aout<7) {
+      sd_nrec=0;
+      if (aout<6) {
+	sd_nupd=0;
+	if (aout<5) {
+	  sd_dampfact=0;
+	  if (aout<4) {
+	    delta=0;
+	    if (aout==2)
+	      rstat=0;
+	  }
+	}
+      }
+    }
+    W_CHKSIZE(schedjind,nupdjind,"SCHEDJIND");
+    if (aout>2) {
+      W_CHKSIZE(rstat,nupdjind,"RSTAT");
+      if (aout>3) {
+	W_CHKSIZE(delta,nupdjind,"DELTA");
+	if (aout>4) {
+	  if (sd_k==0)
+	    W_RETERROR(1,"Cannot return SD_XXX");
+	  W_CHKSIZE(sd_dampfact,nupdjind,"SD_DAMPFACT");
+	}
+      }
+    }
+    /* Create max_pi data structure (only if selective damping) */
+    Handle<FactEPMaximumPiValues> epMaxPi;
+    if (sd_k>0) {
+      try {
+	epMaxPi.changeRep(new FactEPMaximumPiValues(epRepr,sd_k,
+						    sd_numvalidA,sd_topindA,
+						    sd_topvalA,sd_subindA,
+						    sd_subexcl));
+      } catch (StandardException ex) {
+	W_RETERROR_ARGS(1,"Cannot create FactEPMaximumPiValues (selective damping):\n%s",ex.msg());
+      } catch (...) {
+	W_RETERROR(1,"Cannot create FactEPMaximumPiValues (selective damping): Unspecified exception");
+      }
+    }
+    /* Create EP driver */
+    Handle<FactorizedEPDriver> epDriver;
+    try {
+      epDriver.changeRep(FactEPDriverFactory::create(potMan,epRepr,margbetaA,
+						   margpiA,piminthres,epMaxPi));
+      if (nthreads>1)
+	epDriver->setThreadPotentials(thrPots);
+    } catch (StandardException ex) {
+      W_RETERROR_ARGS(1,"Cannot create FactorizedEPDriver:\n%s",ex.msg());
+    } catch (...) {
+      W_RETERROR(1,"Cannot create FactorizedEPDriver: Unspecified exception");
+    }
+
+    /* Run updates */
+    *nbatch=epDriver->coloredSweep(updjind,nupdjind,schedjind,dampfact,rstat,
+				   delta,sd_dampfact);
+    if (sd_nupd!=0) {
+      int inrec;
+      epMaxPi->getStats(*sd_nupd,inrec);
+      if (sd_nrec!=0) *sd_nrec=inrec;
+    }
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
@@ -0,0 +1,28 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_COMPMARGINALS_F32
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_COMPMARGINALS_F32_H
+#define EPTWRAP_FACT_COMPMARGINALS_F32_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_compmarginals_f32(int ain,int aout,int n,int m,
+				      W_IARRAY(rp_rowind),
+				      W_IARRAY(rp_colind),
+				      W_FARRAY(rp_bvals),W_FARRAY(rp_pi),
+				      W_FARRAY(rp_beta),W_DARRAY(margpi),
+				      W_DARRAY(margbeta),W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_COMPMARGINALS_MAXPI
+ *
+ * ATTENTION: We use the undocumented fact that the content of
+ * matrices passed as arguments to a MEX function can be overwritten
+ * like in a proper call-by-reference. This is not officially
+ * supported and may not work in future Matlab versions!
+ *
+ * EP with factorized Gaussian backbone.
+ * Fused refresh: computes marginals on variables from EP (message)
+ * parameters (as EPTWRAP_FACT_COMPMARGINALS), and optionally the top-K
+ * lists for selective damping (as EPTWRAP_FACT_COMPMAXPI), in a single
+ * pass over the columns of B, which is distributed over NTHREADS
+ * threads (see 'FactEPMaximumPiValues::recomputeMarginals'). Results do
+ * not depend on NTHREADS.
+ *
+ * If RP_TAUIND, RP_A, RP_C are given (nonempty), the model contains
+ * bivariate precision potentials, and MARGA, MARGC are written as well
+ * (see EPTWRAP_FACT_COMPMARGINALS_BVPREC). Otherwise, MARGA, MARGC are
+ * not used.
+ * If SD_K>0, the top-K lists are written to SD_NUMVALID, SD_TOPIND,
+ * SD_TOPVAL (these must have the correct sizes). SD_SUBIND, SD_SUBEXCL
+ * are as in EPTWRAP_FACT_COMPMAXPI.
+ *
+ * Input:
+ * - N:           Number of variables
+ * - M:           Number of factors
+ * - RP_ROWIND:   Factorized EP representation [int32 array]
+ * - RP_COLIND:   " [int32 array]
+ * - RP_BVALS:    " [double array]
+ * - RP_PI:       " [double array]
+ * - RP_BETA:     " [double array]
+ * - RP_TAUIND    " [int32 array]. Can be empty
+ * - RP_A:        " [double array]. Can be empty
+ * - RP_C:        " [double array]. Can be empty
+ * - MARGPI:      Marginal pi parameters written here
+ * - MARGBETA:    " (beta)
+ * - MARGA:       " (a). Can be empty
+ * - MARGC:       " (c). Can be empty
+ * - NTHREADS:    Number of threads
+ * - SD_K:        Value K (0: Top-K lists not computed). Optional
+ * - SD_NUMVALID: Max pi data structure written here. Optional
+ * - SD_TOPIND:   ". Optional
+ * - SD_TOPVAL:   ". Optional
+ * - SD_SUBIND:   See above. Optional [int32 array]
+ * - SD_SUBEXCL:  ". Def.: 0 [int]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_compmarginals_maxpi.h"
+#include "src/eptools/FactorizedEPRepresentation.h"
+#include "src/eptools/FactEPMaximumPiValues.h"
+
+void eptwrap_fact_compmarginals_maxpi(int ain,int aout,int n,int m,
+				      W_IARRAY(rp_rowind),
+				      W_IARRAY(rp_colind),
+				      W_DARRAY(rp_bvals),W_DARRAY(rp_pi),
+				      W_DARRAY(rp_beta),W_IARRAY(rp_tauind),
+				      W_DARRAY(rp_a),W_DARRAY(rp_c),
+				      W_DARRAY(margpi),W_DARRAY(margbeta),
+				      W_DARRAY(marga),W_DARRAY(margc),
+				      int nthreads,int sd_k,
+				      W_IARRAY(sd_numvalid),
+				      W_IARRAY(sd_topind),
+				      W_DARRAY(sd_topval),
+				      W_IARRAY(sd_subind),int sd_subexcl,
+				      W_ERRORARGS)
+{
+  int i,numk;
+  Handle<FactorizedEPRepresentation> epRepr;
+  ArrayHandle<int> sd_numvalidA,sd_topindA,sd_subindA;
+  ArrayHandle<double> sd_topvalA;
+  Handle<FactEPMaximumPiValues> epMaxPi;
+
+  try {
+    /* Read arguments */
+    if (ain!=15 && (ain<19 || ain>21))
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout!=0)
+      W_RETERROR(2,"No return arguments");
+    if (nthreads<1)
+      W_RETERROR(1,"NTHREADS: Must be positive");
+    if (ain<21)
+      sd_subexcl=0;
+    if (ain<20)
+      sd_subind=0;
+    if (ain<19)
+      sd_k=0;
+    if (sd_k<0 || sd_k==1)
+      W_RETERROR(1,"SD_K: Must be 0 or >1");
+    if (sd_subind!=0 && nsd_subind==0)
+      sd_subind=0;
+    if (sd_subind!=0 && nsd_subind>m)
+      W_RETERROR(1,"SD_SUBIND: Wrong size");
+    W_CHKSIZE(margpi,n,"MARGPI");
+    W_CHKSIZE(margbeta,n,"MARGBETA");
+    /* Representation */
+    if (nrp_tauind>0)
+      createFactEPRepres_bvprec(n,m,W_ARR(rp_rowind),W_ARR(rp_colind),
+				W_ARR(rp_bvals),W_ARR(rp_pi),W_ARR(rp_beta),
+				W_ARR(rp_tauind),W_ARR(rp_a),W_ARR(rp_c),
+				epRepr,W_ERRARGS);
+    else
+      createFactEPRepres(n,m,W_ARR(rp_rowind),W_ARR(rp_colind),
+			 W_ARR(rp_bvals),W_ARR(rp_pi),W_ARR(rp_beta),epRepr,
+			 W_ERRARGS);
+    if (epRepr==0)
+      return;
+    if ((numk=epRepr->numPrecVariables())>0) {
+      W_CHKSIZE(marga,numk,"MARGA");
+      W_CHKSIZE(margc,numk,"MARGC");
+    }
+    /* Compute marginals (and top-K lists) */
+    if (sd_k>0) {
+      W_CHKSIZE(sd_numvalid,n,"SD_NUMVALID");
+      i=n*(sd_k+1);
+      W_CHKSIZE(sd_topind,i,"SD_TOPIND");
+      W_CHKSIZE(sd_topval,i,"SD_TOPVAL");
+      W_MASKARRAY(sd_numvalid);
+      W_MASKARRAY(sd_topind);
+      W_MASKARRAY(sd_topval);
+      if (sd_subind!=0)
+	W_MASKARRAY(sd_subind);
+      for (i=0; i<n; i++)
+	sd_numvalid[i]=1; // Just to make constructor happy
+      try {
+	epMaxPi.changeRep(new FactEPMaximumPiValues(epRepr,sd_k,sd_numvalidA,
+						    sd_topindA,sd_topvalA,
+						    sd_subindA,
+						    sd_subexcl!=0));
+      } catch (StandardException ex) {
+	W_RETERROR_ARGS(1,"Cannot create FactEPMaximumPiValues (selective damping):\n%s",ex.msg());
+      }
+      epMaxPi->recomputeMarginals(margbeta,margpi,nthreads);
+    } else
+      epRepr->compMarginals(margbeta,margpi,false,nthreads);
+    if (numk>0)
+      epRepr->compTauMarginals(marga,margc,false,nthreads);
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s",ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
@@ -0,0 +1,29 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_COMPMAXPI_I64
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_COMPMAXPI_I64_H
+#define EPTWRAP_FACT_COMPMAXPI_I64_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_compmaxpi_i64(int ain,int aout,int n,int m,
+				  W_I64ARRAY(rp_rowind),W_I64ARRAY(rp_colind),
+				  W_DARRAY64(rp_bvals),W_DARRAY64(rp_pi),
+				  W_DARRAY64(rp_beta),int sd_k,
+				  W_IARRAY(sd_subind),int sd_subexcl,
+				  W_IARRAY(sd_numvalid),W_IARRAY(sd_topind),
+				  W_DARRAY(sd_topval),W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
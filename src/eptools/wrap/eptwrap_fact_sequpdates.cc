@@ -56,6 +56,12 @@
  * variables (I/O, content is overwritten).
  * SD_NUPD, SD_NREC return statistics about this datastructure (number of
  * update calls and block recomputations).
+ * If SD_HEAP is true, 'FactEPMaximumPiHeap' is used instead: max_j pi_ji
+ * is tracked by a heap per variable, so that no recomputations are
+ * needed (SD_NREC is 0). The heaps are built at the start of each call
+ * (O(nnz)), this pays off for long runs of updates on variables with
+ * large |V_i|. SD_NUMVALID, SD_TOPIND, SD_TOPVAL are written back at the
+ * end. If SD_HEAP is given, SD_SUBIND may be empty (no subset).
  *
  * Input:
  * - N:           Number of variables
@@ -80,6 +86,7 @@
  * - SD_TOPVAL:   " [double array; I/O]
  * - SD_SUBIND    " [int32 array]
  * - SD_SUBEXCL   ". Def.: false
+ * - SD_HEAP      ". Use 'FactEPMaximumPiHeap'? Def.: false
  *
  * Return:
  * - RSTAT:       Return stati for each update. Optional [int32]
@@ -95,7 +102,9 @@
 #include "src/eptools/wrap/eptools_helper.h"
 #include "src/eptools/wrap/eptwrap_fact_sequpdates.h"
 #include "src/eptools/FactorizedEPDriver.h"
+#include "src/eptools/FactEPDriverFactory.h"
 #include "src/eptools/FactEPMaximumPiValues.h"
+#include "src/eptools/FactEPMaximumPiHeap.h"
 
 void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
 			     W_IARRAY(pm_potids),W_IARRAY(pm_numpot),
@@ -106,14 +115,14 @@ void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
 			     W_DARRAY(margbeta),double piminthres,
 			     double dampfact,W_IARRAY(sd_numvalid),
 			     W_IARRAY(sd_topind),W_DARRAY(sd_topval),
-			     W_IARRAY(sd_subind),int sd_subexcl,
+			     W_IARRAY(sd_subind),int sd_subexcl,int sd_heap,
 			     W_IARRAY(rstat),W_DARRAY(delta),
 			     W_DARRAY(sd_dampfact),int* sd_nupd,int* sd_nrec,
 			     W_ERRORARGS)
 {
   try {
     /* Read arguments */
-    if (ain<16 || ain>22)
+    if (ain<16 || ain>23)
       W_RETERROR(2,"Wrong number of input arguments");
     if (aout>5)
       W_RETERROR(2,"Too many return arguments");
@@ -168,15 +177,19 @@ void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
 	W_MASKARRAY(sd_topval);
 	//printMsgStdout("Point 5");
 	if (ain>20) {
-	  if (nsd_subind==0 || nsd_subind>m)
+	  if ((nsd_subind==0 && ain<23) || nsd_subind>m)
 	    W_RETERROR(1,"SD_SUBIND: Wrong size");
-	  W_MASKARRAY(sd_subind);
+	  if (nsd_subind>0) {
+	    W_MASKARRAY(sd_subind);
+	  }
 	  if (ain==21)
 	    sd_subexcl=0;
 	}
       }
     } else
       dampfact=0.0;
+    if (ain<23)
+      sd_heap=0;
     /* Return arguments: Default values and check sizes */
     if (aout<5) {
       sd_nrec=0;
@@ -206,15 +219,24 @@ void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
     /* Create max_pi data structure (only if selective damping) */
     Handle<FactEPMaximumPiValues> epMaxPi;
     //printMsgStdout("Point 6");
+    Handle<FactEPMaximumPiHeap> epMaxPiHeap;
     if (sd_k>0) {
       try {
 	//sprintf(W_ERRSTR,"MEX: n=%d,K=%d,numvalid=%d,topind=%d,topval=%d",n,
 	//	sd_k,sd_numvalidA.size(),sd_topindA.size(),sd_topvalA.size());
 	//printMsgStdout(W_ERRSTR);
-	epMaxPi.changeRep(new FactEPMaximumPiValues(epRepr,sd_k,
-						    sd_numvalidA,sd_topindA,
-						    sd_topvalA,sd_subindA,
-						    sd_subexcl));
+	if (sd_heap) {
+	  epMaxPiHeap.changeRep(new FactEPMaximumPiHeap(epRepr,sd_k,
+							sd_numvalidA,
+							sd_topindA,sd_topvalA,
+							sd_subindA,
+							sd_subexcl));
+	  epMaxPi=epMaxPiHeap;
+	} else
+	  epMaxPi.changeRep(new FactEPMaximumPiValues(epRepr,sd_k,
+						      sd_numvalidA,
+						      sd_topindA,sd_topvalA,
+						      sd_subindA,sd_subexcl));
       } catch (StandardException ex) {
 	W_RETERROR_ARGS(1,"Cannot create FactEPMaximumPiValues (selective damping):\n%s",ex.msg());
       } catch (...) {
@@ -225,8 +247,8 @@ void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
     Handle<FactorizedEPDriver> epDriver;
     //printMsgStdout("Point 7");
     try {
-      epDriver.changeRep(new FactorizedEPDriver(potMan,epRepr,margbetaA,
-						margpiA,piminthres,epMaxPi));
+      epDriver.changeRep(FactEPDriverFactory::create(potMan,epRepr,margbetaA,
+						   margpiA,piminthres,epMaxPi));
     } catch (StandardException ex) {
       W_RETERROR_ARGS(1,"Cannot create FactorizedEPDriver:\n%s",ex.msg());
     } catch (...) {
@@ -247,6 +269,8 @@ void eptwrap_fact_sequpdates(int ain,int aout,int n,int m,W_IARRAY(updjind),
 	sd_dampfact[i]=1.0;
     }
     //printMsgStdout("Point 9");
+    if (!(epMaxPiHeap==0))
+      epMaxPiHeap->syncTopLists();
     if (sd_nupd!=0) {
       int inrec;
       epMaxPi->getStats(*sd_nupd,inrec);
@@ -24,7 +24,8 @@ extern "C" {
 			       double piminthres,double dampfact,
 			       W_IARRAY(sd_numvalid),W_IARRAY(sd_topind),
 			       W_DARRAY(sd_topval),W_IARRAY(sd_subind),
-			       int sd_subexcl,W_IARRAY(rstat),W_DARRAY(delta),
+			       int sd_subexcl,int sd_heap,W_IARRAY(rstat),
+			       W_DARRAY(delta),
 			       W_DARRAY(sd_dampfact),int* sd_nupd,int* sd_nrec,
 			       W_ERRORARGS);
 
@@ -0,0 +1,108 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_APPEND
+ *
+ * EP with factorized Gaussian backbone. Appends potentials (rows of B)
+ * to the model of a session object created by
+ * EPTWRAP_FACT_SESSION_CREATE, keeping the current EP state (see
+ * 'FactorizedEPDriver::appendPotentials'). The new potentials get
+ * indexes M, M+1, ..., where M is the current number of potentials
+ * (returned in J0). MARGPI, MARGBETA (and the SD_XXX arrays if selective
+ * damping is active) passed at creation are updated by the new messages.
+ * The EP parameters of new potentials are kept in the session (not in
+ * RP_PI, RP_BETA). Run updates on them by EPTWRAP_FACT_SESSION_UPDATES.
+ * Only for 32-bit index, double precision.
+ * The potential manager for the new potentials is given by PM_XXX as in
+ * EPTWRAP_FACT_SESSION_CREATE, it must have size NUM (number of new
+ * potentials). The session refers to these arrays (they are not
+ * copied). New row k (0-based) has support index
+ * AP_IND[AP_ROWOFF[k]:(AP_ROWOFF[k+1]-1)] (ascending, 0-based, not
+ * empty) and B values in AP_BVALS at the same positions. AP_ROWOFF has
+ * size NUM+1, AP_ROWOFF[0] must be 0.
+ *
+ * Input:
+ * - SESS:        Session object [void*]
+ * - PM_POTIDS:   Potential manager [int32 array]
+ * - PM_NUMPOT:   " [int32 array]
+ * - PM_PARVEC:   " [double array]
+ * - PM_PARSHRD:  " [int32 array]
+ * - PM_ANNOBJ:   " [void* array]
+ * - AP_ROWOFF:   Row offsets [int32 array]
+ * - AP_IND:      Support indexes [int32 array]
+ * - AP_BVALS:    B values [double array]
+ * - AP_PI:       Initial EP parameters pi. Optional, def. is 0
+ * - AP_BETA:     Initial EP parameters beta. Optional, def. is 0
+ *
+ * Return:
+ * - J0:          Index of first new potential [int32]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_append.h"
+#include "src/eptools/FactorizedEPSession.h"
+
+void eptwrap_fact_session_append(int ain,int aout,void* sess,
+				 W_IARRAY(pm_potids),W_IARRAY(pm_numpot),
+				 W_DARRAY(pm_parvec),W_IARRAY(pm_parshrd),
+				 W_ARRAY(pm_annobj,void*),W_IARRAY(ap_rowoff),
+				 W_IARRAY(ap_ind),W_DARRAY(ap_bvals),
+				 W_DARRAY(ap_pi),W_DARRAY(ap_beta),int* j0,
+				 W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<9 || ain>11)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout>1)
+      W_RETERROR(2,"Too many return arguments");
+    if (sess==0)
+      W_RETERROR(1,"SESS is NULL");
+    FactorizedEPSession& epSess=*((FactorizedEPSession*) sess);
+    int num=nap_rowoff-1;
+    if (num<1)
+      W_RETERROR(1,"AP_ROWOFF: Wrong size");
+    if (ap_rowoff[num]!=nap_ind)
+      W_RETERROR(1,"AP_IND: Wrong size");
+    W_CHKSIZE(ap_bvals,nap_ind,"AP_BVALS");
+    if (ain>9) {
+      W_CHKSIZE(ap_pi,nap_ind,"AP_PI");
+      if (ain>10) {
+	W_CHKSIZE(ap_beta,nap_ind,"AP_BETA");
+      } else
+	ap_beta=0;
+    } else
+      ap_pi=ap_beta=0;
+    if (aout==0)
+      j0=0;
+    /* Potential manager (for all threads of the session) */
+    Handle<PotentialManager> potMan;
+    int nthreads=epSess.getDriver().numThreads();
+    if (nthreads>1) {
+      ArrayHandle<Handle<PotentialManager> > thrPots;
+      createThreadPotManagers(W_ARR(pm_potids),W_ARR(pm_numpot),
+			      W_ARR(pm_parvec),W_ARR(pm_parshrd),
+			      W_ARR(pm_annobj),nthreads,potMan,thrPots,
+			      W_ERRARGS);
+    } else
+      createPotentialManager(W_ARR(pm_potids),W_ARR(pm_numpot),
+			     W_ARR(pm_parvec),W_ARR(pm_parshrd),
+			     W_ARR(pm_annobj),potMan,W_ERRARGS);
+    if (potMan==0)
+      return;
+    if (potMan->size()!=num)
+      W_RETERROR(1,"PM_*: Potential manager has wrong size");
+
+    /* Append potentials */
+    int ret=epSess.appendPotentials(potMan,pm_potids,pm_numpot,npm_potids,
+				    num,ap_rowoff,ap_ind,ap_bvals,ap_beta,
+				    ap_pi);
+    if (j0!=0) *j0=ret;
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
@@ -0,0 +1,29 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_APPEND
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_APPEND_H
+#define EPTWRAP_FACT_SESSION_APPEND_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_append(int ain,int aout,void* sess,
+				   W_IARRAY(pm_potids),W_IARRAY(pm_numpot),
+				   W_DARRAY(pm_parvec),W_IARRAY(pm_parshrd),
+				   W_ARRAY(pm_annobj,void*),
+				   W_IARRAY(ap_rowoff),W_IARRAY(ap_ind),
+				   W_DARRAY(ap_bvals),W_DARRAY(ap_pi),
+				   W_DARRAY(ap_beta),int* j0,W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_CREATE
+ *
+ * EP with factorized Gaussian backbone. Creates a session object
+ * ('FactorizedEPSession'), which keeps potential manager, representation,
+ * selective damping data structure and EP driver between calls. Updates
+ * are run by EPTWRAP_FACT_SESSION_UPDATES, the session is destroyed by
+ * EPTWRAP_FACT_SESSION_DELETE.
+ * Arguments are the same as for EPTWRAP_FACT_SEQUPDATES (without UPDJIND,
+ * DAMPFACT), and are checked here only once. The session object refers
+ * to all array arguments (they are not copied). The caller must make
+ * sure they remain valid (and are not moved) until the session is
+ * deleted. RP_PI, RP_BETA, MARGPI, MARGBETA, SD_NUMVALID, SD_TOPIND,
+ * SD_TOPVAL are overwritten by later EPTWRAP_FACT_SESSION_UPDATES calls.
+ * If NTHREADS>1, potential managers for NTHREADS threads are created
+ * here as well (see EPTWRAP_FACT_COLUPDATES).
+ * Complete runs of sweeps are done by EPTWRAP_FACT_SESSION_SWEEPS.
+ * PM_POTIDS, PM_NUMPOT are copied for filtering potentials by type
+ * there.
+ * If SD_HEAP is true, selective damping uses 'FactEPMaximumPiHeap' (see
+ * EPTWRAP_FACT_SEQUPDATES). The heaps are built once here (O(nnz)) and
+ * kept by the session, and SD_NUMVALID, SD_TOPIND, SD_TOPVAL are written
+ * back at the end of each EPTWRAP_FACT_SESSION_UPDATES,
+ * EPTWRAP_FACT_SESSION_SWEEPS call, for variables changed in the call
+ * only. SD_SUBIND may be empty then. Such a session does not support
+ * EPTWRAP_FACT_SESSION_APPEND.
+ *
+ * Input:
+ * - N:           Number of variables
+ * - M:           Number of factors
+ * - PM_POTIDS:   Potential manager [int32 array]
+ * - PM_NUMPOT:   " [int32 array]
+ * - PM_PARVEC:   " [double array]
+ * - PM_PARSHRD:  " [int32 array]
+ * - PM_ANNOBJ:   " [void* array]
+ * - RP_ROWIND:   Factorized EP representation [int32 array]
+ * - RP_COLIND:   " [int32 array]
+ * - RP_BVALS:    " [double array]
+ * - RP_PI:       " [double array; I/O]
+ * - RP_BETA:     " [double array; I/O]
+ * - MARGPI:      Variable marginals [I/O]
+ * - MARGBETA:    " [I/O]
+ * - PIMINTHRES:  See EPTWRAP_FACT_SEQUPDATES. Positive
+ * - NTHREADS:    Number of threads. Optional, def. is 1
+ * - SD_NUMVALID: Selective damping. Optional [int32 array; I/O]
+ * - SD_TOPIND:   " [int32 array; I/O]
+ * - SD_TOPVAL:   " [double array; I/O]
+ * - SD_SUBIND    " [int32 array]
+ * - SD_SUBEXCL   ". Def.: false
+ * - SD_HEAP      ". Use 'FactEPMaximumPiHeap'? Def.: false
+ *
+ * Return:
+ * - SESS:        Session object [void*]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_create.h"
+#include "src/eptools/FactorizedEPRepresentation.h"
+
+void eptwrap_fact_session_create(int ain,int aout,int n,int m,
+				 W_IARRAY(pm_potids),W_IARRAY(pm_numpot),
+				 W_DARRAY(pm_parvec),W_IARRAY(pm_parshrd),
+				 W_ARRAY(pm_annobj,void*),W_IARRAY(rp_rowind),
+				 W_IARRAY(rp_colind),W_DARRAY(rp_bvals),
+				 W_DARRAY(rp_pi),W_DARRAY(rp_beta),
+				 W_DARRAY(margpi),W_DARRAY(margbeta),
+				 double piminthres,int nthreads,
+				 W_IARRAY(sd_numvalid),W_IARRAY(sd_topind),
+				 W_DARRAY(sd_topval),W_IARRAY(sd_subind),
+				 int sd_subexcl,int sd_heap,void** sess,
+				 W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<15 || ain>22)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout!=1)
+      W_RETERROR(2,"Wrong number of return arguments");
+    if (n<1) W_RETERROR(1,"N wrong");
+    if (m<1) W_RETERROR(1,"M wrong");
+    /* Representation of B */
+    Handle<FactorizedEPRepresentation> epRepr;
+    createFactEPRepres(n,m,W_ARR(rp_rowind),W_ARR(rp_colind),W_ARR(rp_bvals),
+		       W_ARR(rp_pi),W_ARR(rp_beta),epRepr,W_ERRARGS);
+    if (epRepr==0)
+      return;
+    /* Potential managers, driver and session */
+    createFactEPSession(ain,n,m,W_ARR(pm_potids),W_ARR(pm_numpot),
+			W_ARR(pm_parvec),W_ARR(pm_parshrd),W_ARR(pm_annobj),
+			epRepr,W_ARR(margpi),W_ARR(margbeta),piminthres,
+			nthreads,W_ARR(sd_numvalid),W_ARR(sd_topind),
+			W_ARR(sd_topval),W_ARR(sd_subind),sd_subexcl,
+			sd_heap,sess,W_ERRARGS);
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
@@ -0,0 +1,90 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_CREATE_F32
+ *
+ * EP with factorized Gaussian backbone. Creates a session object
+ * ('FactorizedEPSession'). Same as EPTWRAP_FACT_SESSION_CREATE, but
+ * RP_BVALS, RP_PI, RP_BETA are single precision arrays (see
+ * EPTWRAP_FACT_COMPMARGINALS_F32). The session is used with
+ * EPTWRAP_FACT_SESSION_UPDATES, EPTWRAP_FACT_SESSION_SWEEPS,
+ * EPTWRAP_FACT_SESSION_DELETE as usual. Potentials with bounded
+ * variance ('EPTWRAP_FACT_SEQUPDATES') and the packed layout (PACKED
+ * argument of EPTWRAP_FACT_SESSION_SWEEPS) are not supported in this
+ * case.
+ *
+ * Input:
+ * - N:           Number of variables
+ * - M:           Number of factors
+ * - PM_POTIDS:   Potential manager [int32 array]
+ * - PM_NUMPOT:   " [int32 array]
+ * - PM_PARVEC:   " [double array]
+ * - PM_PARSHRD:  " [int32 array]
+ * - PM_ANNOBJ:   " [void* array]
+ * - RP_ROWIND:   Factorized EP representation [int32 array]
+ * - RP_COLIND:   " [int32 array]
+ * - RP_BVALS:    " [float array]
+ * - RP_PI:       " [float array; I/O]
+ * - RP_BETA:     " [float array; I/O]
+ * - MARGPI:      Variable marginals [I/O]
+ * - MARGBETA:    " [I/O]
+ * - PIMINTHRES:  See EPTWRAP_FACT_SEQUPDATES. Positive
+ * - NTHREADS:    Number of threads. Optional, def. is 1
+ * - SD_NUMVALID: Selective damping. Optional [int32 array; I/O]
+ * - SD_TOPIND:   " [int32 array; I/O]
+ * - SD_TOPVAL:   " [double array; I/O]
+ * - SD_SUBIND    " [int32 array]
+ * - SD_SUBEXCL   ". Def.: false
+ * - SD_HEAP      ". Use 'FactEPMaximumPiHeap'? Def.: false
+ *
+ * Return:
+ * - SESS:        Session object [void*]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_create_f32.h"
+#include "src/eptools/FactorizedEPRepresentation.h"
+
+void eptwrap_fact_session_create_f32(int ain,int aout,int n,int m,
+				     W_IARRAY(pm_potids),W_IARRAY(pm_numpot),
+				     W_DARRAY(pm_parvec),W_IARRAY(pm_parshrd),
+				     W_ARRAY(pm_annobj,void*),
+				     W_IARRAY(rp_rowind),
+				     W_IARRAY(rp_colind),
+				     W_FARRAY(rp_bvals),W_FARRAY(rp_pi),
+				     W_FARRAY(rp_beta),W_DARRAY(margpi),
+				     W_DARRAY(margbeta),double piminthres,
+				     int nthreads,W_IARRAY(sd_numvalid),
+				     W_IARRAY(sd_topind),W_DARRAY(sd_topval),
+				     W_IARRAY(sd_subind),int sd_subexcl,
+				     int sd_heap,void** sess,W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<15 || ain>22)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout!=1)
+      W_RETERROR(2,"Wrong number of return arguments");
+    if (n<1) W_RETERROR(1,"N wrong");
+    if (m<1) W_RETERROR(1,"M wrong");
+    /* Representation of B */
+    Handle<FactorizedEPRepresentation> epRepr;
+    createFactEPRepresF32(n,m,W_ARR(rp_rowind),W_ARR(rp_colind),
+			  W_ARR(rp_bvals),W_ARR(rp_pi),W_ARR(rp_beta),epRepr,
+			  W_ERRARGS);
+    if (epRepr==0)
+      return;
+    /* Potential managers, driver and session */
+    createFactEPSession(ain,n,m,W_ARR(pm_potids),W_ARR(pm_numpot),
+			W_ARR(pm_parvec),W_ARR(pm_parshrd),W_ARR(pm_annobj),
+			epRepr,W_ARR(margpi),W_ARR(margbeta),piminthres,
+			nthreads,W_ARR(sd_numvalid),W_ARR(sd_topind),
+			W_ARR(sd_topval),W_ARR(sd_subind),sd_subexcl,
+			sd_heap,sess,W_ERRARGS);
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
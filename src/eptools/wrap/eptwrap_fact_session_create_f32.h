@@ -0,0 +1,39 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_CREATE_F32
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_CREATE_F32_H
+#define EPTWRAP_FACT_SESSION_CREATE_F32_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_create_f32(int ain,int aout,int n,int m,
+				       W_IARRAY(pm_potids),
+				       W_IARRAY(pm_numpot),
+				       W_DARRAY(pm_parvec),
+				       W_IARRAY(pm_parshrd),
+				       W_ARRAY(pm_annobj,void*),
+				       W_IARRAY(rp_rowind),
+				       W_IARRAY(rp_colind),
+				       W_FARRAY(rp_bvals),
+				       W_FARRAY(rp_pi),
+				       W_FARRAY(rp_beta),W_DARRAY(margpi),
+				       W_DARRAY(margbeta),double piminthres,
+				       int nthreads,W_IARRAY(sd_numvalid),
+				       W_IARRAY(sd_topind),
+				       W_DARRAY(sd_topval),
+				       W_IARRAY(sd_subind),int sd_subexcl,
+				       int sd_heap,void** sess,W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_DELETE
+ *
+ * Deletes session object created by EPTWRAP_FACT_SESSION_CREATE. SESS
+ * must not be used afterwards. Does nothing if SESS is NULL.
+ *
+ * Input:
+ * - SESS: Session object [void*]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_delete.h"
+#include "src/eptools/FactorizedEPSession.h"
+
+void eptwrap_fact_session_delete(void* sess,W_ERRORARGS)
+{
+  try {
+    if (sess!=0)
+      delete (FactorizedEPSession*) sess;
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
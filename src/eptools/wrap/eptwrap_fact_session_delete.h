@@ -0,0 +1,23 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_DELETE
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_DELETE_H
+#define EPTWRAP_FACT_SESSION_DELETE_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_delete(void* sess,W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
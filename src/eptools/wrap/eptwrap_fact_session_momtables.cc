@@ -0,0 +1,87 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_MOMTABLES
+ *
+ * EP with factorized Gaussian backbone. Enables moment tables for the
+ * potentials of a session object created by EPTWRAP_FACT_SESSION_CREATE
+ * (see 'DefaultPotManager::setMomentTables'), or disables them if TOL
+ * is 0. Potentials with the same parameters share a table over cavity
+ * means in MURANGE and cavity variances in RHORANGE, which answers
+ * local EP updates by interpolation up to an error of about TOL (on
+ * standardized values, see 'PotMomentTable'). Cells are refined at
+ * most MAXDEPTH times. Tables are created only for parameter settings
+ * shared by at least MINSHARE potentials (at most 64 per block of
+ * PM_POTIDS). Updates outside the table range, or where the tolerance
+ * cannot be met, are done exactly. This pays off for potentials whose
+ * updates use numerical quadrature.
+ * Tables are built lazily during later updates, and are discarded by
+ * the next call. Potentials appended after this call are not covered.
+ *
+ * Input:
+ * - SESS:     Session object [void*]
+ * - TOL:      S.a. Nonnegative
+ * - MURANGE:  S.a. Optional, def. is [-10 10]
+ * - RHORANGE: S.a. Optional, def. is [1e-4 100]
+ * - MAXDEPTH: S.a. Optional, def. is 6
+ * - MINSHARE: S.a. Optional, def. is 2
+ *
+ * Return:
+ * - NTAB:     Number of tables created [int32]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_momtables.h"
+#include "src/eptools/FactorizedEPSession.h"
+#include "src/eptools/potentials/PotMomentTable.h"
+
+void eptwrap_fact_session_momtables(int ain,int aout,void* sess,
+				    double tol,W_DARRAY(murange),
+				    W_DARRAY(rhorange),int maxdepth,
+				    int minshare,int* ntab,W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<2 || ain>6)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout!=1)
+      W_RETERROR(2,"Wrong number of return arguments");
+    if (sess==0)
+      W_RETERROR(1,"SESS is NULL");
+    FactorizedEPSession& epSess=*((FactorizedEPSession*) sess);
+    if (tol<0.0)
+      W_RETERROR(1,"TOL must be nonnegative");
+    PotMomentTableOptions opts;
+    opts.tol=tol;
+    if (ain>2) {
+      W_CHKSIZE(murange,2,"MURANGE");
+      if (murange[0]>=murange[1])
+	W_RETERROR(1,"MURANGE: Invalid range");
+      opts.muMin=murange[0]; opts.muMax=murange[1];
+      if (ain>3) {
+	W_CHKSIZE(rhorange,2,"RHORANGE");
+	if (rhorange[0]<=0.0 || rhorange[0]>=rhorange[1])
+	  W_RETERROR(1,"RHORANGE: Invalid range");
+	opts.rhoMin=rhorange[0]; opts.rhoMax=rhorange[1];
+	if (ain>4) {
+	  if (maxdepth<0 || maxdepth>20)
+	    W_RETERROR(1,"MAXDEPTH: Out of range");
+	  opts.maxDepth=maxdepth;
+	  if (ain>5) {
+	    if (minshare<1)
+	      W_RETERROR(1,"MINSHARE must be positive");
+	    opts.minShare=minshare;
+	  }
+	}
+      }
+    }
+    PotentialManager& potMan=epSess.getDriver().getEPPotentials();
+    *ntab=potMan.setMomentTables((tol>0.0)?&opts:0);
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
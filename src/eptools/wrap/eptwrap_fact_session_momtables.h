@@ -0,0 +1,26 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_MOMTABLES
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_MOMTABLES_H
+#define EPTWRAP_FACT_SESSION_MOMTABLES_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_momtables(int ain,int aout,void* sess,
+				      double tol,W_DARRAY(murange),
+				      W_DARRAY(rhorange),int maxdepth,
+				      int minshare,int* ntab,W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
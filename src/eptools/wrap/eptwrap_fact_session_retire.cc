@@ -0,0 +1,45 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_RETIRE
+ *
+ * EP with factorized Gaussian backbone. Retires potentials of a session
+ * object created by EPTWRAP_FACT_SESSION_CREATE (see
+ * 'FactorizedEPDriver::retirePotentials'): their messages are removed
+ * from MARGPI, MARGBETA, their EP parameters are set to zero, and they
+ * are skipped by all further updates (return status 5). Potentials
+ * already retired are ignored. Potentials are retired in the ordering
+ * of RETJIND. If this fails for one of them (marginal precision would
+ * become too small), an error is returned, and this and the remaining
+ * ones are not retired.
+ *
+ * Input:
+ * - SESS:    Session object [void*]
+ * - RETJIND: Potentials to retire [int32 array]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_retire.h"
+#include "src/eptools/FactorizedEPSession.h"
+
+void eptwrap_fact_session_retire(void* sess,W_IARRAY(retjind),W_ERRORARGS)
+{
+  try {
+    if (sess==0)
+      W_RETERROR(1,"SESS is NULL");
+    FactorizedEPSession& epSess=*((FactorizedEPSession*) sess);
+    int m=epSess.getDriver().numPotentials();
+    if (nretjind==0)
+      W_RETERROR(1,"RETJIND must not be empty");
+    Interval<int> ivM(0,m-1,IntVal::ivClosed,IntVal::ivClosed);
+    if (ivM.check(retjind,nretjind)!=0)
+      W_RETERROR(1,"RETJIND: Entries out of range");
+    epSess.retirePotentials(retjind,nretjind);
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
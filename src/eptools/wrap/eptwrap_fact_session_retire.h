@@ -0,0 +1,24 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_RETIRE
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_RETIRE_H
+#define EPTWRAP_FACT_SESSION_RETIRE_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_retire(void* sess,W_IARRAY(retjind),
+				   W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
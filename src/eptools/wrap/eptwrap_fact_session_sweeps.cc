@@ -0,0 +1,224 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_SWEEPS
+ *
+ * EP with factorized Gaussian backbone. Runs sweeps of EP updates until
+ * convergence, using a session object created by
+ * EPTWRAP_FACT_SESSION_CREATE. See 'FactorizedEPDriver::runSweeps'.
+ * In each sweep, all potentials are updated on, in a random ordering
+ * drawn from a generator seeded by SEED. Potentials whose types are in
+ * SKIPIDS are never updated. If FIRSTIDS is given, the first sweep is
+ * restricted to potentials whose types are in FIRSTIDS. Types are
+ * potential type IDs (see EPTWRAP_GETPOTID), matched against PM_POTIDS
+ * passed at session creation.
+ * MODE selects the update schedule, see EPTWRAP_FACT_SESSION_UPDATES.
+ * In addition, MODE 4 is residual scheduling: after a first sequential
+ * sweep, potentials are updated in the order of a priority queue keyed
+ * on their last DELTA, where an update raises the keys of all potentials
+ * sharing variables with it to at least its DELTA. A sweep then stops
+ * early once all keys are below DELTAEPS, and its DELTA is the largest
+ * key. Variables with more than MAXFANOUT potentials do not raise keys
+ * (0: no limit). See 'FactorizedEPDriver::runSweeps'.
+ * If REFRESH is 1, marginals are recomputed from EP parameters after each
+ * sweep. If REFRESH is 2, only the marginals of variables touched by
+ * the sweep are recomputed (same result, cost proportional to the
+ * updates done), and a full refresh is done only if marginals drift
+ * from the EP parameters by more than DRIFTTOL (relative), see
+ * 'FactorizedEPDriver::refreshMarginals'. We stop after MAXIT sweeps, or
+ * once the convergence statistic DELTA (maximum of DELTA over all
+ * updates of a sweep, see EPTWRAP_FACT_SEQUPDATES) is below DELTAEPS.
+ * If PACKED is true, the EP representation is switched to a packed row
+ * layout during the sweeps (see 'FactorizedEPRepresentation::packLayout').
+ * This can be faster for large models. Results are the same.
+ * If FREEZEK>0, potentials whose DELTA stays below FREEZEEPS (0: use
+ * DELTAEPS) for FREEZEK consecutive sweeps are frozen (not updated on),
+ * until the marginal of one of their variables moves by more than
+ * REACTTOL (relative; 0: use FREEZEEPS). Not for MODE 4.
+ * If WARMSTART is true, a warm start state is kept for each potential
+ * (last proximal map solution for potentials with quadrature), which
+ * speeds up local EP updates. It stays on for later calls. See
+ * 'FactorizedEPDriver::setWarmStart'.
+ *
+ * Statistics for each sweep are returned in DELTA, NSKIP, NSDAMP,
+ * NREFRESH (first NIT entries, resp. rows). NSKIP(k,:) is the histogram
+ * of update return stati for sweep k (size 6). NSDAMP(k) is the number
+ * of successful updates in sweep k which were selectively damped (0 if
+ * selective damping is not active). NREFRESH(k) is the number of
+ * variables whose marginals were recomputed after sweep k. NFROZEN(k)
+ * is the number of potentials frozen in sweep k (not part of NSKIP).
+ *
+ * Input:
+ * - SESS:        Session object [void*]
+ * - MAXIT:       Maximum number of sweeps. Positive
+ * - DELTAEPS:    Convergence threshold. Positive
+ * - DAMPFACT:    Damping factor, in [0,1). Optional, def. is 0
+ * - MODE:        S.a. Optional, def. is 0
+ * - REFRESH:     S.a. Optional, def. is 1
+ * - SEED:        S.a. Optional, def. is 0
+ * - SKIPIDS:     S.a. Optional, def. is empty [int32 array]
+ * - FIRSTIDS:    S.a. Optional, def. is empty [int32 array]
+ * - PACKED:      S.a. Optional, def. is false
+ * - DRIFTTOL:    S.a. Optional, def. is 1e-6
+ * - MAXFANOUT:   S.a. Optional, def. is 0
+ * - FREEZEK:     S.a. Optional, def. is 0
+ * - FREEZEEPS:   S.a. Optional, def. is 0
+ * - REACTTOL:    S.a. Optional, def. is 0
+ * - WARMSTART:   S.a. Optional, def. is false
+ *
+ * Return:
+ * - NIT:         Number of sweeps done [int32]
+ * - RSTAT:       0: Converged (DELTA<DELTAEPS); 1: MAXIT sweeps done.
+ *                Optional [int32]
+ * - DELTA:       S.a. Optional, size MAXIT
+ * - NSKIP:       S.a. Optional, size MAXIT*6 [int32]
+ * - NSDAMP:      S.a. Optional, size MAXIT [int32]
+ * - NREFRESH:    S.a. Optional, size MAXIT [int32]
+ * - NFROZEN:     S.a. Optional, size MAXIT [int32]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_sweeps.h"
+#include "src/eptools/FactorizedEPSession.h"
+
+void eptwrap_fact_session_sweeps(int ain,int aout,void* sess,int maxit,
+				 double deltaeps,double dampfact,int mode,
+				 int refresh,int seed,W_IARRAY(skipids),
+				 W_IARRAY(firstids),int packed,double drifttol,
+				 int maxfanout,int freezek,double freezeeps,
+				 double reacttol,int warmstart,int* nit,
+				 int* rstat,
+				 W_DARRAY(delta),
+				 W_IARRAY(nskip),W_IARRAY(nsdamp),
+				 W_IARRAY(nrefresh),W_IARRAY(nfrozen),
+				 W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<3 || ain>16)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout<1 || aout>7)
+      W_RETERROR(2,"Wrong number of return arguments");
+    if (sess==0)
+      W_RETERROR(1,"SESS is NULL");
+    FactorizedEPSession& epSess=*((FactorizedEPSession*) sess);
+    if (maxit<1)
+      W_RETERROR(1,"MAXIT must be positive");
+    if (deltaeps<=0.0)
+      W_RETERROR(1,"DELTAEPS must be positive");
+    FactEPSweepOptions opts;
+    if (ain>3) {
+      if (dampfact<0.0 || dampfact>=1.0)
+	W_RETERROR(1,"DAMPFACT: Out of range");
+      if (ain>4) {
+	if (mode<FactorizedEPDriver::modeSequential ||
+	    mode>FactorizedEPDriver::modeResidual)
+	  W_RETERROR(1,"MODE: Out of range");
+	opts.mode=mode;
+	if (ain>5) {
+	  if (refresh<0 || refresh>2)
+	    W_RETERROR(1,"REFRESH: Out of range");
+	  opts.doRefresh=(refresh!=0);
+	  opts.dirtyRefresh=(refresh==2);
+	  if (ain>6) {
+	    opts.seed=(uint) seed;
+	    if (ain>7) {
+	      if (nskipids>0)
+		opts.skipIds.changeRep(skipids,nskipids,false);
+	      if (ain>8) {
+		if (nfirstids>0)
+		  opts.firstIds.changeRep(firstids,nfirstids,false);
+		if (ain>9) {
+		  opts.packLayout=(packed!=0);
+		  if (ain>10) {
+		    if (drifttol<0.0)
+		      W_RETERROR(1,"DRIFTTOL: Must be nonnegative");
+		    opts.driftTol=drifttol;
+		    if (ain>11) {
+		      if (maxfanout<0)
+			W_RETERROR(1,"MAXFANOUT: Must be nonnegative");
+		      opts.maxFanout=maxfanout;
+		      if (ain>12) {
+			if (freezek<0)
+			  W_RETERROR(1,"FREEZEK: Must be nonnegative");
+			if (freezek>0 && mode==FactorizedEPDriver::modeResidual)
+			  W_RETERROR(1,"FREEZEK: Not for MODE 4");
+			opts.freezeSweeps=freezek;
+			if (ain>13) {
+			  if (freezeeps<0.0)
+			    W_RETERROR(1,"FREEZEEPS: Must be nonnegative");
+			  opts.freezeEps=freezeeps;
+			  if (ain>14) {
+			    if (reacttol<0.0)
+			      W_RETERROR(1,"REACTTOL: Must be nonnegative");
+			    opts.reactTol=reacttol;
+			    if (ain>15)
+			      opts.warmStart=(warmstart!=0);
+			  }
+			}
+		      }
+		    }
+		  }
+		}
+	      }
+	    }
+	  }
+	}
+      }
+    } else
+      dampfact=0.0;
+    /* Return arguments: Default values and check sizes */
+    if (aout<7) {
+      nfrozen=0;
+      if (aout<6)
+	nrefresh=0;
+      if (aout<5) {
+	nsdamp=0;
+	if (aout<4) {
+	  nskip=0;
+	  if (aout<3) {
+	    delta=0;
+	    if (aout==1)
+	      rstat=0;
+	  }
+	}
+      }
+    }
+    if (aout>2) {
+      W_CHKSIZE(delta,maxit,"DELTA");
+      if (aout>3) {
+	W_CHKSIZE(nskip,maxit*FactEPSweepStats::numStatus,"NSKIP");
+	if (aout>4) {
+	  W_CHKSIZE(nsdamp,maxit,"NSDAMP");
+	  if (aout>5) {
+	    W_CHKSIZE(nrefresh,maxit,"NREFRESH");
+	    if (aout>6)
+	      W_CHKSIZE(nfrozen,maxit,"NFROZEN");
+	  }
+	}
+      }
+    }
+
+    /* Run sweeps */
+    FactEPSweepStats stats;
+    *nit=epSess.runSweeps(maxit,deltaeps,dampfact,opts,stats);
+    if (rstat!=0) *rstat=stats.converged?0:1;
+    if (delta!=0)
+      std::copy(stats.delta.p(),stats.delta.p()+(*nit),delta);
+    if (nskip!=0)
+      std::copy(stats.numSkip.p(),
+		stats.numSkip.p()+(*nit)*FactEPSweepStats::numStatus,nskip);
+    if (nsdamp!=0)
+      std::copy(stats.numSelDamp.p(),stats.numSelDamp.p()+(*nit),nsdamp);
+    if (nrefresh!=0)
+      std::copy(stats.numRefresh.p(),stats.numRefresh.p()+(*nit),nrefresh);
+    if (nfrozen!=0)
+      std::copy(stats.numFrozen.p(),stats.numFrozen.p()+(*nit),nfrozen);
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
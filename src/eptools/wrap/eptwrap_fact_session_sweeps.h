@@ -0,0 +1,33 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_SWEEPS
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_SWEEPS_H
+#define EPTWRAP_FACT_SESSION_SWEEPS_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_sweeps(int ain,int aout,void* sess,int maxit,
+				   double deltaeps,double dampfact,int mode,
+				   int refresh,int seed,W_IARRAY(skipids),
+				   W_IARRAY(firstids),int packed,double drifttol,
+				   int maxfanout,int freezek,double freezeeps,
+				   double reacttol,int warmstart,int* nit,
+				   int* rstat,
+				   W_DARRAY(delta),
+				   W_IARRAY(nskip),W_IARRAY(nsdamp),
+				   W_IARRAY(nrefresh),W_IARRAY(nfrozen),
+				   W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_UPDATES
+ *
+ * EP with factorized Gaussian backbone. Run a number of updates on
+ * potentials, using a session object created by
+ * EPTWRAP_FACT_SESSION_CREATE. RP_PI, RP_BETA, MARGPI, MARGBETA (and the
+ * SD_XXX arrays if selective damping is active) passed there are
+ * overwritten.
+ * MODE selects the update schedule (see 'FactorizedEPSession'):
+ * - 0: Sequential updates in the ordering of UPDJIND. Same as
+ *      EPTWRAP_FACT_SEQUPDATES
+ * - 1: Colored parallel updates. Same as EPTWRAP_FACT_COLUPDATES, same
+ *      results as 0
+ * - 2: Parallel (synchronous) updates. Same as EPTWRAP_FACT_PARUPDATES.
+ *      Entries of UPDJIND must be distinct
+ * - 3: Asynchronous updates. Same as EPTWRAP_FACT_ASYNCUPDATES. Entries
+ *      of UPDJIND must be distinct, no selective damping
+ * Modes 1, 2, 3 use the number of threads passed at session creation.
+ * For all modes, return arguments are w.r.t. the ordering of UPDJIND.
+ *
+ * Input:
+ * - SESS:        Session object [void*]
+ * - UPDJIND:     Update on these potentials [int32 array]
+ * - DAMPFACT:    Damping factor, in [0,1). Optional, def. is 0
+ * - MODE:        S.a. Optional, def. is 0
+ *
+ * Return:
+ * - RSTAT:       Return stati for each update. Optional [int32]
+ * - DELTA:       See EPTWRAP_FACT_SEQUPDATES. Optional
+ * - SD_DAMPFACT: " Optional, only if selective damping
+ * - SD_NUPD:     " [int32]
+ * - SD_NREC:     " [int32]
+ * -------------------------------------------------------------------
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#include "src/main.h"
+#include "src/eptools/wrap/eptools_helper.h"
+#include "src/eptools/wrap/eptwrap_fact_session_updates.h"
+#include "src/eptools/FactorizedEPSession.h"
+
+void eptwrap_fact_session_updates(int ain,int aout,void* sess,
+				  W_IARRAY(updjind),double dampfact,int mode,
+				  W_IARRAY(rstat),W_DARRAY(delta),
+				  W_DARRAY(sd_dampfact),int* sd_nupd,
+				  int* sd_nrec,W_ERRORARGS)
+{
+  try {
+    /* Read arguments */
+    if (ain<2 || ain>4)
+      W_RETERROR(2,"Wrong number of input arguments");
+    if (aout>5)
+      W_RETERROR(2,"Too many return arguments");
+    if (sess==0)
+      W_RETERROR(1,"SESS is NULL");
+    FactorizedEPSession& epSess=*((FactorizedEPSession*) sess);
+    int m=epSess.getDriver().numPotentials();
+    if (nupdjind==0)
+      W_RETERROR(1,"UPDJIND must not be empty");
+    Interval<int> ivM(0,m-1,IntVal::ivClosed,IntVal::ivClosed);
+    if (ivM.check(updjind,nupdjind)!=0)
+      W_RETERROR(1,"UPDJIND: Entries of out range");
+    if (ain>2) {
+      if (dampfact<0.0 || dampfact>=1.0)
+	W_RETERROR(1,"DAMPFACT: Out of range");
+      if (ain>3) {
+	if (mode<FactorizedEPSession::modeSequential ||
+	    mode>FactorizedEPSession::modeAsync)
+	  W_RETERROR(1,"MODE: Out of range");
+      } else
+	mode=FactorizedEPSession::modeSequential;
+    } else {
+      dampfact=0.0; mode=FactorizedEPSession::modeSequential;
+    }
+    /* Return arguments: Default values and check sizes */
+    if (aout<5) {
+      sd_nrec=0;
+      if (aout<4) {
+	sd_nupd=0;
+	if (aout<3) {
+	  sd_dampfact=0;
+	  if (aout<2) {
+	    delta=0;
+	    if (aout==0)
+	      rstat=0;
+	  }
+	}
+      }
+    }
+    if (aout>0) {
+      W_CHKSIZE(rstat,nupdjind,"RSTAT");
+      if (aout>1) {
+	W_CHKSIZE(delta,nupdjind,"DELTA");
+	if (aout>2) {
+	  if (!epSess.isSelectiveDamping())
+	    W_RETERROR(1,"Cannot return SD_XXX");
+	  W_CHKSIZE(sd_dampfact,nupdjind,"SD_DAMPFACT");
+	}
+      }
+    }
+
+    /* Run updates */
+    epSess.runUpdates(updjind,nupdjind,dampfact,mode,rstat,delta,
+		      sd_dampfact);
+    if (sd_nupd!=0) {
+      int inrec;
+      epSess.getSelDampStats(*sd_nupd,inrec);
+      if (sd_nrec!=0) *sd_nrec=inrec;
+    }
+    W_RETOK;
+  } catch (StandardException ex) {
+    W_RETERROR_ARGS(1,"Caught LHOTSE exception: %s", ex.msg());
+  } catch (...) {
+    W_RETERROR(1,"Caught unspecified exception");
+  }
+}
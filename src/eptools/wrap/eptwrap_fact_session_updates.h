@@ -0,0 +1,27 @@
+/* -------------------------------------------------------------------
+ * EPTWRAP_FACT_SESSION_UPDATES
+ * -------------------------------------------------------------------
+ * Declaration wrapper function
+ * Author: Matthias Seeger
+ * ------------------------------------------------------------------- */
+
+#ifndef EPTWRAP_FACT_SESSION_UPDATES_H
+#define EPTWRAP_FACT_SESSION_UPDATES_H
+
+#include "src/eptools/wrap/eptools_helper_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void eptwrap_fact_session_updates(int ain,int aout,void* sess,
+				    W_IARRAY(updjind),double dampfact,
+				    int mode,W_IARRAY(rstat),W_DARRAY(delta),
+				    W_DARRAY(sd_dampfact),int* sd_nupd,
+				    int* sd_nrec,W_ERRORARGS);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif